@@ -23,9 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIOUtil.h>
 #include "mitkCommandLineParser.h"
 
-#include <mitkGIFCooccurenceMatrix.h>
-#include <mitkGIFGrayLevelRunLength.h>
-#include <mitkGIFFirstOrderStatistics.h>
+#include <mitkGIFMultiLabelFeatureEngine.h>
 #include <mitkGIFVolumetricStatistics.h>
 
 typedef itk::Image< double, 3 >                 FloatImageType;
@@ -61,6 +59,7 @@ int main(int argc, char* argv[])
   parser.addArgument("header","head",mitkCommandLineParser::String,"Add Header (Labels) to output","",us::Any());
   parser.addArgument("description","d",mitkCommandLineParser::String,"Text","Description that is added to the output",us::Any());
   parser.addArgument("same-space", "sp", mitkCommandLineParser::String, "Bool", "Set the spacing of all images to equal. Otherwise an error will be thrown. ", us::Any());
+  parser.addArgument("multi-label", "ml", mitkCommandLineParser::String, "Bool", "Calculates the features of each label of the mask and writes one line per label. Volumetric features are not supported.", us::Any());
   parser.addArgument("direction", "dir", mitkCommandLineParser::String, "Int", "Allows to specify the direction for Cooc and RL. 0: All directions, 1: Only single direction (Test purpose), 2,3,4... Without dimension 0,1,2... ", us::Any());
 
   // Miniapp Infos
@@ -80,9 +79,7 @@ int main(int argc, char* argv[])
     return EXIT_SUCCESS;
   }
 
-  MITK_INFO << "Version: "<< 1.3;
-
-  bool useCooc = parsedArgs.count("cooccurence");
+  MITK_INFO << "Version: "<< 1.4;
 
   mitk::Image::Pointer image = mitk::IOUtil::LoadImage(parsedArgs["image"].ToString());
   mitk::Image::Pointer mask = mitk::IOUtil::LoadImage(parsedArgs["mask"].ToString());
@@ -117,95 +114,105 @@ int main(int argc, char* argv[])
     direction = splitDouble(parsedArgs["direction"].ToString(), ';')[0];
   }
 
-  mitk::AbstractGlobalImageFeature::FeatureListType stats;
   ////////////////////////////////////////////////////////////////
-  // CAlculate First Order Features
+  // Calculate First Order, Co-occurence and Run-Length Features
+  // of all labels in one go
   ////////////////////////////////////////////////////////////////
-  if (parsedArgs.count("first-order"))
+  mitk::GIFMultiLabelFeatureEngine::Pointer engine = mitk::GIFMultiLabelFeatureEngine::New();
+  engine->SetUseFirstOrder(parsedArgs.count("first-order"));
+  engine->SetDirection(direction);
+  if (parsedArgs.count("cooccurence"))
+  {
+    engine->SetCooccurenceRanges(splitDouble(parsedArgs["cooccurence"].ToString(),';'));
+  }
+  if (parsedArgs.count("run-length"))
   {
-    MITK_INFO << "Start calculating first order statistics....";
-    mitk::GIFFirstOrderStatistics::Pointer firstOrderCalculator = mitk::GIFFirstOrderStatistics::New();
-    auto localResults = firstOrderCalculator->CalculateFeatures(image, mask);
-    stats.insert(stats.end(), localResults.begin(), localResults.end());
-    MITK_INFO << "Finished calculating first order statistics....";
+    engine->SetRunLengthRanges(splitDouble(parsedArgs["run-length"].ToString(),';'));
   }
 
-  ////////////////////////////////////////////////////////////////
-  // CAlculate Volume based Features
-  ////////////////////////////////////////////////////////////////
-  if (parsedArgs.count("volume"))
+  bool multiLabel = parsedArgs.count("multi-label");
+  mitk::GIFMultiLabelFeatureEngine::LabelFeatureMapType labelStats;
+  if (engine->GetUseFirstOrder() || !engine->GetCooccurenceRanges().empty() || !engine->GetRunLengthRanges().empty())
   {
-    MITK_INFO << "Start calculating volumetric ....";
-    mitk::GIFVolumetricStatistics::Pointer volCalculator = mitk::GIFVolumetricStatistics::New();
-    auto localResults = volCalculator->CalculateFeatures(image, mask);
-    stats.insert(stats.end(), localResults.begin(), localResults.end());
-    MITK_INFO << "Finished calculating volumetric....";
+    MITK_INFO << "Start calculating first order, co-occurence and run-length features....";
+    labelStats = engine->CalculateFeaturesOfLabels(image, mask);
+    MITK_INFO << "Finished calculating first order, co-occurence and run-length features....";
+  }
+  if (!multiLabel)
+  {
+    mitk::AbstractGlobalImageFeature::FeatureListType stats = labelStats[1];
+    labelStats.clear();
+    labelStats[1] = stats;
   }
 
   ////////////////////////////////////////////////////////////////
-  // CAlculate Co-occurence Features
+  // CAlculate Volume based Features
   ////////////////////////////////////////////////////////////////
-  if (parsedArgs.count("cooccurence"))
+  if (parsedArgs.count("volume"))
   {
-    auto ranges = splitDouble(parsedArgs["cooccurence"].ToString(),';');
-
-    for (int i = 0; i < ranges.size(); ++i)
+    if (multiLabel)
     {
-      MITK_INFO << "Start calculating coocurence with range " << ranges[i] << "....";
-      mitk::GIFCooccurenceMatrix::Pointer coocCalculator = mitk::GIFCooccurenceMatrix::New();
-      coocCalculator->SetRange(ranges[i]);
-      coocCalculator->SetDirection(direction);
-      auto localResults = coocCalculator->CalculateFeatures(image, mask);
-      stats.insert(stats.end(), localResults.begin(), localResults.end());
-      MITK_INFO << "Finished calculating coocurence with range " << ranges[i] << "....";
+      MITK_WARN << "Volumetric features are only calculated for single label masks.";
+    } else {
+      MITK_INFO << "Start calculating volumetric ....";
+      mitk::GIFVolumetricStatistics::Pointer volCalculator = mitk::GIFVolumetricStatistics::New();
+      auto localResults = volCalculator->CalculateFeatures(image, mask);
+      // keep the volumetric features behind the first order features
+      auto & stats = labelStats[1];
+      auto position = stats.begin();
+      while (position != stats.end() && position->first.compare(0, 10, "FirstOrder") == 0)
+      {
+        ++position;
+      }
+      stats.insert(position, localResults.begin(), localResults.end());
+      MITK_INFO << "Finished calculating volumetric....";
     }
   }
 
-  ////////////////////////////////////////////////////////////////
-  // CAlculate Run-Length Features
-  ////////////////////////////////////////////////////////////////
-  if (parsedArgs.count("run-length"))
+  for (auto label = labelStats.begin(); label != labelStats.end(); ++label)
   {
-    auto ranges = splitDouble(parsedArgs["run-length"].ToString(),';');
-
-    for (int i = 0; i < ranges.size(); ++i)
+    const auto & stats = label->second;
+    for (std::size_t i = 0; i < stats.size(); ++i)
     {
-      MITK_INFO << "Start calculating run-length with number of bins " << ranges[i] << "....";
-      mitk::GIFGrayLevelRunLength::Pointer calculator = mitk::GIFGrayLevelRunLength::New();
-      calculator->SetRange(ranges[i]);
-
-      auto localResults = calculator->CalculateFeatures(image, mask);
-      stats.insert(stats.end(), localResults.begin(), localResults.end());
-      MITK_INFO << "Finished calculating run-length with number of bins " << ranges[i] << "....";
+      std::cout << stats[i].first << " - " << stats[i].second <<std::endl;
     }
   }
-  for (int i = 0; i < stats.size(); ++i)
-  {
-    std::cout << stats[i].first << " - " << stats[i].second <<std::endl;
-  }
 
   std::ofstream output(parsedArgs["output"].ToString(),std::ios::app);
-  if ( parsedArgs.count("header") )
+  if ( parsedArgs.count("header") && !labelStats.empty())
   {
     if ( parsedArgs.count("description") )
     {
       output << "Description" << ";";
     }
-    for (int i = 0; i < stats.size(); ++i)
+    if (multiLabel)
+    {
+      output << "Label" << ";";
+    }
+    const auto & stats = labelStats.begin()->second;
+    for (std::size_t i = 0; i < stats.size(); ++i)
     {
       output << stats[i].first << ";";
     }
     output << std::endl;
   }
-  if ( parsedArgs.count("description") )
-  {
-    output << parsedArgs["description"].ToString() << ";";
-  }
-  for (int i = 0; i < stats.size(); ++i)
+  for (auto label = labelStats.begin(); label != labelStats.end(); ++label)
   {
-    output << stats[i].second << ";";
+    if ( parsedArgs.count("description") )
+    {
+      output << parsedArgs["description"].ToString() << ";";
+    }
+    if (multiLabel)
+    {
+      output << label->first << ";";
+    }
+    const auto & stats = label->second;
+    for (std::size_t i = 0; i < stats.size(); ++i)
+    {
+      output << stats[i].second << ";";
+    }
+    output << std::endl;
   }
-  output << std::endl;
   output.close();
 
   return 0;
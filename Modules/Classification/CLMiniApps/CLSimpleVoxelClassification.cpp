@@ -27,6 +27,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIOUtil.h>
 
 #include <mitkDataCollectionUtilities.h>
+#include <mitkDCFeatureBlockReader.h>
+#include <mitkDCMatrixBlockWriter.h>
 #include <mitkRandomForestIO.h>
 #include <mitkVigraRandomForestClassifier.h>
 
@@ -200,21 +202,21 @@ int main(int argc, char* argv[])
   forest->Train(trainDataX, trainDataY);
 
 
-  // prepare feature matrix for test case
-  auto testDataX = mitk::DCUtilities::DC3dDToMatrixXd(testCollection,features, classMap);
-  auto testDataNewY = forest->Predict(testDataX);
+  // predict the test case block-wise, writing labels and the probabilities of the first two classes
+  std::vector<std::string> resultNames;
+  resultNames.push_back("RESULT");
+  std::vector<std::string> probabilityNames;
+  probabilityNames.push_back("prob0");
+  probabilityNames.push_back("prob1");
 
-
-  mitk::DCUtilities::MatrixToDC3d(testDataNewY, testCollection, "RESULT", classMap);
-
-  Eigen::MatrixXd Probs = forest->GetPointWiseProbabilities();
-
-
-  Eigen::MatrixXd prob0 = Probs.col(0);
-  Eigen::MatrixXd prob1 = Probs.col(1);
-
-  mitk::DCUtilities::MatrixToDC3d(prob0, testCollection,"prob0", classMap);
-  mitk::DCUtilities::MatrixToDC3d(prob1, testCollection,"prob1", classMap);
+  mitk::DCFeatureBlockReader testDataReader(testCollection, features, classMap);
+  mitk::DCMatrixBlockWriter testDataWriter(testCollection, resultNames, probabilityNames, classMap);
+  Eigen::MatrixXf testDataX;
+  while (testDataReader.ReadBlock(testDataX))
+  {
+    auto testDataNewY = forest->Predict(testDataX);
+    testDataWriter.WriteBlock(testDataNewY, forest->GetPointWiseProbabilities());
+  }
 
 
   std::vector<std::string> outputFilter;
@@ -29,6 +29,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIOUtil.h>
 
 #include <mitkDataCollectionUtilities.h>
+#include <mitkDCFeatureBlockReader.h>
+#include <mitkDCMatrixBlockWriter.h>
 #include <mitkRandomForestIO.h>
 
 // ----------------------- Forest Handling ----------------------
@@ -338,11 +340,19 @@ int main(int argc, char* argv[])
     //////////////////////////////////////////////////////////////////////////////
     // If required do test
     //////////////////////////////////////////////////////////////////////////////
-    auto testDataX = mitk::DCUtilities::DC3dDToMatrixXd(testCollection,modalities, testMask);
-    auto testDataNewY = forest->Predict(testDataX);
+    // Predict block-wise, so that the feature matrix of the whole test collection is never allocated
+    std::vector<std::string> resultNames;
+    resultNames.push_back(resultMask);
+    mitk::DCFeatureBlockReader testDataReader(testCollection, modalities, testMask);
+    mitk::DCMatrixBlockWriter testDataWriter(testCollection, resultNames, testMask);
+    Eigen::MatrixXf testDataX;
+    while (testDataReader.ReadBlock(testDataX))
+    {
+      auto testDataNewY = forest->Predict(testDataX);
+      testDataWriter.WriteBlock(testDataNewY);
+    }
     //MITK_INFO << testDataNewY;
 
-    mitk::DCUtilities::MatrixToDC3d(testDataNewY, testCollection, resultMask, testMask);
     //forest.SetMaskName(testMask);
     //forest.SetCollection(testCollection);
     //forest.Test();
@@ -0,0 +1,101 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkGIFMultiLabelFeatureEngine_h
+#define mitkGIFMultiLabelFeatureEngine_h
+
+#include <mitkAbstractGlobalImageFeature.h>
+#include <mitkBaseData.h>
+#include <MitkCLUtilitiesExports.h>
+
+#include <map>
+
+namespace mitk
+{
+  /**
+  * \brief Calculates first order, co-occurence and run-length features for all labels of a label image at once.
+  *
+  * Gives the same features as GIFFirstOrderStatistics, GIFCooccurenceMatrix and GIFGrayLevelRunLength with the
+  * same settings, but instead of running one filter pipeline per feature class, per offset and per mask, the image
+  * is traversed once. The statistics, co-occurence matrices and run-length matrices of all offsets, ranges and
+  * labels are accumulated in this traversal, afterwards the features of the labels are calculated in parallel.
+  *
+  * Each label value greater than zero is an own region. CalculateFeatures() returns the features of label 1,
+  * which corresponds to the single feature classes and a binary mask.
+  */
+  class MITKCLUTILITIES_EXPORT GIFMultiLabelFeatureEngine : public AbstractGlobalImageFeature
+  {
+  public:
+    mitkClassMacro(GIFMultiLabelFeatureEngine,AbstractGlobalImageFeature)
+      itkFactorylessNewMacro(Self)
+      itkCloneMacro(Self)
+
+      GIFMultiLabelFeatureEngine();
+
+    typedef std::map<int, FeatureListType> LabelFeatureMapType;
+
+    /**
+    * \brief Calculates the features of label 1 of the mask.
+    */
+    virtual FeatureListType CalculateFeatures(const Image::Pointer & image, const Image::Pointer &mask) override;
+
+    /**
+    * \brief Calculates the features of each label greater than zero of the label image.
+    */
+    LabelFeatureMapType CalculateFeaturesOfLabels(const Image::Pointer & image, const Image::Pointer &labelImage);
+
+    /**
+    * \brief Returns a list of the names of all features that are calculated from this class
+    */
+    virtual FeatureNameListType GetFeatureNames() override;
+
+    itkGetConstMacro(UseFirstOrder, bool);
+    itkSetMacro(UseFirstOrder, bool);
+    itkGetConstMacro(HistogramSize,int);
+    itkSetMacro(HistogramSize, int);
+    itkGetConstMacro(UseCtRange,bool);
+    itkSetMacro(UseCtRange, bool);
+    itkGetConstMacro(Direction, unsigned int);
+    itkSetMacro(Direction, unsigned int);
+
+    /** Ranges of the co-occurence matrices, no co-occurence features are calculated if empty */
+    void SetCooccurenceRanges(const std::vector<double> & ranges) { m_CooccurenceRanges = ranges; }
+    std::vector<double> GetCooccurenceRanges() const { return m_CooccurenceRanges; }
+
+    /** Ranges (number of bins) of the run-length matrices, no run-length features are calculated if empty */
+    void SetRunLengthRanges(const std::vector<double> & ranges) { m_RunLengthRanges = ranges; }
+    std::vector<double> GetRunLengthRanges() const { return m_RunLengthRanges; }
+
+    struct ParameterStruct
+    {
+      bool m_UseFirstOrder;
+      int m_HistogramSize;
+      bool m_UseCtRange;
+      unsigned int m_Direction;
+      std::vector<double> m_CooccurenceRanges;
+      std::vector<double> m_RunLengthRanges;
+    };
+
+  private:
+    bool m_UseFirstOrder;
+    int m_HistogramSize;
+    bool m_UseCtRange;
+    unsigned int m_Direction;
+    std::vector<double> m_CooccurenceRanges;
+    std::vector<double> m_RunLengthRanges;
+  };
+}
+#endif //mitkGIFMultiLabelFeatureEngine_h
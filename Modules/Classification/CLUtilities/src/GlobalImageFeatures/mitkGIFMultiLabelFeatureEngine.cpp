@@ -0,0 +1,744 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkGIFMultiLabelFeatureEngine.h>
+
+// MITK
+#include <mitkITKImageImport.h>
+#include <mitkImageCast.h>
+#include <mitkImageAccessByItk.h>
+
+// ITK
+#include <itkEnhancedScalarImageToTextureFeaturesFilter.h>
+#include <itkEnhancedScalarImageToRunLengthFeaturesFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkMultiThreader.h>
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <unordered_map>
+
+static const char* CooccurenceFeatureNames[] = {
+  "Energy", "Entropy", "Correlation", "InverseDifferenceMoment", "Inertia", "ClusterShade", "ClusterProminence",
+  "HaralickCorrelation", "Autocorrelation", "Contrast", "Dissimilarity", "MaximumProbability", "InverseVariance",
+  "Homogeneity1", "ClusterTendency", "Variance", "SumAverage", "SumEntropy", "SumVariance", "DifferenceAverage",
+  "DifferenceEntropy", "DifferenceVariance", "InverseDifferenceMomentNormalized", "InverseDifferenceNormalized",
+  "InverseDifference" };
+static const unsigned int NumberOfCooccurenceFeatures = 25;
+
+static const char* RunLengthFeatureNames[] = {
+  "ShortRunEmphasis", "LongRunEmphasis", "GreyLevelNonuniformity", "RunLengthNonuniformity",
+  "LowGreyLevelRunEmphasis", "HighGreyLevelRunEmphasis", "ShortRunLowGreyLevelEmphasis",
+  "ShortRunHighGreyLevelEmphasis", "LongRunLowGreyLevelEmphasis", "LongRunHighGreyLevelEmphasis", "RunPercentage",
+  "NumberOfRuns" };
+static const unsigned int NumberOfRunLengthFeatures = 12;
+
+static const char* FirstOrderFeatureNames[] = {
+  "FirstOrder Range", "FirstOrder Uniformity", "FirstOrder Entropy", "FirstOrder Energy", "FirstOrder RMS",
+  "FirstOrder Kurtosis", "FirstOrder Skewness", "FirstOrder Mean absolute deviation",
+  "FirstOrder Covered Image Intensity Range", "FirstOrder Minimum", "FirstOrder Maximum", "FirstOrder Mean",
+  "FirstOrder Variance", "FirstOrder Sum", "FirstOrder Median", "FirstOrder Standard deviation",
+  "FirstOrder No. of Voxel" };
+static const unsigned int NumberOfFirstOrderFeatures = 17;
+
+/** Sparse co-occurence or run-length matrix, the key is index[0] + index[1] * size[0] of the histogram */
+typedef std::unordered_map<unsigned long, unsigned long> SparseMatrixType;
+
+template<typename TPixel, unsigned int VImageDimension>
+struct MultiLabelFeatureData
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<int, VImageDimension> LabelImageType;
+  typedef typename ImageType::OffsetType OffsetType;
+
+  const ImageType* m_Image;
+  const LabelImageType* m_LabelImage;
+  mitk::GIFMultiLabelFeatureEngine::ParameterStruct m_Params;
+  TPixel m_ImageMinimum;
+  TPixel m_ImageMaximum;
+
+  std::vector<int> m_Labels;
+  std::vector<std::vector<itk::OffsetValueType> > m_LabelVoxels; ///< buffer offsets of the voxels of each label in raster order
+  std::vector<std::vector<OffsetType> > m_CooccurenceOffsets; ///< offsets for each co-occurence range
+  std::vector<OffsetType> m_RunLengthOffsets;
+  std::vector<mitk::GIFMultiLabelFeatureEngine::FeatureListType> m_Features; ///< result of each label
+};
+
+/** Bin of a value within the bounds of the histogram, the same bin as returned by Histogram::GetIndex() */
+template<typename THistogram>
+static unsigned int GetBinOfValue(const THistogram* histogram, unsigned int dimension, double value)
+{
+  const int size = histogram->GetSize(dimension);
+  const double lower = histogram->GetBinMin(dimension, 0);
+  const double upper = histogram->GetBinMax(dimension, size - 1);
+  int bin = static_cast<int>((value - lower) / (upper - lower) * size);
+  bin = std::max(0, std::min(size - 1, bin));
+  while (bin > 0 && value < histogram->GetBinMin(dimension, bin))
+    --bin;
+  while (bin < size - 1 && value >= histogram->GetBinMax(dimension, bin))
+    ++bin;
+  return bin;
+}
+
+/** Same as Histogram::GetBinMinFromValue() without searching all bins */
+template<typename THistogram>
+static double GetBinMinFromValue(const THistogram* histogram, double value)
+{
+  const unsigned int size = histogram->GetSize(0);
+  if (value <= histogram->GetBinMin(0, 0))
+    return histogram->GetBinMin(0, 0);
+  if (value >= histogram->GetBinMin(0, size - 1))
+    return histogram->GetBinMin(0, size - 1);
+  return histogram->GetBinMin(0, GetBinOfValue(histogram, 0, value));
+}
+
+/** Same as Histogram::GetBinMaxFromValue() without searching all bins */
+template<typename THistogram>
+static double GetBinMaxFromValue(const THistogram* histogram, double value)
+{
+  const unsigned int size = histogram->GetSize(0);
+  if (value <= histogram->GetBinMax(0, 0))
+    return histogram->GetBinMax(0, 0);
+  if (value >= histogram->GetBinMax(0, size - 1))
+    return histogram->GetBinMax(0, size - 1);
+  return histogram->GetBinMax(0, GetBinOfValue(histogram, 0, value));
+}
+
+/** Writes a sparse matrix into a 2D histogram, or resets its bins to zero */
+template<typename THistogram>
+static void SetHistogramFrequencies(THistogram* histogram, const SparseMatrixType & matrix, bool reset)
+{
+  typename THistogram::IndexType index(2);
+  const unsigned long sizeX = histogram->GetSize(0);
+  for (auto iter = matrix.begin(); iter != matrix.end(); ++iter)
+  {
+    index[0] = iter->first % sizeX;
+    index[1] = iter->first / sizeX;
+    histogram->SetFrequencyOfIndex(index, reset ? 0 : iter->second);
+  }
+  histogram->Modified();
+}
+
+/** Number of gray levels of the run-length matrix, as chosen by GIFGrayLevelRunLength */
+static int GetRunLengthRangeOfPixels(double range)
+{
+  int rangeOfPixels = range;
+  if (rangeOfPixels < 2)
+    rangeOfPixels = 256;
+  return rangeOfPixels;
+}
+
+/** Feature name prefixes as used by GIFCooccurenceMatrix and GIFGrayLevelRunLength */
+static std::string GetCooccurencePrefix(double range)
+{
+  std::ostringstream  ss;
+  ss << range;
+  return "co-occ. (" + ss.str() + ") ";
+}
+
+static std::string GetRunLengthPrefix(int rangeOfPixels)
+{
+  std::ostringstream  ss;
+  ss << rangeOfPixels;
+  return "RunLength. (" + ss.str() + ") ";
+}
+
+static void AddMeansAndStdNames(const std::string & prefix, const char** names, unsigned int numberOfFeatures,
+                                mitk::GIFMultiLabelFeatureEngine::FeatureNameListType & featureList)
+{
+  for (unsigned int feature = 0; feature < numberOfFeatures; ++feature)
+  {
+    featureList.push_back(prefix + names[feature] + " Means");
+    featureList.push_back(prefix + names[feature] + " Std.");
+  }
+}
+
+/** Mean and standard deviation over the offsets as in the ITK texture filters */
+static void AddMeansAndStd(const std::vector<std::vector<double> > & features, const std::string & prefix,
+                           const char** names, unsigned int numberOfFeatures,
+                           mitk::GIFMultiLabelFeatureEngine::FeatureListType & featureList)
+{
+  if (features.empty())
+    return;
+  for (unsigned int feature = 0; feature < numberOfFeatures; ++feature)
+  {
+    double mean = features[0][feature];
+    double deviation = 0;
+    for (std::size_t offset = 1; offset < features.size(); ++offset)
+    {
+      double k = offset + 1;
+      double x = features[offset][feature];
+      double newMean = mean + (x - mean) / k;
+      deviation += (x - mean) * (x - newMean);
+      mean = newMean;
+    }
+    deviation = std::sqrt(deviation / features.size());
+    featureList.push_back(std::make_pair(prefix + names[feature] + " Means", mean));
+    featureList.push_back(std::make_pair(prefix + names[feature] + " Std.", deviation));
+  }
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void CalculateFirstOrderFeaturesOfLabel(MultiLabelFeatureData<TPixel, VImageDimension> & data, std::size_t label,
+                                               mitk::GIFMultiLabelFeatureEngine::FeatureListType & featureList)
+{
+  typedef itk::Statistics::Histogram<double> HistogramType;
+
+  const TPixel* buffer = data.m_Image->GetBufferPointer();
+  const std::vector<itk::OffsetValueType> & voxels = data.m_LabelVoxels[label];
+
+  HistogramType::Pointer histogram = HistogramType::New();
+  histogram->SetMeasurementVectorSize(1);
+  HistogramType::SizeType size(1);
+  HistogramType::MeasurementVectorType lowerBound(1), upperBound(1);
+  if (data.m_Params.m_UseCtRange)
+  {
+    size[0] = static_cast<int>(1024.5 + 3096.5);
+    lowerBound[0] = -1024.5;
+    upperBound[0] = 3096.5;
+  } else {
+    size[0] = data.m_Params.m_HistogramSize;
+    lowerBound[0] = data.m_ImageMinimum;
+    upperBound[0] = data.m_ImageMaximum;
+  }
+  histogram->Initialize(size, lowerBound, upperBound);
+
+  HistogramType::MeasurementVectorType measurement(1);
+  HistogramType::IndexType index(1);
+  double sum = 0;
+  double sumOfSquares = 0;
+  double minimum = buffer[voxels[0]];
+  double maximum = buffer[voxels[0]];
+  for (auto voxel = voxels.begin(); voxel != voxels.end(); ++voxel)
+  {
+    double value = buffer[*voxel];
+    sum += value;
+    sumOfSquares += value * value;
+    minimum = std::min(minimum, value);
+    maximum = std::max(maximum, value);
+    measurement[0] = value;
+    if (histogram->GetIndex(measurement, index))
+    {
+      histogram->IncreaseFrequencyOfIndex(index, 1);
+    }
+  }
+
+  // Statistics as calculated by itk::LabelStatisticsImageFilter
+  unsigned long numberOfVoxels = voxels.size();
+  double count = numberOfVoxels;
+  double mean = sum / count;
+  double variance = 0;
+  if (numberOfVoxels > 1)
+  {
+    variance = (sumOfSquares - sum * sum / count) / (count - 1);
+  }
+  double sigma = std::sqrt(variance);
+
+  double total = 0;
+  unsigned int medianBin = 0;
+  while (total <= numberOfVoxels / 2 && medianBin < histogram->GetSize(0))
+  {
+    index[0] = medianBin;
+    total += histogram->GetFrequency(index);
+    ++medianBin;
+  }
+  --medianBin;
+  double median = histogram->GetBinMin(0, medianBin) + (histogram->GetBinMax(0, medianBin) - histogram->GetBinMin(0, medianBin)) / 2;
+
+  // Features as calculated by GIFFirstOrderStatistics
+  double imageRange = static_cast<double>(data.m_ImageMaximum) - static_cast<double>(data.m_ImageMinimum);
+  double range = maximum - minimum;
+  double uncorrected_std_dev = std::sqrt((count - 1) / count * variance);
+  double binWidth = histogram->GetBinMax(0, 0) - histogram->GetBinMin(0, 0);
+
+  double uniformity = 0;
+  double entropy = 0;
+  double squared_sum = 0;
+  double kurtosis = 0;
+  double mean_absolut_deviation = 0;
+  double skewness = 0;
+
+  double Log2 = log(2);
+  for (int i = 0; i < (int)(histogram->GetSize(0)); ++i)
+  {
+    index[0] = i;
+    double prob = histogram->GetFrequency(index);
+
+    if (prob < 0.1)
+      continue;
+
+    double voxelValue = histogram->GetBinMin(0, i) + binWidth * 0.5;
+
+    squared_sum += prob * voxelValue*voxelValue;
+
+    prob /= count;
+    mean_absolut_deviation += prob* std::abs(voxelValue - mean);
+
+    kurtosis += prob* (voxelValue - mean) * (voxelValue - mean) * (voxelValue - mean) * (voxelValue - mean);
+    skewness += prob* (voxelValue - mean) * (voxelValue - mean) * (voxelValue - mean);
+
+    uniformity += prob*prob;
+    if (prob > 0)
+    {
+      entropy += prob * std::log(prob) / Log2;
+    }
+  }
+
+  double rms = std::sqrt(squared_sum / count);
+  kurtosis = kurtosis / (uncorrected_std_dev*uncorrected_std_dev * uncorrected_std_dev*uncorrected_std_dev);
+  skewness = skewness / (uncorrected_std_dev*uncorrected_std_dev * uncorrected_std_dev);
+  double coveredGrayValueRange = range / imageRange;
+
+  double values[] = { range, uniformity, entropy, squared_sum, rms, kurtosis, skewness, mean_absolut_deviation,
+    coveredGrayValueRange, minimum, maximum, mean, variance, sum, median, sigma, count };
+  for (unsigned int i = 0; i < NumberOfFirstOrderFeatures; ++i)
+  {
+    featureList.push_back(std::make_pair(FirstOrderFeatureNames[i], values[i]));
+  }
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void CalculateCooccurenceFeaturesOfLabel(MultiLabelFeatureData<TPixel, VImageDimension> & data, std::size_t label,
+                                                mitk::GIFMultiLabelFeatureEngine::FeatureListType & featureList)
+{
+  typedef typename MultiLabelFeatureData<TPixel, VImageDimension>::ImageType ImageType;
+  typedef itk::Statistics::EnhancedScalarImageToTextureFeaturesFilter<ImageType> FilterType;
+  typedef typename FilterType::HistogramType HistogramType;
+  typedef typename FilterType::TextureFeaturesFilterType TextureFilterType;
+
+  const std::vector<double> & ranges = data.m_Params.m_CooccurenceRanges;
+  const TPixel* buffer = data.m_Image->GetBufferPointer();
+  const int* labelBuffer = data.m_LabelImage->GetBufferPointer();
+  const typename ImageType::RegionType region = data.m_Image->GetBufferedRegion();
+  const std::vector<itk::OffsetValueType> & voxels = data.m_LabelVoxels[label];
+  const int labelValue = data.m_Labels[label];
+
+  // Same binning as the co-occurence matrix filter used by GIFCooccurenceMatrix
+  const TPixel minimum = static_cast<TPixel>(data.m_ImageMinimum - 0.5);
+  const TPixel maximum = static_cast<TPixel>(data.m_ImageMaximum + 0.5);
+  const unsigned int bins = FilterType::CooccurrenceMatrixFilterType::DefaultBinsPerAxis;
+  typename HistogramType::Pointer histogram = HistogramType::New();
+  histogram->SetMeasurementVectorSize(2);
+  typename HistogramType::SizeType size(2);
+  size.Fill(bins);
+  typename HistogramType::MeasurementVectorType lowerBound(2), upperBound(2);
+  lowerBound.Fill(minimum);
+  upperBound.Fill(static_cast<double>(maximum) + 1);
+  histogram->Initialize(size, lowerBound, upperBound);
+
+  // Accumulate the matrices of all ranges and offsets while the voxels of the label are visited once
+  std::vector<std::vector<SparseMatrixType> > matrices(ranges.size());
+  for (std::size_t r = 0; r < ranges.size(); ++r)
+  {
+    matrices[r].resize(data.m_CooccurenceOffsets[r].size());
+  }
+  for (auto voxel = voxels.begin(); voxel != voxels.end(); ++voxel)
+  {
+    const TPixel centerPixelIntensity = buffer[*voxel];
+    if (centerPixelIntensity < minimum || centerPixelIntensity > maximum)
+      continue;
+    const unsigned long centerBin = GetBinOfValue(histogram.GetPointer(), 0, centerPixelIntensity);
+    const typename ImageType::IndexType centerIndex = data.m_Image->ComputeIndex(*voxel);
+    for (std::size_t r = 0; r < ranges.size(); ++r)
+    {
+      for (std::size_t o = 0; o < data.m_CooccurenceOffsets[r].size(); ++o)
+      {
+        typename ImageType::IndexType index = centerIndex + data.m_CooccurenceOffsets[r][o];
+        if (!region.IsInside(index))
+          continue;
+        itk::OffsetValueType neighbor = data.m_Image->ComputeOffset(index);
+        if (labelBuffer[neighbor] != labelValue)
+          continue;
+        const TPixel pixelIntensity = buffer[neighbor];
+        if (pixelIntensity < minimum || pixelIntensity > maximum)
+          continue;
+        const unsigned long bin = GetBinOfValue(histogram.GetPointer(), 0, pixelIntensity);
+        ++matrices[r][o][centerBin + bin * bins];
+        ++matrices[r][o][bin + centerBin * bins];
+      }
+    }
+  }
+
+  for (std::size_t r = 0; r < ranges.size(); ++r)
+  {
+    std::vector<std::vector<double> > features(matrices[r].size(), std::vector<double>(NumberOfCooccurenceFeatures));
+    for (std::size_t o = 0; o < matrices[r].size(); ++o)
+    {
+      SetHistogramFrequencies(histogram.GetPointer(), matrices[r][o], false);
+      typename TextureFilterType::Pointer textureFilter = TextureFilterType::New();
+      textureFilter->SetInput(histogram);
+      textureFilter->Update();
+      for (unsigned int i = 0; i < NumberOfCooccurenceFeatures; ++i)
+      {
+        features[o][i] = textureFilter->GetFeature(static_cast<typename TextureFilterType::TextureFeatureName>(i));
+      }
+      SetHistogramFrequencies(histogram.GetPointer(), matrices[r][o], true);
+    }
+
+    AddMeansAndStd(features, GetCooccurencePrefix(ranges[r]), CooccurenceFeatureNames, NumberOfCooccurenceFeatures, featureList);
+  }
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void CalculateRunLengthFeaturesOfLabel(MultiLabelFeatureData<TPixel, VImageDimension> & data, std::size_t label,
+                                              std::vector<bool> & visited,
+                                              mitk::GIFMultiLabelFeatureEngine::FeatureListType & featureList)
+{
+  typedef typename MultiLabelFeatureData<TPixel, VImageDimension>::ImageType ImageType;
+  typedef typename MultiLabelFeatureData<TPixel, VImageDimension>::OffsetType OffsetType;
+  typedef itk::Statistics::EnhancedScalarImageToRunLengthFeaturesFilter<ImageType> FilterType;
+  typedef typename FilterType::HistogramType HistogramType;
+  typedef typename FilterType::RunLengthFeaturesFilterType RunLengthFilterType;
+
+  const TPixel* buffer = data.m_Image->GetBufferPointer();
+  const typename ImageType::RegionType region = data.m_Image->GetBufferedRegion();
+  const std::vector<itk::OffsetValueType> & voxels = data.m_LabelVoxels[label];
+
+  for (std::size_t r = 0; r < data.m_Params.m_RunLengthRanges.size(); ++r)
+  {
+    const int rangeOfPixels = GetRunLengthRangeOfPixels(data.m_Params.m_RunLengthRanges[r]);
+
+    // Same binning as the run-length matrix filter used by GIFGrayLevelRunLength
+    TPixel minimum = data.m_ImageMinimum;
+    TPixel maximum = data.m_ImageMaximum;
+    unsigned int bins = rangeOfPixels;
+    if (data.m_Params.m_UseCtRange)
+    {
+      minimum = (TPixel)(-1024.5);
+      maximum = (TPixel)(3096.5);
+      bins = static_cast<unsigned int>(3096.5 + 1024.5);
+    }
+    typename HistogramType::Pointer histogram = HistogramType::New();
+    histogram->SetMeasurementVectorSize(2);
+    typename HistogramType::SizeType size(2);
+    size.Fill(bins);
+    typename HistogramType::MeasurementVectorType lowerBound(2), upperBound(2);
+    lowerBound[0] = minimum;
+    lowerBound[1] = 0;
+    upperBound[0] = maximum;
+    upperBound[1] = rangeOfPixels;
+    histogram->Initialize(size, lowerBound, upperBound);
+    const double lastBinMax = histogram->GetBinMax(0, bins - 1);
+
+    typename HistogramType::MeasurementVectorType run(2);
+    typename HistogramType::IndexType hIndex(2);
+    std::vector<itk::OffsetValueType> visitedVoxels;
+
+    std::vector<std::vector<double> > features(data.m_RunLengthOffsets.size(), std::vector<double>(NumberOfRunLengthFeatures));
+    for (std::size_t o = 0; o < data.m_RunLengthOffsets.size(); ++o)
+    {
+      const OffsetType offset = data.m_RunLengthOffsets[o];
+      SparseMatrixType matrix;
+
+      // Runs are followed from the voxels of the label in raster order, exactly as the run-length matrix filter
+      // does it for a mask, but the voxels outside of the label are never visited as starting points.
+      for (auto voxel = voxels.begin(); voxel != voxels.end(); ++voxel)
+      {
+        const TPixel centerPixelIntensity = buffer[*voxel];
+        if (centerPixelIntensity < minimum || centerPixelIntensity > maximum || visited[*voxel])
+          continue;
+
+        const double centerBinMin = GetBinMinFromValue(histogram.GetPointer(), centerPixelIntensity);
+        const double centerBinMax = GetBinMaxFromValue(histogram.GetPointer(), centerPixelIntensity);
+        const typename ImageType::IndexType centerIndex = data.m_Image->ComputeIndex(*voxel);
+
+        bool runLengthSegmentAlreadyVisited = false;
+        typename ImageType::IndexType lastGoodIndex[2] = { centerIndex, centerIndex };
+        for (int direction = 0; direction < 2 && !runLengthSegmentAlreadyVisited; ++direction)
+        {
+          typename ImageType::IndexType index = direction == 0 ? centerIndex + offset : centerIndex - offset;
+          while (region.IsInside(index))
+          {
+            itk::OffsetValueType neighbor = data.m_Image->ComputeOffset(index);
+            if (visited[neighbor])
+            {
+              runLengthSegmentAlreadyVisited = true;
+              break;
+            }
+            const TPixel pixelIntensity = buffer[neighbor];
+            if (pixelIntensity >= centerBinMin
+              && (pixelIntensity < centerBinMax || (pixelIntensity == centerBinMax && centerBinMax == lastBinMax)))
+            {
+              visited[neighbor] = true;
+              visitedVoxels.push_back(neighbor);
+              lastGoodIndex[direction] = index;
+              if (direction == 0)
+                index += offset;
+              else
+                index -= offset;
+            }
+            else
+            {
+              break;
+            }
+          }
+        }
+        if (runLengthSegmentAlreadyVisited)
+          continue;
+
+        typename ImageType::PointType point;
+        data.m_Image->TransformIndexToPhysicalPoint(lastGoodIndex[1], point);
+        typename ImageType::PointType point2;
+        data.m_Image->TransformIndexToPhysicalPoint(lastGoodIndex[0], point2);
+
+        run[0] = centerPixelIntensity;
+        run[1] = point.EuclideanDistanceTo(point2);
+        if (run[1] >= 0 && run[1] <= rangeOfPixels && histogram->GetIndex(run, hIndex))
+        {
+          ++matrix[hIndex[0] + hIndex[1] * bins];
+        }
+      }
+      for (auto voxel = visitedVoxels.begin(); voxel != visitedVoxels.end(); ++voxel)
+      {
+        visited[*voxel] = false;
+      }
+      visitedVoxels.clear();
+
+      SetHistogramFrequencies(histogram.GetPointer(), matrix, false);
+      typename RunLengthFilterType::Pointer runLengthFilter = RunLengthFilterType::New();
+      runLengthFilter->SetInput(histogram);
+      runLengthFilter->SetNumberOfVoxels(voxels.size());
+      runLengthFilter->Update();
+      for (unsigned int i = 0; i < NumberOfRunLengthFeatures; ++i)
+      {
+        features[o][i] = runLengthFilter->GetFeature(static_cast<typename RunLengthFilterType::RunLengthFeatureName>(i));
+      }
+      SetHistogramFrequencies(histogram.GetPointer(), matrix, true);
+    }
+
+    AddMeansAndStd(features, GetRunLengthPrefix(rangeOfPixels), RunLengthFeatureNames, NumberOfRunLengthFeatures, featureList);
+  }
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static ITK_THREAD_RETURN_TYPE CalculateFeaturesOfLabelsCallback(void * arg)
+{
+  typedef itk::MultiThreader::ThreadInfoStruct  ThreadInfoType;
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  MultiLabelFeatureData<TPixel, VImageDimension> * data = static_cast<MultiLabelFeatureData<TPixel, VImageDimension> *>(infoStruct->UserData);
+
+  std::vector<bool> visited;
+  if (!data->m_Params.m_RunLengthRanges.empty())
+  {
+    visited.resize(data->m_Image->GetBufferedRegion().GetNumberOfPixels(), false);
+  }
+
+  // Each thread takes every n-th label
+  for (std::size_t label = infoStruct->ThreadID; label < data->m_Labels.size(); label += infoStruct->NumberOfThreads)
+  {
+    mitk::GIFMultiLabelFeatureEngine::FeatureListType & featureList = data->m_Features[label];
+    if (data->m_Params.m_UseFirstOrder)
+    {
+      CalculateFirstOrderFeaturesOfLabel(*data, label, featureList);
+    }
+    CalculateCooccurenceFeaturesOfLabel(*data, label, featureList);
+    CalculateRunLengthFeaturesOfLabel(*data, label, visited, featureList);
+  }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+void
+  CalculateMultiLabelFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer labelImage, mitk::GIFMultiLabelFeatureEngine::ParameterStruct params, mitk::GIFMultiLabelFeatureEngine::LabelFeatureMapType & labelFeatures)
+{
+  typedef MultiLabelFeatureData<TPixel, VImageDimension> DataType;
+  typedef typename DataType::ImageType ImageType;
+  typedef typename DataType::LabelImageType LabelImageType;
+  typedef typename DataType::OffsetType OffsetType;
+  typedef itk::Statistics::EnhancedScalarImageToTextureFeaturesFilter<ImageType> CooccurenceFilterType;
+  typedef itk::Statistics::EnhancedScalarImageToRunLengthFeaturesFilter<ImageType> RunLengthFilterType;
+
+  typename LabelImageType::Pointer itkLabelImage = LabelImageType::New();
+  mitk::CastToItkImage(labelImage, itkLabelImage);
+
+  DataType data;
+  data.m_Image = itkImage;
+  data.m_LabelImage = itkLabelImage;
+  data.m_Params = params;
+
+  // The only traversal of the whole image: intensity range and voxels of each label
+  std::unordered_map<int, std::size_t> labelIndices;
+  itk::ImageRegionConstIterator<ImageType> imageIter(itkImage, itkImage->GetBufferedRegion());
+  itk::ImageRegionConstIterator<LabelImageType> labelIter(itkLabelImage, itkLabelImage->GetBufferedRegion());
+  data.m_ImageMinimum = itk::NumericTraits<TPixel>::max();
+  data.m_ImageMaximum = itk::NumericTraits<TPixel>::NonpositiveMin();
+  for (itk::OffsetValueType voxel = 0; !imageIter.IsAtEnd(); ++imageIter, ++labelIter, ++voxel)
+  {
+    const TPixel value = imageIter.Get();
+    data.m_ImageMinimum = std::min(data.m_ImageMinimum, value);
+    data.m_ImageMaximum = std::max(data.m_ImageMaximum, value);
+
+    const int label = labelIter.Get();
+    if (label <= 0)
+      continue;
+    auto labelIndex = labelIndices.find(label);
+    if (labelIndex == labelIndices.end())
+    {
+      labelIndex = labelIndices.insert(std::make_pair(label, data.m_Labels.size())).first;
+      data.m_Labels.push_back(label);
+      data.m_LabelVoxels.push_back(std::vector<itk::OffsetValueType>());
+    }
+    data.m_LabelVoxels[labelIndex->second].push_back(voxel);
+  }
+  if (data.m_Labels.empty())
+    return;
+
+  // Offsets as used by GIFCooccurenceMatrix
+  for (std::size_t r = 0; r < params.m_CooccurenceRanges.size(); ++r)
+  {
+    std::vector<OffsetType> newOffset;
+    auto oldOffsets = CooccurenceFilterType::New()->GetOffsets();
+    auto oldOffsetsIterator = oldOffsets->Begin();
+    while(oldOffsetsIterator != oldOffsets->End())
+    {
+      bool continueOuterLoop = false;
+      OffsetType offset = oldOffsetsIterator->Value();
+      for (unsigned int i = 0; i < VImageDimension; ++i)
+      {
+        offset[i] *= params.m_CooccurenceRanges[r];
+        if (params.m_Direction == i + 2 && offset[i] != 0)
+        {
+          continueOuterLoop = true;
+        }
+      }
+      if (params.m_Direction == 1)
+      {
+        offset[0] = 0;
+        offset[1] = 0;
+        offset[2] = 1;
+        newOffset.push_back(offset);
+        break;
+      }
+
+      oldOffsetsIterator++;
+      if (continueOuterLoop)
+        continue;
+      newOffset.push_back(offset);
+    }
+    data.m_CooccurenceOffsets.push_back(newOffset);
+  }
+
+  // Offsets as used by GIFGrayLevelRunLength, pointing forward in raster order like in the run-length matrix filter
+  if (!params.m_RunLengthRanges.empty())
+  {
+    auto oldOffsets = RunLengthFilterType::New()->GetOffsets();
+    auto oldOffsetsIterator = oldOffsets->Begin();
+    while (oldOffsetsIterator != oldOffsets->End())
+    {
+      bool continueOuterLoop = false;
+      OffsetType offset = oldOffsetsIterator->Value();
+      for (unsigned int i = 0; i < VImageDimension; ++i)
+      {
+        if (params.m_Direction == i + 2 && offset[i] != 0)
+        {
+          continueOuterLoop = true;
+        }
+      }
+      if (params.m_Direction == 1)
+      {
+        offset[0] = 0;
+        offset[1] = 0;
+        offset[2] = 1;
+      }
+
+      oldOffsetsIterator++;
+      if (continueOuterLoop)
+        continue;
+
+      int sign = 1;
+      bool metLastNonZero = false;
+      for (int i = VImageDimension - 1; i >= 0; i--)
+      {
+        if (metLastNonZero)
+        {
+          offset[i] *= sign;
+        }
+        else if (offset[i] != 0)
+        {
+          sign = (offset[i] > 0) ? 1 : -1;
+          metLastNonZero = true;
+          offset[i] *= sign;
+        }
+      }
+      data.m_RunLengthOffsets.push_back(offset);
+      if (params.m_Direction == 1)
+        break;
+    }
+  }
+
+  // Features of the labels in parallel
+  data.m_Features.resize(data.m_Labels.size());
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(std::max(1, std::min<int>(threader->GetNumberOfThreads(), data.m_Labels.size())));
+  threader->SetSingleMethod(&CalculateFeaturesOfLabelsCallback<TPixel, VImageDimension>, &data);
+  threader->SingleMethodExecute();
+
+  for (std::size_t label = 0; label < data.m_Labels.size(); ++label)
+  {
+    labelFeatures[data.m_Labels[label]] = data.m_Features[label];
+  }
+}
+
+mitk::GIFMultiLabelFeatureEngine::GIFMultiLabelFeatureEngine() :
+  m_UseFirstOrder(true), m_HistogramSize(256), m_UseCtRange(false), m_Direction(0)
+{
+}
+
+mitk::GIFMultiLabelFeatureEngine::FeatureListType mitk::GIFMultiLabelFeatureEngine::CalculateFeatures(const Image::Pointer & image, const Image::Pointer &mask)
+{
+  LabelFeatureMapType labelFeatures = this->CalculateFeaturesOfLabels(image, mask);
+  return labelFeatures[1];
+}
+
+mitk::GIFMultiLabelFeatureEngine::LabelFeatureMapType mitk::GIFMultiLabelFeatureEngine::CalculateFeaturesOfLabels(const Image::Pointer & image, const Image::Pointer &labelImage)
+{
+  LabelFeatureMapType labelFeatures;
+
+  ParameterStruct params;
+  params.m_UseFirstOrder = m_UseFirstOrder;
+  params.m_HistogramSize = m_HistogramSize;
+  params.m_UseCtRange = m_UseCtRange;
+  params.m_Direction = m_Direction;
+  params.m_CooccurenceRanges = m_CooccurenceRanges;
+  params.m_RunLengthRanges = m_RunLengthRanges;
+
+  AccessByItk_3(image, CalculateMultiLabelFeatures, labelImage, params, labelFeatures);
+
+  return labelFeatures;
+}
+
+mitk::GIFMultiLabelFeatureEngine::FeatureNameListType mitk::GIFMultiLabelFeatureEngine::GetFeatureNames()
+{
+  FeatureNameListType featureList;
+  if (m_UseFirstOrder)
+  {
+    for (unsigned int i = 0; i < NumberOfFirstOrderFeatures; ++i)
+    {
+      featureList.push_back(FirstOrderFeatureNames[i]);
+    }
+  }
+  for (std::size_t r = 0; r < m_CooccurenceRanges.size(); ++r)
+  {
+    AddMeansAndStdNames(GetCooccurencePrefix(m_CooccurenceRanges[r]), CooccurenceFeatureNames, NumberOfCooccurenceFeatures, featureList);
+  }
+  for (std::size_t r = 0; r < m_RunLengthRanges.size(); ++r)
+  {
+    AddMeansAndStdNames(GetRunLengthPrefix(GetRunLengthRangeOfPixels(m_RunLengthRanges[r])), RunLengthFeatureNames, NumberOfRunLengthFeatures, featureList);
+  }
+  return featureList;
+}
@@ -0,0 +1,174 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+
+#include <mitkImageCast.h>
+#include <mitkGIFFirstOrderStatistics.h>
+#include <mitkGIFCooccurenceMatrix.h>
+#include <mitkGIFGrayLevelRunLength.h>
+#include <mitkGIFMultiLabelFeatureEngine.h>
+#include <math.h>
+#include <algorithm>
+
+class mitkGIFMultiLabelFeatureEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGIFMultiLabelFeatureEngineTestSuite);
+
+  MITK_TEST(SingleLabel_EqualsSingleFeatureClasses);
+  MITK_TEST(MultipleLabels_EqualSingleFeatureClasses);
+  MITK_TEST(MissingLabel_NoFeatures);
+  MITK_TEST(FeatureNames_EqualCalculatedFeatures);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  typedef itk::Image<unsigned char,3> MaskType;
+
+  mitk::Image::Pointer m_Image, m_LabelImage, m_Mask1, m_Mask2;
+
+  static void FillCube(MaskType* mask, int x, int y, int z, int range, unsigned char label)
+  {
+    MaskType::IndexType index;
+    for (index[0] = x-range; index[0] < x+range+1; ++index[0])
+    {
+      for (index[1] = y-range; index[1] < y+range+1; ++index[1])
+      {
+        for (index[2] = z-range; index[2] < z+range+1; ++index[2])
+        {
+          mask->SetPixel(index, label);
+        }
+      }
+    }
+  }
+
+  mitk::Image::Pointer CreateMask(bool firstCube, bool secondCube, unsigned char secondLabel)
+  {
+    MaskType::Pointer itkMask;
+    mitk::CastToItkImage(m_Image, itkMask);
+    itkMask->FillBuffer(0);
+    if (firstCube)
+      FillCube(itkMask, 88, 81, 13, 2, 1);
+    if (secondCube)
+      FillCube(itkMask, 60, 70, 20, 3, secondLabel);
+    mitk::Image::Pointer mask;
+    mitk::CastToMitkImage(itkMask, mask);
+    return mask;
+  }
+
+  mitk::GIFMultiLabelFeatureEngine::Pointer CreateEngine()
+  {
+    std::vector<double> cooccurenceRanges;
+    cooccurenceRanges.push_back(1);
+    cooccurenceRanges.push_back(2);
+    std::vector<double> runLengthRanges;
+    runLengthRanges.push_back(16);
+
+    mitk::GIFMultiLabelFeatureEngine::Pointer engine = mitk::GIFMultiLabelFeatureEngine::New();
+    engine->SetCooccurenceRanges(cooccurenceRanges);
+    engine->SetRunLengthRanges(runLengthRanges);
+    return engine;
+  }
+
+  /** Features of the single feature classes in the order of the engine */
+  mitk::AbstractGlobalImageFeature::FeatureListType CalculateSingleFeatures(mitk::Image::Pointer mask)
+  {
+    mitk::AbstractGlobalImageFeature::FeatureListType features;
+    mitk::AbstractGlobalImageFeature::FeatureListType localResults;
+
+    mitk::GIFFirstOrderStatistics::Pointer firstOrderCalculator = mitk::GIFFirstOrderStatistics::New();
+    localResults = firstOrderCalculator->CalculateFeatures(m_Image, mask);
+    features.insert(features.end(), localResults.begin(), localResults.end());
+
+    for (double range = 1; range < 3; ++range)
+    {
+      mitk::GIFCooccurenceMatrix::Pointer coocCalculator = mitk::GIFCooccurenceMatrix::New();
+      coocCalculator->SetRange(range);
+      localResults = coocCalculator->CalculateFeatures(m_Image, mask);
+      features.insert(features.end(), localResults.begin(), localResults.end());
+    }
+
+    mitk::GIFGrayLevelRunLength::Pointer runLengthCalculator = mitk::GIFGrayLevelRunLength::New();
+    runLengthCalculator->SetRange(16);
+    localResults = runLengthCalculator->CalculateFeatures(m_Image, mask);
+    features.insert(features.end(), localResults.begin(), localResults.end());
+    return features;
+  }
+
+  void AssertEqualFeatures(const mitk::AbstractGlobalImageFeature::FeatureListType & expected,
+                           const mitk::AbstractGlobalImageFeature::FeatureListType & features)
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The engine should calculate the same number of features", expected.size(), features.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("The features should be in the same order", expected[i].first, features[i].first);
+      if (expected[i].second != expected[i].second)
+      {
+        CPPUNIT_ASSERT_MESSAGE(expected[i].first + " should be undefined", features[i].second != features[i].second);
+        continue;
+      }
+      double tolerance = 1e-6 * std::max(1.0, std::abs(expected[i].second));
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(expected[i].first, expected[i].second, features[i].second, tolerance);
+    }
+  }
+
+public:
+
+  void setUp(void)
+  {
+    m_Image = mitk::IOUtil::LoadImage(GetTestDataFilePath("Pic3D.nrrd"));
+    m_LabelImage = CreateMask(true, true, 2);
+    m_Mask1 = CreateMask(true, false, 0);
+    m_Mask2 = CreateMask(false, true, 1);
+  }
+
+  void SingleLabel_EqualsSingleFeatureClasses()
+  {
+    auto features = CreateEngine()->CalculateFeatures(m_Image, m_Mask1);
+    AssertEqualFeatures(CalculateSingleFeatures(m_Mask1), features);
+  }
+
+  void MultipleLabels_EqualSingleFeatureClasses()
+  {
+    auto labelFeatures = CreateEngine()->CalculateFeaturesOfLabels(m_Image, m_LabelImage);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Two labels should be found", std::size_t(2), labelFeatures.size());
+    AssertEqualFeatures(CalculateSingleFeatures(m_Mask1), labelFeatures[1]);
+    AssertEqualFeatures(CalculateSingleFeatures(m_Mask2), labelFeatures[2]);
+  }
+
+  void MissingLabel_NoFeatures()
+  {
+    auto labelFeatures = CreateEngine()->CalculateFeaturesOfLabels(m_Image, CreateMask(false, false, 0));
+    CPPUNIT_ASSERT_MESSAGE("An empty label image should give no features", labelFeatures.empty());
+  }
+
+  void FeatureNames_EqualCalculatedFeatures()
+  {
+    mitk::GIFMultiLabelFeatureEngine::Pointer engine = CreateEngine();
+    auto names = engine->GetFeatureNames();
+    auto features = engine->CalculateFeatures(m_Image, m_Mask1);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("There should be a name for every feature", features.size(), names.size());
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("The names should be in the order of the features", features[i].first, names[i]);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGIFMultiLabelFeatureEngine)
@@ -44,6 +44,12 @@ namespace mitk
     Eigen::MatrixXi Predict(const Eigen::MatrixXd &X);
     Eigen::MatrixXi PredictWeighted(const Eigen::MatrixXd &X);
 
+    ///
+    /// @brief Predict class for single precision samples, e.g. blocks of voxels read with a DCFeatureBlockReader.
+    /// The samples are classified without converting them to double.
+    ///
+    Eigen::MatrixXi Predict(const Eigen::MatrixXf &X);
+    Eigen::MatrixXi PredictWeighted(const Eigen::MatrixXf &X);
 
     bool SupportsPointWiseWeight();
     bool SupportsPointWiseProbability();
@@ -74,7 +80,7 @@ namespace mitk
 
 
     struct TrainingData;
-    struct PredictionData;
+    template <typename TFeature> struct PredictionData;
     struct EigenToVigraTransform;
     struct Parameter;
 
@@ -84,9 +90,15 @@ namespace mitk
     vigra::RandomForest<int> m_RandomForest;
 
     static ITK_THREAD_RETURN_TYPE TrainTreesCallback(void *);
+    template <typename TFeature>
+    Eigen::MatrixXi PredictMatrix(const Eigen::Matrix<TFeature, Eigen::Dynamic, Eigen::Dynamic> &X, bool weighted);
+
+    template <typename TFeature>
     static ITK_THREAD_RETURN_TYPE PredictCallback(void *);
+    template <typename TFeature>
     static ITK_THREAD_RETURN_TYPE PredictWeightedCallback(void *);
-    static void VigraPredictWeighted(PredictionData *data, vigra::MultiArrayView<2, double> & X, vigra::MultiArrayView<2, int> & Y, vigra::MultiArrayView<2, double> & P);
+    template <typename TFeature>
+    static void VigraPredictWeighted(PredictionData<TFeature> *data, vigra::MultiArrayView<2, TFeature> & X, vigra::MultiArrayView<2, int> & Y, vigra::MultiArrayView<2, double> & P);
   };
 }
 
@@ -76,10 +76,11 @@ struct mitk::VigraRandomForestClassifier::TrainingData
   Parameter m_Parameter;
 };
 
+template <typename TFeature>
 struct mitk::VigraRandomForestClassifier::PredictionData
 {
   PredictionData(const vigra::RandomForest<int> & refRF,
-    const vigra::MultiArrayView<2, double> refFeature,
+    const vigra::MultiArrayView<2, TFeature> refFeature,
     vigra::MultiArrayView<2, int> refLabel,
     vigra::MultiArrayView<2, double> refProb,
     vigra::MultiArrayView<2, double> refTreeWeights)
@@ -91,7 +92,7 @@ struct mitk::VigraRandomForestClassifier::PredictionData
   {
   }
   const vigra::RandomForest<int> & m_RandomForest;
-  const vigra::MultiArrayView<2, double> m_Feature;
+  const vigra::MultiArrayView<2, TFeature> m_Feature;
   vigra::MultiArrayView<2, int> m_Label;
   vigra::MultiArrayView<2, double> m_Probabilities;
   vigra::MultiArrayView<2, double> m_TreeWeights;
@@ -176,36 +177,26 @@ void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, cons
 
 Eigen::MatrixXi mitk::VigraRandomForestClassifier::Predict(const Eigen::MatrixXd &X_in)
 {
-  // Initialize output Eigen matrices
-  m_OutProbability = Eigen::MatrixXd(X_in.rows(),m_RandomForest.class_count());
-  m_OutProbability.fill(0);
-  m_OutLabel = Eigen::MatrixXi(X_in.rows(),1);
-  m_OutLabel.fill(0);
-
-  // If no weights provided
-  if(m_TreeWeights.rows() != m_RandomForest.tree_count())
-  {
-    m_TreeWeights = Eigen::MatrixXd(m_RandomForest.tree_count(),1);
-    m_TreeWeights.fill(1);
-  }
-
-
-  vigra::MultiArrayView<2, double> P(vigra::Shape2(m_OutProbability.rows(),m_OutProbability.cols()),m_OutProbability.data());
-  vigra::MultiArrayView<2, int> Y(vigra::Shape2(m_OutLabel.rows(),m_OutLabel.cols()),m_OutLabel.data());
-  vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
-  vigra::MultiArrayView<2, double> TW(vigra::Shape2(m_RandomForest.tree_count(),1),m_TreeWeights.data());
+  return this->PredictMatrix<double>(X_in, false);
+}
 
-  std::unique_ptr<PredictionData> data;
-  data.reset( new PredictionData(m_RandomForest,X,Y,P,TW));
+Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::MatrixXd &X_in)
+{
+  return this->PredictMatrix<double>(X_in, true);
+}
 
-  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
-  threader->SetSingleMethod(this->PredictCallback,data.get());
-  threader->SingleMethodExecute();
+Eigen::MatrixXi mitk::VigraRandomForestClassifier::Predict(const Eigen::MatrixXf &X_in)
+{
+  return this->PredictMatrix<float>(X_in, false);
+}
 
-  return m_OutLabel;
+Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::MatrixXf &X_in)
+{
+  return this->PredictMatrix<float>(X_in, true);
 }
 
-Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::MatrixXd &X_in)
+template <typename TFeature>
+Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictMatrix(const Eigen::Matrix<TFeature, Eigen::Dynamic, Eigen::Dynamic> &X_in, bool weighted)
 {
   // Initialize output Eigen matrices
   m_OutProbability = Eigen::MatrixXd(X_in.rows(),m_RandomForest.class_count());
@@ -223,14 +214,21 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::
 
   vigra::MultiArrayView<2, double> P(vigra::Shape2(m_OutProbability.rows(),m_OutProbability.cols()),m_OutProbability.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(m_OutLabel.rows(),m_OutLabel.cols()),m_OutLabel.data());
-  vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
+  vigra::MultiArrayView<2, TFeature> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
   vigra::MultiArrayView<2, double> TW(vigra::Shape2(m_RandomForest.tree_count(),1),m_TreeWeights.data());
 
-  std::unique_ptr<PredictionData> data;
-  data.reset( new PredictionData(m_RandomForest,X,Y,P,TW));
+  std::unique_ptr<PredictionData<TFeature> > data;
+  data.reset( new PredictionData<TFeature>(m_RandomForest,X,Y,P,TW));
 
   itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
-  threader->SetSingleMethod(this->PredictWeightedCallback,data.get());
+  if (weighted)
+  {
+    threader->SetSingleMethod(&VigraRandomForestClassifier::PredictWeightedCallback<TFeature>,data.get());
+  }
+  else
+  {
+    threader->SetSingleMethod(&VigraRandomForestClassifier::PredictCallback<TFeature>,data.get());
+  }
   threader->SingleMethodExecute();
 
   return m_OutLabel;
@@ -296,6 +294,7 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::TrainTreesCallback(voi
 
 }
 
+template <typename TFeature>
 ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictCallback(void * arg)
 {
   // Get the ThreadInfoStruct
@@ -306,7 +305,7 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictCallback(void *
 
   // Get the user defined parameters containing all
   // neccesary informations
-  PredictionData * data = (PredictionData *)(infoStruct->UserData);
+  PredictionData<TFeature> * data = (PredictionData<TFeature> *)(infoStruct->UserData);
   unsigned int numberOfRowsToCalculate = 0;
 
   // Get number of rows to calculate
@@ -320,7 +319,7 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictCallback(void *
     end_index += data->m_Feature.shape()[0] % infoStruct->NumberOfThreads;
   }
 
-  vigra::MultiArrayView<2, double> split_features;
+  vigra::MultiArrayView<2, TFeature> split_features;
   vigra::MultiArrayView<2, int> split_labels;
   vigra::MultiArrayView<2, double> split_probability;
   {
@@ -349,6 +348,7 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictCallback(void *
 
 }
 
+template <typename TFeature>
 ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictWeightedCallback(void * arg)
 {
   // Get the ThreadInfoStruct
@@ -359,7 +359,7 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictWeightedCallbac
 
   // Get the user defined parameters containing all
   // neccesary informations
-  PredictionData * data = (PredictionData *)(infoStruct->UserData);
+  PredictionData<TFeature> * data = (PredictionData<TFeature> *)(infoStruct->UserData);
   unsigned int numberOfRowsToCalculate = 0;
 
   // Get number of rows to calculate
@@ -373,7 +373,7 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictWeightedCallbac
     end_index += data->m_Feature.shape()[0] % infoStruct->NumberOfThreads;
   }
 
-  vigra::MultiArrayView<2, double> split_features;
+  vigra::MultiArrayView<2, TFeature> split_features;
   vigra::MultiArrayView<2, int> split_labels;
   vigra::MultiArrayView<2, double> split_probability;
   {
@@ -400,14 +400,15 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictWeightedCallbac
 }
 
 
-void mitk::VigraRandomForestClassifier::VigraPredictWeighted(PredictionData * data, vigra::MultiArrayView<2, double> & X, vigra::MultiArrayView<2, int> & Y, vigra::MultiArrayView<2, double> & P)
+template <typename TFeature>
+void mitk::VigraRandomForestClassifier::VigraPredictWeighted(PredictionData<TFeature> * data, vigra::MultiArrayView<2, TFeature> & X, vigra::MultiArrayView<2, int> & Y, vigra::MultiArrayView<2, double> & P)
 {
 
   int isSampleWeighted = data->m_RandomForest.options_.predict_weighted_;
 //#pragma omp parallel for
   for(int row=0; row < vigra::rowCount(X); ++row)
   {
-    vigra::MultiArrayView<2, double, vigra::StridedArrayTag> currentRow(rowVector(X, row));
+    vigra::MultiArrayView<2, TFeature, vigra::StridedArrayTag> currentRow(rowVector(X, row));
 
     vigra::ArrayVector<double>::const_iterator weights;
 
@@ -0,0 +1,118 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+
+#include <mitkDataCollection.h>
+#include <mitkDataCollectionUtilities.h>
+#include <mitkDCFeatureBlockReader.h>
+#include <mitkDCMatrixBlockWriter.h>
+
+#include <mitkImageGenerator.h>
+
+#include <algorithm>
+#include <cmath>
+
+class mitkDCFeatureBlockReaderTestClass
+{
+public:
+  mitk::DataCollection::Pointer m_Collection;
+  std::vector<std::string> m_Names;
+
+  void Init()
+  {
+    mitk::DataCollection::Pointer dataCol1 = mitk::DataCollection::New();
+    dataCol1->AddData(mitk::ImageGenerator::GenerateRandomImage<double>(5,4,3,1,1,1,1,10,0).GetPointer(),"T1");
+    dataCol1->AddData(mitk::ImageGenerator::GenerateRandomImage<double>(5,4,3,1,1,1,1,10,0).GetPointer(),"T2");
+    dataCol1->AddData(mitk::ImageGenerator::GenerateRandomImage<unsigned char>(5,4,3,1,1,1,1,1,0).GetPointer(),"Mask");
+
+    mitk::DataCollection::Pointer dataCol2 = mitk::DataCollection::New();
+    dataCol2->AddData(mitk::ImageGenerator::GenerateRandomImage<double>(6,6,2,1,1,1,1,10,0).GetPointer(),"T1");
+    dataCol2->AddData(mitk::ImageGenerator::GenerateRandomImage<double>(6,6,2,1,1,1,1,10,0).GetPointer(),"T2");
+    dataCol2->AddData(mitk::ImageGenerator::GenerateRandomImage<unsigned char>(6,6,2,1,1,1,1,1,0).GetPointer(),"Mask");
+
+    m_Collection = mitk::DataCollection::New();
+    m_Collection->AddData(dataCol1.GetPointer(), "0001");
+    m_Collection->AddData(dataCol2.GetPointer(), "0002");
+
+    m_Names.clear();
+    m_Names.push_back("T1");
+    m_Names.push_back("T2");
+  }
+
+  void BlocksMatchCompleteMatrix()
+  {
+    Init();
+    Eigen::MatrixXd complete = mitk::DCUtilities::DC3dDToMatrixXd(m_Collection, m_Names, "Mask");
+
+    mitk::DCFeatureBlockReader reader(m_Collection, m_Names, "Mask", 7);
+    Eigen::MatrixXf block;
+    int row = 0;
+    bool equal = true;
+    while (reader.ReadBlock(block))
+    {
+      MITK_TEST_CONDITION_REQUIRED(block.rows() <= 7 && block.cols() == 2, "Block has the requested size");
+      for (int i = 0; i < block.rows() && row+i < complete.rows(); ++i)
+      {
+        for (int col = 0; col < 2; ++col)
+        {
+          equal = equal && std::abs(block(i,col) - complete(row+i,col)) < 1e-4;
+        }
+      }
+      row += block.rows();
+    }
+    MITK_TEST_CONDITION_REQUIRED(row == complete.rows(), "All voxels within the mask are read");
+    MITK_TEST_CONDITION_REQUIRED(reader.GetNumberOfReadVoxels() == row, "Number of read voxels is counted");
+    MITK_TEST_CONDITION_REQUIRED(equal, "Blocks contain the same features as the complete matrix");
+    MITK_TEST_CONDITION_REQUIRED(reader.IsAtEnd() && block.rows() == 0, "Reader is at the end");
+  }
+
+  void WrittenBlocksMatchMatrix()
+  {
+    Init();
+    int numberOfVoxels = mitk::DCUtilities::VoxelInMask(m_Collection, "Mask");
+    Eigen::MatrixXi labels(numberOfVoxels, 1);
+    for (int row = 0; row < numberOfVoxels; ++row)
+    {
+      labels(row,0) = row % 3 + 1;
+    }
+
+    std::vector<std::string> labelNames;
+    labelNames.push_back("Result");
+    mitk::DCMatrixBlockWriter writer(m_Collection, labelNames, "Mask");
+    for (int row = 0; row < numberOfVoxels; row += 5)
+    {
+      int rows = std::min(5, numberOfVoxels - row);
+      Eigen::MatrixXi block = labels.block(row, 0, rows, 1);
+      writer.WriteBlock(block);
+    }
+    MITK_TEST_CONDITION_REQUIRED(writer.GetNumberOfWrittenVoxels() == numberOfVoxels, "All voxels within the mask are written");
+
+    Eigen::MatrixXi result = mitk::DCUtilities::DC3dDToMatrixXi(m_Collection, "Result", "Mask");
+    MITK_TEST_CONDITION_REQUIRED(result == labels, "Written labels are read back in the same order");
+  }
+};
+
+int mitkDCFeatureBlockReaderTest(int /*argc*/, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("mitkDCFeatureBlockReaderTest");
+
+  mitkDCFeatureBlockReaderTestClass test;
+  test.BlocksMatchCompleteMatrix();
+  test.WrittenBlocksMatchMatrix();
+
+  MITK_TEST_END();
+}
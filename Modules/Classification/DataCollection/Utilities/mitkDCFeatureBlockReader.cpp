@@ -0,0 +1,73 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkDCFeatureBlockReader.h>
+
+#include <algorithm>
+
+mitk::DCFeatureBlockReader::DCFeatureBlockReader(mitk::DataCollection::Pointer dc, const std::vector<std::string> &names, std::string mask, int blockSize) :
+  m_MaskIter(dc, mask), m_BlockSize(std::max(blockSize, 1)), m_NumberOfReadVoxels(0)
+{
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    DataIterType iter(dc, names[i]);
+    m_DataIter.push_back(iter);
+  }
+  SkipToMaskedVoxel();
+}
+
+bool mitk::DCFeatureBlockReader::IsAtEnd()
+{
+  return m_MaskIter.IsAtEnd();
+}
+
+bool mitk::DCFeatureBlockReader::ReadBlock(Eigen::MatrixXf &block)
+{
+  int numberOfNames = m_DataIter.size();
+
+  block.resize(m_BlockSize, numberOfNames);
+  int row = 0;
+  while (row < m_BlockSize && ! m_MaskIter.IsAtEnd())
+  {
+    for (int col = 0; col < numberOfNames; ++col)
+    {
+      block(row,col) = static_cast<float>(m_DataIter[col].GetVoxel());
+      ++(m_DataIter[col]);
+    }
+    ++m_MaskIter;
+    ++row;
+    SkipToMaskedVoxel();
+  }
+  if (row < m_BlockSize)
+  {
+    // conservativeResize keeps the rows read so far
+    block.conservativeResize(row, numberOfNames);
+  }
+  m_NumberOfReadVoxels += row;
+  return row > 0;
+}
+
+void mitk::DCFeatureBlockReader::SkipToMaskedVoxel()
+{
+  while ( ! m_MaskIter.IsAtEnd() && m_MaskIter.GetVoxel() == 0)
+  {
+    for (std::size_t col = 0; col < m_DataIter.size(); ++col)
+    {
+      ++(m_DataIter[col]);
+    }
+    ++m_MaskIter;
+  }
+}
@@ -0,0 +1,66 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkDCFeatureBlockReader_h
+#define mitkDCFeatureBlockReader_h
+
+#include <MitkDataCollectionExports.h>
+
+#include <mitkDataCollection.h>
+#include <mitkDataCollectionImageIterator.h>
+#include <Eigen/Dense>
+
+namespace mitk
+{
+  /**
+  \brief Reads the features of the voxels within a mask block by block.
+
+  Same row layout as DCUtilities::DC3dDToMatrixXd, but the feature matrix of the whole collection is never
+  allocated. Each block holds the features of the next blockSize voxels within the mask in single precision,
+  so the memory needed for a classification is bounded by the block size instead of the number of voxels.
+  The rows of the blocks can be written back with a DCMatrixBlockWriter using the same mask.
+  */
+  class MITKDATACOLLECTION_EXPORT DCFeatureBlockReader
+  {
+  public:
+    static const int DefaultBlockSize = 65536;
+
+    DCFeatureBlockReader(mitk::DataCollection::Pointer dc, const std::vector<std::string> &names, std::string mask, int blockSize = DefaultBlockSize);
+
+    /**
+    \brief Reads the features of the next block of voxels. The matrix is only reallocated if the size of the block changes.
+    \return false if all voxels within the mask are read, the matrix has no rows then.
+    */
+    bool ReadBlock(Eigen::MatrixXf &block);
+
+    bool IsAtEnd();
+
+    /** \return the number of voxels within the mask read so far */
+    long GetNumberOfReadVoxels() const { return m_NumberOfReadVoxels; }
+
+  private:
+    typedef mitk::DataCollectionImageIterator<double, 3> DataIterType;
+
+    void SkipToMaskedVoxel();
+
+    mitk::DataCollectionImageIterator<unsigned char, 3> m_MaskIter;
+    std::vector<DataIterType> m_DataIter;
+    int m_BlockSize;
+    long m_NumberOfReadVoxels;
+  };
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkDCMatrixBlockWriter.h>
+
+#include <mitkDataCollectionUtilities.h>
+
+#include <algorithm>
+
+mitk::DCMatrixBlockWriter::DCMatrixBlockWriter(mitk::DataCollection::Pointer dc, const std::vector<std::string> &labelNames, std::string mask) :
+  m_MaskIter(dc, mask), m_NumberOfWrittenVoxels(0)
+{
+  Initialize(dc, labelNames, std::vector<std::string>(), mask);
+}
+
+mitk::DCMatrixBlockWriter::DCMatrixBlockWriter(mitk::DataCollection::Pointer dc, const std::vector<std::string> &labelNames, const std::vector<std::string> &probabilityNames, std::string mask) :
+  m_MaskIter(dc, mask), m_NumberOfWrittenVoxels(0)
+{
+  Initialize(dc, labelNames, probabilityNames, mask);
+}
+
+void mitk::DCMatrixBlockWriter::Initialize(mitk::DataCollection::Pointer dc, const std::vector<std::string> &labelNames, const std::vector<std::string> &probabilityNames, std::string mask)
+{
+  for (std::size_t i = 0; i < labelNames.size(); ++i)
+  {
+    DCUtilities::EnsureUCharImageInDC(dc,labelNames[i],mask);
+    LabelIterType iter(dc, labelNames[i]);
+    m_LabelIter.push_back(iter);
+  }
+  for (std::size_t i = 0; i < probabilityNames.size(); ++i)
+  {
+    DCUtilities::EnsureDoubleImageInDC(dc,probabilityNames[i],mask);
+    ProbabilityIterType iter(dc, probabilityNames[i]);
+    m_ProbabilityIter.push_back(iter);
+  }
+  // the mask iterator was created before the images were added, restart it
+  m_MaskIter.ToBegin();
+  SkipToMaskedVoxel();
+}
+
+void mitk::DCMatrixBlockWriter::WriteBlock(const Eigen::MatrixXi &labels, const Eigen::MatrixXd &probabilities)
+{
+  int numberOfLabels = std::min<int>(m_LabelIter.size(), labels.cols());
+  int numberOfProbabilities = std::min<int>(m_ProbabilityIter.size(), probabilities.cols());
+
+  for (int row = 0; row < labels.rows() && ! m_MaskIter.IsAtEnd(); ++row)
+  {
+    for (int col = 0; col < numberOfLabels; ++col)
+    {
+      m_LabelIter[col].SetVoxel(labels(row,col));
+    }
+    for (std::size_t col = 0; col < m_LabelIter.size(); ++col)
+    {
+      ++(m_LabelIter[col]);
+    }
+    for (int col = 0; col < numberOfProbabilities; ++col)
+    {
+      m_ProbabilityIter[col].SetVoxel(probabilities(row,col));
+    }
+    for (std::size_t col = 0; col < m_ProbabilityIter.size(); ++col)
+    {
+      ++(m_ProbabilityIter[col]);
+    }
+    ++m_MaskIter;
+    ++m_NumberOfWrittenVoxels;
+    SkipToMaskedVoxel();
+  }
+}
+
+void mitk::DCMatrixBlockWriter::SkipToMaskedVoxel()
+{
+  while ( ! m_MaskIter.IsAtEnd() && m_MaskIter.GetVoxel() == 0)
+  {
+    for (std::size_t col = 0; col < m_LabelIter.size(); ++col)
+    {
+      ++(m_LabelIter[col]);
+    }
+    for (std::size_t col = 0; col < m_ProbabilityIter.size(); ++col)
+    {
+      ++(m_ProbabilityIter[col]);
+    }
+    ++m_MaskIter;
+  }
+}
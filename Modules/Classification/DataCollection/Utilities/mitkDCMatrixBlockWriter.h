@@ -0,0 +1,64 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkDCMatrixBlockWriter_h
+#define mitkDCMatrixBlockWriter_h
+
+#include <MitkDataCollectionExports.h>
+
+#include <mitkDataCollection.h>
+#include <mitkDataCollectionImageIterator.h>
+#include <Eigen/Dense>
+
+namespace mitk
+{
+  /**
+  \brief Writes classification results block by block into the voxels within a mask.
+
+  Counterpart of DCFeatureBlockReader: the rows of consecutive blocks are written to consecutive voxels within the
+  mask, like DCUtilities::MatrixToDC3d does for a single matrix. Labels are written to unsigned char images and
+  probabilities to double images, missing images are created when the writer is constructed.
+  */
+  class MITKDATACOLLECTION_EXPORT DCMatrixBlockWriter
+  {
+  public:
+    DCMatrixBlockWriter(mitk::DataCollection::Pointer dc, const std::vector<std::string> &labelNames, std::string mask);
+    DCMatrixBlockWriter(mitk::DataCollection::Pointer dc, const std::vector<std::string> &labelNames, const std::vector<std::string> &probabilityNames, std::string mask);
+
+    /**
+    \brief Writes the next block. Column i of the matrices is written to the i-th label or probability image,
+    the probabilities are ignored if no probability images are given.
+    */
+    void WriteBlock(const Eigen::MatrixXi &labels, const Eigen::MatrixXd &probabilities = Eigen::MatrixXd());
+
+    /** \return the number of voxels within the mask written so far */
+    long GetNumberOfWrittenVoxels() const { return m_NumberOfWrittenVoxels; }
+
+  private:
+    typedef mitk::DataCollectionImageIterator<unsigned char, 3> LabelIterType;
+    typedef mitk::DataCollectionImageIterator<double, 3> ProbabilityIterType;
+
+    void Initialize(mitk::DataCollection::Pointer dc, const std::vector<std::string> &labelNames, const std::vector<std::string> &probabilityNames, std::string mask);
+    void SkipToMaskedVoxel();
+
+    mitk::DataCollectionImageIterator<unsigned char, 3> m_MaskIter;
+    std::vector<LabelIterType> m_LabelIter;
+    std::vector<ProbabilityIterType> m_ProbabilityIter;
+    long m_NumberOfWrittenVoxels;
+  };
+}
+
+#endif
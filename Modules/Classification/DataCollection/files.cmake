@@ -6,6 +6,8 @@ SET(CPP_FILES
   Utilities/mitkCostingStatistic.cpp
   Utilities/mitkCollectionStatistic.cpp
   Utilities/mitkDataCollectionUtilities.cpp
+  Utilities/mitkDCFeatureBlockReader.cpp
+  Utilities/mitkDCMatrixBlockWriter.cpp
   testcase.cpp
 )
 
@@ -20,5 +22,7 @@ SET(H_FILES
   Utilities/mitkCostingStatistic.h
   Utilities/mitkCollectionStatistic.h
   Utilities/mitkDataCollectionUtilities.h
+  Utilities/mitkDCFeatureBlockReader.h
+  Utilities/mitkDCMatrixBlockWriter.h
   testcase.h
 )
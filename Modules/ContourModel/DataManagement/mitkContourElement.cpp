@@ -17,15 +17,328 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkContourElement.h>
 #include <vtkMath.h>
 
-mitk::ContourElement::ContourElement()
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+  typedef mitk::ContourElement::VertexType VertexType;
+
+  double SquaredDistanceToLineSegment(const mitk::Point3D &point, const mitk::Point3D &v1, const mitk::Point3D &v2)
+  {
+    mitk::Vector3D p_v1 = point - v1;
+    mitk::Vector3D v2_v1 = v2 - v1;
+
+    const double l2 = v2_v1.GetSquaredNorm();
+    if (l2 == 0.0)
+    {
+      return p_v1.GetSquaredNorm();
+    }
+
+    double tc = (p_v1 * v2_v1) / l2;
+
+    // take into account we have line segments and not (infinite) lines
+    if (tc < 0.0)
+      tc = 0.0;
+    if (tc > 1.0)
+      tc = 1.0;
+
+    mitk::Point3D crossPoint = v1 + v2_v1 * tc;
+
+    return point.SquaredEuclideanDistanceTo(crossPoint);
+  }
+
+  /** Nearest control point closer than eps to a point, or the nearest vertex if there is no such control point. */
+  class NearestVertex
+  {
+  public:
+    NearestVertex(const mitk::Point3D &point, float eps)
+      : m_Point(point), m_Eps(eps), m_Vertex(nullptr), m_ControlVertex(nullptr), m_Distance(0), m_ControlDistance(0)
+    {
+    }
+
+    void Add(VertexType *vertex)
+    {
+      double distance = vertex->Coordinates.EuclideanDistanceTo(m_Point);
+      if (distance >= m_Eps)
+      {
+        return;
+      }
+      if (m_Vertex == nullptr || distance < m_Distance)
+      {
+        m_Vertex = vertex;
+        m_Distance = distance;
+      }
+      if (vertex->IsControlPoint && (m_ControlVertex == nullptr || distance < m_ControlDistance))
+      {
+        m_ControlVertex = vertex;
+        m_ControlDistance = distance;
+      }
+    }
+
+    VertexType *Get() const { return m_ControlVertex != nullptr ? m_ControlVertex : m_Vertex; }
+  private:
+    mitk::Point3D m_Point;
+    double m_Eps;
+    VertexType *m_Vertex;
+    VertexType *m_ControlVertex;
+    double m_Distance;
+    double m_ControlDistance;
+  };
+}
+
+/** Each vertex is the start of the line segment to the next vertex, the last vertex is the start of a segment of
+* length zero. A segment is listed in all grid cells it passes through, so all segments within a distance of a point
+* are found in the cells overlapping the cube around the point.
+*/
+struct mitk::ContourElement::SpatialIndex
+{
+  typedef unsigned long long CellKeyType;
+
+  struct Segment
+  {
+    VertexType *Start;
+    VertexType *End;
+  };
+
+  struct Entry
+  {
+    Entry() : Previous(nullptr), Next(nullptr) {}
+    VertexType *Previous;
+    VertexType *Next;
+    std::vector<CellKeyType> Cells;
+  };
+
+  explicit SpatialIndex(mitk::ScalarType cellSize) : m_CellSize(cellSize) {}
+
+  /** Adds a vertex between two neighbors, which are nullptr at the ends of the contour. */
+  void Link(VertexType *vertex, VertexType *previous, VertexType *next)
+  {
+    Entry &entry = m_Entries[vertex];
+    entry.Previous = previous;
+    entry.Next = next;
+    this->Register(vertex, entry);
+
+    if (previous != nullptr)
+    {
+      Entry &previousEntry = m_Entries[previous];
+      this->Unregister(previous, previousEntry);
+      previousEntry.Next = vertex;
+      this->Register(previous, previousEntry);
+    }
+    if (next != nullptr)
+    {
+      m_Entries[next].Previous = vertex;
+    }
+  }
+
+  void Unlink(const VertexType *vertex)
+  {
+    auto iter = m_Entries.find(vertex);
+    if (iter == m_Entries.end())
+    {
+      return;
+    }
+
+    VertexType *previous = iter->second.Previous;
+    VertexType *next = iter->second.Next;
+    this->Unregister(vertex, iter->second);
+    m_Entries.erase(iter);
+
+    if (previous != nullptr)
+    {
+      Entry &previousEntry = m_Entries[previous];
+      this->Unregister(previous, previousEntry);
+      previousEntry.Next = next;
+      this->Register(previous, previousEntry);
+    }
+    if (next != nullptr)
+    {
+      m_Entries[next].Previous = previous;
+    }
+  }
+
+  /** Moves the segments from and to a vertex to the cells of its current coordinates. */
+  void Update(VertexType *vertex)
+  {
+    auto iter = m_Entries.find(vertex);
+    if (iter == m_Entries.end())
+    {
+      return;
+    }
+
+    this->Unregister(vertex, iter->second);
+    this->Register(vertex, iter->second);
+
+    VertexType *previous = iter->second.Previous;
+    if (previous != nullptr)
+    {
+      Entry &previousEntry = m_Entries[previous];
+      this->Unregister(previous, previousEntry);
+      this->Register(previous, previousEntry);
+    }
+  }
+
+  /** Collects the segments listed in the cells around a point, a segment can be collected several times.
+  * Returns false if there are more cells around the point than occupied cells, a linear search is faster then.
+  */
+  bool GetSegments(const mitk::Point3D &point, mitk::ScalarType distance, std::vector<Segment> &segments) const
+  {
+    // a small margin for segments through the corners of cells
+    distance += m_CellSize * 1e-6;
+
+    long first[3];
+    long last[3];
+    double numberOfCells = 1;
+    for (int i = 0; i < 3; ++i)
+    {
+      first[i] = this->GetCellIndex(point[i] - distance);
+      last[i] = this->GetCellIndex(point[i] + distance);
+      numberOfCells *= last[i] - first[i] + 1;
+    }
+    if (numberOfCells > m_Cells.size())
+    {
+      return false;
+    }
+
+    long cell[3];
+    for (cell[0] = first[0]; cell[0] <= last[0]; ++cell[0])
+    {
+      for (cell[1] = first[1]; cell[1] <= last[1]; ++cell[1])
+      {
+        for (cell[2] = first[2]; cell[2] <= last[2]; ++cell[2])
+        {
+          auto iter = m_Cells.find(GetCellKey(cell));
+          if (iter != m_Cells.end())
+          {
+            segments.insert(segments.end(), iter->second.begin(), iter->second.end());
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+  long GetCellIndex(double coordinate) const
+  {
+    // 21 bits per axis in the key
+    const double limit = (1 << 20) - 1;
+    return static_cast<long>(std::max(-limit, std::min(limit, std::floor(coordinate / m_CellSize))));
+  }
+
+  static CellKeyType GetCellKey(const long cell[3])
+  {
+    const CellKeyType offset = 1 << 20;
+    return ((cell[0] + offset) << 42) | ((cell[1] + offset) << 21) | (cell[2] + offset);
+  }
+
+  /** Lists the segment of a vertex in all cells it passes through (Amanatides and Woo). */
+  void Register(VertexType *vertex, Entry &entry)
+  {
+    const mitk::Point3D &start = vertex->Coordinates;
+    const mitk::Point3D &end = entry.Next != nullptr ? entry.Next->Coordinates : start;
+    const Segment segment = {vertex, entry.Next != nullptr ? entry.Next : vertex};
+
+    long cell[3];
+    long last[3];
+    long step[3];
+    double tMax[3];
+    double tDelta[3];
+    long remainingSteps = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      cell[i] = this->GetCellIndex(start[i]);
+      last[i] = this->GetCellIndex(end[i]);
+      step[i] = last[i] > cell[i] ? 1 : (last[i] < cell[i] ? -1 : 0);
+      remainingSteps += std::abs(last[i] - cell[i]);
+
+      const double direction = end[i] - start[i];
+      if (step[i] != 0)
+      {
+        tMax[i] = ((cell[i] + (step[i] > 0 ? 1 : 0)) * m_CellSize - start[i]) / direction;
+        tDelta[i] = m_CellSize / std::abs(direction);
+      }
+      else
+      {
+        tMax[i] = std::numeric_limits<double>::max();
+        tDelta[i] = 0;
+      }
+    }
+
+    while (true)
+    {
+      const CellKeyType key = GetCellKey(cell);
+      m_Cells[key].push_back(segment);
+      entry.Cells.push_back(key);
+
+      if (remainingSteps-- == 0)
+      {
+        break;
+      }
+
+      // step along the axis with the nearest cell border, which has not reached the last cell yet
+      int axis = -1;
+      for (int i = 0; i < 3; ++i)
+      {
+        if (cell[i] != last[i] && (axis < 0 || tMax[i] < tMax[axis]))
+        {
+          axis = i;
+        }
+      }
+      cell[axis] += step[axis];
+      tMax[axis] += tDelta[axis];
+    }
+  }
+
+  void Unregister(const VertexType *vertex, Entry &entry)
+  {
+    for (CellKeyType key : entry.Cells)
+    {
+      auto iter = m_Cells.find(key);
+      std::vector<Segment> &segments = iter->second;
+      for (std::size_t i = 0; i < segments.size(); ++i)
+      {
+        if (segments[i].Start == vertex)
+        {
+          segments[i] = segments.back();
+          segments.pop_back();
+          break;
+        }
+      }
+      if (segments.empty())
+      {
+        m_Cells.erase(iter);
+      }
+    }
+    entry.Cells.clear();
+  }
+
+  mitk::ScalarType m_CellSize;
+  std::unordered_map<const VertexType *, Entry> m_Entries;
+  std::unordered_map<CellKeyType, std::vector<Segment>> m_Cells;
+};
+
+mitk::ContourElement::ContourElement() : m_SpatialIndexCellSize(2.0)
 {
   this->m_Vertices = new VertexListType();
   this->m_IsClosed = false;
 }
 
 mitk::ContourElement::ContourElement(const mitk::ContourElement &other)
-  : itk::LightObject(), m_Vertices(other.m_Vertices), m_IsClosed(other.m_IsClosed)
+  : itk::LightObject(),
+    m_Vertices(new VertexListType()),
+    m_IsClosed(other.m_IsClosed),
+    m_SpatialIndexCellSize(other.m_SpatialIndexCellSize)
 {
+  ConstVertexIterator it = other.m_Vertices->begin();
+  ConstVertexIterator end = other.m_Vertices->end();
+  while (it != end)
+  {
+    this->m_Vertices->push_back(this->NewVertex((*it)->Coordinates, (*it)->IsControlPoint));
+    it++;
+  }
 }
 
 mitk::ContourElement::~ContourElement()
@@ -33,24 +346,104 @@ mitk::ContourElement::~ContourElement()
   delete this->m_Vertices;
 }
 
+mitk::ContourElement::VertexType *mitk::ContourElement::NewVertex(const mitk::Point3D &point, bool isControlPoint)
+{
+  if (!this->m_FreeVertices.empty())
+  {
+    VertexType *vertex = this->m_FreeVertices.back();
+    this->m_FreeVertices.pop_back();
+    vertex->Coordinates = point;
+    vertex->IsControlPoint = isControlPoint;
+    return vertex;
+  }
+
+  // a block is never filled beyond its capacity, so the vertices keep their addresses
+  if (this->m_VertexPool.empty() || this->m_VertexPool.back().size() == this->m_VertexPool.back().capacity())
+  {
+    this->m_VertexPool.push_back(std::vector<VertexType>());
+    this->m_VertexPool.back().reserve(std::max<std::size_t>(64, this->m_Vertices->size()));
+  }
+  this->m_VertexPool.back().push_back(VertexType(point, isControlPoint));
+  return &this->m_VertexPool.back().back();
+}
+
+mitk::ContourElement::VertexIterator mitk::ContourElement::InsertVertex(VertexIterator where, VertexType *vertex)
+{
+  if (this->m_SpatialIndex)
+  {
+    VertexType *previous = where == this->m_Vertices->begin() ? nullptr : *(where - 1);
+    VertexType *next = where == this->m_Vertices->end() ? nullptr : *where;
+    this->m_SpatialIndex->Link(vertex, previous, next);
+  }
+  return this->m_Vertices->insert(where, vertex);
+}
+
+mitk::ContourElement::VertexIterator mitk::ContourElement::EraseVertex(VertexIterator where)
+{
+  if (this->m_SpatialIndex)
+  {
+    this->m_SpatialIndex->Unlink(*where);
+  }
+  this->m_FreeVertices.push_back(*where);
+  return this->m_Vertices->erase(where);
+}
+
+mitk::ContourElement::SpatialIndex *mitk::ContourElement::GetSpatialIndex()
+{
+  if (!this->m_SpatialIndex && this->m_SpatialIndexCellSize > 0)
+  {
+    this->m_SpatialIndex.reset(new SpatialIndex(this->m_SpatialIndexCellSize));
+
+    VertexType *previous = nullptr;
+    for (VertexType *vertex : *this->m_Vertices)
+    {
+      this->m_SpatialIndex->Link(vertex, previous, nullptr);
+      previous = vertex;
+    }
+  }
+  return this->m_SpatialIndex.get();
+}
+
+void mitk::ContourElement::SetSpatialIndexCellSize(mitk::ScalarType cellSize)
+{
+  if (this->m_SpatialIndexCellSize != cellSize)
+  {
+    this->m_SpatialIndexCellSize = cellSize;
+    this->m_SpatialIndex.reset();
+  }
+}
+
+mitk::ScalarType mitk::ContourElement::GetSpatialIndexCellSize() const
+{
+  return this->m_SpatialIndexCellSize;
+}
+
+void mitk::ContourElement::UpdateSpatialIndex(VertexType *vertex)
+{
+  if (this->m_SpatialIndex)
+  {
+    this->m_SpatialIndex->Update(vertex);
+  }
+}
+
 void mitk::ContourElement::AddVertex(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_back(new VertexType(vertex, isControlPoint));
+  this->InsertVertex(this->m_Vertices->end(), this->NewVertex(vertex, isControlPoint));
 }
 
 void mitk::ContourElement::AddVertex(VertexType &vertex)
 {
-  this->m_Vertices->push_back(&vertex);
+  this->InsertVertex(this->m_Vertices->end(), this->NewVertex(vertex.Coordinates, vertex.IsControlPoint));
 }
 
 void mitk::ContourElement::AddVertexAtFront(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_front(new VertexType(vertex, isControlPoint));
+  this->InsertVertex(this->m_Vertices->begin(), this->NewVertex(vertex, isControlPoint));
 }
 
 void mitk::ContourElement::AddVertexAtFront(VertexType &vertex)
 {
-  this->m_Vertices->push_front(&vertex);
+  this->InsertVertex(this->m_Vertices->begin(), this->NewVertex(vertex.Coordinates, vertex.IsControlPoint));
 }
 
 void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isControlPoint, int index)
@@ -59,7 +452,7 @@ void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isCon
   {
     auto _where = this->m_Vertices->begin();
     _where += index;
-    this->m_Vertices->insert(_where, new VertexType(vertex, isControlPoint));
+    this->InsertVertex(_where, this->NewVertex(vertex, isControlPoint));
   }
 }
 
@@ -68,6 +461,7 @@ void mitk::ContourElement::SetVertexAt(int pointId, const Point3D &point)
   if (pointId >= 0 && this->GetSize() > pointId)
   {
     this->m_Vertices->at(pointId)->Coordinates = point;
+    this->UpdateSpatialIndex(this->m_Vertices->at(pointId));
   }
 }
 
@@ -77,6 +471,7 @@ void mitk::ContourElement::SetVertexAt(int pointId, const VertexType *vertex)
   {
     this->m_Vertices->at(pointId)->Coordinates = vertex->Coordinates;
     this->m_Vertices->at(pointId)->IsControlPoint = vertex->IsControlPoint;
+    this->UpdateSpatialIndex(this->m_Vertices->at(pointId));
   }
 }
 
@@ -92,11 +487,20 @@ bool mitk::ContourElement::IsEmpty()
 
 mitk::ContourElement::VertexType *mitk::ContourElement::GetVertexAt(const mitk::Point3D &point, float eps)
 {
-  /* current version iterates over the whole deque - should some kind of an octree with spatial query*/
-
   if (eps > 0)
   {
-    // currently no method with better performance is available
+    std::vector<SpatialIndex::Segment> segments;
+    SpatialIndex *index = this->GetSpatialIndex();
+    if (index != nullptr && index->GetSegments(point, eps, segments))
+    {
+      // each vertex starts a segment, which is listed in the cell of the vertex
+      NearestVertex nearest(point, eps);
+      for (const auto &segment : segments)
+      {
+        nearest.Add(segment.Start);
+      }
+      return nearest.Get();
+    }
     return BruteForceGetVertexAt(point, eps);
   } // if eps < 0
   return nullptr;
@@ -106,121 +510,16 @@ mitk::ContourElement::VertexType *mitk::ContourElement::BruteForceGetVertexAt(co
 {
   if (eps > 0)
   {
-    std::deque<std::pair<double, VertexType *>> nearestlist;
-
-    ConstVertexIterator it = this->m_Vertices->begin();
-
-    ConstVertexIterator end = this->m_Vertices->end();
-
-    while (it != end)
-    {
-      mitk::Point3D currentPoint = (*it)->Coordinates;
-
-      double distance = currentPoint.EuclideanDistanceTo(point);
-      if (distance < eps)
-      {
-        // if list is emtpy, add point to list
-        if (nearestlist.size() < 1)
-        {
-          nearestlist.push_front(std::pair<double, VertexType *>((*it)->Coordinates.EuclideanDistanceTo(point), (*it)));
-        }
-        // found an approximate point - check if current is closer then first in nearestlist
-        else if (distance < nearestlist.front().first)
-        {
-          // found even closer vertex
-          nearestlist.push_front(std::pair<double, VertexType *>((*it)->Coordinates.EuclideanDistanceTo(point), (*it)));
-        }
-      } // if distance > eps
-
-      it++;
-    } // while
-    if (nearestlist.size() > 0)
+    NearestVertex nearest(point, eps);
+    for (VertexType *vertex : *this->m_Vertices)
     {
-      /*++++++++++++++++++++ return the nearest active point if one was found++++++++++++++++++*/
-      auto it = nearestlist.begin();
-      auto end = nearestlist.end();
-      while (it != end)
-      {
-        if ((*it).second->IsControlPoint)
-        {
-          return (*it).second;
-        }
-        it++;
-      }
-      /*---------------------------------------------------------------------------------------*/
-
-      // return closest point
-      return nearestlist.front().second;
+      nearest.Add(vertex);
     }
+    return nearest.Get();
   }
   return nullptr;
 }
 
-/*mitk::ContourElement::VertexType* mitk::ContourElement::OptimizedGetVertexAt(const mitk::Point3D &point, float eps)
-{
-  if( (eps > 0) && (this->m_Vertices->size()>0) )
-  {
-      int k = 1;
-      int dim = 3;
-      int nPoints = this->m_Vertices->size();
-      ANNpointArray pointsArray;
-      ANNpoint queryPoint;
-      ANNidxArray indexArray;
-      ANNdistArray distanceArray;
-      ANNkd_tree* kdTree;
-
-      queryPoint = annAllocPt(dim);
-      pointsArray = annAllocPts(nPoints, dim);
-      indexArray = new ANNidx[k];
-      distanceArray = new ANNdist[k];
-
-
-       int i = 0;
-
-      //fill points array with our control points
-      for(VertexIterator it = this->m_Vertices->begin(); it != this->m_Vertices->end(); it++, i++)
-      {
-        mitk::Point3D cur = (*it)->Coordinates;
-        pointsArray[i][0]= cur[0];
-        pointsArray[i][1]= cur[1];
-        pointsArray[i][2]= cur[2];
-      }
-
-      //create the kd tree
-      kdTree = new ANNkd_tree(pointsArray,nPoints, dim);
-
-      //fill mitk::Point3D into ANN query point
-      queryPoint[0] = point[0];
-      queryPoint[1] = point[1];
-      queryPoint[2] = point[2];
-
-      //k nearest neighbour search
-      kdTree->annkSearch(queryPoint, k, indexArray, distanceArray, eps);
-
-      VertexType* ret = NULL;
-
-      try
-      {
-        ret = this->m_Vertices->at(indexArray[0]);
-      }
-      catch(std::out_of_range ex)
-      {
-        //ret stays NULL
-        return ret;
-      }
-
-      //clean up ANN
-      delete [] indexArray;
-      delete [] distanceArray;
-      delete kdTree;
-      annClose();
-
-      return ret;
-  }
-  return NULL;
-}
-*/
-
 mitk::ContourElement::VertexListType *mitk::ContourElement::GetVertexList()
 {
   return this->m_Vertices;
@@ -233,40 +532,39 @@ bool mitk::ContourElement::IsClosed()
 
 bool mitk::ContourElement::IsNearContour(const mitk::Point3D &point, float eps)
 {
-  ConstVertexIterator it1 = this->m_Vertices->begin();
-  ConstVertexIterator it2 = this->m_Vertices->begin();
-  it2++; // it2 runs one position ahead
-
-  ConstVertexIterator end = this->m_Vertices->end();
-
-  int counter = 0;
-
-  for (; it1 != end; it1++, it2++, counter++)
+  if (this->m_Vertices->empty() || eps <= 0)
   {
-    if (it2 == end)
-      it2 = this->m_Vertices->begin();
-
-    mitk::Point3D v1 = (*it1)->Coordinates;
-    mitk::Point3D v2 = (*it2)->Coordinates;
-
-    const float l2 = v1.SquaredEuclideanDistanceTo(v2);
-
-    mitk::Vector3D p_v1 = point - v1;
-    mitk::Vector3D v2_v1 = v2 - v1;
-
-    double tc = (p_v1 * v2_v1) / l2;
+    return false;
+  }
 
-    // take into account we have line segments and not (infinite) lines
-    if (tc < 0.0)
-      tc = 0.0;
-    if (tc > 1.0)
-      tc = 1.0;
+  // the segment from the last to the first vertex is not part of the spatial index
+  if (SquaredDistanceToLineSegment(point, this->m_Vertices->back()->Coordinates, this->m_Vertices->front()->Coordinates) <
+      eps)
+  {
+    return true;
+  }
 
-    mitk::Point3D crossPoint = v1 + v2_v1 * tc;
+  std::vector<SpatialIndex::Segment> segments;
+  SpatialIndex *index = this->GetSpatialIndex();
+  if (index != nullptr && index->GetSegments(point, std::sqrt(eps), segments))
+  {
+    for (const auto &segment : segments)
+    {
+      if (SquaredDistanceToLineSegment(point, segment.Start->Coordinates, segment.End->Coordinates) < eps)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
 
-    double distance = point.SquaredEuclideanDistanceTo(crossPoint);
+  ConstVertexIterator it1 = this->m_Vertices->begin();
+  ConstVertexIterator it2 = it1 + 1; // it2 runs one position ahead
+  ConstVertexIterator end = this->m_Vertices->end();
 
-    if (distance < eps)
+  for (; it2 != end; it1++, it2++)
+  {
+    if (SquaredDistanceToLineSegment(point, (*it1)->Coordinates, (*it2)->Coordinates) < eps)
     {
       return true;
     }
@@ -311,21 +609,37 @@ mitk::ContourElement::VertexListType *mitk::ContourElement::GetControlVertices()
 
 void mitk::ContourElement::Concatenate(mitk::ContourElement *other, bool check)
 {
-  if (other->GetSize() > 0)
+  // the other contour might be this one, so only the vertices present at the beginning are added
+  const VertexListType::size_type size = other->m_Vertices->size();
+  SpatialIndex *index = check ? this->GetSpatialIndex() : nullptr;
+
+  for (VertexListType::size_type i = 0; i < size; ++i)
   {
-    ConstVertexIterator otherIt = other->m_Vertices->begin();
-    ConstVertexIterator otherEnd = other->m_Vertices->end();
-    while (otherIt != otherEnd)
+    const VertexType *otherVertex = other->m_Vertices->at(i);
+
+    bool found = false;
+    if (check)
     {
-      if (check)
+      std::vector<SpatialIndex::Segment> segments;
+      if (index != nullptr && index->GetSegments(otherVertex->Coordinates, 0, segments))
+      {
+        for (const auto &segment : segments)
+        {
+          if (segment.Start->Coordinates == otherVertex->Coordinates)
+          {
+            found = true;
+            break;
+          }
+        }
+      }
+      else
       {
         ConstVertexIterator thisIt = this->m_Vertices->begin();
         ConstVertexIterator thisEnd = this->m_Vertices->end();
 
-        bool found = false;
         while (thisIt != thisEnd)
         {
-          if ((*thisIt)->Coordinates == (*otherIt)->Coordinates)
+          if ((*thisIt)->Coordinates == otherVertex->Coordinates)
           {
             found = true;
             break;
@@ -333,14 +647,12 @@ void mitk::ContourElement::Concatenate(mitk::ContourElement *other, bool check)
 
           thisIt++;
         }
-        if (!found)
-          this->m_Vertices->push_back(*otherIt);
-      }
-      else
-      {
-        this->m_Vertices->push_back(*otherIt);
       }
-      otherIt++;
+    }
+
+    if (!found)
+    {
+      this->InsertVertex(this->m_Vertices->end(), this->NewVertex(otherVertex->Coordinates, otherVertex->IsControlPoint));
     }
   }
 }
@@ -356,7 +668,7 @@ bool mitk::ContourElement::RemoveVertex(const VertexType *vertex)
   {
     if ((*it) == vertex)
     {
-      this->m_Vertices->erase(it);
+      this->EraseVertex(it);
       return true;
     }
 
@@ -393,7 +705,7 @@ bool mitk::ContourElement::RemoveVertexAt(int index)
 {
   if (index >= 0 && static_cast<VertexListType::size_type>(index) < this->m_Vertices->size())
   {
-    this->m_Vertices->erase(this->m_Vertices->begin() + index);
+    this->EraseVertex(this->m_Vertices->begin() + index);
     return true;
   }
   else
@@ -404,35 +716,15 @@ bool mitk::ContourElement::RemoveVertexAt(int index)
 
 bool mitk::ContourElement::RemoveVertexAt(mitk::Point3D &point, float eps)
 {
-  /* current version iterates over the whole deque - should be some kind of an octree with spatial query*/
-
-  if (eps > 0)
-  {
-    auto it = this->m_Vertices->begin();
-
-    auto end = this->m_Vertices->end();
-
-    while (it != end)
-    {
-      mitk::Point3D currentPoint = (*it)->Coordinates;
-
-      if (currentPoint.EuclideanDistanceTo(point) < eps)
-      {
-        // approximate point found
-        // now erase it
-        this->m_Vertices->erase(it);
-        return true;
-      }
-
-      it++;
-    }
-  }
-  return false;
+  return this->RemoveVertex(this->GetVertexAt(point, eps));
 }
 
 void mitk::ContourElement::Clear()
 {
   this->m_Vertices->clear();
+  this->m_VertexPool.clear();
+  this->m_FreeVertices.clear();
+  this->m_SpatialIndex.reset();
 }
 //----------------------------------------------------------------------
 void mitk::ContourElement::RedistributeControlVertices(const VertexType *selected, int period)
@@ -20,9 +20,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkContourModelExports.h>
 #include <mitkNumericTypes.h>
 
-//#include <ANN/ANN.h>
-
 #include <deque>
+#include <memory>
+#include <vector>
 
 namespace mitk
 {
@@ -32,6 +32,11 @@ namespace mitk
   end of the contour and to iterate in both directions.
   To mark a vertex as a special one it can be set as a control point.
 
+  The vertices are owned by the contour element. They are allocated in blocks and stay at
+  their address until they are removed, removed vertices are reused for new ones.
+  Spatial queries use a uniform grid of the line segments between the vertices, which is
+  built by the first query and then kept up to date with every change of the contour.
+
   \Note It is highly not recommend to use this class directly as no secure mechanism is used here.
   Use mitk::ContourModel instead providing some additional features.
   */
@@ -48,7 +53,9 @@ namespace mitk
       */
       struct ContourModelVertex
     {
-      ContourModelVertex(mitk::Point3D &point, bool active = false) : IsControlPoint(active), Coordinates(point) {}
+      ContourModelVertex(const mitk::Point3D &point, bool active = false) : IsControlPoint(active), Coordinates(point)
+      {
+      }
       ContourModelVertex(const ContourModelVertex &other)
         : IsControlPoint(other.IsControlPoint), Coordinates(other.Coordinates)
       {
@@ -92,7 +99,7 @@ namespace mitk
     */
     virtual void AddVertex(mitk::Point3D &point, bool isControlPoint);
 
-    /** \brief Add a vertex at the end of the contour
+    /** \brief Add a copy of a vertex at the end of the contour
     \param vertex - a contour element vertex.
     */
     virtual void AddVertex(VertexType &vertex);
@@ -103,7 +110,7 @@ namespace mitk
     */
     virtual void AddVertexAtFront(mitk::Point3D &point, bool isControlPoint);
 
-    /** \brief Add a vertex at the front of the contour
+    /** \brief Add a copy of a vertex at the front of the contour
     \param vertex - a contour element vertex.
     */
     virtual void AddVertexAtFront(VertexType &vertex);
@@ -132,7 +139,8 @@ namespace mitk
     */
     virtual VertexType *GetVertexAt(int index);
 
-    /** \brief Returns the approximate nearest vertex a given posoition in 3D space
+    /** \brief Returns the nearest control point closer than eps to a given position in 3D space,
+    or the nearest vertex if there is no such control point.
     \param point - query position in 3D space.
     \param eps - the error bound for search algorithm.
     */
@@ -157,8 +165,9 @@ namespace mitk
     virtual bool IsClosed();
 
     /** \brief Returns whether a given point is near a contour, according to eps.
+    The line segment between the last and the first vertex is part of the contour.
     \param point - query position in 3D space.
-    \param eps - the error bound for search algorithm.
+    \param eps - the error bound for search algorithm, compared to the squared distance.
     */
     virtual bool IsNearContour(const mitk::Point3D &point, float eps);
 
@@ -178,7 +187,7 @@ namespace mitk
     virtual void SetClosed(bool isClosed);
 
     /** \brief Concatenate the contuor with a another contour.
-    All vertices of the other contour will be added after last vertex.
+    Copies of all vertices of the other contour will be added after last vertex.
     \param other - the other contour
     \param check - set it true to avoid intersections
     */
@@ -194,7 +203,7 @@ namespace mitk
     */
     virtual bool RemoveVertexAt(int index);
 
-    /** \brief Remove the approximate nearest vertex at given position in 3D space if one exists.
+    /** \brief Remove the vertex returned by GetVertexAt(point, eps) if one exists.
     \param point - query point in 3D space.
     \param eps - error bound for search algorithm.
     */
@@ -204,17 +213,23 @@ namespace mitk
     */
     virtual void Clear();
 
-    /** \brief Returns the approximate nearest vertex a given posoition in 3D space
+    /** \brief Same as GetVertexAt(point, eps), but tests all vertices instead of using the spatial index.
     \param point - query position in 3D space.
     \param eps - the error bound for search algorithm.
     */
     VertexType *BruteForceGetVertexAt(const mitk::Point3D &point, float eps);
 
-    /** \brief Returns the approximate nearest vertex a given posoition in 3D space
-    \param point - query position in 3D space.
-    \param eps - the error bound for search algorithm.
+    /** \brief Set the edge length of the cells of the spatial index, 0 disables the index.
+    The default is 2, e.g. millimeters for a contour in world coordinates.
     */
-    // VertexType* OptimizedGetVertexAt(const mitk::Point3D &point, float eps);
+    void SetSpatialIndexCellSize(mitk::ScalarType cellSize);
+
+    mitk::ScalarType GetSpatialIndexCellSize() const;
+
+    /** \brief Update the spatial index after the coordinates of a vertex were changed through its pointer.
+    Vertices of other contours are ignored.
+    */
+    void UpdateSpatialIndex(VertexType *vertex);
 
     VertexListType *GetControlVertices();
 
@@ -231,8 +246,29 @@ namespace mitk
     ContourElement(const mitk::ContourElement &other);
     virtual ~ContourElement();
 
+    /** \brief Uniform grid of the line segments between consecutive vertices, see mitkContourElement.cpp. */
+    struct SpatialIndex;
+
+    /** \brief Returns the spatial index, builds it if necessary. nullptr if the index is disabled. */
+    SpatialIndex *GetSpatialIndex();
+
+    /** \brief Returns an unused vertex of the pool. */
+    VertexType *NewVertex(const mitk::Point3D &point, bool isControlPoint);
+
+    /** \brief Inserts a vertex of the pool into the container and the spatial index. */
+    VertexIterator InsertVertex(VertexIterator where, VertexType *vertex);
+
+    /** \brief Removes a vertex from the container and the spatial index and returns it to the pool. */
+    VertexIterator EraseVertex(VertexIterator where);
+
     VertexListType *m_Vertices; // double ended queue with vertices
     bool m_IsClosed;
+
+    std::deque<std::vector<VertexType>> m_VertexPool; // blocks of vertices, never reallocated
+    std::vector<VertexType *> m_FreeVertices;          // removed vertices of the pool
+
+    mitk::ScalarType m_SpatialIndexCellSize;
+    std::unique_ptr<SpatialIndex> m_SpatialIndex;
   };
 } // namespace mitk
 
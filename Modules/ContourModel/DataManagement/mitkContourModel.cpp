@@ -350,6 +350,11 @@ bool mitk::ContourModel::RemoveVertex(const VertexType *vertex, int timestep)
   {
     if (this->m_ContourSeries[timestep]->RemoveVertex(vertex))
     {
+      // removed vertices are reused by the contour
+      if (this->m_SelectedVertex == vertex)
+      {
+        this->m_SelectedVertex = nullptr;
+      }
       this->Modified();
       this->m_UpdateBoundingBox = true;
       this->InvokeEvent(ContourModelSizeChangeEvent());
@@ -361,8 +366,12 @@ bool mitk::ContourModel::RemoveVertex(const VertexType *vertex, int timestep)
 
 bool mitk::ContourModel::RemoveVertexAt(int index, int timestep)
 {
-  if (!this->IsEmptyTimeStep(timestep))
+  if (!this->IsEmptyTimeStep(timestep) && index >= 0 && index < this->m_ContourSeries[timestep]->GetSize())
   {
+    if (this->m_ContourSeries[timestep]->GetVertexAt(index) == this->m_SelectedVertex)
+    {
+      this->m_SelectedVertex = nullptr;
+    }
     if (this->m_ContourSeries[timestep]->RemoveVertexAt(index))
     {
       this->Modified();
@@ -378,13 +387,7 @@ bool mitk::ContourModel::RemoveVertexAt(mitk::Point3D &point, float eps, int tim
 {
   if (!this->IsEmptyTimeStep(timestep))
   {
-    if (this->m_ContourSeries[timestep]->RemoveVertexAt(point, eps))
-    {
-      this->Modified();
-      this->m_UpdateBoundingBox = true;
-      this->InvokeEvent(ContourModelSizeChangeEvent());
-      return true;
-    }
+    return this->RemoveVertex(this->m_ContourSeries[timestep]->GetVertexAt(point, eps), timestep);
   }
   return false;
 }
@@ -425,6 +428,11 @@ void mitk::ContourModel::ShiftVertex(VertexType *vertex, mitk::Vector3D &vector)
   vertex->Coordinates[0] += vector[0];
   vertex->Coordinates[1] += vector[1];
   vertex->Coordinates[2] += vector[2];
+
+  for (auto &contour : this->m_ContourSeries)
+  {
+    contour->UpdateSpatialIndex(vertex);
+  }
 }
 
 void mitk::ContourModel::Clear(int timestep)
@@ -185,6 +185,11 @@ vtkSmartPointer<vtkPolyData> mitk::ContourModelMapper2D::CreateVtkPolyDataFromCo
     mitk::ContourModel::VertexIterator next = renderingContour->IteratorBegin(timestep);
     if (next != renderingContour->IteratorEnd(timestep))
     {
+      // each vertex is inserted once, consecutive vertices share the point between their lines
+      points->SetNumberOfPoints(renderingContour->GetNumberOfVertices(timestep));
+      points->SetPoint(0, (*current)->Coordinates[0], (*current)->Coordinates[1], (*current)->Coordinates[2]);
+      vtkIdType currentId = 0;
+
       next++;
 
       mitk::ContourModel::VertexIterator end = renderingContour->IteratorEnd(timestep);
@@ -194,15 +199,13 @@ vtkSmartPointer<vtkPolyData> mitk::ContourModelMapper2D::CreateVtkPolyDataFromCo
         mitk::ContourModel::VertexType *currentControlPoint = *current;
         mitk::ContourModel::VertexType *nextControlPoint = *next;
 
-        vtkIdType p1 = points->InsertNextPoint(currentControlPoint->Coordinates[0],
-                                               currentControlPoint->Coordinates[1],
-                                               currentControlPoint->Coordinates[2]);
-        vtkIdType p2 = points->InsertNextPoint(
-          nextControlPoint->Coordinates[0], nextControlPoint->Coordinates[1], nextControlPoint->Coordinates[2]);
+        vtkIdType nextId = currentId + 1;
+        points->SetPoint(
+          nextId, nextControlPoint->Coordinates[0], nextControlPoint->Coordinates[1], nextControlPoint->Coordinates[2]);
         // add the line between both contorlPoints
         lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
+        lines->InsertCellPoint(currentId);
+        lines->InsertCellPoint(nextId);
 
         if (currentControlPoint->IsControlPoint)
         {
@@ -225,6 +228,7 @@ vtkSmartPointer<vtkPolyData> mitk::ContourModelMapper2D::CreateVtkPolyDataFromCo
 
         current++;
         next++;
+        currentId = nextId;
       } // end while (it!=end)
 
       // check if last control point is enabled to draw it
@@ -253,17 +257,9 @@ vtkSmartPointer<vtkPolyData> mitk::ContourModelMapper2D::CreateVtkPolyDataFromCo
       if (renderingContour->IsClosed(timestep))
       {
         // add a line from the last to the first control point
-        mitk::ContourModel::VertexType *firstControlPoint = *(renderingContour->IteratorBegin(timestep));
-        mitk::ContourModel::VertexType *lastControlPoint = *(--(renderingContour->IteratorEnd(timestep)));
-        vtkIdType p2 = points->InsertNextPoint(
-          lastControlPoint->Coordinates[0], lastControlPoint->Coordinates[1], lastControlPoint->Coordinates[2]);
-        vtkIdType p1 = points->InsertNextPoint(
-          firstControlPoint->Coordinates[0], firstControlPoint->Coordinates[1], firstControlPoint->Coordinates[2]);
-
-        // add the line between both contorlPoints
         lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
+        lines->InsertCellPoint(0);
+        lines->InsertCellPoint(currentId);
       } // end if(isClosed)
 
       // Add the points to the dataset
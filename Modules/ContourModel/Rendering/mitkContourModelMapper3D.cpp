@@ -136,6 +136,11 @@ vtkSmartPointer<vtkPolyData> mitk::ContourModelMapper3D::CreateVtkPolyDataFromCo
   mitk::ContourModel::VertexIterator next = inputContour->IteratorBegin(timestep);
   if (next != inputContour->IteratorEnd(timestep))
   {
+    // each vertex is inserted once, consecutive vertices share the point between their lines
+    points->SetNumberOfPoints(inputContour->GetNumberOfVertices(timestep));
+    points->SetPoint(0, (*current)->Coordinates[0], (*current)->Coordinates[1], (*current)->Coordinates[2]);
+    vtkIdType currentId = 0;
+
     next++;
 
     mitk::ContourModel::VertexIterator end = inputContour->IteratorEnd(timestep);
@@ -145,22 +150,22 @@ vtkSmartPointer<vtkPolyData> mitk::ContourModelMapper3D::CreateVtkPolyDataFromCo
       mitk::ContourModel::VertexType *currentControlPoint = *current;
       mitk::ContourModel::VertexType *nextControlPoint = *next;
 
+      vtkIdType nextId = currentId + 1;
+      points->SetPoint(
+        nextId, nextControlPoint->Coordinates[0], nextControlPoint->Coordinates[1], nextControlPoint->Coordinates[2]);
+
       if (!(currentControlPoint->Coordinates[0] == nextControlPoint->Coordinates[0] &&
             currentControlPoint->Coordinates[1] == nextControlPoint->Coordinates[1] &&
             currentControlPoint->Coordinates[2] == nextControlPoint->Coordinates[2]))
       {
-        vtkIdType p1 = points->InsertNextPoint(currentControlPoint->Coordinates[0],
-                                               currentControlPoint->Coordinates[1],
-                                               currentControlPoint->Coordinates[2]);
-        vtkIdType p2 = points->InsertNextPoint(
-          nextControlPoint->Coordinates[0], nextControlPoint->Coordinates[1], nextControlPoint->Coordinates[2]);
         // add the line between both contorlPoints
         lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
+        lines->InsertCellPoint(currentId);
+        lines->InsertCellPoint(nextId);
       }
       current++;
       next++;
+      currentId = nextId;
     }
 
     if (inputContour->IsClosed(timestep))
@@ -172,15 +177,10 @@ vtkSmartPointer<vtkPolyData> mitk::ContourModelMapper3D::CreateVtkPolyDataFromCo
           lastControlPoint->Coordinates[1] != firstControlPoint->Coordinates[1] ||
           lastControlPoint->Coordinates[2] != firstControlPoint->Coordinates[2])
       {
-        vtkIdType p2 = points->InsertNextPoint(
-          lastControlPoint->Coordinates[0], lastControlPoint->Coordinates[1], lastControlPoint->Coordinates[2]);
-        vtkIdType p1 = points->InsertNextPoint(
-          firstControlPoint->Coordinates[0], firstControlPoint->Coordinates[1], firstControlPoint->Coordinates[2]);
-
         // add the line to the cellArray
         lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
+        lines->InsertCellPoint(0);
+        lines->InsertCellPoint(currentId);
       }
     }
 
@@ -13,9 +13,12 @@ A PARTICULAR PURPOSE.
 See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
+#include <mitkContourElement.h>
 #include <mitkContourModel.h>
 #include <mitkTestingMacros.h>
 
+#include <random>
+
 // Add a vertex to the contour and see if size changed
 static void TestAddVertex()
 {
@@ -400,6 +403,105 @@ static void TestContourModelAPI()
   MITK_TEST_CONDITION(contour2->GetNumberOfVertices() == 1, "Add call with another contour");
 }
 
+// Remove the selected vertex, the contour must not keep the removed vertex selected
+static void TestRemoveSelectedVertex()
+{
+  mitk::ContourModel::Pointer contour = mitk::ContourModel::New();
+
+  mitk::Point3D p;
+  p[0] = p[1] = p[2] = 0;
+
+  contour->AddVertex(p);
+  contour->SelectVertexAt(0);
+  contour->RemoveVertex(contour->GetSelectedVertex());
+
+  MITK_TEST_CONDITION(contour->GetSelectedVertex() == nullptr, "Removed vertex was deselected");
+}
+
+// Spatial queries with the spatial index have to give the same results as without it, also after editing the contour
+static void TestSpatialIndex()
+{
+  mitk::ContourElement::Pointer indexed = mitk::ContourElement::New();
+  mitk::ContourElement::Pointer linear = mitk::ContourElement::New();
+  linear->SetSpatialIndexCellSize(0);
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> coordinate(0, 100);
+
+  mitk::Point3D p;
+  p[2] = 0;
+  for (int i = 0; i < 500; ++i)
+  {
+    p[0] = coordinate(generator);
+    p[1] = coordinate(generator);
+    indexed->AddVertex(p, i % 5 == 0);
+    linear->AddVertex(p, i % 5 == 0);
+
+    // build the index while the contour is being edited
+    if (i == 100)
+    {
+      indexed->IsNearContour(p, 1);
+    }
+  }
+
+  for (int i = 0; i < 100; ++i)
+  {
+    int index = i * 3;
+    p[0] = coordinate(generator);
+    p[1] = coordinate(generator);
+    switch (i % 4)
+    {
+      case 0:
+        indexed->InsertVertexAtIndex(p, false, index);
+        linear->InsertVertexAtIndex(p, false, index);
+        break;
+      case 1:
+        indexed->SetVertexAt(index, p);
+        linear->SetVertexAt(index, p);
+        break;
+      case 2:
+        indexed->RemoveVertexAt(index);
+        linear->RemoveVertexAt(index);
+        break;
+      default:
+        indexed->AddVertexAtFront(p, true);
+        linear->AddVertexAtFront(p, true);
+    }
+  }
+
+  bool equalVertices = true;
+  bool equalNearContour = true;
+  for (int i = 0; i < 1000; ++i)
+  {
+    p[0] = coordinate(generator);
+    p[1] = coordinate(generator);
+    const mitk::ContourElement::VertexType *vertex = indexed->GetVertexAt(p, 3);
+    equalVertices = equalVertices && vertex == indexed->BruteForceGetVertexAt(p, 3) &&
+                    indexed->GetIndex(vertex) == linear->GetIndex(linear->GetVertexAt(p, 3));
+    equalNearContour = equalNearContour && indexed->IsNearContour(p, 1.5) == linear->IsNearContour(p, 1.5);
+  }
+
+  MITK_TEST_CONDITION(equalVertices, "Vertices found with spatial index");
+  MITK_TEST_CONDITION(equalNearContour, "Nearness to contour with spatial index");
+}
+
+// A cloned contour element has its own vertices
+static void TestCloneContourElement()
+{
+  mitk::ContourElement::Pointer element = mitk::ContourElement::New();
+
+  mitk::Point3D p;
+  p[0] = p[1] = p[2] = 0;
+  element->AddVertex(p, true);
+
+  mitk::ContourElement::Pointer clone = element->Clone();
+  element->Clear();
+
+  MITK_TEST_CONDITION(clone->GetSize() == 1 && clone->GetVertexAt(0)->Coordinates == p &&
+                        clone->GetVertexAt(0)->IsControlPoint,
+                      "Clone contour element");
+}
+
 int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
 {
   MITK_TEST_BEGIN("mitkContourModelTest")
@@ -418,6 +520,9 @@ int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
   TestSetVertices();
   TestSelectVertexAtWrongPosition();
   TestContourModelAPI();
+  TestRemoveSelectedVertex();
+  TestSpatialIndex();
+  TestCloneContourElement();
 
   MITK_TEST_END()
 }
@@ -38,6 +38,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkGeometry3D.h"
 #include "mitkLevelWindow.h"
+#include <functional>
 #include <map>
 #include <set>
 
@@ -87,9 +88,24 @@ namespace mitk
     /**
      * \brief Get the data object (instance of BaseData, e.g., an Image)
      * managed by this DataNode
+     *
+     * If a data loader is set, it is called first, see SetDataLoader().
      */
     BaseData *GetData() const;
 
+    /**
+     * \brief Get the data object without calling the data loader, NULL while the data is not loaded
+     */
+    BaseData *GetDataWithoutLoading() const { return m_Data; }
+
+    /**
+     * \brief Class name of the data, or of the data the loader will provide, without calling the data loader
+     *
+     * Use this instead of GetData()->GetNameOfClass() where only the type of the data is needed,
+     * e.g. in node predicates and indices. Empty if the node has no data.
+     */
+    std::string GetDataType() const;
+
     /**
      * \brief Get the transformation applied prior to displaying the data as
      * a vtkTransform
@@ -111,6 +127,29 @@ namespace mitk
      */
     virtual void SetData(mitk::BaseData *baseData);
 
+    /**
+     * \brief Loads the data of a node on demand, see SetDataLoader()
+     */
+    typedef std::function<void(DataNode &)> DataLoaderType;
+
+    /**
+     * \brief Set a function that provides the data of the node when it is accessed for the first time
+     *
+     * Readers use this to create nodes before their data is read, e.g. SceneIO when loading
+     * scenes on demand. The first call of GetData() removes the loader and calls it, the loader is
+     * expected to call SetData(). Errors of the loader are logged and leave the node without data.
+     * Setting data before removes the loader. Like SetData(), this is not thread-safe.
+     *
+     * \param dataType class name of the data the loader will provide, returned by GetDataType() until the
+     * data is loaded
+     */
+    void SetDataLoader(const DataLoaderType &loader, const std::string &dataType = "");
+
+    /**
+     * \brief Whether the data of the node is not loaded yet, see SetDataLoader()
+     */
+    bool HasDataLoader() const { return static_cast<bool>(m_DataLoader); }
+
     /**
      * \brief Set the Interactor.
      */
@@ -562,6 +601,12 @@ namespace mitk
      */
     BaseData::Pointer m_Data;
 
+    /// \brief Provides m_Data on first access, see SetDataLoader()
+    mutable DataLoaderType m_DataLoader;
+
+    /// \brief Class name of the data provided by m_DataLoader
+    mutable std::string m_DataLoaderDataType;
+
     /**
      * \brief BaseRenderer-independent PropertyList
      *
@@ -102,7 +102,7 @@ namespace mitk
     //## (see definition of NodePredicateBase for details).
     //## The method returns a set of SmartPointers to the DataNodes that fulfill the
     //## conditions. A set of all objects can be retrieved with the GetAll() method;
-    SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const;
+    virtual SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const;
 
     //##Documentation
     //## @brief returns a set of source objects for a given node that meet the given condition(s).
@@ -397,6 +397,12 @@ namespace mitk
     //## If the cast succeeds the ChangedNodeEvent is emitted with this node.
     void OnNodeModifiedOrDeleted(const itk::Object *caller, const itk::EventObject &event);
 
+    //##Documentation
+    //## @brief Called for each ModifiedEvent of a node in the storage, also while node modified events are blocked.
+    //##
+    //## Subclasses that keep information derived from the nodes (e.g. query indices) can update it here.
+    virtual void OnNodeChanged(const mitk::DataNode *node);
+
     //##Documentation
     //## @brief  Adds a Modified-Listener to the given Node.
     void AddListeners(const mitk::DataNode *_Node);
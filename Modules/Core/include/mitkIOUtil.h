@@ -28,6 +28,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIFileReader.h>
 #include <mitkIFileWriter.h>
 
+#include <itkImageIORegion.h>
+
 #include <fstream>
 
 namespace us
@@ -286,6 +288,22 @@ namespace mitk
      */
     static mitk::Image::Pointer LoadImage(const std::string &path);
 
+    /**
+     * @brief LoadImage Convenience method to load a sub-block of an image.
+     *
+     * Only the pixels within \c region are read if the file format supports streaming
+     * (see ItkImageIO::OPTION_REGION_INDEX()). The geometry of the returned image is
+     * positioned at the region. A 4D region with a time size of 1 selects a single time step.
+     * A size of 0 reads up to the end of the image in that dimension.
+     *
+     * @param path The path to the image including file name and file extension.
+     * @param region The region to read, given in image index coordinates.
+     * @throws mitk::Exception This exception is thrown when the Image is NULL, the region is
+     * invalid or the responsible reader does not support reading regions.
+     * @return Returns the mitkImage.
+     */
+    static mitk::Image::Pointer LoadImage(const std::string &path, const itk::ImageIORegion &region);
+
     /**
      * @brief LoadSurface Convenience method to load an arbitrary mitkSurface.
      * @param path The path to the surface including file name and file extension.
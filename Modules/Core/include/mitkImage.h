@@ -644,6 +644,25 @@ namespace mitk
       new \a ImageStatisticsHolder object.
       */
     StatisticsHolderPointer GetStatistics() const { return m_ImageStatistics; }
+
+    /**
+      \brief Marks the whole image as modified, cached information of all time steps becomes invalid.
+      */
+    virtual void Modified() const override;
+
+    /**
+      \brief Marks only the data of time step \a t as modified.
+
+      Like Modified(), but information cached per time step (e.g. by the ImageStatisticsHolder) stays valid for
+      all other time steps. Use this instead of Modified() after writing to the buffer of a single time step.
+      */
+    void TimeStepModified(unsigned int t) const;
+
+    /**
+      \brief Time of the last modification of the data of time step \a t, by Modified() or TimeStepModified(t).
+      */
+    itk::ModifiedTimeType GetTimeStepMTime(unsigned int t) const;
+
   protected:
     mitkCloneMacro(Self);
 
@@ -703,6 +722,10 @@ namespace mitk
     friend class ImageStatisticsHolder;
     StatisticsHolderPointer m_ImageStatistics;
 
+    mutable itk::TimeStamp m_AllTimeStepsModifiedTime;
+    // one per time step, sized by Initialize() and never resized afterwards
+    mutable std::vector<itk::TimeStamp> m_TimeStepModifiedTimes;
+
   private:
     ImageDataItemPointer GetSliceData_unlocked(
       int s, int t, int n, void *data, ImportMemoryManagementType importMemoryManagement) const;
@@ -134,6 +134,16 @@ namespace mitk
     unsigned long GetSize() const { return m_Size; }
     virtual void Modified() const;
 
+    /**
+     * @brief Attaches an object that owns the referenced image memory.
+     *
+     * Used for data that is neither managed by this item nor by the caller, e.g. a
+     * mitk::MemoryMappedFile. The owner is kept alive as long as this item (and thus any
+     * sub-item referencing it as parent) exists.
+     */
+    void SetDataOwner(itk::LightObject *owner) { m_DataOwner = owner; }
+    itk::LightObject *GetDataOwner() const { return m_DataOwner.GetPointer(); }
+
   protected:
     unsigned char *m_Data;
 
@@ -150,6 +160,8 @@ namespace mitk
 
     unsigned long m_Size;
 
+    itk::LightObject::Pointer m_DataOwner;
+
   private:
     void ComputeItemSize(const unsigned int *dimensions, unsigned int dimension);
 
@@ -47,6 +47,9 @@ namespace mitk
 
     typedef itk::Statistics::Histogram<double> HistogramType;
 
+    //##Documentation
+    //## \brief Get the histogram of time step \a t. The histogram is cached per time step and only recomputed
+    //## after the data of that time step has been modified (see Image::TimeStepModified()).
     virtual const HistogramType *GetScalarHistogram(int t = 0, unsigned int = 0);
 
     //##Documentation
@@ -149,6 +152,10 @@ namespace mitk
   protected:
     virtual void ResetImageStatistics();
 
+    //##Documentation
+    //## \brief Resets the statistics of time step \a t only, the other time steps keep their values.
+    virtual void ResetImageStatistics(unsigned int t);
+
     virtual void ComputeImageStatistics(int t = 0, unsigned int component = 0);
 
     virtual void Expand(unsigned int timeSteps);
@@ -168,6 +175,13 @@ namespace mitk
     mutable std::vector<ScalarType> m_Scalar2ndMax;
 
     itk::TimeStamp m_LastRecomputeTimeStamp;
+
+    //##Documentation
+    //## \brief Time of the last computation of the extrema of each time step, compared with Image::GetTimeStepMTime()
+    std::vector<itk::TimeStamp> m_TimeStepRecomputeTimeStamps;
+
+    std::vector<HistogramType::ConstPointer> m_ScalarHistograms;
+    std::vector<itk::TimeStamp> m_ScalarHistogramTimeStamps;
   };
 
 } // end namespace
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkAbstractFileIO.h"
 
 #include <itkImageIOBase.h>
+#include <itkImageIORegion.h>
 
 namespace mitk
 {
@@ -30,6 +31,17 @@ namespace mitk
    * Instantiating this class with a given itk::ImageIOBase instance
    * will register corresponding MITK reader/writer services for that
    * ITK ImageIO object.
+   *
+   * If the reader option OPTION_MEMORY_MAPPING() is enabled, the pixel data of
+   * uncompressed NRRD and MetaImage files stored in native byte order is memory
+   * mapped (copy-on-write) instead of read. It is then paged in by the operating
+   * system only when accessed. Files that do not qualify are read as usual.
+   *
+   * The reader options OPTION_REGION_INDEX(), OPTION_REGION_SIZE() and
+   * OPTION_TIME_STEP() restrict reading to a sub-block of the image. ImageIOs
+   * that support streaming (e.g. MetaImage, NIfTI) only read the requested
+   * region from disk, all others read the file and crop it. The geometry of
+   * the resulting image is positioned at the requested region.
    */
   class MITKCORE_EXPORT ItkImageIO : public AbstractFileIO
   {
@@ -37,6 +49,23 @@ namespace mitk
     ItkImageIO(itk::ImageIOBase::Pointer imageIO);
     ItkImageIO(const CustomMimeType &mimeType, itk::ImageIOBase::Pointer imageIO, int rank);
 
+    /** Name of the boolean reader option that enables memory mapping (default: false). */
+    static std::string OPTION_MEMORY_MAPPING();
+
+    /** Name of the string reader option holding the whitespace separated start index of the region to read.
+     *  Missing trailing entries default to 0 (default: empty, i.e. whole image). */
+    static std::string OPTION_REGION_INDEX();
+
+    /** Name of the string reader option holding the whitespace separated size of the region to read.
+     *  Missing trailing entries or a size of 0 select the remaining extent of that dimension. */
+    static std::string OPTION_REGION_SIZE();
+
+    /** Name of the int reader option selecting a single time step of a 3D+t image (default: -1, i.e. all). */
+    static std::string OPTION_TIME_STEP();
+
+    /** Returns reader options that restrict reading to \c region. */
+    static IFileReader::Options CreateRegionReaderOptions(const itk::ImageIORegion &region);
+
     // -------------- AbstractFileReader -------------
 
     using AbstractFileReader::Read;
@@ -55,6 +84,12 @@ namespace mitk
     // Fills the m_DefaultMetaDataKeys vector with default values
     virtual void InitializeDefaultMetaDataKeys();
 
+    // Registers the reader options with their default values
+    void InitializeDefaultReaderOptions();
+
+    // Returns the part of largestRegion that is selected by the region reader options
+    itk::ImageIORegion GetRequestedIORegion(const itk::ImageIORegion &largestRegion);
+
   private:
     ItkImageIO(const ItkImageIO &other);
 
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkUndoModel.h"
 #include <MitkCoreExports.h>
 // STL header
+#include <utility>
 #include <vector>
 // ITK header
 #pragma GCC visibility push(default)
@@ -35,12 +36,20 @@ namespace mitk
   //##
   //## Derived from UndoModel AND itk::Object. Invokes ITK-events to signal listening
   //## GUI elements, whether each of the stacks is empty or not (to enable/disable button, ...)
+  //##
+  //## The items of both stacks may hold a limited amount of memory, see SetMemoryBudget().
+  //## If a new item exceeds the budget, the oldest items of the undo stack move their data
+  //## to disk. The items stay on the stack, so nothing can be lost.
   class MITKCORE_EXPORT LimitedLinearUndo : public UndoModel
   {
   public:
     typedef std::vector<UndoStackItem *> UndoContainer;
     typedef std::vector<UndoStackItem *>::reverse_iterator UndoContainerRevIter;
 
+    typedef std::pair<int, std::size_t> StackMemoryUsageItem;
+    typedef std::vector<StackMemoryUsageItem>
+      StackMemoryUsage; /// a list of pairs (ObjectEventId, bytes in memory), from the top of a stack downwards
+
     mitkClassMacro(LimitedLinearUndo, UndoModel);
     itkFactorylessNewMacro(Self) itkCloneMacro(Self)
 
@@ -101,6 +110,25 @@ namespace mitk
     //## corresponding to the given values; if nothing found, then returns NULL
     virtual OperationEvent *GetLastOfType(OperationActor *destination, OperationType opType) override;
 
+    //##Documentation
+    //## @brief Sets the number of bytes the items of both stacks may hold in memory
+    //##
+    //## Zero means no limit. The default is 512 MB.
+    void SetMemoryBudget(std::size_t budget);
+    itkGetConstMacro(MemoryBudget, std::size_t);
+
+    //##Documentation
+    //## @brief Returns the number of bytes held in memory by the items of both stacks
+    std::size_t GetMemoryUsage() const;
+
+    //##Documentation
+    //## @brief Returns the memory usage of each item of the undo stack
+    StackMemoryUsage GetUndoMemoryUsage() const;
+
+    //##Documentation
+    //## @brief Returns the memory usage of each item of the redo stack
+    StackMemoryUsage GetRedoMemoryUsage() const;
+
   protected:
     //##Documentation
     //## Constructor
@@ -114,12 +142,20 @@ namespace mitk
     //## elements in the list and to clear the list
     void ClearList(UndoContainer *list);
 
+    //## @brief Moves the data of the oldest items of the undo stack to disk
+    //## until the memory budget is kept. The newest item stays in memory.
+    void EnforceMemoryBudget();
+
     UndoContainer m_UndoList;
 
     UndoContainer m_RedoList;
 
+    std::size_t m_MemoryBudget;
+
   private:
     int FirstObjectEventIdOfCurrentGroup(UndoContainer &stack);
+
+    static StackMemoryUsage GetStackMemoryUsage(const UndoContainer &stack);
   };
 
 #pragma GCC visibility push(default)
@@ -0,0 +1,98 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKMEMORYMAPPEDFILE_H
+#define MITKMEMORYMAPPEDFILE_H
+
+#include <MitkCoreExports.h>
+#include <mitkCommon.h>
+
+#include <itkLightObject.h>
+
+#include <string>
+
+namespace mitk
+{
+  /**
+   * \brief Copy-on-write memory mapping of a byte range of a file.
+   *
+   * The mapped range is paged in lazily by the operating system when it is
+   * first accessed, so a large image payload does not have to be resident
+   * in memory as a whole. Writing to the mapped memory never modifies the
+   * file; modified pages are private to the process.
+   *
+   * The object is meant to be attached to an ImageDataItem via
+   * ImageDataItem::SetDataOwner(), which keeps the mapping alive as long as
+   * the image (or any sub-item referencing it) exists.
+   *
+   * \warning The mapped file must not be truncated or overwritten while the
+   * mapping exists.
+   */
+  class MITKCORE_EXPORT MemoryMappedFile : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(MemoryMappedFile, itk::LightObject);
+    itkFactorylessNewMacro(Self);
+
+    /**
+     * \brief Maps \c length bytes of \c fileName starting at byte \c offset.
+     *
+     * An existing mapping is released first.
+     *
+     * \throws mitk::Exception if the file cannot be opened or mapped.
+     */
+    void Map(const std::string &fileName, size_t offset, size_t length);
+
+    /** \brief Releases the mapping. Pointers obtained by GetData() become invalid. */
+    void Unmap();
+
+    bool IsMapped() const { return m_Data != nullptr; }
+
+    /** \brief Pointer to the first mapped byte (the requested offset, not the page boundary). */
+    void *GetData() const { return m_Data; }
+
+    size_t GetLength() const { return m_Length; }
+
+    const std::string &GetFileName() const { return m_FileName; }
+
+    /** \brief Required alignment of the file offset passed to the operating system. */
+    static size_t GetAllocationGranularity();
+
+  protected:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+  private:
+    MemoryMappedFile(const Self &) = delete;
+    Self &operator=(const Self &) = delete;
+
+    std::string m_FileName;
+
+    void *m_Data;
+    size_t m_Length;
+
+    // start and size of the whole, granularity-aligned view
+    void *m_View;
+    size_t m_ViewLength;
+
+#if defined(_WIN32)
+    void *m_FileHandle;
+    void *m_MappingHandle;
+#endif
+  };
+}
+
+#endif
@@ -44,6 +44,8 @@ namespace mitk
     //## @brief Checks, if the nodes data object is of a specific data type
     virtual bool CheckNode(const mitk::DataNode *node) const override;
 
+    const std::string &GetValidDataType() const { return m_ValidDataType; }
+
   protected:
     //##Documentation
     //## @brief Protected constructor, use static instantiation functions instead
@@ -59,6 +61,7 @@ namespace mitk
    * E.g. if you query for type BaseData, you will also get Image and Surface objects.
    *
    * The desired type is given as a template parameter, the constructor takes no other parameters.
+   * Unlike NodePredicateDataType, this predicate loads data that is read on demand (see DataNode::SetDataLoader()).
    */
   template <class T>
   class TNodePredicateDataType : public NodePredicateBase
@@ -49,6 +49,10 @@ namespace mitk
     //## @brief Checks, if the nodes contains a property that is equal to m_ValidProperty
     virtual bool CheckNode(const mitk::DataNode *node) const override;
 
+    const std::string &GetValidPropertyName() const { return m_ValidPropertyName; }
+    const mitk::BaseProperty *GetValidProperty() const { return m_ValidProperty; }
+    const mitk::BaseRenderer *GetRenderer() const { return m_Renderer; }
+
   protected:
     //##Documentation
     //## @brief Constructor to check for a named property
@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkCommon.h>
 
+#include <cstddef>
+
 namespace mitk
 {
   typedef int OperationType;
@@ -43,6 +45,16 @@ namespace mitk
 
     OperationType GetOperationType();
 
+    //##Documentation
+    //## @brief Number of bytes of data held by the operation, e.g. an image for undo.
+    //## Zero for operations that hold no significant amount of data.
+    virtual std::size_t GetMemoryUsage() const;
+
+    //##Documentation
+    //## @brief Moves the data held by the operation out of memory, e.g. into a temporary file.
+    //## Called by undo models to keep within their memory budget, does nothing by default.
+    virtual void MoveDataToDisk();
+
   protected:
     OperationType m_OperationType;
   };
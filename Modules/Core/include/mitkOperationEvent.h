@@ -78,6 +78,14 @@ namespace mitk
     virtual void ReverseOperations();
     virtual void ReverseAndExecute();
 
+    //##Documentation
+    //## @brief Returns the number of bytes of data held by this item, zero by default
+    virtual std::size_t GetMemoryUsage() const;
+
+    //##Documentation
+    //## @brief Moves the data held by this item out of memory, does nothing by default
+    virtual void MoveDataToDisk();
+
     //##Documentation
     //## @brief Increases the current ObjectEventId
     //## For example if a button click generates operations the ObjectEventId has to be incremented to be able to undo
@@ -170,6 +178,12 @@ namespace mitk
     //##reverses and executes both operations (used, when moved from undo to redo stack)
     virtual void ReverseAndExecute() override;
 
+    //## @brief Returns the number of bytes of data held by both operations
+    virtual std::size_t GetMemoryUsage() const override;
+
+    //## @brief Moves the data of both operations out of memory
+    virtual void MoveDataToDisk() override;
+
     //## @brief returns true if the destination still is present
     //## and false if it already has been deleted
     virtual bool IsValid();
@@ -17,10 +17,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef MITKSTANDALONEDATASTORAGE_H_HEADER_INCLUDED_
 #define MITKSTANDALONEDATASTORAGE_H_HEADER_INCLUDED_
 
+#include "itkCommand.h"
 #include "itkVectorContainer.h"
 #include "mitkDataStorage.h"
 #include "mitkMessage.h"
 #include <map>
+#include <set>
 
 namespace mitk
 {
@@ -91,6 +93,19 @@ namespace mitk
     //##
     SetOfObjects::ConstPointer GetAll() const override;
 
+    //##Documentation
+    //## @brief returns a set of data objects that meet the given condition(s)
+    //##
+    //## Conditions that consist of NodePredicateProperty (without renderer), NodePredicateDataType
+    //## and NodePredicateAnd/Or/Not combinations of these are answered from indices instead of checking
+    //## every node. The data type index is always kept, a property index is created for a property key
+    //## the first time it is queried. Results of composite conditions are cached until a node is added or
+    //## removed, or until a node changes a data type or property the condition depends on. The indices follow
+    //## the ModifiedEvents of the nodes and of their indexed property objects, so values changed directly on a
+    //## property (e.g. by BaseProperty::SetValue()) are noticed, too. All other conditions are checked against
+    //## every node (see DataStorage::GetSubset()).
+    SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const override;
+
     /*ITK Mutex */
     mutable itk::SimpleFastMutexLock m_Mutex;
 
@@ -125,12 +140,105 @@ namespace mitk
     //## @brief Prints the contents of the StandaloneDataStorage to os. Do not call directly, call ->Print() instead
     virtual void PrintSelf(std::ostream &os, itk::Indent indent) const override;
 
+    //##Documentation
+    //## @brief Updates the query indices for a modified node
+    void OnNodeChanged(const mitk::DataNode *node) override;
+
+    typedef std::set<const mitk::DataNode *> NodeSet;
+
+    //##Documentation
+    //## @brief Indexed property of a node, the property object is observed for changes of its value
+    struct IndexedProperty
+    {
+      std::string value;
+      BaseProperty::Pointer property;
+      unsigned long mTime;
+    };
+
+    //##Documentation
+    //## @brief Indexed values of a node, used to remove the node from the indices again
+    struct IndexedNodeValues
+    {
+      std::string dataType;
+      std::map<std::string, IndexedProperty> properties;
+    };
+
+    struct CachedSubset
+    {
+      itk::SmartPointer<const NodePredicateBase> condition;
+      unsigned long conditionMTime;
+      std::set<std::string> propertyKeys;
+      bool dependsOnDataType;
+      SetOfObjects::ConstPointer result;
+    };
+
+    struct ObservedProperty
+    {
+      BaseProperty::Pointer property;
+      unsigned long observerTag;
+      NodeSet nodes;
+    };
+
+    //##Documentation
+    //## @brief checks whether a condition can be evaluated with the indices
+    static bool IsIndexedCondition(const NodePredicateBase *condition);
+
+    //##Documentation
+    //## @brief evaluates an indexed condition, m_Mutex has to be locked
+    void EvaluateIndexedCondition(const NodePredicateBase *condition, NodeSet &result) const;
+
+    //##Documentation
+    //## @brief collects the property keys evaluated by an indexed condition and whether it evaluates the data type
+    static void GetConditionDependencies(const NodePredicateBase *condition,
+                                         std::set<std::string> &propertyKeys,
+                                         bool &dependsOnDataType);
+
+    //##Documentation
+    //## @brief index maintenance, m_Mutex has to be locked
+    void AddToIndices(const mitk::DataNode *node) const;
+    void RemoveFromIndices(const mitk::DataNode *node) const;
+    void CreatePropertyIndex(const std::string &propertyKey) const;
+    void AddToPropertyIndex(const mitk::DataNode *node,
+                            const std::string &propertyKey,
+                            BaseProperty *property,
+                            IndexedNodeValues &values) const;
+
+    //##Documentation
+    //## @brief re-indexes the nodes in m_ModifiedNodes and removes the cached results that depend on their
+    //## changes, m_Mutex has to be locked
+    void UpdateModifiedNodes() const;
+
+    //##Documentation
+    //## @brief marks the nodes of a modified indexed property object as modified
+    void OnIndexedPropertyModified(const itk::Object *caller, const itk::EventObject &event);
+
     //##Documentation
     //## @brief Nodes and their relation are stored in m_SourceNodes
     AdjacencyList m_SourceNodes;
     //##Documentation
     //## @brief Nodes are stored in reverse relation for easier traversal in the opposite direction of the relation
     AdjacencyList m_DerivedNodes;
+
+    //##Documentation
+    //## @brief Indexed values of each node
+    mutable std::map<const mitk::DataNode *, IndexedNodeValues> m_IndexedNodeValues;
+    //##Documentation
+    //## @brief Nodes by the class name of their data
+    mutable std::map<std::string, NodeSet> m_DataTypeIndex;
+    //##Documentation
+    //## @brief Nodes by property key and property value (class name and value string) of the queried keys
+    mutable std::map<std::string, std::map<std::string, NodeSet>> m_PropertyIndex;
+    //##Documentation
+    //## @brief Results of composite conditions, removed when nodes are added or removed or when an indexed value
+    //## they depend on changes
+    mutable std::map<const NodePredicateBase *, CachedSubset> m_CachedSubsets;
+    //##Documentation
+    //## @brief Nodes whose indexed values might have changed since they were indexed
+    mutable NodeSet m_ModifiedNodes;
+    //##Documentation
+    //## @brief Observers of the indexed property objects and the nodes that have them
+    mutable std::map<const BaseProperty *, ObservedProperty> m_ObservedProperties;
+    itk::MemberCommand<StandaloneDataStorage>::Pointer m_PropertyModifiedCommand;
   };
 } // namespace mitk
 #endif /* MITKSTANDALONEDATASTORAGE_H_HEADER_INCLUDED_ */
@@ -17,9 +17,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkLimitedLinearUndo.h"
 #include <mitkRenderingManager.h>
 
-mitk::LimitedLinearUndo::LimitedLinearUndo()
+mitk::LimitedLinearUndo::LimitedLinearUndo() : m_MemoryBudget(512 * 1024 * 1024)
 {
-  // nothing to do
 }
 
 mitk::LimitedLinearUndo::~LimitedLinearUndo()
@@ -54,6 +53,8 @@ bool mitk::LimitedLinearUndo::SetOperationEvent(UndoStackItem *stackItem)
 
   m_UndoList.push_back(operationEvent);
 
+  this->EnforceMemoryBudget();
+
   InvokeEvent(UndoNotEmptyEvent());
 
   return true;
@@ -197,6 +198,65 @@ mitk::OperationEvent *mitk::LimitedLinearUndo::GetLastOfType(OperationActor *des
   return nullptr;
 }
 
+void mitk::LimitedLinearUndo::SetMemoryBudget(std::size_t budget)
+{
+  if (m_MemoryBudget != budget)
+  {
+    m_MemoryBudget = budget;
+    this->EnforceMemoryBudget();
+    this->Modified();
+  }
+}
+
+std::size_t mitk::LimitedLinearUndo::GetMemoryUsage() const
+{
+  std::size_t memoryUsage(0);
+  for (auto iter = m_UndoList.begin(); iter != m_UndoList.end(); ++iter)
+    memoryUsage += (*iter)->GetMemoryUsage();
+  for (auto iter = m_RedoList.begin(); iter != m_RedoList.end(); ++iter)
+    memoryUsage += (*iter)->GetMemoryUsage();
+  return memoryUsage;
+}
+
+mitk::LimitedLinearUndo::StackMemoryUsage mitk::LimitedLinearUndo::GetUndoMemoryUsage() const
+{
+  return GetStackMemoryUsage(m_UndoList);
+}
+
+mitk::LimitedLinearUndo::StackMemoryUsage mitk::LimitedLinearUndo::GetRedoMemoryUsage() const
+{
+  return GetStackMemoryUsage(m_RedoList);
+}
+
+mitk::LimitedLinearUndo::StackMemoryUsage mitk::LimitedLinearUndo::GetStackMemoryUsage(const UndoContainer &stack)
+{
+  StackMemoryUsage memoryUsage;
+  for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter)
+  {
+    memoryUsage.push_back(StackMemoryUsageItem((*iter)->GetObjectEventId(), (*iter)->GetMemoryUsage()));
+  }
+  return memoryUsage;
+}
+
+void mitk::LimitedLinearUndo::EnforceMemoryBudget()
+{
+  if (m_MemoryBudget == 0 || m_UndoList.empty())
+    return;
+
+  std::size_t memoryUsage = this->GetMemoryUsage();
+
+  // oldest items first, they are the least likely to be undone
+  for (auto iter = m_UndoList.begin(); memoryUsage > m_MemoryBudget && iter + 1 != m_UndoList.end(); ++iter)
+  {
+    std::size_t itemMemoryUsage = (*iter)->GetMemoryUsage();
+    if (itemMemoryUsage == 0)
+      continue;
+
+    (*iter)->MoveDataToDisk();
+    memoryUsage = memoryUsage - itemMemoryUsage + (*iter)->GetMemoryUsage();
+  }
+}
+
 int mitk::LimitedLinearUndo::FirstObjectEventIdOfCurrentGroup(mitk::LimitedLinearUndo::UndoContainer &stack)
 {
   int currentGroupEventId = stack.back()->GetGroupEventId();
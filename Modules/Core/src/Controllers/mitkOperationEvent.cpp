@@ -76,6 +76,15 @@ void mitk::UndoStackItem::ReverseAndExecute()
   ReverseOperations();
 }
 
+std::size_t mitk::UndoStackItem::GetMemoryUsage() const
+{
+  return 0;
+}
+
+void mitk::UndoStackItem::MoveDataToDisk()
+{
+}
+
 // ******************** mitk::OperationEvent ********************
 
 mitk::Operation *mitk::OperationEvent::GetOperation()
@@ -138,6 +147,24 @@ void mitk::OperationEvent::ReverseAndExecute()
     m_Destination->ExecuteOperation(m_Operation);
 }
 
+std::size_t mitk::OperationEvent::GetMemoryUsage() const
+{
+  std::size_t memoryUsage(0);
+  if (m_Operation)
+    memoryUsage += m_Operation->GetMemoryUsage();
+  if (m_UndoOperation)
+    memoryUsage += m_UndoOperation->GetMemoryUsage();
+  return memoryUsage;
+}
+
+void mitk::OperationEvent::MoveDataToDisk()
+{
+  if (m_Operation)
+    m_Operation->MoveDataToDisk();
+  if (m_UndoOperation)
+    m_UndoOperation->MoveDataToDisk();
+}
+
 mitk::OperationActor *mitk::OperationEvent::GetDestination()
 {
   return m_Destination;
@@ -47,11 +47,45 @@ mitk::Mapper *mitk::DataNode::GetMapper(MapperSlotId id) const
 
 mitk::BaseData *mitk::DataNode::GetData() const
 {
+  if (m_DataLoader)
+  {
+    // the loader is removed first, since it sets the data and might access it again
+    DataLoaderType loader;
+    std::swap(loader, m_DataLoader);
+    m_DataLoaderDataType.clear();
+    try
+    {
+      loader(*const_cast<DataNode *>(this));
+    }
+    catch (std::exception &e)
+    {
+      MITK_ERROR << "Could not load the data of node " << this->GetName() << ": " << e.what();
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Could not load the data of node " << this->GetName();
+    }
+
+    // the node lost the data type of its loader, which observers like the data storage indices have to notice
+    if (m_Data.IsNull())
+      const_cast<DataNode *>(this)->Modified();
+  }
   return m_Data;
 }
 
+std::string mitk::DataNode::GetDataType() const
+{
+  if (m_Data.IsNotNull())
+    return m_Data->GetNameOfClass();
+
+  return m_DataLoader ? m_DataLoaderDataType : std::string();
+}
+
 void mitk::DataNode::SetData(mitk::BaseData *baseData)
 {
+  m_DataLoader = nullptr;
+  m_DataLoaderDataType.clear();
+
   if (m_Data != baseData)
   {
     m_Mappers.clear();
@@ -82,6 +116,12 @@ void mitk::DataNode::SetData(mitk::BaseData *baseData)
   }
 }
 
+void mitk::DataNode::SetDataLoader(const DataLoaderType &loader, const std::string &dataType)
+{
+  m_DataLoader = loader;
+  m_DataLoaderDataType = dataType;
+}
+
 mitk::DataNode::DataNode() : m_PropertyListModifiedObserverTag(0)
 {
   m_Mappers.resize(10);
@@ -497,9 +537,10 @@ void mitk::DataNode::AddProperty(const char *propertyKey,
 
 vtkLinearTransform *mitk::DataNode::GetVtkTransform(int t) const
 {
-  assert(m_Data.IsNotNull());
+  mitk::BaseData *data = this->GetData();
+  assert(data);
 
-  mitk::BaseGeometry *geometry = m_Data->GetGeometry(t);
+  mitk::BaseGeometry *geometry = data->GetGeometry(t);
 
   if (geometry == NULL)
     return NULL;
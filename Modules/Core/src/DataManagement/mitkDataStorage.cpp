@@ -113,9 +113,7 @@ void mitk::DataStorage::PrintSelf(std::ostream &os, itk::Indent indent) const
   {
     std::string name;
     allIt.Value()->GetName(name);
-    std::string datatype;
-    if (allIt.Value()->GetData() != NULL)
-      datatype = allIt.Value()->GetData()->GetNameOfClass();
+    std::string datatype = allIt.Value()->GetDataType();
     os << indent << " " << allIt.Value().GetPointer() << "<" << datatype << ">: " << name << std::endl;
     mitk::DataStorage::SetOfObjects::ConstPointer parents = this->GetSources(allIt.Value());
     if (parents->Size() > 0)
@@ -197,10 +195,13 @@ void mitk::DataStorage::OnNodeInteractorChanged(itk::Object *caller, const itk::
 
 void mitk::DataStorage::OnNodeModifiedOrDeleted(const itk::Object *caller, const itk::EventObject &event)
 {
+  const mitk::DataNode *_Node = dynamic_cast<const mitk::DataNode *>(caller);
+  if (_Node && dynamic_cast<const itk::ModifiedEvent *>(&event))
+    this->OnNodeChanged(_Node);
+
   if (m_BlockNodeModifiedEvents)
     return;
 
-  const mitk::DataNode *_Node = dynamic_cast<const mitk::DataNode *>(caller);
   if (_Node)
   {
     const itk::ModifiedEvent *modEvent = dynamic_cast<const itk::ModifiedEvent *>(&event);
@@ -211,6 +212,10 @@ void mitk::DataStorage::OnNodeModifiedOrDeleted(const itk::Object *caller, const
   }
 }
 
+void mitk::DataStorage::OnNodeChanged(const mitk::DataNode *)
+{
+}
+
 void mitk::DataStorage::AddListeners(const mitk::DataNode *_Node)
 {
   itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_MutexOne);
@@ -286,8 +291,9 @@ mitk::TimeGeometry::Pointer mitk::DataStorage::ComputeBoundingGeometry3D(const S
   for (SetOfObjects::ConstIterator it = input->Begin(); it != input->End(); ++it)
   {
     DataNode::Pointer node = it->Value();
-    if ((node.IsNotNull()) && (node->GetData() != NULL) && (node->GetData()->IsEmpty() == false) &&
-        node->IsOn(boolPropertyKey, renderer) && node->IsOn(boolPropertyKey2, renderer))
+    // the properties are checked first, so that the data of hidden nodes is not loaded
+    if ((node.IsNotNull()) && node->IsOn(boolPropertyKey, renderer) && node->IsOn(boolPropertyKey2, renderer) &&
+        (node->GetData() != NULL) && (node->GetData()->IsEmpty() == false))
     {
       const TimeGeometry *timeGeometry = node->GetData()->GetUpdatedTimeGeometry();
 
@@ -432,8 +438,9 @@ mitk::BoundingBox::Pointer mitk::DataStorage::ComputeBoundingBox(const char *boo
   for (SetOfObjects::ConstIterator it = all->Begin(); it != all->End(); ++it)
   {
     DataNode::Pointer node = it->Value();
-    if ((node.IsNotNull()) && (node->GetData() != NULL) && (node->GetData()->IsEmpty() == false) &&
-        node->IsOn(boolPropertyKey, renderer) && node->IsOn(boolPropertyKey2, renderer))
+    // the properties are checked first, so that the data of hidden nodes is not loaded
+    if ((node.IsNotNull()) && node->IsOn(boolPropertyKey, renderer) && node->IsOn(boolPropertyKey2, renderer) &&
+        (node->GetData() != NULL) && (node->GetData()->IsEmpty() == false))
     {
       const TimeGeometry *geometry = node->GetData()->GetUpdatedTimeGeometry();
       if (geometry != NULL)
@@ -485,8 +492,9 @@ mitk::TimeBounds mitk::DataStorage::ComputeTimeBounds(const char *boolPropertyKe
   for (SetOfObjects::ConstIterator it = all->Begin(); it != all->End(); ++it)
   {
     DataNode::Pointer node = it->Value();
-    if ((node.IsNotNull()) && (node->GetData() != NULL) && (node->GetData()->IsEmpty() == false) &&
-        node->IsOn(boolPropertyKey, renderer) && node->IsOn(boolPropertyKey2, renderer))
+    // the properties are checked first, so that the data of hidden nodes is not loaded
+    if ((node.IsNotNull()) && node->IsOn(boolPropertyKey, renderer) && node->IsOn(boolPropertyKey2, renderer) &&
+        (node->GetData() != NULL) && (node->GetData()->IsEmpty() == false))
     {
       const TimeGeometry *geometry = node->GetData()->GetUpdatedTimeGeometry();
       if (geometry != NULL)
@@ -30,6 +30,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkMutexLockHolder.h>
 
 // Other
+#include <algorithm>
 #include <cmath>
 
 #define FILL_C_ARRAY(_arr, _size, _value)                                                                              \
@@ -102,6 +103,39 @@ mitk::Image::~Image()
   delete m_ImageStatistics;
 }
 
+void mitk::Image::Modified() const
+{
+  Superclass::Modified();
+  m_AllTimeStepsModifiedTime.Modified();
+}
+
+void mitk::Image::TimeStepModified(unsigned int t) const
+{
+  // the time stamps are only allocated by Initialize(), so that several threads may mark their time steps
+  if (t >= m_TimeStepModifiedTimes.size())
+  {
+    this->Modified();
+    return;
+  }
+
+  // bypasses Modified() of this class to keep the time stamps of the other time steps
+  Superclass::Modified();
+  m_TimeStepModifiedTimes[t].Modified();
+}
+
+itk::ModifiedTimeType mitk::Image::GetTimeStepMTime(unsigned int t) const
+{
+  // BaseData::GetMTime() calls Modified() if the geometry has changed
+  this->GetMTime();
+
+  itk::ModifiedTimeType time = m_AllTimeStepsModifiedTime.GetMTime();
+  if (t < m_TimeStepModifiedTimes.size())
+  {
+    time = std::max(time, m_TimeStepModifiedTimes[t].GetMTime());
+  }
+  return time;
+}
+
 const mitk::PixelType mitk::Image::GetPixelType(int n) const
 {
   return this->m_ImageDescriptor->GetChannelTypeById(n);
@@ -701,8 +735,8 @@ bool mitk::Image::SetImportSlice(void *data, int s, int t, int n, ImportMemoryMa
     if (sl->GetData() != data)
       std::memcpy(sl->GetData(), data, m_OffsetTable[2] * (ptypeSize));
     sl->Modified();
-    // we have changed the data: call Modified()!
-    Modified();
+    // we have changed the data of time step t: call TimeStepModified()!
+    TimeStepModified(t);
   }
   else
   {
@@ -737,8 +771,8 @@ bool mitk::Image::SetImportVolume(void *data, int t, int n, ImportMemoryManageme
       std::memcpy(vol->GetData(), data, m_OffsetTable[3] * (ptypeSize));
     vol->Modified();
     vol->SetComplete(true);
-    // we have changed the data: call Modified()!
-    Modified();
+    // we have changed the data of time step t: call TimeStepModified()!
+    TimeStepModified(t);
   }
   else
   {
@@ -908,6 +942,8 @@ void mitk::Image::Initialize(const mitk::PixelType &type,
 
   m_Slices.assign(GetNumberOfChannels() * m_Dimensions[3] * m_Dimensions[2], dnull);
 
+  m_TimeStepModifiedTimes.assign(m_Dimensions[3], itk::TimeStamp());
+
   ComputeOffsetTable();
 
   Initialize();
@@ -179,6 +179,7 @@ mitk::ImageDataItem::ImageDataItem(const ImageDataItem &other)
     m_Offset(other.m_Offset),
     m_IsComplete(other.m_IsComplete),
     m_Size(other.m_Size),
+    m_DataOwner(other.m_DataOwner),
     m_Parent(other.m_Parent),
     m_Dimension(other.m_Dimension),
     m_Timestep(other.m_Timestep)
@@ -28,6 +28,7 @@ mitk::ImageStatisticsHolder::ImageStatisticsHolder(mitk::Image *image)
   m_ScalarMax.resize(1, itk::NumericTraits<ScalarType>::NonpositiveMin());
   m_Scalar2ndMin.resize(1, itk::NumericTraits<ScalarType>::max());
   m_Scalar2ndMax.resize(1, itk::NumericTraits<ScalarType>::NonpositiveMin());
+  m_TimeStepRecomputeTimeStamps.resize(1);
 
   mitk::HistogramGenerator::Pointer generator = mitk::HistogramGenerator::New();
   m_HistogramGeneratorObject = generator;
@@ -48,6 +49,20 @@ mitk::ImageStatisticsHolder::~ImageStatisticsHolder()
 const mitk::ImageStatisticsHolder::HistogramType *mitk::ImageStatisticsHolder::GetScalarHistogram(
   int t, unsigned int /*component*/)
 {
+  if (!m_Image->IsValidTimeStep(t))
+    return nullptr;
+
+  if (static_cast<unsigned int>(t) >= m_ScalarHistograms.size())
+  {
+    m_ScalarHistograms.resize(t + 1);
+    m_ScalarHistogramTimeStamps.resize(t + 1);
+  }
+
+  // histogram of this time step still valid?
+  if (m_ScalarHistograms[t].IsNotNull() &&
+      m_Image->GetTimeStepMTime(t) <= m_ScalarHistogramTimeStamps[t].GetMTime())
+    return m_ScalarHistograms[t];
+
   mitk::ImageTimeSelector *timeSelector = this->GetTimeSelector();
   if (timeSelector != nullptr)
   {
@@ -58,7 +73,11 @@ const mitk::ImageStatisticsHolder::HistogramType *mitk::ImageStatisticsHolder::G
       static_cast<mitk::HistogramGenerator *>(m_HistogramGeneratorObject.GetPointer());
     generator->SetImage(timeSelector->GetOutput());
     generator->ComputeHistogram();
-    return static_cast<const mitk::ImageStatisticsHolder::HistogramType *>(generator->GetHistogram());
+
+    // the generator creates a new histogram for every computation, the cached one stays untouched
+    m_ScalarHistograms[t] = generator->GetHistogram();
+    m_ScalarHistogramTimeStamps[t].Modified();
+    return m_ScalarHistograms[t];
   }
   return nullptr;
 }
@@ -98,6 +117,7 @@ void mitk::ImageStatisticsHolder::Expand(unsigned int timeSteps)
     m_Scalar2ndMax.resize(timeSteps, itk::NumericTraits<ScalarType>::NonpositiveMin());
     m_CountOfMinValuedVoxels.resize(timeSteps, 0);
     m_CountOfMaxValuedVoxels.resize(timeSteps, 0);
+    m_TimeStepRecomputeTimeStamps.resize(timeSteps);
   }
 }
 
@@ -109,100 +129,218 @@ void mitk::ImageStatisticsHolder::ResetImageStatistics()
   m_Scalar2ndMax.assign(1, itk::NumericTraits<ScalarType>::NonpositiveMin());
   m_CountOfMinValuedVoxels.assign(1, 0);
   m_CountOfMaxValuedVoxels.assign(1, 0);
+  m_TimeStepRecomputeTimeStamps.assign(1, itk::TimeStamp());
+}
+
+void mitk::ImageStatisticsHolder::ResetImageStatistics(unsigned int t)
+{
+  if (t >= m_ScalarMin.size())
+    return;
+
+  m_ScalarMin[t] = itk::NumericTraits<ScalarType>::max();
+  m_ScalarMax[t] = itk::NumericTraits<ScalarType>::NonpositiveMin();
+  m_Scalar2ndMin[t] = itk::NumericTraits<ScalarType>::max();
+  m_Scalar2ndMax[t] = itk::NumericTraits<ScalarType>::NonpositiveMin();
+  m_CountOfMinValuedVoxels[t] = 0;
+  m_CountOfMaxValuedVoxels[t] = 0;
 }
 
 #include "mitkImageAccessByItk.h"
 
-//#define BOUNDINGOBJECT_IGNORE
+#include <algorithm>
 
-template <typename ItkImageType>
-void mitk::_ComputeExtremaInItkImage(const ItkImageType *itkImage, mitk::ImageStatisticsHolder *statisticsHolder, int t)
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
 {
-  typename ItkImageType::RegionType region;
-  region = itkImage->GetBufferedRegion();
-  if (region.Crop(itkImage->GetRequestedRegion()) == false)
-    return;
-  if (region != itkImage->GetRequestedRegion())
-    return;
+  // smaller buffers are not worth the threading overhead
+  const std::size_t MinimumNumberOfValuesPerThread = 1 << 16;
+
+  template <typename TValue>
+  struct Extrema
+  {
+    TValue min;
+    TValue max;
+    TValue secondMin;
+    TValue secondMax;
+    unsigned int countOfMin;
+    unsigned int countOfMax;
+  };
+
+  // Extrema of every step-th value of a block. Two passes with branch free loop bodies instead of one pass with data
+  // dependent branches, so the compiler can vectorize both loops. VStride is 0 if the stride is only known at runtime.
+  template <typename TValue, std::size_t VStride>
+  void ComputeBlockExtrema(const TValue *values, std::size_t numberOfValues, std::size_t stride, Extrema<TValue> &extrema)
+  {
+    const std::size_t step = VStride > 0 ? VStride : stride;
 
-  itk::ImageRegionConstIterator<ItkImageType> it(itkImage, region);
-  typedef typename ItkImageType::PixelType TPixel;
-  TPixel value = 0;
+    // NaN values fail every comparison and are thus ignored, like in the former iterator based loop
+    TValue min = itk::NumericTraits<TValue>::max();
+    TValue max = itk::NumericTraits<TValue>::NonpositiveMin();
+    for (std::size_t i = 0; i < numberOfValues; ++i)
+    {
+      const TValue value = values[i * step];
+      min = value < min ? value : min;
+      max = value > max ? value : max;
+    }
 
-  if (statisticsHolder == nullptr || !statisticsHolder->IsValidTimeStep(t))
-    return;
-  statisticsHolder->Expand(t + 1); // make sure we have initialized all arrays
-  statisticsHolder->m_CountOfMinValuedVoxels[t] = 0;
-  statisticsHolder->m_CountOfMaxValuedVoxels[t] = 0;
+    TValue secondMin = itk::NumericTraits<TValue>::max();
+    TValue secondMax = itk::NumericTraits<TValue>::NonpositiveMin();
+    unsigned int countOfMin = 0;
+    unsigned int countOfMax = 0;
+    for (std::size_t i = 0; i < numberOfValues; ++i)
+    {
+      const TValue value = values[i * step];
+      countOfMin += value == min;
+      countOfMax += value == max;
+      secondMin = (value > min && value < secondMin) ? value : secondMin;
+      secondMax = (value < max && value > secondMax) ? value : secondMax;
+    }
 
-  statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t] = itk::NumericTraits<ScalarType>::max();
-  statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t] =
-    itk::NumericTraits<ScalarType>::NonpositiveMin();
+    extrema.min = min;
+    extrema.max = max;
+    extrema.secondMin = secondMin;
+    extrema.secondMax = secondMax;
+    extrema.countOfMin = countOfMin;
+    extrema.countOfMax = countOfMax;
+  }
 
-  while (!it.IsAtEnd())
+  // Extrema of every stride-th value of the buffer, computed in one block per thread.
+  // Returns false if the buffer contains no comparable value.
+  template <typename TValue>
+  bool ComputeExtrema(const TValue *values, std::size_t numberOfValues, std::size_t stride, Extrema<TValue> &extrema)
   {
-    value = it.Get();
-//  if ( (value > mitkImage->m_ScalarMin) && (value < mitkImage->m_Scalar2ndMin) )        mitkImage->m_Scalar2ndMin =
-//  value;
-//  else if ( (value < mitkImage->m_ScalarMax) && (value > mitkImage->m_Scalar2ndMax) )   mitkImage->m_Scalar2ndMax =
-//  value;
-//  else if (value > mitkImage->m_ScalarMax)                                              mitkImage->m_ScalarMax =
-//  value;
-//  else if (value < mitkImage->m_ScalarMin)                                              mitkImage->m_ScalarMin =
-//  value;
-
-// if numbers start with 2ndMin or 2ndMax and never have that value again, the previous above logic failed
-#ifdef BOUNDINGOBJECT_IGNORE
-    if (value > -32765)
-    {
+    int numberOfBlocks = 1;
+#ifdef _OPENMP
+    numberOfBlocks = static_cast<int>(std::max<std::size_t>(
+      1, std::min<std::size_t>(omp_get_max_threads(), numberOfValues / MinimumNumberOfValuesPerThread)));
 #endif
-      // update min
-      if (value < statisticsHolder->m_ScalarMin[t])
+
+    std::vector<Extrema<TValue>> blocks(numberOfBlocks);
+
+#pragma omp parallel for num_threads(numberOfBlocks)
+    for (int b = 0; b < numberOfBlocks; ++b)
+    {
+      const std::size_t begin = numberOfValues * b / numberOfBlocks;
+      const std::size_t end = numberOfValues * (b + 1) / numberOfBlocks;
+
+      if (stride == 1)
+        ComputeBlockExtrema<TValue, 1>(values + begin, end - begin, stride, blocks[b]);
+      else
+        ComputeBlockExtrema<TValue, 0>(values + begin * stride, end - begin, stride, blocks[b]);
+    }
+
+    // merge the blocks: the minimum of a block that is larger than the overall minimum is a candidate for the
+    // second smallest value, otherwise the second smallest value of the block is. Same for the maximum.
+    bool found = false;
+    for (const auto &block : blocks)
+    {
+      // blocks without comparable values (only NaN) have no occurrence of their minimum
+      if (block.countOfMin == 0)
+        continue;
+
+      if (!found)
       {
-        statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t];
-        statisticsHolder->m_ScalarMin[t] = value;
-        statisticsHolder->m_CountOfMinValuedVoxels[t] = 1;
+        extrema = block;
+        found = true;
+        continue;
       }
-      else if (value == statisticsHolder->m_ScalarMin[t])
+
+      if (block.min < extrema.min)
+      {
+        extrema.secondMin = std::min(extrema.min, block.secondMin);
+        extrema.min = block.min;
+        extrema.countOfMin = block.countOfMin;
+      }
+      else if (block.min == extrema.min)
       {
-        ++statisticsHolder->m_CountOfMinValuedVoxels[t];
+        extrema.secondMin = std::min(extrema.secondMin, block.secondMin);
+        extrema.countOfMin += block.countOfMin;
       }
-      else if (value < statisticsHolder->m_Scalar2ndMin[t])
+      else
       {
-        statisticsHolder->m_Scalar2ndMin[t] = value;
+        extrema.secondMin = std::min(extrema.secondMin, block.min);
       }
 
-      // update max
-      if (value > statisticsHolder->m_ScalarMax[t])
+      if (block.max > extrema.max)
       {
-        statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t];
-        statisticsHolder->m_ScalarMax[t] = value;
-        statisticsHolder->m_CountOfMaxValuedVoxels[t] = 1;
+        extrema.secondMax = std::max(extrema.max, block.secondMax);
+        extrema.max = block.max;
+        extrema.countOfMax = block.countOfMax;
       }
-      else if (value == statisticsHolder->m_ScalarMax[t])
+      else if (block.max == extrema.max)
       {
-        ++statisticsHolder->m_CountOfMaxValuedVoxels[t];
+        extrema.secondMax = std::max(extrema.secondMax, block.secondMax);
+        extrema.countOfMax += block.countOfMax;
       }
-      else if (value > statisticsHolder->m_Scalar2ndMax[t])
+      else
       {
-        statisticsHolder->m_Scalar2ndMax[t] = value;
+        extrema.secondMax = std::max(extrema.secondMax, block.max);
       }
-#ifdef BOUNDINGOBJECT_IGNORE
     }
-#endif
 
-    ++it;
+    return found;
+  }
+
+  template <typename TValue>
+  void StoreExtrema(const Extrema<TValue> &extrema,
+                    mitk::ScalarType &min,
+                    mitk::ScalarType &max,
+                    mitk::ScalarType &secondMin,
+                    mitk::ScalarType &secondMax,
+                    unsigned int &countOfMin,
+                    unsigned int &countOfMax)
+  {
+    min = extrema.min;
+    max = extrema.max;
+    secondMin = extrema.secondMin;
+    secondMax = extrema.secondMax;
+    countOfMin = extrema.countOfMin;
+    countOfMax = extrema.countOfMax;
+
+    //// guard for wrong 2dMin/Max on single constant value images
+    if (max == min)
+    {
+      secondMax = secondMin = max;
+    }
   }
+}
+
+template <typename ItkImageType>
+void mitk::_ComputeExtremaInItkImage(const ItkImageType *itkImage, mitk::ImageStatisticsHolder *statisticsHolder, int t)
+{
+  typename ItkImageType::RegionType region;
+  region = itkImage->GetBufferedRegion();
+  if (region.Crop(itkImage->GetRequestedRegion()) == false)
+    return;
+  if (region != itkImage->GetRequestedRegion())
+    return;
+  // the whole buffer is processed at once
+  if (region != itkImage->GetBufferedRegion())
+    return;
+
+  if (statisticsHolder == nullptr || !statisticsHolder->IsValidTimeStep(t))
+    return;
+  statisticsHolder->Expand(t + 1); // make sure we have initialized all arrays
+  statisticsHolder->ResetImageStatistics(t);
 
-  //// guard for wrong 2dMin/Max on single constant value images
-  if (statisticsHolder->m_ScalarMax[t] == statisticsHolder->m_ScalarMin[t])
+  typedef typename ItkImageType::InternalPixelType TValue;
+  Extrema<TValue> extrema;
+  if (ComputeExtrema<TValue>(itkImage->GetBufferPointer(), region.GetNumberOfPixels(), 1, extrema))
   {
-    statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMax[t];
+    StoreExtrema(extrema,
+                 statisticsHolder->m_ScalarMin[t],
+                 statisticsHolder->m_ScalarMax[t],
+                 statisticsHolder->m_Scalar2ndMin[t],
+                 statisticsHolder->m_Scalar2ndMax[t],
+                 statisticsHolder->m_CountOfMinValuedVoxels[t],
+                 statisticsHolder->m_CountOfMaxValuedVoxels[t]);
   }
+
+  statisticsHolder->m_TimeStepRecomputeTimeStamps[t].Modified();
   statisticsHolder->m_LastRecomputeTimeStamp.Modified();
-  // MITK_DEBUG <<"extrema "<<itk::NumericTraits<TPixel>::NonpositiveMin()<<" "<<mitkImage->m_ScalarMin<<"
-  // "<<mitkImage->m_Scalar2ndMin<<" "<<mitkImage->m_Scalar2ndMax<<" "<<mitkImage->m_ScalarMax<<"
-  // "<<itk::NumericTraits<TPixel>::max();
 }
 
 template <typename ItkImageType>
@@ -217,83 +355,37 @@ void mitk::_ComputeExtremaInItkVectorImage(const ItkImageType *itkImage,
     return;
   if (region != itkImage->GetRequestedRegion())
     return;
-
-  itk::ImageRegionConstIterator<ItkImageType> it(itkImage, region);
+  // the whole buffer is processed at once
+  if (region != itkImage->GetBufferedRegion())
+    return;
 
   if (statisticsHolder == nullptr || !statisticsHolder->IsValidTimeStep(t))
     return;
-  statisticsHolder->Expand(t + 1); // make sure we have initialized all arrays
-  statisticsHolder->m_CountOfMinValuedVoxels[t] = 0;
-  statisticsHolder->m_CountOfMaxValuedVoxels[t] = 0;
-
-  statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t] = itk::NumericTraits<ScalarType>::max();
-  statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t] =
-    itk::NumericTraits<ScalarType>::NonpositiveMin();
 
-  while (!it.IsAtEnd())
-  {
-    double value = it.Get()[component];
-//  if ( (value > mitkImage->m_ScalarMin) && (value < mitkImage->m_Scalar2ndMin) )        mitkImage->m_Scalar2ndMin =
-//  value;
-//  else if ( (value < mitkImage->m_ScalarMax) && (value > mitkImage->m_Scalar2ndMax) )   mitkImage->m_Scalar2ndMax =
-//  value;
-//  else if (value > mitkImage->m_ScalarMax)                                              mitkImage->m_ScalarMax =
-//  value;
-//  else if (value < mitkImage->m_ScalarMin)                                              mitkImage->m_ScalarMin =
-//  value;
-
-// if numbers start with 2ndMin or 2ndMax and never have that value again, the previous above logic failed
-#ifdef BOUNDINGOBJECT_IGNORE
-    if (value > -32765)
-    {
-#endif
-      // update min
-      if (value < statisticsHolder->m_ScalarMin[t])
-      {
-        statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t];
-        statisticsHolder->m_ScalarMin[t] = value;
-        statisticsHolder->m_CountOfMinValuedVoxels[t] = 1;
-      }
-      else if (value == statisticsHolder->m_ScalarMin[t])
-      {
-        ++statisticsHolder->m_CountOfMinValuedVoxels[t];
-      }
-      else if (value < statisticsHolder->m_Scalar2ndMin[t])
-      {
-        statisticsHolder->m_Scalar2ndMin[t] = value;
-      }
-
-      // update max
-      if (value > statisticsHolder->m_ScalarMax[t])
-      {
-        statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t];
-        statisticsHolder->m_ScalarMax[t] = value;
-        statisticsHolder->m_CountOfMaxValuedVoxels[t] = 1;
-      }
-      else if (value == statisticsHolder->m_ScalarMax[t])
-      {
-        ++statisticsHolder->m_CountOfMaxValuedVoxels[t];
-      }
-      else if (value > statisticsHolder->m_Scalar2ndMax[t])
-      {
-        statisticsHolder->m_Scalar2ndMax[t] = value;
-      }
-#ifdef BOUNDINGOBJECT_IGNORE
-    }
-#endif
+  const std::size_t numberOfComponents = itkImage->GetNumberOfComponentsPerPixel();
+  if (component >= numberOfComponents)
+    return;
 
-    ++it;
-  }
+  statisticsHolder->Expand(t + 1); // make sure we have initialized all arrays
+  statisticsHolder->ResetImageStatistics(t);
 
-  //// guard for wrong 2dMin/Max on single constant value images
-  if (statisticsHolder->m_ScalarMax[t] == statisticsHolder->m_ScalarMin[t])
+  // the components of all pixels are interleaved in the buffer of a vector image
+  typedef typename ItkImageType::InternalPixelType TValue;
+  Extrema<TValue> extrema;
+  if (ComputeExtrema<TValue>(
+        itkImage->GetBufferPointer() + component, region.GetNumberOfPixels(), numberOfComponents, extrema))
   {
-    statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMax[t];
+    StoreExtrema(extrema,
+                 statisticsHolder->m_ScalarMin[t],
+                 statisticsHolder->m_ScalarMax[t],
+                 statisticsHolder->m_Scalar2ndMin[t],
+                 statisticsHolder->m_Scalar2ndMax[t],
+                 statisticsHolder->m_CountOfMinValuedVoxels[t],
+                 statisticsHolder->m_CountOfMaxValuedVoxels[t]);
   }
+
+  statisticsHolder->m_TimeStepRecomputeTimeStamps[t].Modified();
   statisticsHolder->m_LastRecomputeTimeStamp.Modified();
-  // MITK_DEBUG <<"extrema "<<itk::NumericTraits<TPixel>::NonpositiveMin()<<" "<<mitkImage->m_ScalarMin<<"
-  // "<<mitkImage->m_Scalar2ndMin<<" "<<mitkImage->m_Scalar2ndMax<<" "<<mitkImage->m_ScalarMax<<"
-  // "<<itk::NumericTraits<TPixel>::max();
 }
 
 void mitk::ImageStatisticsHolder::ComputeImageStatistics(int t, unsigned int component)
@@ -302,12 +394,12 @@ void mitk::ImageStatisticsHolder::ComputeImageStatistics(int t, unsigned int com
   if (!m_Image->IsValidTimeStep(t))
     return;
 
-  // image modified?
-  if (this->m_Image->GetMTime() > m_LastRecomputeTimeStamp.GetMTime())
-    this->ResetImageStatistics();
-
   Expand(t + 1);
 
+  // time step modified? The values of the other time steps stay valid.
+  if (m_Image->GetTimeStepMTime(t) > m_TimeStepRecomputeTimeStamps[t].GetMTime())
+    this->ResetImageStatistics(t);
+
   // do we have valid information already?
   if (m_ScalarMin[t] != itk::NumericTraits<ScalarType>::max() ||
       m_Scalar2ndMin[t] != itk::NumericTraits<ScalarType>::max())
@@ -349,6 +441,7 @@ void mitk::ImageStatisticsHolder::ComputeImageStatistics(int t, unsigned int com
     m_ScalarMax[t] = 255;
     m_Scalar2ndMin[t] = 0;
     m_Scalar2ndMax[t] = 255;
+    m_TimeStepRecomputeTimeStamps[t].Modified();
   }
 }
 
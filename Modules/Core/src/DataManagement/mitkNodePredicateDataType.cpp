@@ -36,10 +36,11 @@ bool mitk::NodePredicateDataType::CheckNode(const mitk::DataNode *node) const
   if (node == nullptr)
     throw std::invalid_argument("NodePredicateDataType: invalid node");
 
-  mitk::BaseData *data = node->GetData();
+  // the data type is known without loading data that is read on demand
+  const std::string dataType = node->GetDataType();
 
-  if (data == nullptr)
+  if (dataType.empty())
     return false; // or should we check if m_ValidDataType == "NULL" so that nodes without data can be requested?
 
-  return (m_ValidDataType.compare(data->GetNameOfClass()) == 0); // return true if data type matches
+  return (m_ValidDataType.compare(dataType) == 0); // return true if data type matches
 }
@@ -20,12 +20,52 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkSimpleFastMutexLock.h"
 #include "mitkDataNode.h"
 #include "mitkGroupTagProperty.h"
+#include "mitkNodePredicateAnd.h"
 #include "mitkNodePredicateBase.h"
+#include "mitkNodePredicateDataType.h"
+#include "mitkNodePredicateNot.h"
+#include "mitkNodePredicateOr.h"
 #include "mitkNodePredicateProperty.h"
 #include "mitkProperties.h"
 
+#include <algorithm>
+#include <iterator>
+#include <typeinfo>
+
+namespace
+{
+  // maximum number of cached composite condition results
+  const size_t MaximumCachedSubsets = 64;
+
+  std::string GetIndexedPropertyValue(const mitk::BaseProperty *property)
+  {
+    return std::string(property->GetNameOfClass()) + '\n' + property->GetValueAsString();
+  }
+
+  // latest modification of a condition, its child conditions and the properties it compares to
+  unsigned long GetConditionMTime(const mitk::NodePredicateBase *condition)
+  {
+    unsigned long mTime = condition->GetMTime();
+
+    if (auto propertyCondition = dynamic_cast<const mitk::NodePredicateProperty *>(condition))
+    {
+      if (propertyCondition->GetValidProperty() != nullptr)
+        mTime = std::max(mTime, propertyCondition->GetValidProperty()->GetMTime());
+    }
+    else if (auto compositeCondition = dynamic_cast<const mitk::NodePredicateCompositeBase *>(condition))
+    {
+      mitk::NodePredicateCompositeBase::ChildPredicates children = compositeCondition->GetPredicates();
+      for (auto it = children.cbegin(); it != children.cend(); ++it)
+        mTime = std::max(mTime, GetConditionMTime(*it));
+    }
+    return mTime;
+  }
+}
+
 mitk::StandaloneDataStorage::StandaloneDataStorage() : mitk::DataStorage()
 {
+  m_PropertyModifiedCommand = itk::MemberCommand<StandaloneDataStorage>::New();
+  m_PropertyModifiedCommand->SetCallbackFunction(this, &StandaloneDataStorage::OnIndexedPropertyModified);
 }
 
 mitk::StandaloneDataStorage::~StandaloneDataStorage()
@@ -34,6 +74,12 @@ mitk::StandaloneDataStorage::~StandaloneDataStorage()
   {
     this->RemoveListeners(it->first);
   }
+
+  // the properties might outlive the data storage
+  for (auto it = m_ObservedProperties.begin(); it != m_ObservedProperties.end(); ++it)
+  {
+    it->second.property->RemoveObserver(it->second.observerTag);
+  }
 }
 
 bool mitk::StandaloneDataStorage::IsInitialized() const
@@ -85,6 +131,9 @@ void mitk::StandaloneDataStorage::Add(mitk::DataNode *node, const mitk::DataStor
 
     // register for ITK changed events
     this->AddListeners(node);
+
+    this->AddToIndices(node);
+    m_CachedSubsets.clear();
   }
 
   /* Notify observers */
@@ -116,6 +165,10 @@ void mitk::StandaloneDataStorage::Remove(const mitk::DataNode *node)
     /* remove node from both relation adjacency lists */
     this->RemoveFromRelation(node, m_SourceNodes);
     this->RemoveFromRelation(node, m_DerivedNodes);
+
+    m_ModifiedNodes.erase(node);
+    this->RemoveFromIndices(node);
+    m_CachedSubsets.clear();
   }
 }
 
@@ -244,15 +297,345 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSources(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectSources) const
 {
-  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
-  return this->GetRelations(node, m_SourceNodes, condition, onlyDirectSources);
+  SetOfObjects::ConstPointer sources;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    sources = this->GetRelations(node, m_SourceNodes, nullptr, onlyDirectSources);
+  }
+  // the condition is checked without the lock, since it might load the data of a node (see DataNode::SetDataLoader())
+  return condition != nullptr ? this->FilterSetOfObjects(sources, condition) : sources;
 }
 
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetDerivations(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectDerivations) const
 {
+  SetOfObjects::ConstPointer derivations;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    derivations = this->GetRelations(node, m_DerivedNodes, nullptr, onlyDirectDerivations);
+  }
+  return condition != nullptr ? this->FilterSetOfObjects(derivations, condition) : derivations;
+}
+
+mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSubset(
+  const NodePredicateBase *condition) const
+{
+  if (condition == nullptr || !IsIndexedCondition(condition))
+    return Superclass::GetSubset(condition);
+
+  // composite conditions are cached; evaluating a single property or data type condition is as cheap as the lookup
+  const bool cacheResult = dynamic_cast<const NodePredicateCompositeBase *>(condition) != nullptr;
+  const unsigned long conditionMTime = cacheResult ? GetConditionMTime(condition) : 0;
+
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+  this->UpdateModifiedNodes();
+
+  if (cacheResult)
+  {
+    auto cached = m_CachedSubsets.find(condition);
+    if (cached != m_CachedSubsets.end() && cached->second.conditionMTime == conditionMTime)
+      return cached->second.result;
+  }
+
+  NodeSet nodes;
+  this->EvaluateIndexedCondition(condition, nodes);
+
+  // NodeSet is ordered by node address like m_SourceNodes, so the result has the same order as GetAll()
+  mitk::DataStorage::SetOfObjects::Pointer result = mitk::DataStorage::SetOfObjects::New();
+  for (auto it = nodes.cbegin(); it != nodes.cend(); ++it)
+    result->InsertElement(result->Size(), const_cast<mitk::DataNode *>(*it));
+
+  if (cacheResult)
+  {
+    if (m_CachedSubsets.size() >= MaximumCachedSubsets)
+      m_CachedSubsets.clear();
+
+    CachedSubset &cached = m_CachedSubsets[condition];
+    cached.condition = condition;
+    cached.conditionMTime = conditionMTime;
+    cached.propertyKeys.clear();
+    cached.dependsOnDataType = false;
+    GetConditionDependencies(condition, cached.propertyKeys, cached.dependsOnDataType);
+    cached.result = result.GetPointer();
+  }
+
+  return SetOfObjects::ConstPointer(result);
+}
+
+bool mitk::StandaloneDataStorage::IsIndexedCondition(const NodePredicateBase *condition)
+{
+  // exact types only, subclasses may override CheckNode()
+  const std::type_info &type = typeid(*condition);
+
+  if (type == typeid(NodePredicateProperty))
+  {
+    auto propertyCondition = static_cast<const NodePredicateProperty *>(condition);
+    return propertyCondition->GetRenderer() == nullptr && !propertyCondition->GetValidPropertyName().empty();
+  }
+
+  if (type == typeid(NodePredicateDataType))
+    return true;
+
+  if (type == typeid(NodePredicateAnd) || type == typeid(NodePredicateOr) || type == typeid(NodePredicateNot))
+  {
+    NodePredicateCompositeBase::ChildPredicates children =
+      static_cast<const NodePredicateCompositeBase *>(condition)->GetPredicates();
+    if (children.empty())
+      return false;
+
+    for (auto it = children.cbegin(); it != children.cend(); ++it)
+      if (!IsIndexedCondition(*it))
+        return false;
+    return true;
+  }
+
+  return false;
+}
+
+void mitk::StandaloneDataStorage::GetConditionDependencies(const NodePredicateBase *condition,
+                                                           std::set<std::string> &propertyKeys,
+                                                           bool &dependsOnDataType)
+{
+  if (auto propertyCondition = dynamic_cast<const NodePredicateProperty *>(condition))
+  {
+    propertyKeys.insert(propertyCondition->GetValidPropertyName());
+  }
+  else if (dynamic_cast<const NodePredicateDataType *>(condition) != nullptr)
+  {
+    dependsOnDataType = true;
+  }
+  else
+  {
+    NodePredicateCompositeBase::ChildPredicates children =
+      static_cast<const NodePredicateCompositeBase *>(condition)->GetPredicates();
+    for (auto it = children.cbegin(); it != children.cend(); ++it)
+      GetConditionDependencies(*it, propertyKeys, dependsOnDataType);
+  }
+}
+
+void mitk::StandaloneDataStorage::EvaluateIndexedCondition(const NodePredicateBase *condition, NodeSet &result) const
+{
+  result.clear();
+
+  if (auto propertyCondition = dynamic_cast<const NodePredicateProperty *>(condition))
+  {
+    const std::string &key = propertyCondition->GetValidPropertyName();
+    if (m_PropertyIndex.find(key) == m_PropertyIndex.end())
+      this->CreatePropertyIndex(key);
+    const std::map<std::string, NodeSet> &values = m_PropertyIndex[key];
+
+    const BaseProperty *validProperty = propertyCondition->GetValidProperty();
+    if (validProperty == nullptr)
+    {
+      // any node that has the property
+      for (auto it = values.cbegin(); it != values.cend(); ++it)
+        result.insert(it->second.cbegin(), it->second.cend());
+      return;
+    }
+
+    auto candidates = values.find(GetIndexedPropertyValue(validProperty));
+    if (candidates == values.end())
+      return;
+
+    // the value string only preselects, equality is decided by the condition itself
+    for (auto it = candidates->second.cbegin(); it != candidates->second.cend(); ++it)
+      if (condition->CheckNode(*it))
+        result.insert(result.end(), *it);
+    return;
+  }
+
+  if (auto dataTypeCondition = dynamic_cast<const NodePredicateDataType *>(condition))
+  {
+    auto nodes = m_DataTypeIndex.find(dataTypeCondition->GetValidDataType());
+    if (nodes != m_DataTypeIndex.end())
+      result = nodes->second;
+    return;
+  }
+
+  NodePredicateCompositeBase::ChildPredicates children =
+    static_cast<const NodePredicateCompositeBase *>(condition)->GetPredicates();
+  NodeSet childResult;
+
+  if (dynamic_cast<const NodePredicateNot *>(condition) != nullptr)
+  {
+    this->EvaluateIndexedCondition(children.front(), childResult);
+    for (auto it = m_IndexedNodeValues.cbegin(); it != m_IndexedNodeValues.cend(); ++it)
+      if (childResult.find(it->first) == childResult.end())
+        result.insert(result.end(), it->first);
+    return;
+  }
+
+  const bool conjunction = dynamic_cast<const NodePredicateAnd *>(condition) != nullptr;
+  auto it = children.cbegin();
+  this->EvaluateIndexedCondition(*it, result);
+  for (++it; it != children.cend(); ++it)
+  {
+    if (conjunction && result.empty())
+      return;
+
+    this->EvaluateIndexedCondition(*it, childResult);
+    NodeSet combined;
+    if (conjunction)
+      std::set_intersection(result.cbegin(),
+                            result.cend(),
+                            childResult.cbegin(),
+                            childResult.cend(),
+                            std::inserter(combined, combined.end()));
+    else
+      std::set_union(result.cbegin(),
+                     result.cend(),
+                     childResult.cbegin(),
+                     childResult.cend(),
+                     std::inserter(combined, combined.end()));
+    result.swap(combined);
+  }
+}
+
+void mitk::StandaloneDataStorage::AddToIndices(const mitk::DataNode *node) const
+{
+  if (node == nullptr)
+    return;
+
+  IndexedNodeValues &values = m_IndexedNodeValues[node];
+
+  // GetData() must not be called here, the data loader of the node would lock m_Mutex again
+  values.dataType = node->GetDataType();
+  if (!values.dataType.empty())
+    m_DataTypeIndex[values.dataType].insert(node);
+
+  for (auto it = m_PropertyIndex.cbegin(); it != m_PropertyIndex.cend(); ++it)
+  {
+    BaseProperty *property = node->GetProperty(it->first.c_str());
+    if (property != nullptr)
+      this->AddToPropertyIndex(node, it->first, property, values);
+  }
+}
+
+void mitk::StandaloneDataStorage::AddToPropertyIndex(const mitk::DataNode *node,
+                                                     const std::string &propertyKey,
+                                                     BaseProperty *property,
+                                                     IndexedNodeValues &values) const
+{
+  IndexedProperty &indexed = values.properties[propertyKey];
+  indexed.value = GetIndexedPropertyValue(property);
+  indexed.property = property;
+  indexed.mTime = property->GetMTime();
+  m_PropertyIndex[propertyKey][indexed.value].insert(node);
+
+  // BaseProperty::SetValue() does not modify the node, so the property itself is observed
+  ObservedProperty &observed = m_ObservedProperties[property];
+  if (observed.property.IsNull())
+  {
+    observed.property = property;
+    observed.observerTag = property->AddObserver(itk::ModifiedEvent(), m_PropertyModifiedCommand);
+  }
+  observed.nodes.insert(node);
+}
+
+void mitk::StandaloneDataStorage::RemoveFromIndices(const mitk::DataNode *node) const
+{
+  auto values = m_IndexedNodeValues.find(node);
+  if (values == m_IndexedNodeValues.end())
+    return;
+
+  if (!values->second.dataType.empty())
+  {
+    auto nodes = m_DataTypeIndex.find(values->second.dataType);
+    nodes->second.erase(node);
+    if (nodes->second.empty())
+      m_DataTypeIndex.erase(nodes);
+  }
+
+  for (auto it = values->second.properties.cbegin(); it != values->second.properties.cend(); ++it)
+  {
+    std::map<std::string, NodeSet> &propertyValues = m_PropertyIndex[it->first];
+    auto nodes = propertyValues.find(it->second.value);
+    nodes->second.erase(node);
+    if (nodes->second.empty())
+      propertyValues.erase(nodes);
+
+    auto observed = m_ObservedProperties.find(it->second.property.GetPointer());
+    observed->second.nodes.erase(node);
+    if (observed->second.nodes.empty())
+    {
+      it->second.property->RemoveObserver(observed->second.observerTag);
+      m_ObservedProperties.erase(observed);
+    }
+  }
+
+  m_IndexedNodeValues.erase(values);
+}
+
+void mitk::StandaloneDataStorage::CreatePropertyIndex(const std::string &propertyKey) const
+{
+  // the key is indexed even if no node has the property yet
+  m_PropertyIndex[propertyKey];
+
+  for (auto it = m_IndexedNodeValues.begin(); it != m_IndexedNodeValues.end(); ++it)
+  {
+    BaseProperty *property = it->first->GetProperty(propertyKey.c_str());
+    if (property != nullptr)
+      this->AddToPropertyIndex(it->first, propertyKey, property, it->second);
+  }
+}
+
+void mitk::StandaloneDataStorage::UpdateModifiedNodes() const
+{
+  for (auto node = m_ModifiedNodes.cbegin(); node != m_ModifiedNodes.cend(); ++node)
+  {
+    const IndexedNodeValues previous = m_IndexedNodeValues[*node];
+    this->RemoveFromIndices(*node);
+    this->AddToIndices(*node);
+    const IndexedNodeValues &current = m_IndexedNodeValues[*node];
+
+    // keys whose property object, value or modification time differ
+    const bool dataTypeChanged = previous.dataType != current.dataType;
+    std::set<std::string> changedKeys;
+    for (auto it = m_PropertyIndex.cbegin(); it != m_PropertyIndex.cend(); ++it)
+    {
+      auto before = previous.properties.find(it->first);
+      auto after = current.properties.find(it->first);
+      const bool hadProperty = before != previous.properties.end();
+      const bool hasProperty = after != current.properties.end();
+      if (hadProperty != hasProperty ||
+          (hasProperty && (before->second.property.GetPointer() != after->second.property.GetPointer() ||
+                           before->second.mTime != after->second.mTime || before->second.value != after->second.value)))
+        changedKeys.insert(it->first);
+    }
+
+    if (!dataTypeChanged && changedKeys.empty())
+      continue;
+
+    for (auto cached = m_CachedSubsets.begin(); cached != m_CachedSubsets.end();)
+    {
+      bool affected = dataTypeChanged && cached->second.dependsOnDataType;
+      for (auto key = changedKeys.cbegin(); !affected && key != changedKeys.cend(); ++key)
+        affected = cached->second.propertyKeys.find(*key) != cached->second.propertyKeys.end();
+
+      if (affected)
+        cached = m_CachedSubsets.erase(cached);
+      else
+        ++cached;
+    }
+  }
+  m_ModifiedNodes.clear();
+}
+
+void mitk::StandaloneDataStorage::OnNodeChanged(const mitk::DataNode *node)
+{
+  // the node is re-indexed by the next query, a node is often modified several times in a row
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+  if (m_IndexedNodeValues.find(node) != m_IndexedNodeValues.end())
+    m_ModifiedNodes.insert(node);
+}
+
+void mitk::StandaloneDataStorage::OnIndexedPropertyModified(const itk::Object *caller, const itk::EventObject &)
+{
+  // only marks the nodes, observers of the property must not be removed while it invokes them
   itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
-  return this->GetRelations(node, m_DerivedNodes, condition, onlyDirectDerivations);
+  auto observed = m_ObservedProperties.find(static_cast<const BaseProperty *>(caller));
+  if (observed != m_ObservedProperties.end())
+    m_ModifiedNodes.insert(observed->second.nodes.cbegin(), observed->second.nodes.cend());
 }
 
 void mitk::StandaloneDataStorage::PrintSelf(std::ostream &os, itk::Indent indent) const
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkFileWriterRegistry.h>
 #include <mitkIDataNodeReader.h>
 #include <mitkIMimeTypeProvider.h>
+#include <mitkItkImageIO.h>
 #include <mitkProgressBar.h>
 #include <mitkStandaloneDataStorage.h>
 #include <usGetModuleContext.h>
@@ -605,6 +606,26 @@ namespace mitk
     return image;
   }
 
+  Image::Pointer IOUtil::LoadImage(const std::string &path, const itk::ImageIORegion &region)
+  {
+    std::vector<BaseData::Pointer> data = Load(path, ItkImageIO::CreateRegionReaderOptions(region));
+    mitk::Image::Pointer image = data.empty() ? nullptr : dynamic_cast<mitk::Image *>(data.front().GetPointer());
+    if (image.IsNull())
+    {
+      mitkThrow() << path << " could not be loaded as mitk::Image";
+    }
+
+    for (unsigned int i = 0; i < region.GetImageDimension(); ++i)
+    {
+      // a size of 0 selects the remaining extent, which is not known here
+      if (region.GetSize(i) != 0 && image->GetDimension(i) != region.GetSize(i))
+      {
+        mitkThrow() << "The reader for " << path << " does not support reading image regions";
+      }
+    }
+    return image;
+  }
+
   Surface::Pointer IOUtil::LoadSurface(const std::string &path)
   {
     BaseData::Pointer baseData = Impl::LoadBaseDataFromFile(path);
@@ -24,14 +24,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 #include <mitkImageReadAccessor.h>
 #include <mitkLocaleSwitch.h>
+#include <mitkMemoryMappedFile.h>
 
+#include <itkByteSwapper.h>
 #include <itkImage.h>
 #include <itkImageFileReader.h>
 #include <itkImageIOFactory.h>
 #include <itkImageIORegion.h>
 #include <itkMetaDataObject.h>
 
+#include <itksys/SystemTools.hxx>
+
 #include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 namespace mitk
 {
@@ -40,6 +47,46 @@ namespace mitk
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TYPE = "org_mitk_timegeometry_type";
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TIMEPOINTS = "org_mitk_timegeometry_timepoints";
 
+  std::string ItkImageIO::OPTION_MEMORY_MAPPING()
+  {
+    static std::string s = "Memory map uncompressed data";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_REGION_INDEX()
+  {
+    static std::string s = "Region index";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_REGION_SIZE()
+  {
+    static std::string s = "Region size";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_TIME_STEP()
+  {
+    static std::string s = "Time step";
+    return s;
+  }
+
+  IFileReader::Options ItkImageIO::CreateRegionReaderOptions(const itk::ImageIORegion &region)
+  {
+    std::ostringstream index;
+    std::ostringstream size;
+    for (unsigned int i = 0; i < region.GetImageDimension(); ++i)
+    {
+      index << (i > 0 ? " " : "") << region.GetIndex(i);
+      size << (i > 0 ? " " : "") << region.GetSize(i);
+    }
+
+    Options options;
+    options[OPTION_REGION_INDEX()] = us::Any(index.str());
+    options[OPTION_REGION_SIZE()] = us::Any(size.str());
+    return options;
+  }
+
   ItkImageIO::ItkImageIO(const ItkImageIO &other)
     : AbstractFileIO(other), m_ImageIO(dynamic_cast<itk::ImageIOBase *>(other.m_ImageIO->Clone().GetPointer()))
   {
@@ -108,6 +155,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultReaderOptions();
 
     std::vector<std::string> readExtensions = m_ImageIO->GetSupportedReadExtensions();
 
@@ -177,6 +225,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultReaderOptions();
 
     if (rank)
     {
@@ -209,6 +258,286 @@ namespace mitk
     return result;
   };
 
+  std::string TrimWhitespace(const std::string &str)
+  {
+    const std::string whitespace = " \t";
+    const std::string::size_type begin = str.find_first_not_of(whitespace);
+    if (begin == std::string::npos)
+      return std::string();
+    return str.substr(begin, str.find_last_not_of(whitespace) - begin + 1);
+  }
+
+  /**Helper function that locates the raw pixel payload of uncompressed NRRD and MetaImage files.
+   * Returns true only if the payload is stored exactly in the memory layout that imageIO->Read() would
+   * produce (raw encoding, native byte order, no axis permutation), so that it can be mapped instead of read.
+   * dataFile and offset then denote the file containing the payload and its position within that file.*/
+  bool LocateUncompressedPayload(const std::string &path,
+                                 const itk::ImageIOBase *imageIO,
+                                 std::string &dataFile,
+                                 size_t &offset)
+  {
+    const std::string imageIOName = imageIO->GetNameOfClass();
+    const bool isNrrd = imageIOName == "NrrdImageIO";
+    const bool isMeta = imageIOName == "MetaImageIO";
+
+    if (!isNrrd && !isMeta)
+      return false;
+
+    if (imageIO->GetComponentSize() > 1)
+    {
+      const itk::ImageIOBase::ByteOrder systemByteOrder =
+        itk::ByteSwapper<int>::SystemIsBigEndian() ? itk::ImageIOBase::BigEndian : itk::ImageIOBase::LittleEndian;
+      if (imageIO->GetByteOrder() != systemByteOrder)
+        return false;
+    }
+
+    // NrrdImageIO permutes the axes of vector images whose component axis is not the fastest one
+    if (isNrrd && imageIO->GetNumberOfComponents() > 1)
+      return false;
+
+    std::ifstream header(path.c_str(), std::ios::in | std::ios::binary);
+    if (!header.good())
+      return false;
+
+    std::string line;
+    std::getline(header, line);
+    if (isNrrd && line.compare(0, 4, "NRRD") != 0)
+      return false;
+    if (isMeta)
+      header.seekg(0);
+
+    const std::string fieldSeparator = isNrrd ? ":" : "=";
+    std::string elementDataFile;
+    long long skip = 0;
+    bool headerComplete = false;
+
+    while (std::getline(header, line))
+    {
+      if (!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1);
+
+      if (line.empty())
+      {
+        if (isNrrd)
+        {
+          headerComplete = true;
+          break;
+        }
+        continue;
+      }
+
+      if (line[0] == '#')
+        continue;
+
+      const std::string::size_type separatorPos = line.find(fieldSeparator);
+      if (separatorPos == std::string::npos)
+        return false;
+
+      // NRRD key/value pairs ("key:=value") are not fields
+      if (isNrrd && line.compare(separatorPos, 2, ":=") == 0)
+        continue;
+
+      std::string key = line.substr(0, separatorPos);
+      std::string value = line.substr(separatorPos + 1);
+      key = TrimWhitespace(key);
+      value = TrimWhitespace(value);
+
+      if (isNrrd)
+      {
+        if (key == "encoding" && value != "raw")
+          return false;
+        else if (key == "line skip" || key == "lineskip")
+        {
+          if (value != "0")
+            return false;
+        }
+        else if (key == "byte skip" || key == "byteskip")
+          skip = atoll(value.c_str());
+        else if (key == "data file" || key == "datafile")
+          elementDataFile = value;
+      }
+      else
+      {
+        if (key == "CompressedData" && itksys::SystemTools::LowerCase(value) != "false")
+          return false;
+        else if (key == "HeaderSize")
+          skip = atoll(value.c_str());
+        else if (key == "ElementDataFile")
+        {
+          // ElementDataFile terminates a MetaImage header
+          elementDataFile = value;
+          headerComplete = true;
+          break;
+        }
+      }
+    }
+
+    if (isNrrd && !headerComplete && elementDataFile.empty())
+      return false;
+    if (isMeta && !headerComplete)
+      return false;
+
+    if (elementDataFile.empty() || elementDataFile == "LOCAL")
+    {
+      if (skip != 0)
+        return false;
+      dataFile = path;
+      skip = static_cast<long long>(header.tellg());
+      if (skip < 0)
+        return false;
+    }
+    else
+    {
+      // file lists and printf-style patterns split the payload over several files
+      if (elementDataFile == "LIST" || elementDataFile.find_first_of("% \t") != std::string::npos)
+        return false;
+      dataFile = itksys::SystemTools::CollapseFullPath(elementDataFile, itksys::SystemTools::GetFilenamePath(path));
+    }
+
+    const unsigned long long fileSize = itksys::SystemTools::FileLength(dataFile);
+    const unsigned long long payloadSize = imageIO->GetImageSizeInBytes();
+
+    if (fileSize < payloadSize)
+      return false;
+
+    // a skip of -1 means that the payload is stored at the very end of the file
+    const unsigned long long payloadOffset = skip == -1 ? fileSize - payloadSize : static_cast<unsigned long long>(skip);
+
+    if (skip < -1 || payloadOffset + payloadSize > fileSize)
+      return false;
+
+    // pixels must be aligned within the mapping to be safely accessible
+    if (payloadOffset % imageIO->GetComponentSize() != 0)
+      return false;
+
+    offset = static_cast<size_t>(payloadOffset);
+    return true;
+  }
+
+  /**Helper function that copies the pixels of targetRegion from a buffer holding sourceRegion
+   * into a buffer holding exactly targetRegion. targetRegion has to be contained in sourceRegion.*/
+  void CopyIORegion(const unsigned char *source,
+                    const itk::ImageIORegion &sourceRegion,
+                    unsigned char *target,
+                    const itk::ImageIORegion &targetRegion,
+                    size_t pixelSize)
+  {
+    const unsigned int dimension = targetRegion.GetImageDimension();
+    const size_t rowSize = targetRegion.GetSize(0) * pixelSize;
+    const size_t numberOfRows = targetRegion.GetNumberOfPixels() / targetRegion.GetSize(0);
+
+    // position of the current row relative to the start of targetRegion
+    std::vector<itk::ImageIORegion::SizeValueType> position(dimension, 0);
+
+    for (size_t row = 0; row < numberOfRows; ++row)
+    {
+      size_t sourceOffset = 0;
+      size_t stride = 1;
+      for (unsigned int d = 0; d < dimension; ++d)
+      {
+        sourceOffset += (targetRegion.GetIndex(d) + position[d] - sourceRegion.GetIndex(d)) * stride;
+        stride *= sourceRegion.GetSize(d);
+      }
+
+      std::memcpy(target + row * rowSize, source + sourceOffset * pixelSize, rowSize);
+
+      for (unsigned int d = 1; d < dimension; ++d)
+      {
+        if (++position[d] < targetRegion.GetSize(d))
+          break;
+        position[d] = 0;
+      }
+    }
+  }
+
+  /**Helper function that parses a whitespace separated list of integers.*/
+  std::vector<long long> ParseIntegerList(const std::string &str)
+  {
+    std::vector<long long> result;
+    std::istringstream stream(str);
+    long long value;
+    while (stream >> value)
+    {
+      result.push_back(value);
+    }
+    if (!stream.eof())
+    {
+      mitkThrow() << "Invalid integer list \"" << str << "\"";
+    }
+    return result;
+  }
+
+  itk::ImageIORegion ItkImageIO::GetRequestedIORegion(const itk::ImageIORegion &largestRegion)
+  {
+    Options options = this->GetReaderOptions();
+    const unsigned int dimension = largestRegion.GetImageDimension();
+
+    std::string indexOption;
+    std::string sizeOption;
+    int timeStep = -1;
+    try
+    {
+      indexOption = us::any_cast<std::string>(options[OPTION_REGION_INDEX()]);
+      sizeOption = us::any_cast<std::string>(options[OPTION_REGION_SIZE()]);
+      timeStep = us::any_cast<int>(options[OPTION_TIME_STEP()]);
+    }
+    catch (const us::BadAnyCastException &e)
+    {
+      MITK_WARN << "Unexpected error: " << e.what();
+    }
+
+    const std::vector<long long> index = ParseIntegerList(indexOption);
+    const std::vector<long long> size = ParseIntegerList(sizeOption);
+
+    if (index.size() > dimension || size.size() > dimension)
+    {
+      mitkThrow() << "Requested region has more dimensions than the image (" << dimension << ")";
+    }
+
+    itk::ImageIORegion region = largestRegion;
+    for (unsigned int i = 0; i < dimension; ++i)
+    {
+      // missing entries and a size of 0 select the whole remaining extent
+      const long long start = i < index.size() ? index[i] : 0;
+      const long long extent = largestRegion.GetSize(i);
+      if (start < 0 || start >= extent)
+      {
+        mitkThrow() << "Requested region index " << start << " is outside of image dimension " << i << " [0, "
+                    << extent << ")";
+      }
+      const long long length = (i < size.size() && size[i] > 0) ? size[i] : extent - start;
+      if (start + length > extent)
+      {
+        mitkThrow() << "Requested region exceeds image dimension " << i << " (" << start << " + " << length << " > "
+                    << extent << ")";
+      }
+      region.SetIndex(i, start);
+      region.SetSize(i, length);
+    }
+
+    if (timeStep >= 0)
+    {
+      if (dimension < 4)
+      {
+        if (timeStep > 0)
+        {
+          mitkThrow() << "Requested time step " << timeStep << " does not exist in the image";
+        }
+      }
+      else
+      {
+        if (static_cast<unsigned int>(timeStep) >= largestRegion.GetSize(3))
+        {
+          mitkThrow() << "Requested time step " << timeStep << " does not exist in the image";
+        }
+        region.SetIndex(3, timeStep);
+        region.SetSize(3, 1);
+      }
+    }
+
+    return region;
+  }
+
   std::vector<BaseData::Pointer> ItkImageIO::Read()
   {
     std::vector<BaseData::Pointer> result;
@@ -282,13 +611,95 @@ namespace mitk
     ioRegion.SetSize(ioSize);
     ioRegion.SetIndex(ioStart);
 
-    MITK_INFO << "ioRegion: " << ioRegion << std::endl;
+    // restrict reading to a sub-block or a single time step if requested by the reader options
+    itk::ImageIORegion requestedRegion = ioRegion;
+    if (m_ImageIO->GetNumberOfDimensions() <= MAXDIM)
+    {
+      requestedRegion = this->GetRequestedIORegion(ioRegion);
+    }
+    const bool readsSubRegion = !(requestedRegion == ioRegion);
+
+    if (readsSubRegion)
+    {
+      unsigned int j, itkDimMax3 = (ndim >= 3 ? 3 : ndim);
+      for (i = 0; i < ndim; ++i)
+      {
+        dimensions[i] = requestedRegion.GetSize(i);
+      }
+      // the origin of the sub-block is the world position of its first voxel
+      for (i = 0; i < itkDimMax3; ++i)
+        for (j = 0; j < itkDimMax3; ++j)
+          origin[i] += m_ImageIO->GetDirection(j)[i] * spacing[j] * requestedRegion.GetIndex(j);
+    }
+
+    MITK_INFO << "ioRegion: " << requestedRegion << std::endl;
     m_ImageIO->SetIORegion(ioRegion);
-    void *buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
-    m_ImageIO->Read(buffer);
+
+    bool useMemoryMapping = false;
+    try
+    {
+      useMemoryMapping = us::any_cast<bool>(this->GetReaderOptions()[OPTION_MEMORY_MAPPING()]);
+    }
+    catch (const us::BadAnyCastException &e)
+    {
+      MITK_WARN << "Unexpected error: " << e.what();
+    }
+
+    MemoryMappedFile::Pointer mappedFile;
+    std::string dataFile;
+    size_t dataOffset = 0;
+    if (useMemoryMapping && !readsSubRegion && m_ImageIO->GetNumberOfDimensions() <= MAXDIM &&
+        LocateUncompressedPayload(path, m_ImageIO, dataFile, dataOffset))
+    {
+      try
+      {
+        mappedFile = MemoryMappedFile::New();
+        mappedFile->Map(dataFile, dataOffset, m_ImageIO->GetImageSizeInBytes());
+      }
+      catch (const mitk::Exception &e)
+      {
+        MITK_WARN << "Could not memory map " << dataFile << ", reading it instead: " << e.GetDescription();
+        mappedFile = nullptr;
+      }
+    }
 
     image->Initialize(MakePixelType(m_ImageIO), ndim, dimensions);
-    image->SetImportChannel(buffer, 0, Image::ManageMemory);
+
+    if (mappedFile.IsNotNull())
+    {
+      // Pages of the payload are only loaded when slices or volumes are actually accessed
+      MITK_INFO << "memory mapped image data from " << dataFile << " (offset " << dataOffset << ")";
+      image->SetImportChannel(mappedFile->GetData(), 0, Image::ReferenceMemory);
+      image->GetChannelData(0)->SetDataOwner(mappedFile);
+    }
+    else if (readsSubRegion)
+    {
+      // ImageIOs that cannot stream (e.g. compressed files) return a larger region that is cropped afterwards
+      const size_t pixelSize = m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents();
+      itk::ImageIORegion streamableRegion =
+        m_ImageIO->GenerateStreamableReadRegionFromRequestedRegion(requestedRegion);
+      m_ImageIO->SetIORegion(streamableRegion);
+
+      unsigned char *buffer = new unsigned char[streamableRegion.GetNumberOfPixels() * pixelSize];
+      m_ImageIO->Read(buffer);
+
+      if (!(streamableRegion == requestedRegion))
+      {
+        MITK_INFO << m_ImageIO->GetNameOfClass() << " read " << streamableRegion.GetNumberOfPixels()
+                  << " pixels to provide the requested region";
+        unsigned char *croppedBuffer = new unsigned char[requestedRegion.GetNumberOfPixels() * pixelSize];
+        CopyIORegion(buffer, streamableRegion, croppedBuffer, requestedRegion, pixelSize);
+        delete[] buffer;
+        buffer = croppedBuffer;
+      }
+      image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    }
+    else
+    {
+      void *buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
+      m_ImageIO->Read(buffer);
+      image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    }
 
     const itk::MetaDataDictionary &dictionary = m_ImageIO->GetMetaDataDictionary();
 
@@ -316,6 +727,10 @@ namespace mitk
     // re-initialize TimeGeometry
     TimeGeometry::Pointer timeGeometry;
 
+    // time steps stored in the file and the first one that has been read
+    const unsigned int fileTimeSteps = ndim > 3 ? ioRegion.GetSize(3) : image->GetDimension(3);
+    const unsigned int firstTimeStep = ndim > 3 ? requestedRegion.GetIndex(3) : 0;
+
     if (dictionary.HasKey(PROPERTY_NAME_TIMEGEOMETRY_TYPE) || dictionary.HasKey(PROPERTY_KEY_TIMEGEOMETRY_TYPE))
     { // also check for the name because of backwards compatibility. Past code version stored with the name and not with
       // the key
@@ -346,19 +761,20 @@ namespace mitk
           timePoints = ConvertMetaDataObjectToTimePointList(dictionary.Get(PROPERTY_KEY_TIMEGEOMETRY_TIMEPOINTS));
         }
 
-        if (timePoints.size() - 1 != image->GetDimension(3))
+        if (timePoints.size() - 1 != fileTimeSteps)
         {
           MITK_ERROR << "Stored timepoints (" << timePoints.size() - 1 << ") and size of image time dimension ("
-                     << image->GetDimension(3) << ") do not match. Switch to ProportionalTimeGeometry fallback"
+                     << fileTimeSteps << ") do not match. Switch to ProportionalTimeGeometry fallback"
                      << std::endl;
         }
         else
         {
           ArbitraryTimeGeometry::Pointer arbitraryTimeGeometry = ArbitraryTimeGeometry::New();
-          TimePointVector::const_iterator pos = timePoints.begin();
+          TimePointVector::const_iterator pos = timePoints.begin() + firstTimeStep;
           TimePointVector::const_iterator prePos = pos++;
+          TimePointVector::const_iterator end = pos + image->GetDimension(3);
 
-          for (; pos != timePoints.end(); ++prePos, ++pos)
+          for (; pos != end; ++prePos, ++pos)
           {
             arbitraryTimeGeometry->AppendTimeStepClone(slicedGeometry, *pos, *prePos);
           }
@@ -373,12 +789,16 @@ namespace mitk
       MITK_INFO << "used time geometry: " << ProportionalTimeGeometry::GetStaticNameOfClass() << std::endl;
       ProportionalTimeGeometry::Pointer propTimeGeometry = ProportionalTimeGeometry::New();
       propTimeGeometry->Initialize(slicedGeometry, image->GetDimension(3));
+      if (firstTimeStep > 0)
+      {
+        propTimeGeometry->SetFirstTimePoint(propTimeGeometry->GetFirstTimePoint() +
+                                            firstTimeStep * propTimeGeometry->GetStepDuration());
+      }
       timeGeometry = propTimeGeometry;
     }
 
     image->SetTimeGeometry(timeGeometry);
 
-    buffer = NULL;
     MITK_INFO << "number of image components: " << image->GetPixelType().GetNumberOfComponents() << std::endl;
 
     for (itk::MetaDataDictionary::ConstIterator iter = dictionary.Begin(), iterEnd = dictionary.End(); iter != iterEnd;
@@ -623,7 +1043,22 @@ namespace mitk
       }
 
       ImageReadAccessor imageAccess(image);
-      m_ImageIO->Write(imageAccess.GetData());
+      const void *data = imageAccess.GetData();
+
+      // Writing truncates the target files. If the pixel data is memory mapped, it might be mapped
+      // from one of them, e.g. the data file of a MetaImage with a detached header, which is named by
+      // the ImageIO. So mapped pixel data is always detached from its file first.
+      std::vector<char> detachedData;
+      const MemoryMappedFile *mappedFile =
+        dynamic_cast<const MemoryMappedFile *>(image->GetChannelData(0)->GetDataOwner());
+      if (mappedFile != nullptr && mappedFile->IsMapped())
+      {
+        const char *begin = static_cast<const char *>(data);
+        detachedData.assign(begin, begin + m_ImageIO->GetImageSizeInBytes());
+        data = detachedData.data();
+      }
+
+      m_ImageIO->Write(data);
     }
     catch (const std::exception &e)
     {
@@ -660,6 +1095,16 @@ namespace mitk
   }
 
   ItkImageIO *ItkImageIO::IOClone() const { return new ItkImageIO(*this); }
+  void ItkImageIO::InitializeDefaultReaderOptions()
+  {
+    Options defaultOptions;
+    defaultOptions[OPTION_MEMORY_MAPPING()] = us::Any(false);
+    defaultOptions[OPTION_REGION_INDEX()] = us::Any(std::string());
+    defaultOptions[OPTION_REGION_SIZE()] = us::Any(std::string());
+    defaultOptions[OPTION_TIME_STEP()] = us::Any(-1);
+    this->SetDefaultReaderOptions(defaultOptions);
+  }
+
   void ItkImageIO::InitializeDefaultMetaDataKeys()
   {
     this->m_DefaultMetaDataKeys.push_back("NRRD.space");
@@ -84,6 +84,8 @@ void mitk::LoggingBackend::Unregister()
 {
   if (mitkLogBackend)
   {
+    // write the buffered messages of the asynchronous mode to the log file before it is closed
+    mbilog::FlushBackends();
     SetLogFile(nullptr);
     mbilog::UnregisterBackend(mitkLogBackend);
     delete mitkLogBackend;
@@ -0,0 +1,168 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkMemoryMappedFile.h"
+
+#include <mitkException.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mitk::MemoryMappedFile::MemoryMappedFile()
+  : m_Data(nullptr),
+    m_Length(0),
+    m_View(nullptr),
+    m_ViewLength(0)
+#if defined(_WIN32)
+    ,
+    m_FileHandle(nullptr),
+    m_MappingHandle(nullptr)
+#endif
+{
+}
+
+mitk::MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Unmap();
+}
+
+size_t mitk::MemoryMappedFile::GetAllocationGranularity()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return static_cast<size_t>(info.dwAllocationGranularity);
+#else
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+void mitk::MemoryMappedFile::Map(const std::string &fileName, size_t offset, size_t length)
+{
+  this->Unmap();
+
+  if (length == 0)
+  {
+    mitkThrow() << "Cannot map an empty range of " << fileName;
+  }
+
+  const size_t granularity = GetAllocationGranularity();
+  const size_t viewOffset = offset - offset % granularity;
+  const size_t viewLength = length + (offset - viewOffset);
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(fileName.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    mitkThrow() << "Cannot open " << fileName << " for memory mapping";
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) < offset + length)
+  {
+    CloseHandle(file);
+    mitkThrow() << "File " << fileName << " is smaller than the requested mapping";
+  }
+
+  // PAGE_WRITECOPY together with FILE_MAP_COPY gives a private copy-on-write view
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  if (mapping == nullptr)
+  {
+    CloseHandle(file);
+    mitkThrow() << "Cannot create file mapping for " << fileName;
+  }
+
+  const unsigned long long largeOffset = viewOffset;
+  void *view = MapViewOfFile(mapping,
+                             FILE_MAP_COPY,
+                             static_cast<DWORD>(largeOffset >> 32),
+                             static_cast<DWORD>(largeOffset & 0xFFFFFFFF),
+                             viewLength);
+  if (view == nullptr)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    mitkThrow() << "Cannot map view of " << fileName;
+  }
+
+  m_FileHandle = file;
+  m_MappingHandle = mapping;
+#else
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    mitkThrow() << "Cannot open " << fileName << " for memory mapping";
+  }
+
+  struct stat fileStatus;
+  if (fstat(fd, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) < offset + length)
+  {
+    close(fd);
+    mitkThrow() << "File " << fileName << " is smaller than the requested mapping";
+  }
+
+  // MAP_PRIVATE: writes through image accessors stay in (copied) process pages
+  void *view = mmap(nullptr, viewLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, static_cast<off_t>(viewOffset));
+
+  // the mapping holds its own reference to the file
+  close(fd);
+
+  if (view == MAP_FAILED)
+  {
+    mitkThrow() << "Cannot memory map " << fileName;
+  }
+#endif
+
+  m_FileName = fileName;
+  m_View = view;
+  m_ViewLength = viewLength;
+  m_Data = static_cast<char *>(view) + (offset - viewOffset);
+  m_Length = length;
+}
+
+void mitk::MemoryMappedFile::Unmap()
+{
+  if (m_View == nullptr)
+    return;
+
+#if defined(_WIN32)
+  UnmapViewOfFile(m_View);
+  CloseHandle(m_MappingHandle);
+  CloseHandle(m_FileHandle);
+  m_MappingHandle = nullptr;
+  m_FileHandle = nullptr;
+#else
+  munmap(m_View, m_ViewLength);
+#endif
+
+  m_View = nullptr;
+  m_ViewLength = 0;
+  m_Data = nullptr;
+  m_Length = 0;
+  m_FileName.clear();
+}
@@ -236,14 +236,19 @@ void mitk::VtkPropRenderer::PrepareMapperQueue()
     const DataNode::Pointer node = it->Value();
     if (node.IsNull())
       continue;
+
+    bool visible = true;
+    node->GetVisibility(visible, this, "visible");
+
+    // the mapper depends on the data, which is not loaded for hidden nodes
+    if (!visible && node->HasDataLoader())
+      continue;
+
     const mitk::Mapper::Pointer mapper = node->GetMapper(m_MapperID);
 
     if (mapper.IsNull())
       continue;
 
-    bool visible = true;
-    node->GetVisibility(visible, this, "visible");
-
     // The information about LOD-enabled mappers is required by RenderingManager
     if (mapper->IsLODEnabled(this) && visible)
     {
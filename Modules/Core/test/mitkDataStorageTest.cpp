@@ -506,6 +506,64 @@ void TestDataStorage(mitk::DataStorage *ds, std::string filename)
     MITK_TEST_CONDITION(ds->GetNamedNode("This name does not exist") == NULL,
                         "Checking named node method with wrong name");
 
+    /* Checking that indexed queries follow node modifications */
+    {
+      mitk::NodePredicateDataType::Pointer p1 = mitk::NodePredicateDataType::New("Surface");
+      mitk::NodePredicateProperty::Pointer p2 =
+        mitk::NodePredicateProperty::New("color", mitk::ColorProperty::New(color));
+      mitk::NodePredicateAnd::Pointer predicate = mitk::NodePredicateAnd::New(p1, p2);
+      MITK_TEST_CONDITION(ds->GetSubset(predicate)->Size() == 1, "Requesting a composite condition twice (1)");
+      MITK_TEST_CONDITION(ds->GetSubset(predicate)->Size() == 1, "Requesting a composite condition twice (2)");
+
+      n2->SetName("Renamed Surface Node");
+      MITK_TEST_CONDITION((ds->GetNamedNode("Node 2 - Surface Node") == NULL) &&
+                            (ds->GetNamedNode("Renamed Surface Node") == n2),
+                          "Checking named node method after renaming");
+
+      n2->SetColor(0.0, 1.0, 0.0);
+      MITK_TEST_CONDITION(ds->GetSubset(predicate)->Size() == 0, "Requesting a composite condition after modification");
+
+      n2->SetColor(color);
+      n2->SetName("Node 2 - Surface Node");
+      MITK_TEST_CONDITION(ds->GetSubset(predicate)->Size() == 1 && ds->GetNamedNode("Node 2 - Surface Node") == n2,
+                          "Requesting a composite condition after restoring the node");
+
+      // the Data Manager changes the values of the property objects without modifying the node
+      mitk::StringProperty *nameProperty = dynamic_cast<mitk::StringProperty *>(n2->GetProperty("name"));
+      nameProperty->SetValue("Renamed Surface Node");
+      MITK_TEST_CONDITION((ds->GetNamedNode("Node 2 - Surface Node") == NULL) &&
+                            (ds->GetNamedNode("Renamed Surface Node") == n2),
+                          "Checking named node method after renaming the property");
+
+      mitk::ColorProperty *colorProperty = dynamic_cast<mitk::ColorProperty *>(n2->GetProperty("color"));
+      colorProperty->SetColor(0.0, 1.0, 0.0);
+      MITK_TEST_CONDITION(ds->GetSubset(predicate)->Size() == 0,
+                          "Requesting a composite condition after modifying the property");
+
+      colorProperty->SetColor(color);
+      nameProperty->SetValue("Node 2 - Surface Node");
+      MITK_TEST_CONDITION(ds->GetSubset(predicate)->Size() == 1 && ds->GetNamedNode("Node 2 - Surface Node") == n2,
+                          "Requesting a composite condition after restoring the properties");
+    }
+
+    /* Checking that a node with a data loader is added and queried without loading its data */
+    {
+      mitk::NodePredicateDataType::Pointer isSurface = mitk::NodePredicateDataType::New("Surface");
+      const unsigned int surfaces = ds->GetSubset(isSurface)->Size();
+
+      mitk::Surface::Pointer loadedSurface = mitk::Surface::New();
+      mitk::DataNode::Pointer loaderNode = mitk::DataNode::New();
+      loaderNode->SetDataLoader([loadedSurface](mitk::DataNode &node) { node.SetData(loadedSurface); }, "Surface");
+      ds->Add(loaderNode);
+      MITK_TEST_CONDITION(loaderNode->HasDataLoader() && ds->GetSubset(isSurface)->Size() == surfaces + 1,
+                          "Requesting the data type of a node whose data is not loaded");
+
+      MITK_TEST_CONDITION(loaderNode->GetData() == loadedSurface && !loaderNode->HasDataLoader() &&
+                            ds->GetSubset(isSurface)->Size() == surfaces + 1,
+                          "Loading the data of a node in the data storage");
+      ds->Remove(loaderNode);
+    }
+
     /* Checking named object method */
     MITK_TEST_CONDITION(ds->GetNamedObject<mitk::Image>("Node 1 - Image Node") == image,
                         "Checking named object method");
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageGenerator.h"
 #include "mitkImagePixelReadAccessor.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 #include "mitkPixelTypeMultiplex.h"
 #include <mitkImage.h>
 #include <mitkImageCast.h>
@@ -35,6 +36,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // stl includes
 #include <fstream>
+#include <vector>
 
 // vtk includes
 #include <vtkImageData.h>
@@ -159,6 +161,49 @@ public:
 
     MITK_ASSERT_EQUAL(imageGeometry, planegeometry, "Matrix elements of cloned matrix equal original matrix");
   }
+
+  void GetStatistics_TimeStepModified_OtherTimeStepsNotRecomputed()
+  {
+    mitk::Image::Pointer image = mitk::Image::New();
+    unsigned int dim[] = {300, 300, 2, 2};
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 4, dim);
+
+    // large enough to be split into several blocks, extrema in different blocks
+    const unsigned int size = dim[0] * dim[1] * dim[2];
+    std::vector<float> volume(size);
+    for (unsigned int i = 0; i < size; ++i)
+      volume[i] = static_cast<float>(i % 1000);
+    volume[10] = -5;
+    volume[size - 10] = -5;
+    volume[size / 2] = 2000;
+    image->SetImportVolume(volume.data(), 0);
+    image->SetImportVolume(volume.data(), 1);
+
+    mitk::ImageStatisticsHolder *statistics = image->GetStatistics();
+    MITK_TEST_CONDITION(statistics->GetScalarValueMin(0) == -5, "Minimum of time step 0");
+    MITK_TEST_CONDITION(statistics->GetScalarValue2ndMin(0) == 0, "Second smallest value of time step 0");
+    MITK_TEST_CONDITION(statistics->GetCountOfMinValuedVoxels(0) == 2, "Count of minimum of time step 0");
+    MITK_TEST_CONDITION(statistics->GetScalarValueMax(0) == 2000, "Maximum of time step 0");
+    MITK_TEST_CONDITION(statistics->GetScalarValue2ndMax(0) == 999, "Second largest value of time step 0");
+    MITK_TEST_CONDITION(statistics->GetCountOfMaxValuedVoxels(0) == 1, "Count of maximum of time step 0");
+    MITK_TEST_CONDITION(statistics->GetScalarValueMax(1) == 2000, "Maximum of time step 1");
+
+    // change time step 1 only
+    volume[size / 2] = 3000;
+    image->SetImportVolume(volume.data(), 1);
+
+    // write to time step 0 without marking it as modified: cached values must be kept
+    {
+      mitk::ImageWriteAccessor accessor(image, image->GetVolumeData(0));
+      static_cast<float *>(accessor.GetData())[size / 2] = 4000;
+    }
+
+    MITK_TEST_CONDITION(statistics->GetScalarValueMax(1) == 3000, "Maximum of modified time step 1 recomputed");
+    MITK_TEST_CONDITION(statistics->GetScalarValueMax(0) == 2000, "Maximum of unmodified time step 0 not recomputed");
+
+    image->Modified();
+    MITK_TEST_CONDITION(statistics->GetScalarValueMax(0) == 4000, "Maximum of time step 0 recomputed after Modified()");
+  }
 };
 
 int mitkImageTest(int argc, char *argv[])
@@ -167,6 +212,7 @@ int mitkImageTest(int argc, char *argv[])
 
   mitkImageTestClass tester;
   tester.SetClonedGeometry_None_ClonedEqualInput();
+  tester.GetStatistics_TimeStepModified_OtherTimeStepsNotRecomputed();
 
   // Create Image out of nowhere
   mitk::Image::Pointer imgMem = mitk::Image::New();
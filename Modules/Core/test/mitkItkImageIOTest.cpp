@@ -22,10 +22,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIOUtil.h"
 #include "mitkITKImageImport.h"
 #include <mitkExtractSliceFilter.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkItkImageIO.h>
+#include <mitkMemoryMappedFile.h>
 
 #include "itksys/SystemTools.hxx"
+#include <itkByteSwapper.h>
 #include <itkImageRegionIterator.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -47,6 +53,8 @@ class mitkItkImageIOTestSuite : public mitk::TestFixture
   MITK_TEST(TestWrite3DImageWithTwoPlanes);
   MITK_TEST(TestWrite3DplusT_ArbitraryTG);
   MITK_TEST(TestWrite3DplusT_ProportionalTG);
+  MITK_TEST(TestMemoryMappedRead);
+  MITK_TEST(TestRegionRead);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -422,6 +430,172 @@ public:
     CPPUNIT_ASSERT_THROW(mitk::IOUtil::SaveImage(image, mitk::IOUtil::CreateTemporaryFile("3Dto2DTestImageXXXXXX.png")),
                          mitk::Exception);
   }
+
+  /**
+  * Read an uncompressed MetaImage with memory mapping enabled and make sure that the data is mapped,
+  * correct and that modifications do not leak back into the file
+  */
+  void TestMemoryMappedRead()
+  {
+    const unsigned int size[3] = {10, 8, 6};
+    const unsigned int numberOfPixels = size[0] * size[1] * size[2];
+
+    std::ofstream rawStream;
+    const std::string rawFileName = mitk::IOUtil::CreateTemporaryFile(rawStream, std::ios_base::binary, "MappedTestImageXXXXXX.raw");
+    std::vector<short> pixels(numberOfPixels);
+    for (unsigned int i = 0; i < numberOfPixels; ++i)
+    {
+      pixels[i] = static_cast<short>(i - 100);
+    }
+    rawStream.write(reinterpret_cast<const char *>(pixels.data()), numberOfPixels * sizeof(short));
+    rawStream.close();
+
+    std::ofstream headerStream;
+    const std::string headerFileName = mitk::IOUtil::CreateTemporaryFile(headerStream, "MappedTestImageXXXXXX.mhd");
+    headerStream << "ObjectType = Image\n"
+                 << "NDims = 3\n"
+                 << "BinaryData = True\n"
+                 << "BinaryDataByteOrderMSB = "
+                 << (itk::ByteSwapper<short>::SystemIsBigEndian() ? "True" : "False") << "\n"
+                 << "CompressedData = False\n"
+                 << "DimSize = " << size[0] << " " << size[1] << " " << size[2] << "\n"
+                 << "ElementType = MET_SHORT\n"
+                 << "ElementDataFile = " << itksys::SystemTools::GetFilenameName(rawFileName) << "\n";
+    headerStream.close();
+
+    mitk::IFileReader::Options options;
+    options[mitk::ItkImageIO::OPTION_MEMORY_MAPPING()] = us::Any(true);
+
+    std::vector<mitk::BaseData::Pointer> data = mitk::IOUtil::Load(headerFileName, options);
+    CPPUNIT_ASSERT_MESSAGE("One image loaded", data.size() == 1);
+    mitk::Image::Pointer image = dynamic_cast<mitk::Image *>(data.front().GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Loaded data is an image", image.IsNotNull());
+
+    CPPUNIT_ASSERT_MESSAGE(
+      "Image data is memory mapped",
+      dynamic_cast<mitk::MemoryMappedFile *>(image->GetChannelData(0)->GetDataOwner()) != nullptr);
+
+    {
+      mitk::ImageReadAccessor readAccess(image);
+      CPPUNIT_ASSERT_MESSAGE(
+        "Mapped pixel values are correct",
+        std::equal(pixels.begin(), pixels.end(), static_cast<const short *>(readAccess.GetData())));
+    }
+
+    {
+      mitk::ImageWriteAccessor writeAccess(image, image->GetSliceData(2));
+      static_cast<short *>(writeAccess.GetData())[0] = 42;
+    }
+
+    {
+      mitk::ImageReadAccessor readAccess(image);
+      CPPUNIT_ASSERT_MESSAGE("Modification is visible in the image",
+                             static_cast<const short *>(readAccess.GetData())[2 * size[0] * size[1]] == 42);
+    }
+
+    std::ifstream rawCheck(rawFileName.c_str(), std::ios::binary);
+    std::vector<short> filePixels(numberOfPixels);
+    rawCheck.read(reinterpret_cast<char *>(filePixels.data()), numberOfPixels * sizeof(short));
+    rawCheck.close();
+    CPPUNIT_ASSERT_MESSAGE("Mapped file is not modified", filePixels == pixels);
+
+    // the data file of a header named like the mapped file may be written onto the mapped file
+    const std::string resavedHeaderFileName = rawFileName.substr(0, rawFileName.size() - 4) + ".mhd";
+    mitk::IOUtil::Save(image, resavedHeaderFileName);
+    pixels[2 * size[0] * size[1]] = 42;
+    mitk::Image::Pointer resavedImage = mitk::IOUtil::LoadImage(resavedHeaderFileName);
+    {
+      mitk::ImageReadAccessor readAccess(resavedImage);
+      CPPUNIT_ASSERT_MESSAGE(
+        "Image saved onto its mapped file is written correctly",
+        std::equal(pixels.begin(), pixels.end(), static_cast<const short *>(readAccess.GetData())));
+    }
+
+    resavedImage = nullptr;
+    image = nullptr;
+    data.clear();
+    std::remove(headerFileName.c_str());
+    std::remove(resavedHeaderFileName.c_str());
+    std::remove(rawFileName.c_str());
+  }
+
+  /**
+  * Read a sub-block of a stored image and compare pixel values and geometry with the full image
+  */
+  void TestRegionRead()
+  {
+    typedef itk::Image<short, 3> ImageType;
+
+    ImageType::Pointer itkImage = ImageType::New();
+    ImageType::RegionType region;
+    ImageType::SizeType size;
+    size[0] = 20;
+    size[1] = 15;
+    size[2] = 10;
+    region.SetSize(size);
+    itkImage->SetRegions(region);
+    ImageType::SpacingType spacing;
+    spacing[0] = 0.5;
+    spacing[1] = 2.0;
+    spacing[2] = 3.0;
+    itkImage->SetSpacing(spacing);
+    itkImage->Allocate();
+
+    itk::ImageRegionIterator<ImageType> imageIterator(itkImage, itkImage->GetLargestPossibleRegion());
+    for (short value = 0; !imageIterator.IsAtEnd(); ++imageIterator, ++value)
+    {
+      imageIterator.Set(value);
+    }
+
+    mitk::Image::Pointer image = mitk::ImportItkImage(itkImage);
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile("RegionTestImageXXXXXX.nrrd");
+    mitk::IOUtil::Save(image, fileName);
+
+    itk::ImageIORegion ioRegion(3);
+    ioRegion.SetIndex(0, 3);
+    ioRegion.SetIndex(1, 4);
+    ioRegion.SetIndex(2, 5);
+    ioRegion.SetSize(0, 6);
+    ioRegion.SetSize(1, 7);
+    ioRegion.SetSize(2, 2);
+
+    mitk::Image::Pointer subImage = mitk::IOUtil::LoadImage(fileName, ioRegion);
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(ioRegion.GetSize(i)), subImage->GetDimension(i));
+    }
+
+    mitk::Point3D expectedOrigin;
+    mitk::Point3D fullIndex;
+    fullIndex[0] = 3;
+    fullIndex[1] = 4;
+    fullIndex[2] = 5;
+    image->GetGeometry()->IndexToWorld(fullIndex, expectedOrigin);
+    CPPUNIT_ASSERT_MESSAGE("Origin of sub-block is the position of its first voxel",
+                           mitk::Equal(expectedOrigin, subImage->GetGeometry()->GetOrigin(), mitk::eps, true));
+
+    mitk::ImageReadAccessor readAccess(subImage);
+    const short *data = static_cast<const short *>(readAccess.GetData());
+    for (unsigned int z = 0; z < 2; ++z)
+      for (unsigned int y = 0; y < 7; ++y)
+        for (unsigned int x = 0; x < 6; ++x)
+        {
+          const short expected = static_cast<short>((x + 3) + (y + 4) * size[0] + (z + 5) * size[0] * size[1]);
+          CPPUNIT_ASSERT_EQUAL(expected, data[x + y * 6 + z * 6 * 7]);
+        }
+
+    // a size of 0 reads up to the end of the image
+    ioRegion.SetSize(2, 0);
+    mitk::Image::Pointer remainingImage = mitk::IOUtil::LoadImage(fileName, ioRegion);
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(size[2] - 5), remainingImage->GetDimension(2));
+    mitk::ImageReadAccessor remainingAccess(remainingImage);
+    const short *remainingData = static_cast<const short *>(remainingAccess.GetData());
+    const short expectedLast = static_cast<short>((5 + 3) + (6 + 4) * size[0] + (size[2] - 1) * size[0] * size[1]);
+    CPPUNIT_ASSERT_EQUAL(expectedLast, remainingData[5 + 6 * 6 + (size[2] - 6) * 6 * 7]);
+
+    std::remove(fileName.c_str());
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkItkImageIO)
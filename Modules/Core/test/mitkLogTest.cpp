@@ -22,6 +22,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkNumericTypes.h>
 #include <mitkStandardFileLocations.h>
 
+#include <atomic>
+#include <thread>
+
 /** Documentation
  *
  * @brief this class provides an accessible BackendCout to determine whether this backend was
@@ -47,6 +50,33 @@ public:
 private:
   bool m_Called;
 };
+/** Documentation
+ *
+ * @brief this backend counts the processed messages. While it is blocked, the processing of a message
+ * does not return, so that the buffer of the asynchronous mode fills up.
+ * It is needed for the asynchronous mode test.
+ */
+class TestBackendCounter : public mbilog::BackendBase
+{
+public:
+  TestBackendCounter() : m_Count(0), m_Blocked(false), m_Waiting(false) {}
+
+  void ProcessMessage(const mbilog::LogMessage &) override
+  {
+    m_Waiting = m_Blocked.load();
+    while (m_Blocked)
+      std::this_thread::yield();
+    m_Waiting = false;
+    ++m_Count;
+  }
+
+  mbilog::OutputType GetOutputType() const override { return mbilog::Other; }
+
+  std::atomic<unsigned int> m_Count;
+  std::atomic<bool> m_Blocked;
+  std::atomic<bool> m_Waiting;
+};
+
 /** Documentation
   *
   * @brief Objects of this class can start an internal thread by calling the Start() method.
@@ -292,6 +322,55 @@ public:
     mbilog::UnregisterBackend(&myCoutBackend);
     MITK_TEST_CONDITION_REQUIRED(success, "Test disable / enable logging backends.")
   }
+
+  static void TestAsynchronousMode()
+  {
+    TestBackendCounter counter;
+    mbilog::RegisterBackend(&counter);
+    mbilog::DisableBackends(mbilog::Console);
+
+    // the buffer is much smaller than the number of messages, so that the emitting threads have to wait
+    mbilog::EnableAsynchronousMode(16, mbilog::Block);
+    MITK_TEST_CONDITION_REQUIRED(mbilog::IsAsynchronousModeEnabled(), "Test enable asynchronous mode.");
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+      threads.push_back(std::thread([]() {
+        for (int j = 0; j < 250; ++j)
+          MITK_INFO << "Asynchronous message " << j;
+      }));
+    }
+    for (auto &thread : threads)
+      thread.join();
+    mbilog::FlushBackends();
+    MITK_TEST_CONDITION_REQUIRED(counter.m_Count == 1000, "Test no message is lost in asynchronous mode.");
+    MITK_TEST_CONDITION_REQUIRED(mbilog::GetNumberOfDroppedMessages() == 0, "Test no message is dropped.");
+
+    // one message is held by the blocked backend, the next 16 messages fill the buffer
+    mbilog::EnableAsynchronousMode(16, mbilog::Drop);
+    counter.m_Count = 0;
+    counter.m_Blocked = true;
+    MITK_INFO << "Blocking message";
+    while (!counter.m_Waiting)
+      std::this_thread::yield();
+    for (int j = 0; j < 100; ++j)
+      MITK_INFO << "Dropped message " << j;
+    MITK_TEST_CONDITION_REQUIRED(mbilog::GetNumberOfDroppedMessages() == 100 - 16,
+                                 "Test messages are dropped if the buffer is full.");
+    counter.m_Blocked = false;
+    mbilog::FlushBackends();
+    MITK_TEST_CONDITION_REQUIRED(counter.m_Count >= 1 + 16, "Test buffered messages are distributed.");
+
+    mbilog::DisableAsynchronousMode();
+    MITK_TEST_CONDITION_REQUIRED(!mbilog::IsAsynchronousModeEnabled(), "Test disable asynchronous mode.");
+    counter.m_Count = 0;
+    MITK_INFO << "Synchronous message";
+    MITK_TEST_CONDITION_REQUIRED(counter.m_Count == 1, "Test messages are distributed immediately again.");
+
+    mbilog::EnableBackends(mbilog::Console);
+    mbilog::UnregisterBackend(&counter);
+  }
 };
 
 int mitkLogTest(int /* argc */, char * /*argv*/ [])
@@ -309,6 +388,7 @@ int mitkLogTest(int /* argc */, char * /*argv*/ [])
   mitkLogTestClass::TestThreadSaveLog(false); // false = to console
   mitkLogTestClass::TestThreadSaveLog(true);  // true = to file
   mitkLogTestClass::TestEnableDisableBackends();
+  mitkLogTestClass::TestAsynchronousMode();
   // TODO actually test file somehow?
 
   // always end with this!
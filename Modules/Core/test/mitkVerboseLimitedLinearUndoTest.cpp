@@ -36,6 +36,20 @@ namespace mitk
     TestOperation(OperationType operationType) : Operation(operationType) { g_GlobalCounter++; };
     virtual ~TestOperation() { g_GlobalCounter--; };
   };
+
+  /**
+  * @brief Operation holding some bytes of data, which can be moved to disk
+  **/
+  class MemoryTestOperation : public Operation
+  {
+  public:
+    MemoryTestOperation(std::size_t bytes) : Operation(OpTEST), m_Bytes(bytes), m_OnDisk(false) {}
+    virtual std::size_t GetMemoryUsage() const override { return m_OnDisk ? 0 : m_Bytes; }
+    virtual void MoveDataToDisk() override { m_OnDisk = true; }
+  private:
+    std::size_t m_Bytes;
+    bool m_OnDisk;
+  };
 } // namespace
 
 /**
@@ -130,6 +144,28 @@ int mitkVerboseLimitedLinearUndoTest(int /* argc */, char * /*argv*/ [])
   // static singleton
   MITK_TEST_CONDITION_REQUIRED(g_GlobalCounter == 4, "checking singleton UndoModel");
 
+  // the oldest items move their data to disk if the memory budget is exceeded
+  mitk::VerboseLimitedLinearUndo::Pointer budgetUndo = mitk::VerboseLimitedLinearUndo::New();
+  budgetUndo->SetMemoryBudget(1000);
+  for (int i = 0; i < 3; i++)
+  {
+    mitk::OperationEvent *operationEvent = new mitk::OperationEvent(
+      nullptr, new mitk::MemoryTestOperation(300), new mitk::MemoryTestOperation(300), "Test");
+    budgetUndo->SetOperationEvent(operationEvent);
+    mitk::OperationEvent::IncCurrObjectEventId();
+  }
+  MITK_TEST_CONDITION_REQUIRED(budgetUndo->GetMemoryUsage() == 600, "checking memory usage within budget");
+
+  mitk::LimitedLinearUndo::StackMemoryUsage undoMemoryUsage = budgetUndo->GetUndoMemoryUsage();
+  MITK_TEST_CONDITION_REQUIRED(undoMemoryUsage.size() == 3, "checking memory usage of each item");
+  MITK_TEST_CONDITION_REQUIRED(undoMemoryUsage[0].second == 600 && undoMemoryUsage[1].second == 0 &&
+                                 undoMemoryUsage[2].second == 0,
+                               "checking that the oldest items moved to disk");
+
+  budgetUndo->Undo();
+  MITK_TEST_CONDITION_REQUIRED(budgetUndo->GetRedoMemoryUsage().size() == 1 && budgetUndo->GetMemoryUsage() == 600,
+                               "checking memory usage of the redo list");
+
   // always end with this!
   MITK_TEST_END()
   // operations will be deleted after terminating the application
@@ -0,0 +1,172 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+// std includes
+#include <iostream>
+#include <string>
+
+// CTK includes
+#include "mitkCommandLineParser.h"
+
+// MITK includes
+#include <mitkDICOMDCMTKTagScanner.h>
+#include <mitkDICOMGDCMTagScanner.h>
+#include <mitkDICOMITKSeriesGDCMReader.h>
+
+// ITK includes
+#include <itkTimeProbe.h>
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
+
+/** \brief Scans all files of a directory once and reports the throughput in files per second. */
+void RunScan(mitk::DICOMTagScanner* scanner, const std::string& name, const mitk::StringList& files, unsigned int threads)
+{
+  mitk::DICOMITKSeriesGDCMReader::Pointer reader = mitk::DICOMITKSeriesGDCMReader::New();
+  scanner->AddTagPaths(reader->GetTagsOfInterest());
+  scanner->SetInputFiles(files);
+  scanner->SetNumberOfScanThreads(threads);
+
+  itk::TimeProbe clock;
+  clock.Start();
+  scanner->Scan();
+  clock.Stop();
+
+  const double seconds = clock.GetTotal();
+  std::cout << name << " (" << (threads == 0 ? std::string("all") : std::to_string(threads)) << " threads): "
+            << scanner->GetFrameInfoList().size() << " of " << files.size() << " files in " << seconds << " s, "
+            << (seconds > 0 ? files.size() / seconds : 0) << " files/s" << std::endl;
+}
+
+/** \brief Measures the tag scanning throughput of DICOMGDCMTagScanner and DICOMDCMTKTagScanner.
+ *
+ * All files of the input directory are scanned for the tags required by DICOMITKSeriesGDCMReader,
+ * once sequentially and once with the requested number of threads. The persistent tag scan cache
+ * is switched off, so every run parses all headers.
+ */
+int main(int argc, char *argv[])
+{
+  mitkCommandLineParser parser;
+
+  parser.setCategory("DICOM");
+  parser.setTitle("DICOM Tag Scanner Benchmark");
+  parser.setDescription("Measures the throughput of the DICOM tag scanners in files per second.");
+  parser.setContributor("MBI");
+
+  parser.setArgumentPrefix("--", "-");
+  parser.beginGroup("Required I/O parameters");
+  parser.addArgument(
+    "input", "i", mitkCommandLineParser::InputDirectory, "Input directory", "directory of DICOM files", us::Any(), false);
+  parser.endGroup();
+
+  parser.beginGroup("Optional parameters");
+  parser.addArgument(
+    "threads", "t", mitkCommandLineParser::Int, "Threads", "number of scan threads (default 0: one per processor)");
+  parser.addArgument(
+    "scanner", "s", mitkCommandLineParser::String, "Scanner", "gdcm, dcmtk or both (default both)");
+  parser.endGroup();
+
+  std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+
+  if (parsedArgs.size() == 0)
+    return EXIT_FAILURE;
+
+  std::string inputDirectory = us::any_cast<std::string>(parsedArgs["input"]);
+
+  int threads = 0;
+  if (parsedArgs.count("threads"))
+  {
+    threads = us::any_cast<int>(parsedArgs["threads"]);
+  }
+
+  std::string scannerType = "both";
+  if (parsedArgs.count("scanner"))
+  {
+    scannerType = us::any_cast<std::string>(parsedArgs["scanner"]);
+  }
+
+  if (threads < 0 || (scannerType != "gdcm" && scannerType != "dcmtk" && scannerType != "both"))
+  {
+    MITK_ERROR << "Invalid arguments!";
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    itksys::Directory directory;
+    if (!directory.Load(inputDirectory.c_str()))
+    {
+      MITK_ERROR << "Cannot list directory " << inputDirectory;
+      return EXIT_FAILURE;
+    }
+
+    mitk::StringList files;
+    for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i)
+    {
+      std::string file = inputDirectory + "/" + directory.GetFile(i);
+      if (!itksys::SystemTools::FileIsDirectory(file.c_str()))
+      {
+        files.push_back(file);
+      }
+    }
+
+    std::cout << "Scanning " << files.size() << " files" << std::endl;
+
+    // the files are scanned once before measuring, so that all runs find them in the file system cache
+    mitk::DICOMGDCMTagScanner::Pointer warmUp = mitk::DICOMGDCMTagScanner::New();
+    warmUp->SetPersistentCacheDirectory("");
+    warmUp->SetInputFiles(files);
+    warmUp->Scan();
+
+    for (const unsigned int runThreads : { 1u, static_cast<unsigned int>(threads) })
+    {
+      if (scannerType != "dcmtk")
+      {
+        mitk::DICOMGDCMTagScanner::Pointer scanner = mitk::DICOMGDCMTagScanner::New();
+        scanner->SetPersistentCacheDirectory("");
+        RunScan(scanner, "DICOMGDCMTagScanner", files, runThreads);
+      }
+
+      if (scannerType != "gdcm")
+      {
+        mitk::DICOMDCMTKTagScanner::Pointer scanner = mitk::DICOMDCMTKTagScanner::New();
+        scanner->SetPersistentCacheDirectory("");
+        RunScan(scanner, "DICOMDCMTKTagScanner", files, runThreads);
+      }
+
+      if (threads == 1)
+      {
+        break;
+      }
+    }
+
+    return EXIT_SUCCESS;
+  }
+  catch (itk::ExceptionObject e)
+  {
+    MITK_ERROR << e;
+    return EXIT_FAILURE;
+  }
+  catch (std::exception e)
+  {
+    MITK_ERROR << e.what();
+    return EXIT_FAILURE;
+  }
+  catch (...)
+  {
+    MITK_ERROR << "Unexpected error encountered.";
+    return EXIT_FAILURE;
+  }
+}
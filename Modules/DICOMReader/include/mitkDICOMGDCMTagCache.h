@@ -19,7 +19,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMTagCache.h"
 
+#include <list>
+#include <map>
 #include <set>
+#include <vector>
 #include <memory>
 
 #include <gdcmScanner.h>
@@ -47,6 +50,22 @@ namespace mitk
 
       void InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles);
 
+      /** \brief Tag values of files that have not been scanned by the gdcm::Scanner, e.g. from DICOMTagScanIndex. */
+      typedef std::map<std::string, std::map<DICOMTag, std::string>> FileTagValuesType;
+
+      /**
+        \brief Like InitCache() above, but files contained in cachedValues are taken from there instead of the scanner.
+      */
+      void InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles, const FileTagValuesType& cachedValues);
+
+      typedef std::vector<std::shared_ptr<gdcm::Scanner>> ScannerListType;
+
+      /**
+        \brief Like InitCache() above, for input files that have been split between several scanners.
+        The first scanner is the one returned by GetScanner().
+      */
+      void InitCache(const std::set<DICOMTag>& scannedTags, const ScannerListType& scanners, const StringList& inputFiles, const FileTagValuesType& cachedValues);
+
       const gdcm::Scanner& GetScanner() const;
 
   protected:
@@ -58,8 +77,14 @@ namespace mitk
 
       std::shared_ptr<gdcm::Scanner> m_Scanner;
 
+      /// \brief Scanners of further file partitions, see DICOMGDCMTagScanner::Scan().
+      ScannerListType m_PartitionScanners;
+
       DICOMDatasetAccessingImageFrameList m_ScanResult;
 
+      /// \brief Owns the values of cached files, the frame infos only refer to them like to the scanner values.
+      std::list<std::string> m_CachedValues;
+
     private:
       DICOMGDCMTagCache(const DICOMGDCMTagCache&);
   };
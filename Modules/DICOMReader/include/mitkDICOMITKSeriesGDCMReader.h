@@ -209,9 +209,19 @@ class MITKDICOMREADER_EXPORT DICOMITKSeriesGDCMReader : public DICOMFileReader
     // void AllocateOutputImages();
     /**
       \brief Loads images using itk::ImageSeriesReader, potentially applies shearing to correct gantry tilt.
+
+      Blocks are independent of each other and are decoded concurrently (see SetNumberOfLoadingThreads()).
+      Outputs keep their order and properties, the result is identical to loading them one after another.
     */
     virtual bool LoadImages() override;
 
+    /**
+      \brief Maximum number of image blocks that LoadImages() decodes at the same time.
+      0 (default) uses one thread per processor, 1 loads all blocks sequentially.
+    */
+    void SetNumberOfLoadingThreads(unsigned int threads);
+    unsigned int GetNumberOfLoadingThreads() const;
+
     // re-implemented from super-class
     virtual bool CanHandleFile(const std::string& filename) override;
 
@@ -336,6 +346,8 @@ class MITKDICOMREADER_EXPORT DICOMITKSeriesGDCMReader : public DICOMFileReader
 
     DICOMTagCache::Pointer m_TagCache;
     bool m_ExternalCache;
+
+    unsigned int m_NumberOfLoadingThreads;
 };
 
 }
@@ -0,0 +1,123 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkDICOMTagScanIndex_h
+#define mitkDICOMTagScanIndex_h
+
+#include "mitkDICOMTagPath.h"
+#include "mitkDICOMEnums.h"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <MitkDICOMReaderExports.h>
+
+namespace mitk
+{
+
+  /**
+    \ingroup DICOMReaderModule
+    \brief Persistent on-disk storage of tag scan results, used by the DICOMTagScanner implementations.
+
+    For every directory that contains scanned files, one compact binary index file per scanner
+    is kept in a cache directory. The scanners normalize tag values differently, so an index
+    only answers lookups of the scanner that wrote it. An entry of the index stores the size and modification time of
+    a file together with the findings of every tag path that has been scanned in it.
+    A file is only rescanned if it changed or if tags are requested that have not been
+    scanned before.
+
+    Typical usage:
+     - Load() the index files of all input files
+     - Lookup() every file, scan only those that are not found
+     - Update() the index with the new scan results
+     - Save() the changed index files
+
+    @remark Modification times have a resolution of one second. A file that is replaced
+    by another one of the same size within that second is not detected as changed.
+  */
+  class MITKDICOMREADER_EXPORT DICOMTagScanIndex
+  {
+    public:
+
+      /** \brief Explicit tag paths and their values found for one scanned tag path. Empty if the file does not contain the tag. */
+      typedef std::vector<std::pair<DICOMTagPath, std::string>> FindingsType;
+      /** \brief All findings of one file, by scanned (possibly wild carded) tag path. */
+      typedef std::map<DICOMTagPath, FindingsType> FileFindingsType;
+
+      /**
+        \param cacheDirectory directory of the index files
+        \param scannerName identifies the scanner and its value format, e.g. the class name of the scanner
+      */
+      DICOMTagScanIndex(const std::string& cacheDirectory, const std::string& scannerName);
+
+      /**
+        \brief Reads the index files of all directories that contain one of the passed files.
+        Missing or invalid index files are ignored.
+      */
+      void Load(const StringList& filenames);
+
+      /**
+        \brief Retrieve the cached findings of a file.
+        \return false if the file is unknown, has changed since it was scanned or misses one of the requested tag paths.
+      */
+      bool Lookup(const std::string& filename, const std::set<DICOMTagPath>& requestedPaths, FileFindingsType& findings) const;
+
+      /**
+        \brief Stores the findings of a freshly scanned file.
+        Findings of other tag paths are kept as long as the file did not change.
+      */
+      void Update(const std::string& filename, const FileFindingsType& findings);
+
+      /**
+        \brief Writes all index files that have been changed by Update().
+        Errors are reported as warnings only, the index is an optimization.
+      */
+      void Save();
+
+    private:
+
+      struct FileEntry
+      {
+        unsigned long long size = 0;
+        long long modificationTime = 0;
+        FileFindingsType findings;
+      };
+
+      typedef std::map<std::string, FileEntry> DirectoryIndexType;
+
+      struct DirectoryIndex
+      {
+        DirectoryIndexType entries;
+        bool modified = false;
+      };
+
+      static bool GetFileStamp(const std::string& filename, unsigned long long& size, long long& modificationTime);
+
+      std::string GetIndexFilename(const std::string& directory) const;
+
+      bool ReadIndexFile(const std::string& directory, DirectoryIndexType& entries) const;
+      bool WriteIndexFile(const std::string& directory, const DirectoryIndexType& entries) const;
+
+      std::string m_CacheDirectory;
+      std::string m_ScannerName;
+
+      std::map<std::string, DirectoryIndex> m_Directories;
+  };
+}
+
+#endif
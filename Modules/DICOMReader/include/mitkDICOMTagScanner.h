@@ -90,6 +90,29 @@ namespace mitk
       */
       virtual DICOMTagCache::Pointer GetScanCache() const = 0;
 
+      /**
+      \brief Directory for the persistent tag scan cache (see DICOMTagScanIndex).
+      If set, Scan() only parses files that changed or have not been scanned for the requested tags before.
+      An empty string (default) disables the persistent cache.
+      */
+      void SetPersistentCacheDirectory(const std::string& directory);
+      std::string GetPersistentCacheDirectory() const;
+
+      /**
+      \brief Initial persistent cache directory of all scanners created afterwards.
+      Scanners are created internally by readers and reader services, this switches
+      the persistent cache on for all of them.
+      */
+      static void SetDefaultPersistentCacheDirectory(const std::string& directory);
+      static std::string GetDefaultPersistentCacheDirectory();
+
+      /**
+      \brief Maximum number of threads that parse file headers in Scan().
+      0 (default) uses one thread per processor, 1 scans all files sequentially.
+      */
+      void SetNumberOfScanThreads(unsigned int threads);
+      unsigned int GetNumberOfScanThreads() const;
+
     protected:
 
       /** \brief Return active C locale */
@@ -105,6 +128,9 @@ namespace mitk
       */
       void PopLocale() const;
 
+      /** \brief Number of threads Scan() should use for the given number of files, see SetNumberOfScanThreads(). */
+      unsigned int GetNumberOfScanThreadsForFiles(size_t numberOfFiles) const;
+
       DICOMTagScanner();
       virtual ~DICOMTagScanner();
 
@@ -112,6 +138,13 @@ namespace mitk
 
       static itk::MutexLock::Pointer s_LocaleMutex;
 
+      static itk::MutexLock::Pointer s_DefaultPersistentCacheDirectoryMutex;
+      static std::string s_DefaultPersistentCacheDirectory;
+
+      std::string m_PersistentCacheDirectory;
+
+      unsigned int m_NumberOfScanThreads;
+
       mutable std::stack<std::string> m_ReplacedCLocales;
       mutable std::stack<std::locale> m_ReplacedCinLocales;
 
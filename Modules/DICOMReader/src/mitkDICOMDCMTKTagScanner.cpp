@@ -16,10 +16,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMDCMTKTagScanner.h"
 #include "mitkDICOMGenericImageFrameInfo.h"
+#include "mitkDICOMTagScanIndex.h"
 
 #include <dcfilefo.h>
 #include <dcpath.h>
 
+#include <exception>
+#include <vector>
+
 mitk::DICOMDCMTKTagScanner::DICOMDCMTKTagScanner()
 {
 }
@@ -102,63 +106,146 @@ mitk::DICOMTagPath DcmPathToTagPath(DcmPath * dcmpath)
   return result;
 }
 
+namespace
+{
+  /** Parses the header of one file and collects the findings of all passed tag paths. */
+  bool ScanFileForTagPaths(const std::string& fileName, const std::set<mitk::DICOMTagPath>& scannedTags, mitk::DICOMTagScanIndex::FileFindingsType& fileFindings)
+  {
+    DcmFileFormat dfile;
+    OFCondition cond = dfile.loadFile(fileName.c_str());
+    if (cond.bad())
+    {
+      MITK_ERROR << "Error when scanning for tags. Cannot open given file. File: " << fileName;
+      return false;
+    }
+
+    DcmPathProcessor processor;
+    processor.setItemWildcardSupport(true);
+
+    fileFindings.clear();
+    for (const auto& path : scannedTags)
+    {
+      mitk::DICOMTagScanIndex::FindingsType& pathFindings = fileFindings[path];
+
+      std::string tagPath = DICOMTagPathToDCMTKSearchPath(path);
+      cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
+      if (cond.good())
+      {
+        OFList< DcmPath * > findings;
+        processor.getResults(findings);
+        for (const auto& finding : findings)
+        {
+          auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
+          if (!element)
+          {
+            auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
+            if (item)
+            {
+              element = item->getElement(finding->back()->m_itemNo);
+            }
+          }
+
+          if (element)
+          {
+            OFString value;
+            cond = element->getOFStringArray(value);
+            if (cond.good())
+            {
+              pathFindings.push_back(std::make_pair(DcmPathToTagPath(finding), std::string(value.c_str())));
+            }
+          }
+        }
+      }
+    }
+
+    return true;
+  }
+}
+
 void mitk::DICOMDCMTKTagScanner::Scan()
 {
   this->PushLocale();
 
   try
   {
-    DcmPathProcessor processor;
-    processor.setItemWildcardSupport(true);
+    const std::string persistentCacheDirectory = this->GetPersistentCacheDirectory();
+    DICOMTagScanIndex index(persistentCacheDirectory, this->GetNameOfClass());
 
-    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+    const int numberOfFiles = static_cast<int>(this->m_InputFilenames.size());
+    std::vector<DICOMTagScanIndex::FileFindingsType> fileFindings(numberOfFiles);
+    // char instead of bool: std::vector<bool> packs its elements, concurrent writes would race
+    std::vector<char> fromIndex(numberOfFiles, 0);
+    std::vector<char> scanned(numberOfFiles, 0);
 
-    for (const auto& fileName : this->m_InputFilenames)
+    if (!persistentCacheDirectory.empty())
     {
-      DcmFileFormat dfile;
-      OFCondition cond = dfile.loadFile(fileName.c_str());
-      if (cond.bad())
+      index.Load(this->m_InputFilenames);
+      for (int i = 0; i < numberOfFiles; ++i)
       {
-        MITK_ERROR << "Error when scanning for tags. Cannot open given file. File: " << fileName;
+        fromIndex[i] = index.Lookup(this->m_InputFilenames[i], this->m_ScannedTags, fileFindings[i]);
       }
-      else
+    }
+
+    // header parsing is independent for every file, the results are merged in input order below
+    std::exception_ptr scanException;
+#ifdef _OPENMP
+    const int numberOfThreads = static_cast<int>(this->GetNumberOfScanThreadsForFiles(this->m_InputFilenames.size()));
+#endif
+#pragma omp parallel for schedule(dynamic, 8) num_threads(numberOfThreads)
+    for (int i = 0; i < numberOfFiles; ++i)
+    {
+      if (fromIndex[i])
       {
-        DICOMGenericImageFrameInfo::Pointer info = DICOMGenericImageFrameInfo::New(fileName);
+        continue;
+      }
 
-        for (const auto& path : this->m_ScannedTags)
+      try
+      {
+        scanned[i] = ScanFileForTagPaths(this->m_InputFilenames[i], this->m_ScannedTags, fileFindings[i]);
+      }
+      catch (...)
+      {
+#pragma omp critical(DICOMDCMTKTagScannerScan)
+        if (!scanException)
         {
-          std::string tagPath = DICOMTagPathToDCMTKSearchPath(path);
-          cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
-          if (cond.good())
-          {
-            OFList< DcmPath * > findings;
-            processor.getResults(findings);
-            for (const auto& finding : findings)
-            {
-              auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
-              if (!element)
-              {
-                auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
-                if (item)
-                {
-                  element = item->getElement(finding->back()->m_itemNo);
-                }
-              }
-
-              if (element)
-              {
-                OFString value;
-                cond = element->getOFStringArray(value);
-                if (cond.good())
-                {
-                  info->SetTagValue(DcmPathToTagPath(finding), std::string(value.c_str()));
-                }
-              }
-            }
-          }
+          scanException = std::current_exception();
+        }
+      }
+    }
+
+    if (scanException)
+    {
+      std::rethrow_exception(scanException);
+    }
+
+    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+
+    for (int i = 0; i < numberOfFiles; ++i)
+    {
+      if (!fromIndex[i] && !scanned[i])
+      {
+        continue;
+      }
+
+      DICOMGenericImageFrameInfo::Pointer info = DICOMGenericImageFrameInfo::New(this->m_InputFilenames[i]);
+      for (const auto& pathFindings : fileFindings[i])
+      {
+        for (const auto& finding : pathFindings.second)
+        {
+          info->SetTagValue(finding.first, finding.second);
         }
-        newCache->AddFrameInfo(info);
       }
+      newCache->AddFrameInfo(info);
+
+      if (scanned[i] && !persistentCacheDirectory.empty())
+      {
+        index.Update(this->m_InputFilenames[i], fileFindings[i]);
+      }
+    }
+
+    if (!persistentCacheDirectory.empty())
+    {
+      index.Save();
     }
 
     m_Cache = newCache;
@@ -87,17 +87,58 @@ mitk::DICOMDatasetAccessingImageFrameList mitk::DICOMGDCMTagCache::GetFrameInfoL
 void
 mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles)
 {
+  this->InitCache(scannedTags, scanner, inputFiles, FileTagValuesType());
+}
+
+void
+mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles, const FileTagValuesType& cachedValues)
+{
+  this->InitCache(scannedTags, ScannerListType(1, scanner), inputFiles, cachedValues);
+}
+
+void
+mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const ScannerListType& scanners, const StringList& inputFiles, const FileTagValuesType& cachedValues)
+{
+  assert(!scanners.empty());
+
   m_ScannedTags = scannedTags;
   m_InputFilenames = inputFiles;
-  m_Scanner = scanner;
+  m_Scanner = scanners.front();
+  m_PartitionScanners.assign(scanners.begin() + 1, scanners.end());
 
   m_ScanResult.clear();
   m_ScanResult.reserve(m_InputFilenames.size());
+  m_CachedValues.clear();
 
   for (auto inputIter = m_InputFilenames.cbegin(); inputIter != m_InputFilenames.cend(); ++inputIter)
   {
+    const auto cachedIter = cachedValues.find(*inputIter);
+    if (cachedIter != cachedValues.cend())
+    {
+      gdcm::Scanner::TagToValue mapping;
+      for (const auto& tagValue : cachedIter->second)
+      {
+        m_CachedValues.push_back(tagValue.second);
+        mapping[gdcm::Tag(tagValue.first.GetGroup(), tagValue.first.GetElement())] = m_CachedValues.back().c_str();
+      }
+
+      m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(*inputIter, 0), mapping).GetPointer());
+      continue;
+    }
+
+    // unknown files get the (empty) mapping of the first scanner, as before partitioning
+    const gdcm::Scanner* scanner = m_Scanner.get();
+    for (const auto& partitionScanner : m_PartitionScanners)
+    {
+      if (partitionScanner->IsKey(inputIter->c_str()))
+      {
+        scanner = partitionScanner.get();
+        break;
+      }
+    }
+
     m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(*inputIter, 0),
-      m_Scanner->GetMapping(inputIter->c_str())).GetPointer());
+      scanner->GetMapping(inputIter->c_str())).GetPointer());
   }
 }
 
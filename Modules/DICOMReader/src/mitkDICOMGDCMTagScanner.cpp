@@ -17,9 +17,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMGDCMTagScanner.h"
 #include "mitkDICOMGDCMTagCache.h"
 #include "mitkDICOMGDCMImageFrameInfo.h"
+#include "mitkDICOMTagScanIndex.h"
 
 #include <gdcmScanner.h>
 
+#include <vector>
+
 mitk::DICOMGDCMTagScanner::DICOMGDCMTagScanner()
 {
   m_GDCMScanner = std::make_shared<gdcm::Scanner>();
@@ -96,11 +99,110 @@ void mitk::DICOMGDCMTagScanner::SetInputFiles( const StringList& filenames )
 
 void mitk::DICOMGDCMTagScanner::Scan()
 {
+  const std::string persistentCacheDirectory = this->GetPersistentCacheDirectory();
+
+  std::set<DICOMTagPath> requestedPaths;
+  for (const auto& tag : m_ScannedTags)
+  {
+    requestedPaths.insert(DICOMTagPath(tag));
+  }
+
+  DICOMTagScanIndex index(persistentCacheDirectory, this->GetNameOfClass());
+  DICOMGDCMTagCache::FileTagValuesType cachedValues;
+  StringList filesToScan;
+  DICOMTagScanIndex::FileFindingsType findings;
+
+  if (persistentCacheDirectory.empty())
+  {
+    filesToScan = m_InputFilenames;
+  }
+  else
+  {
+    index.Load(m_InputFilenames);
+
+    for (const auto& filename : m_InputFilenames)
+    {
+      if (index.Lookup(filename, requestedPaths, findings))
+      {
+        auto& values = cachedValues[filename];
+        for (const auto& pathFindings : findings)
+        {
+          if (!pathFindings.second.empty())
+          {
+            values[pathFindings.first.GetFirstNode().tag] = pathFindings.second.front().second;
+          }
+        }
+      }
+      else
+      {
+        filesToScan.push_back(filename);
+      }
+    }
+  }
+
+  // Header parsing is independent for every file. gdcm::Scanner works on one thread, so the
+  // files are split into partitions that are scanned by scanners of their own.
+  std::vector<StringList> partitions(this->GetNumberOfScanThreadsForFiles(filesToScan.size()));
+  for (size_t p = 0; p < partitions.size(); ++p)
+  {
+    partitions[p].assign(filesToScan.cbegin() + p * filesToScan.size() / partitions.size(),
+                         filesToScan.cbegin() + (p + 1) * filesToScan.size() / partitions.size());
+  }
+
+  DICOMGDCMTagCache::ScannerListType scanners(1, m_GDCMScanner);
+  for (size_t p = 1; p < partitions.size(); ++p)
+  {
+    auto scanner = std::make_shared<gdcm::Scanner>();
+    for (const auto& tag : m_ScannedTags)
+    {
+      scanner->AddTag(gdcm::Tag(tag.GetGroup(), tag.GetElement()));
+    }
+    scanners.push_back(scanner);
+  }
+
   // TODO integrate push/pop locale??
-  m_GDCMScanner->Scan( m_InputFilenames );
+  const int numberOfPartitions = static_cast<int>(partitions.size());
+#pragma omp parallel for schedule(static, 1) num_threads(numberOfPartitions)
+  for (int p = 0; p < numberOfPartitions; ++p)
+  {
+    scanners[p]->Scan(partitions[p]);
+  }
+
+  if (!persistentCacheDirectory.empty())
+  {
+    for (size_t p = 0; p < partitions.size(); ++p)
+    {
+      for (const auto& filename : partitions[p])
+      {
+        if (!scanners[p]->IsKey(filename.c_str()))
+        {
+          continue; // not readable as DICOM, try again next time
+        }
+
+        const gdcm::Scanner::TagToValue& mapping = scanners[p]->GetMapping(filename.c_str());
+
+        findings.clear();
+        for (const auto& path : requestedPaths)
+        {
+          DICOMTagScanIndex::FindingsType& pathFindings = findings[path];
+
+          const DICOMTag& tag = path.GetFirstNode().tag;
+          const auto mappedValue = mapping.find(gdcm::Tag(tag.GetGroup(), tag.GetElement()));
+          if (mappedValue != mapping.cend())
+          {
+            pathFindings.push_back(std::make_pair(path, std::string(mappedValue->second != nullptr ? mappedValue->second : "")));
+          }
+        }
+
+        index.Update(filename, findings);
+      }
+    }
+
+    index.Save();
+  }
 
   DICOMGDCMTagCache::Pointer newCache = DICOMGDCMTagCache::New();
-  newCache->InitCache(m_ScannedTags, m_GDCMScanner, m_InputFilenames);
+  newCache->InitCache(m_ScannedTags, scanners, m_InputFilenames, cachedValues);
 
   m_Cache = newCache;
 }
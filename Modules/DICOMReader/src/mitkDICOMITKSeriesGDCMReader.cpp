@@ -19,6 +19,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkTimeProbesCollectorBase.h>
 #include <gdcmUIDs.h>
+#include <algorithm>
+#include <exception>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "mitkDICOMITKSeriesGDCMReader.h"
 #include "mitkITKDICOMSeriesReaderHelper.h"
 #include "mitkGantryTiltInformation.h"
@@ -33,6 +38,7 @@ mitk::DICOMITKSeriesGDCMReader::DICOMITKSeriesGDCMReader( unsigned int decimalPl
 , m_FixTiltByShearing( true )
 , m_DecimalPlacesForOrientation( decimalPlacesForOrientation )
 , m_ExternalCache(false)
+, m_NumberOfLoadingThreads( 0 )
 {
   this->EnsureMandatorySortersArePresent( decimalPlacesForOrientation );
 }
@@ -50,6 +56,7 @@ mitk::DICOMITKSeriesGDCMReader::DICOMITKSeriesGDCMReader( const DICOMITKSeriesGD
 , m_DecimalPlacesForOrientation( other.m_DecimalPlacesForOrientation )
 , m_TagCache( other.m_TagCache )
 , m_ExternalCache(other.m_ExternalCache)
+, m_NumberOfLoadingThreads( other.m_NumberOfLoadingThreads )
 {
 }
 
@@ -72,6 +79,7 @@ mitk::DICOMITKSeriesGDCMReader& mitk::DICOMITKSeriesGDCMReader::
     this->m_ReplacedCinLocales               = other.m_ReplacedCinLocales;
     this->m_DecimalPlacesForOrientation      = other.m_DecimalPlacesForOrientation;
     this->m_TagCache                         = other.m_TagCache;
+    this->m_NumberOfLoadingThreads           = other.m_NumberOfLoadingThreads;
   }
   return *this;
 }
@@ -122,6 +130,17 @@ bool mitk::DICOMITKSeriesGDCMReader::GetFixTiltByShearing() const
   return m_FixTiltByShearing;
 }
 
+void mitk::DICOMITKSeriesGDCMReader::SetNumberOfLoadingThreads( unsigned int threads )
+{
+  this->Modified();
+  m_NumberOfLoadingThreads = threads;
+}
+
+unsigned int mitk::DICOMITKSeriesGDCMReader::GetNumberOfLoadingThreads() const
+{
+  return m_NumberOfLoadingThreads;
+}
+
 void mitk::DICOMITKSeriesGDCMReader::SetAcceptTwoSlicesGroups( bool accept ) const
 {
   this->Modified();
@@ -420,15 +439,66 @@ mitk::ReaderImplementationLevel
 
 bool mitk::DICOMITKSeriesGDCMReader::LoadImages()
 {
-  bool success = true;
+  const int numberOfOutputs = static_cast<int>( this->GetNumberOfOutputs() );
+  if ( numberOfOutputs == 0 )
+  {
+    return true;
+  }
+
+  // The locale is process-wide: switch it once for the whole batch. The Push/PopLocale() calls of the
+  // individual blocks are serialized by s_LocaleMutex and only stack further "C" entries on top.
+  PushLocale();
 
-  unsigned int numberOfOutputs = this->GetNumberOfOutputs();
-  for ( unsigned int o = 0; o < numberOfOutputs; ++o )
+  // char instead of bool: std::vector<bool> packs its elements, concurrent writes would race
+  std::vector<char> loaded( numberOfOutputs, 0 );
+  std::exception_ptr firstException;
+
+  // The first block is loaded alone, so that lazily initialized singletons of ITK and GDCM
+  // (object factories, DICOM dictionaries) are set up by a single thread.
+  try
   {
-    success &= this->LoadMitkImageForOutput( o );
+    loaded[0] = this->LoadMitkImageForOutput( 0 );
+  }
+  catch ( ... )
+  {
+    firstException = std::current_exception();
   }
 
-  return success;
+#ifdef _OPENMP
+  int numberOfThreads = std::min( std::max( 1, numberOfOutputs - 1 ), omp_get_max_threads() );
+  if ( m_NumberOfLoadingThreads > 0 )
+  {
+    numberOfThreads = std::min( numberOfThreads, static_cast<int>( m_NumberOfLoadingThreads ) );
+  }
+#endif
+
+  // every iteration only touches its own DICOMImageBlockDescriptor
+#pragma omp parallel for schedule( dynamic ) num_threads( numberOfThreads )
+  for ( int o = 1; o < numberOfOutputs; ++o )
+  {
+    try
+    {
+      loaded[o] = this->LoadMitkImageForOutput( o );
+    }
+    catch ( ... )
+    {
+#pragma omp critical( DICOMITKSeriesGDCMReaderLoadImages )
+      if ( !firstException )
+      {
+        firstException = std::current_exception();
+      }
+    }
+  }
+
+  PopLocale();
+
+  // exceptions cannot leave a parallel region, forward them as the sequential loop did
+  if ( firstException )
+  {
+    std::rethrow_exception( firstException );
+  }
+
+  return std::find( loaded.cbegin(), loaded.cend(), 0 ) == loaded.cend();
 }
 
 bool mitk::DICOMITKSeriesGDCMReader::LoadMitkImageForImageBlockDescriptor(
@@ -0,0 +1,408 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDICOMTagScanIndex.h"
+
+#include <mitkLogMacros.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace
+{
+  // "MITKDTSI" followed by the format version and the scanner name
+  const char IndexMagic[8] = { 'M', 'I', 'T', 'K', 'D', 'T', 'S', 'I' };
+  const unsigned int IndexVersion = 2;
+
+  // guards against reading garbage from a damaged index file
+  const unsigned int MaximumStringLength = 1 << 24;
+
+  template <typename T>
+  void WriteValue(std::ostream& stream, T value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool ReadValue(std::istream& stream, T& value)
+  {
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return stream.good();
+  }
+
+  void WriteString(std::ostream& stream, const std::string& value)
+  {
+    WriteValue<unsigned int>(stream, static_cast<unsigned int>(value.size()));
+    stream.write(value.data(), value.size());
+  }
+
+  bool ReadString(std::istream& stream, std::string& value)
+  {
+    unsigned int length = 0;
+    if (!ReadValue(stream, length) || length > MaximumStringLength)
+    {
+      return false;
+    }
+
+    value.resize(length);
+    if (length > 0)
+    {
+      stream.read(&value[0], length);
+    }
+    return stream.good();
+  }
+
+  void WriteTagPath(std::ostream& stream, const mitk::DICOMTagPath& path)
+  {
+    WriteValue<unsigned int>(stream, static_cast<unsigned int>(path.Size()));
+    for (const auto& node : path.GetNodes())
+    {
+      WriteValue<unsigned char>(stream, static_cast<unsigned char>(node.type));
+      WriteValue<unsigned short>(stream, static_cast<unsigned short>(node.tag.GetGroup()));
+      WriteValue<unsigned short>(stream, static_cast<unsigned short>(node.tag.GetElement()));
+      WriteValue<int>(stream, node.selection);
+    }
+  }
+
+  bool ReadTagPath(std::istream& stream, mitk::DICOMTagPath& path)
+  {
+    unsigned int size = 0;
+    if (!ReadValue(stream, size) || size > MaximumStringLength)
+    {
+      return false;
+    }
+
+    path.Reset();
+    for (unsigned int i = 0; i < size; ++i)
+    {
+      unsigned char type = 0;
+      unsigned short group = 0;
+      unsigned short element = 0;
+      int selection = 0;
+      if (!ReadValue(stream, type) || !ReadValue(stream, group) || !ReadValue(stream, element) || !ReadValue(stream, selection))
+      {
+        return false;
+      }
+
+      path.AddNode(mitk::DICOMTagPath::NodeInfo(mitk::DICOMTag(group, element),
+                                                static_cast<mitk::DICOMTagPath::NodeInfo::NodeType>(type),
+                                                selection));
+    }
+    return true;
+  }
+
+  /** Stable 64 bit FNV-1a hash, std::hash is allowed to differ between runs. */
+  unsigned long long HashString(const std::string& value)
+  {
+    unsigned long long hash = 14695981039346656037ull;
+    for (const char c : value)
+    {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  void SplitFilename(const std::string& filename, std::string& directory, std::string& name)
+  {
+    const std::string fullPath = itksys::SystemTools::CollapseFullPath(filename);
+    directory = itksys::SystemTools::GetFilenamePath(fullPath);
+    name = itksys::SystemTools::GetFilenameName(fullPath);
+  }
+}
+
+mitk::DICOMTagScanIndex::DICOMTagScanIndex(const std::string& cacheDirectory, const std::string& scannerName)
+: m_CacheDirectory(cacheDirectory)
+, m_ScannerName(scannerName)
+{
+}
+
+bool mitk::DICOMTagScanIndex::GetFileStamp(const std::string& filename, unsigned long long& size, long long& modificationTime)
+{
+  if (!itksys::SystemTools::FileExists(filename.c_str(), true))
+  {
+    return false;
+  }
+
+  size = itksys::SystemTools::FileLength(filename.c_str());
+  modificationTime = itksys::SystemTools::ModifiedTime(filename.c_str());
+  return true;
+}
+
+std::string mitk::DICOMTagScanIndex::GetIndexFilename(const std::string& directory) const
+{
+  std::ostringstream name;
+  name << m_CacheDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << HashString(directory) << "."
+       << std::setw(16) << HashString(m_ScannerName) << ".v" << std::dec << IndexVersion << ".mitktagindex";
+  return name.str();
+}
+
+void mitk::DICOMTagScanIndex::Load(const StringList& filenames)
+{
+  std::string directory;
+  std::string name;
+
+  for (const auto& filename : filenames)
+  {
+    SplitFilename(filename, directory, name);
+
+    if (m_Directories.find(directory) == m_Directories.end())
+    {
+      DirectoryIndex& index = m_Directories[directory];
+      if (!this->ReadIndexFile(directory, index.entries))
+      {
+        index.entries.clear();
+      }
+    }
+  }
+}
+
+bool mitk::DICOMTagScanIndex::Lookup(const std::string& filename, const std::set<DICOMTagPath>& requestedPaths, FileFindingsType& findings) const
+{
+  std::string directory;
+  std::string name;
+  SplitFilename(filename, directory, name);
+
+  const auto directoryIter = m_Directories.find(directory);
+  if (directoryIter == m_Directories.cend())
+  {
+    return false;
+  }
+
+  const auto entryIter = directoryIter->second.entries.find(name);
+  if (entryIter == directoryIter->second.entries.cend())
+  {
+    return false;
+  }
+
+  const FileEntry& entry = entryIter->second;
+
+  unsigned long long size = 0;
+  long long modificationTime = 0;
+  if (!GetFileStamp(filename, size, modificationTime) || size != entry.size || modificationTime != entry.modificationTime)
+  {
+    return false;
+  }
+
+  findings.clear();
+  for (const auto& path : requestedPaths)
+  {
+    const auto findingsIter = entry.findings.find(path);
+    if (findingsIter == entry.findings.cend())
+    {
+      return false;
+    }
+    findings.insert(*findingsIter);
+  }
+
+  return true;
+}
+
+void mitk::DICOMTagScanIndex::Update(const std::string& filename, const FileFindingsType& findings)
+{
+  unsigned long long size = 0;
+  long long modificationTime = 0;
+  if (!GetFileStamp(filename, size, modificationTime))
+  {
+    return;
+  }
+
+  std::string directory;
+  std::string name;
+  SplitFilename(filename, directory, name);
+
+  auto directoryIter = m_Directories.find(directory);
+  if (directoryIter == m_Directories.end())
+  {
+    directoryIter = m_Directories.insert(std::make_pair(directory, DirectoryIndex())).first;
+  }
+
+  auto inserted = directoryIter->second.entries.insert(std::make_pair(name, FileEntry()));
+  FileEntry& entry = inserted.first->second;
+  if (inserted.second || entry.size != size || entry.modificationTime != modificationTime)
+  {
+    entry.findings.clear();
+    entry.size = size;
+    entry.modificationTime = modificationTime;
+  }
+
+  for (const auto& finding : findings)
+  {
+    entry.findings[finding.first] = finding.second;
+  }
+
+  directoryIter->second.modified = true;
+}
+
+void mitk::DICOMTagScanIndex::Save()
+{
+  if (!m_Directories.empty() && !itksys::SystemTools::MakeDirectory(m_CacheDirectory.c_str()))
+  {
+    MITK_WARN << "Cannot create DICOM tag scan cache directory " << m_CacheDirectory;
+    return;
+  }
+
+  for (auto& directory : m_Directories)
+  {
+    if (directory.second.modified)
+    {
+      if (this->WriteIndexFile(directory.first, directory.second.entries))
+      {
+        directory.second.modified = false;
+      }
+      else
+      {
+        MITK_WARN << "Cannot write DICOM tag scan cache for " << directory.first;
+      }
+    }
+  }
+}
+
+bool mitk::DICOMTagScanIndex::ReadIndexFile(const std::string& directory, DirectoryIndexType& entries) const
+{
+  std::ifstream stream(this->GetIndexFilename(directory).c_str(), std::ios::binary);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+
+  char magic[sizeof(IndexMagic)];
+  stream.read(magic, sizeof(magic));
+  unsigned int version = 0;
+  if (!stream.good() || !std::equal(magic, magic + sizeof(magic), IndexMagic) || !ReadValue(stream, version) ||
+      version != IndexVersion)
+  {
+    return false;
+  }
+
+  // values of other scanners and hash collisions of directory names are detected here
+  std::string scannerName;
+  std::string indexedDirectory;
+  if (!ReadString(stream, scannerName) || scannerName != m_ScannerName || !ReadString(stream, indexedDirectory) ||
+      indexedDirectory != directory)
+  {
+    return false;
+  }
+
+  unsigned int numberOfEntries = 0;
+  if (!ReadValue(stream, numberOfEntries))
+  {
+    return false;
+  }
+
+  for (unsigned int e = 0; e < numberOfEntries; ++e)
+  {
+    std::string name;
+    FileEntry entry;
+    unsigned int numberOfPaths = 0;
+    if (!ReadString(stream, name) || !ReadValue(stream, entry.size) || !ReadValue(stream, entry.modificationTime) ||
+        !ReadValue(stream, numberOfPaths))
+    {
+      return false;
+    }
+
+    for (unsigned int p = 0; p < numberOfPaths; ++p)
+    {
+      DICOMTagPath path;
+      unsigned int numberOfFindings = 0;
+      if (!ReadTagPath(stream, path) || !ReadValue(stream, numberOfFindings) || numberOfFindings > MaximumStringLength)
+      {
+        return false;
+      }
+
+      FindingsType& findings = entry.findings[path];
+      findings.resize(numberOfFindings);
+      for (auto& finding : findings)
+      {
+        if (!ReadTagPath(stream, finding.first) || !ReadString(stream, finding.second))
+        {
+          return false;
+        }
+      }
+    }
+
+    entries[name] = entry;
+  }
+
+  return true;
+}
+
+bool mitk::DICOMTagScanIndex::WriteIndexFile(const std::string& directory, const DirectoryIndexType& entries) const
+{
+  const std::string filename = this->GetIndexFilename(directory);
+
+  // write a temporary file and replace the index afterwards, so that a concurrent or
+  // interrupted writer never leaves a half written index behind
+  std::ostringstream temporaryName;
+  temporaryName << filename << "." << std::hex << std::random_device()() << ".tmp";
+  const std::string temporaryFilename = temporaryName.str();
+
+  {
+    std::ofstream stream(temporaryFilename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+    {
+      return false;
+    }
+
+    stream.write(IndexMagic, sizeof(IndexMagic));
+    WriteValue(stream, IndexVersion);
+    WriteString(stream, m_ScannerName);
+    WriteString(stream, directory);
+
+    WriteValue<unsigned int>(stream, static_cast<unsigned int>(entries.size()));
+    for (const auto& entry : entries)
+    {
+      WriteString(stream, entry.first);
+      WriteValue(stream, entry.second.size);
+      WriteValue(stream, entry.second.modificationTime);
+
+      WriteValue<unsigned int>(stream, static_cast<unsigned int>(entry.second.findings.size()));
+      for (const auto& pathFindings : entry.second.findings)
+      {
+        WriteTagPath(stream, pathFindings.first);
+        WriteValue<unsigned int>(stream, static_cast<unsigned int>(pathFindings.second.size()));
+        for (const auto& finding : pathFindings.second)
+        {
+          WriteTagPath(stream, finding.first);
+          WriteString(stream, finding.second);
+        }
+      }
+    }
+
+    if (!stream.good())
+    {
+      stream.close();
+      std::remove(temporaryFilename.c_str());
+      return false;
+    }
+  }
+
+  // std::rename does not replace existing files on all platforms
+  std::remove(filename.c_str());
+  if (std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+  {
+    std::remove(temporaryFilename.c_str());
+    return false;
+  }
+
+  return true;
+}
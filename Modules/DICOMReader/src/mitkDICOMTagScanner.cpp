@@ -16,9 +16,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMTagScanner.h"
 
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 itk::MutexLock::Pointer mitk::DICOMTagScanner::s_LocaleMutex = itk::MutexLock::New();
 
+itk::MutexLock::Pointer mitk::DICOMTagScanner::s_DefaultPersistentCacheDirectoryMutex = itk::MutexLock::New();
+std::string mitk::DICOMTagScanner::s_DefaultPersistentCacheDirectory;
+
 mitk::DICOMTagScanner::DICOMTagScanner()
+: m_PersistentCacheDirectory(GetDefaultPersistentCacheDirectory())
+, m_NumberOfScanThreads(0)
 {
 }
 
@@ -74,3 +84,64 @@ std::string mitk::DICOMTagScanner::GetActiveLocale()
 {
   return setlocale(LC_NUMERIC, nullptr);
 }
+
+void mitk::DICOMTagScanner::SetPersistentCacheDirectory(const std::string& directory)
+{
+  if (m_PersistentCacheDirectory != directory)
+  {
+    m_PersistentCacheDirectory = directory;
+    this->Modified();
+  }
+}
+
+std::string mitk::DICOMTagScanner::GetPersistentCacheDirectory() const
+{
+  return m_PersistentCacheDirectory;
+}
+
+void mitk::DICOMTagScanner::SetDefaultPersistentCacheDirectory(const std::string& directory)
+{
+  s_DefaultPersistentCacheDirectoryMutex->Lock();
+  s_DefaultPersistentCacheDirectory = directory;
+  s_DefaultPersistentCacheDirectoryMutex->Unlock();
+}
+
+std::string mitk::DICOMTagScanner::GetDefaultPersistentCacheDirectory()
+{
+  s_DefaultPersistentCacheDirectoryMutex->Lock();
+  std::string directory = s_DefaultPersistentCacheDirectory;
+  s_DefaultPersistentCacheDirectoryMutex->Unlock();
+  return directory;
+}
+
+void mitk::DICOMTagScanner::SetNumberOfScanThreads(unsigned int threads)
+{
+  if (m_NumberOfScanThreads != threads)
+  {
+    m_NumberOfScanThreads = threads;
+    this->Modified();
+  }
+}
+
+unsigned int mitk::DICOMTagScanner::GetNumberOfScanThreads() const
+{
+  return m_NumberOfScanThreads;
+}
+
+unsigned int mitk::DICOMTagScanner::GetNumberOfScanThreadsForFiles(size_t numberOfFiles) const
+{
+  // below this number of files per thread, starting the threads costs more than it gains
+  const size_t minimumFilesPerThread = 16;
+
+  size_t numberOfThreads = 1;
+#ifdef _OPENMP
+  numberOfThreads = static_cast<size_t>(omp_get_max_threads());
+#endif
+  if (m_NumberOfScanThreads > 0)
+  {
+    numberOfThreads = std::min<size_t>(numberOfThreads, m_NumberOfScanThreads);
+  }
+
+  numberOfThreads = std::min(numberOfThreads, std::max<size_t>(1, numberOfFiles / minimumFilesPerThread));
+  return static_cast<unsigned int>(numberOfThreads);
+}
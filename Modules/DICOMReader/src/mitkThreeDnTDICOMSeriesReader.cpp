@@ -199,35 +199,15 @@ bool
 mitk::ThreeDnTDICOMSeriesReader
 ::LoadImages()
 {
-  bool success = true;
-
-  unsigned int numberOfOutputs = this->GetNumberOfOutputs();
-  for (unsigned int o = 0; o < numberOfOutputs; ++o)
-  {
-    const DICOMImageBlockDescriptor& block = this->InternalGetOutput(o);
-
-    if (block.GetFlag("3D+t", false))
-    {
-      success &= this->LoadMitkImageForOutput(o);
-    }
-    else
-    {
-      success &= DICOMITKSeriesGDCMReader::LoadMitkImageForOutput(o); // let superclass handle non-3D+t
-    }
-  }
-
-  return success;
+  // 3D+t and plain 3D blocks are told apart in LoadMitkImageForImageBlockDescriptor(),
+  // so the superclass can load all outputs concurrently
+  return DICOMITKSeriesGDCMReader::LoadImages();
 }
 
 bool
 mitk::ThreeDnTDICOMSeriesReader
 ::LoadMitkImageForImageBlockDescriptor(DICOMImageBlockDescriptor& block) const
 {
-  PushLocale();
-  const DICOMImageFrameList& frames = block.GetImageFrameList();
-  const GantryTiltInformation tiltInfo = block.GetTiltInformation();
-  const bool hasTilt = tiltInfo.IsRegularGantryTilt();
-
   const int numberOfTimesteps = block.GetNumberOfTimeSteps();
 
   if (numberOfTimesteps == 1)
@@ -235,6 +215,11 @@ mitk::ThreeDnTDICOMSeriesReader
     return DICOMITKSeriesGDCMReader::LoadMitkImageForImageBlockDescriptor(block);
   }
 
+  PushLocale();
+  const DICOMImageFrameList& frames = block.GetImageFrameList();
+  const GantryTiltInformation tiltInfo = block.GetTiltInformation();
+  const bool hasTilt = tiltInfo.IsRegularGantryTilt();
+
   const int numberOfFramesPerTimestep = block.GetNumberOfFramesPerTimeStep();
 
   ITKDICOMSeriesReaderHelper::StringContainerList filenamesPerTimestep;
@@ -15,12 +15,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkDICOMDCMTKTagScanner.h"
+#include "mitkDICOMGDCMTagScanner.h"
 #include "mitkDICOMFileReaderTestHelper.h"
 
 #include "mitkTestFixture.h"
 #include "mitkTestingMacros.h"
 
 #include "mitkStringProperty.h"
+#include "mitkIOUtil.h"
+
+#include <itksys/SystemTools.hxx>
 
 class mitkDICOMDCMTKTagScannerTestSuite : public mitk::TestFixture
 {
@@ -28,6 +32,7 @@ class mitkDICOMDCMTKTagScannerTestSuite : public mitk::TestFixture
 
   MITK_TEST(DeepScanning);
   MITK_TEST(MultiFileScanning);
+  MITK_TEST(PersistentCacheScanning);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -123,6 +128,92 @@ public:
     CPPUNIT_ASSERT_MESSAGE("Testing value of instance uid finding of frame 3", findings.front().value == "1.2.276.0.99.1.4.8323329.3795.1303917947.940055");
   }
 
+  void PersistentCacheScanning()
+  {
+    mitk::DICOMTagPath instanceUID(0x0008, 0x0018);
+    mitk::DICOMTagPath planUIDPath;
+    planUIDPath.AddAnySelection(0x300C, 0x0002).AddElement(0x0008, 0x1155);
+
+    mitk::StringList files = ctFiles;
+    files.push_back(doseFiles.front());
+
+    std::string cacheDirectory = mitk::IOUtil::CreateTemporaryDirectory("DICOMTagScanIndexTest-XXXXXX");
+    scanner->SetPersistentCacheDirectory(cacheDirectory);
+    scanner->SetInputFiles(files);
+    scanner->AddTagPath(instanceUID);
+    scanner->AddTagPath(planUIDPath);
+    scanner->Scan();
+
+    mitk::DICOMDatasetAccessingImageFrameList frames = scanner->GetFrameInfoList();
+    CPPUNIT_ASSERT_MESSAGE("Testing number of frames of the initial scan", frames.size() == 5);
+
+    // a fresh scanner has to deliver the same results from the index files
+    mitk::DICOMDCMTKTagScanner::Pointer cachedScanner = mitk::DICOMDCMTKTagScanner::New();
+    cachedScanner->SetPersistentCacheDirectory(cacheDirectory);
+    cachedScanner->SetInputFiles(files);
+    cachedScanner->AddTagPath(instanceUID);
+    cachedScanner->AddTagPath(planUIDPath);
+    cachedScanner->Scan();
+
+    mitk::DICOMDatasetAccessingImageFrameList cachedFrames = cachedScanner->GetFrameInfoList();
+    CPPUNIT_ASSERT_MESSAGE("Testing number of frames of the cached scan", cachedFrames.size() == frames.size());
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Testing file name of cached frame", cachedFrames[i]->Filename == frames[i]->Filename);
+
+      for (const auto& path : { instanceUID, planUIDPath })
+      {
+        mitk::DICOMDatasetAccess::FindingsListType findings = frames[i]->GetTagValueAsString(path);
+        mitk::DICOMDatasetAccess::FindingsListType cachedFindings = cachedFrames[i]->GetTagValueAsString(path);
+        CPPUNIT_ASSERT_MESSAGE("Testing number of cached findings", cachedFindings.size() == findings.size());
+
+        auto cachedIter = cachedFindings.cbegin();
+        for (const auto& finding : findings)
+        {
+          CPPUNIT_ASSERT_MESSAGE("Testing path of cached finding", cachedIter->path == finding.path);
+          CPPUNIT_ASSERT_MESSAGE("Testing value of cached finding", cachedIter->value == finding.value);
+          ++cachedIter;
+        }
+      }
+    }
+
+    // a tag that has not been scanned before is not served from the index
+    mitk::DICOMTagPath patientName(0x0010, 0x0010);
+    cachedScanner->AddTagPath(patientName);
+    cachedScanner->Scan();
+
+    mitk::DICOMDatasetAccess::FindingsListType findings = cachedScanner->GetFrameInfoList().back()->GetTagValueAsString(patientName);
+    CPPUNIT_ASSERT_MESSAGE("Testing finding of an additionally requested tag", findings.size() == 1);
+    CPPUNIT_ASSERT_MESSAGE("Testing value of an additionally requested tag", findings.front().value == "L_H");
+
+    // the GDCM scanner keeps other values than the DCMTK scanner and must not use its index files
+    mitk::DICOMGDCMTagScanner::Pointer gdcmScanner = mitk::DICOMGDCMTagScanner::New();
+    gdcmScanner->SetPersistentCacheDirectory(cacheDirectory);
+    gdcmScanner->SetInputFiles(files);
+    gdcmScanner->AddTagPath(instanceUID);
+    gdcmScanner->Scan();
+
+    mitk::DICOMGDCMTagScanner::Pointer uncachedGDCMScanner = mitk::DICOMGDCMTagScanner::New();
+    uncachedGDCMScanner->SetInputFiles(files);
+    uncachedGDCMScanner->AddTagPath(instanceUID);
+    uncachedGDCMScanner->Scan();
+
+    mitk::DICOMDatasetAccessingImageFrameList gdcmFrames = gdcmScanner->GetFrameInfoList();
+    mitk::DICOMDatasetAccessingImageFrameList uncachedGDCMFrames = uncachedGDCMScanner->GetFrameInfoList();
+    CPPUNIT_ASSERT_MESSAGE("Testing number of frames of the GDCM scan", gdcmFrames.size() == uncachedGDCMFrames.size());
+    for (size_t i = 0; i < gdcmFrames.size(); ++i)
+    {
+      mitk::DICOMDatasetAccess::FindingsListType gdcmFindings = gdcmFrames[i]->GetTagValueAsString(instanceUID);
+      mitk::DICOMDatasetAccess::FindingsListType uncachedFindings = uncachedGDCMFrames[i]->GetTagValueAsString(instanceUID);
+      CPPUNIT_ASSERT_MESSAGE("Testing findings of the GDCM scan with a cache of the DCMTK scanner",
+                             gdcmFindings.size() == 1 && uncachedFindings.size() == 1 &&
+                               gdcmFindings.front().value == uncachedFindings.front().value);
+    }
+
+    itksys::SystemTools::RemoveADirectory(cacheDirectory.c_str());
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkDICOMDCMTKTagScanner)
@@ -81,6 +81,9 @@ namespace mitk
     Image::Pointer GetDiffImage();
 
     bool IsImageStillValid() { return m_ImageStillValid; }
+
+    virtual std::size_t GetMemoryUsage() const override;
+    virtual void MoveDataToDisk() override;
   };
 
 } // namespace mitk
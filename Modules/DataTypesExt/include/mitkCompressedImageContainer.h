@@ -25,6 +25,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObject.h>
 
+#include <atomic>
+#include <future>
+#include <string>
 #include <vector>
 
 namespace mitk
@@ -32,7 +35,12 @@ namespace mitk
   /**
     \brief Holds one (compressed) mitk::Image
 
-    Uses zlib to compress the data of an mitk::Image.
+    Uses zlib to compress the data of an mitk::Image. SetImage() only copies
+    the data, which is compressed in the background with the fastest zlib level.
+    Methods that need the compressed data wait for that.
+
+    The compressed data can be moved to a temporary file with MoveDataToDisk(),
+    e.g. to keep an undo stack within its memory budget.
 
     $Author$
   */
@@ -59,10 +67,40 @@ namespace mitk
      */
     Image::Pointer GetImage();
 
+    /**
+     * \brief Number of bytes of image data held in memory.
+     *
+     * This is the size of the uncompressed data until the compression is done
+     * and zero after MoveDataToDisk(). Does not wait for the compression.
+     */
+    std::size_t GetMemoryUsage() const;
+
+    /**
+     * \brief Moves the compressed data into a temporary file, which is removed with the container.
+     *
+     * GetImage() reads the data from that file afterwards. The data stays in
+     * memory if the file cannot be written.
+     */
+    void MoveDataToDisk();
+
+    /**
+     * \brief True if the data was moved to a temporary file.
+     */
+    bool IsDataOnDisk() const { return !m_DataFilename.empty(); }
+
   protected:
     CompressedImageContainer(); // purposely hidden
     virtual ~CompressedImageContainer();
 
+    /// compresses the buffers of all time steps, runs in the background
+    void CompressByteBuffers();
+
+    /// waits until the buffers of the last SetImage() are compressed
+    void WaitForCompression();
+
+    /// frees the buffers and removes the temporary file
+    void ClearData();
+
     PixelType *m_PixelType;
 
     unsigned int m_ImageDimension;
@@ -72,9 +110,20 @@ namespace mitk
 
     unsigned int m_NumberOfTimeSteps;
 
-    /// one for each timestep. first = pointer to compressed data; second = size of buffer in bytes
+    /// one for each timestep. first = pointer to compressed data; second = size of buffer in bytes.
+    /// The buffers hold the uncompressed data until m_Compression is done, the pointers are NULL while
+    /// the data is on disk.
     std::vector<std::pair<unsigned char *, unsigned long>> m_ByteBuffers;
 
+    /// false for the buffers that are not compressed (yet)
+    std::vector<bool> m_IsCompressed;
+
+    std::future<void> m_Compression;
+    std::atomic<std::size_t> m_MemoryUsage;
+
+    /// temporary file with the compressed buffers one after another, empty if the data is in memory
+    std::string m_DataFilename;
+
     BaseGeometry::Pointer m_ImageGeometry;
   };
 
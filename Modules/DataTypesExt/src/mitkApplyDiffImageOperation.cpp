@@ -62,6 +62,19 @@ void mitk::ApplyDiffImageOperation::OnImageDeleted()
   m_ImageStillValid = false;
 }
 
+std::size_t mitk::ApplyDiffImageOperation::GetMemoryUsage() const
+{
+  return zlibContainer.IsNotNull() ? zlibContainer->GetMemoryUsage() : 0;
+}
+
+void mitk::ApplyDiffImageOperation::MoveDataToDisk()
+{
+  if (zlibContainer.IsNotNull())
+  {
+    zlibContainer->MoveDataToDisk();
+  }
+}
+
 mitk::Image::Pointer mitk::ApplyDiffImageOperation::GetDiffImage()
 {
   // uncompress image to create a valid mitk::Image
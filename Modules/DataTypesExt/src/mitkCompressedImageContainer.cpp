@@ -16,39 +16,65 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCompressedImageContainer.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkIOUtil.h"
 
 #include "itk_zlib.h"
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <stdlib.h>
 
-mitk::CompressedImageContainer::CompressedImageContainer() : m_PixelType(nullptr), m_ImageGeometry(nullptr)
+mitk::CompressedImageContainer::CompressedImageContainer()
+  : m_PixelType(nullptr), m_MemoryUsage(0), m_ImageGeometry(nullptr)
 {
 }
 
 mitk::CompressedImageContainer::~CompressedImageContainer()
 {
-  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
-  {
-    free(iter->first);
-  }
+  this->ClearData();
 
   delete m_PixelType;
 }
 
-void mitk::CompressedImageContainer::SetImage(Image *image)
+void mitk::CompressedImageContainer::ClearData()
 {
+  this->WaitForCompression();
+
   for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
   {
     free(iter->first);
   }
 
   m_ByteBuffers.clear();
+  m_IsCompressed.clear();
+  m_MemoryUsage = 0;
+
+  if (!m_DataFilename.empty())
+  {
+    std::remove(m_DataFilename.c_str());
+    m_DataFilename.clear();
+  }
+}
+
+void mitk::CompressedImageContainer::WaitForCompression()
+{
+  if (m_Compression.valid())
+  {
+    m_Compression.get();
+  }
+}
+
+void mitk::CompressedImageContainer::SetImage(Image *image)
+{
+  this->ClearData();
 
   // Compress diff image using zlib (will be restored on demand)
   // determine memory size occupied by voxel data
   m_ImageDimension = image->GetDimension();
   m_ImageDimensions.clear();
 
+  delete m_PixelType;
   m_PixelType = new mitk::PixelType(image->GetPixelType());
 
   m_OneTimeStepImageSizeInBytes = m_PixelType->GetSize(); // bits per element divided by 8
@@ -70,66 +96,150 @@ void mitk::CompressedImageContainer::SetImage(Image *image)
     m_NumberOfTimeSteps = image->GetDimension(3);
   }
 
+  // only copy the data here, it is compressed in the background
   for (unsigned int timestep = 0; timestep < m_NumberOfTimeSteps; ++timestep)
   {
+    unsigned char *byteBuffer = (unsigned char *)malloc(m_OneTimeStepImageSizeInBytes);
+
+    ImageReadAccessor imgAcc(image, image->GetVolumeData(timestep));
+    memcpy(byteBuffer, imgAcc.GetData(), m_OneTimeStepImageSizeInBytes);
+
+    m_ByteBuffers.push_back(std::pair<unsigned char *, unsigned long>(byteBuffer, m_OneTimeStepImageSizeInBytes));
+    m_IsCompressed.push_back(false);
+    m_MemoryUsage += m_OneTimeStepImageSizeInBytes;
+  }
+
+  m_Compression = std::async(std::launch::async, [this]() { this->CompressByteBuffers(); });
+}
+
+void mitk::CompressedImageContainer::CompressByteBuffers()
+{
+  for (std::size_t timestep = 0; timestep < m_ByteBuffers.size(); ++timestep)
+  {
+    auto iter = m_ByteBuffers.begin() + timestep;
+
     // allocate a buffer as specified by zlib
-    unsigned long bufferSize =
-      m_OneTimeStepImageSizeInBytes + static_cast<unsigned long>(m_OneTimeStepImageSizeInBytes * 0.2) + 12;
+    ::uLongf sourceLen(iter->second);
+    unsigned long bufferSize = ::compressBound(sourceLen);
     unsigned char *byteBuffer = (unsigned char *)malloc(bufferSize);
 
     if (itk::Object::GetDebug())
     {
       // compress image here into a buffer
       MITK_INFO << "Using ZLib version: '" << zlibVersion() << "'" << std::endl
-                << "Attempting to compress " << m_OneTimeStepImageSizeInBytes << " image bytes into a buffer of size "
-                << bufferSize << std::endl;
+                << "Attempting to compress " << sourceLen << " image bytes into a buffer of size " << bufferSize
+                << std::endl;
     }
 
-    ImageReadAccessor imgAcc(image, image->GetVolumeData(timestep));
+    // the fastest level, which pays off for the mostly binary slices of segmentations
     ::Bytef *dest(byteBuffer);
     ::uLongf destLen(bufferSize);
-    ::Bytef *source((unsigned char *)imgAcc.GetData());
-    ::uLongf sourceLen(m_OneTimeStepImageSizeInBytes);
-    int zlibRetVal = ::compress(dest, &destLen, source, sourceLen);
-    if (itk::Object::GetDebug())
+    ::Bytef *source(iter->first);
+    int zlibRetVal = ::compress2(dest, &destLen, source, sourceLen, Z_BEST_SPEED);
+    if (zlibRetVal != Z_OK)
     {
-      if (zlibRetVal == Z_OK)
+      switch (zlibRetVal)
       {
-        MITK_INFO << "Success, using " << destLen << " bytes of the buffer (ratio "
-                  << ((double)destLen / (double)sourceLen) << ")" << std::endl;
-      }
-      else
-      {
-        switch (zlibRetVal)
-        {
-          case Z_MEM_ERROR:
-            MITK_ERROR << "not enough memory" << std::endl;
-            break;
-          case Z_BUF_ERROR:
-            MITK_ERROR << "output buffer too small" << std::endl;
-            break;
-          default:
-            MITK_ERROR << "other, unspecified error" << std::endl;
-            break;
-        }
+        case Z_MEM_ERROR:
+          MITK_ERROR << "not enough memory" << std::endl;
+          break;
+        case Z_BUF_ERROR:
+          MITK_ERROR << "output buffer too small" << std::endl;
+          break;
+        default:
+          MITK_ERROR << "other, unspecified error" << std::endl;
+          break;
       }
+
+      // keep the uncompressed data
+      free(byteBuffer);
+      continue;
+    }
+
+    if (itk::Object::GetDebug())
+    {
+      MITK_INFO << "Success, using " << destLen << " bytes of the buffer (ratio "
+                << ((double)destLen / (double)sourceLen) << ")" << std::endl;
     }
 
     // only use the neccessary amount of memory, realloc the buffer!
     byteBuffer = (unsigned char *)realloc(byteBuffer, destLen);
-    bufferSize = destLen;
-    // MITK_INFO << "Using " << bufferSize << " bytes to store compressed image (" << destLen << " needed)" <<
-    // std::endl;
+    free(iter->first);
+    iter->first = byteBuffer;
+    iter->second = destLen;
+    m_IsCompressed[timestep] = true;
 
-    m_ByteBuffers.push_back(std::pair<unsigned char *, unsigned long>(byteBuffer, bufferSize));
+    m_MemoryUsage += destLen;
+    m_MemoryUsage -= sourceLen;
   }
 }
 
+std::size_t mitk::CompressedImageContainer::GetMemoryUsage() const
+{
+  return m_MemoryUsage;
+}
+
+void mitk::CompressedImageContainer::MoveDataToDisk()
+{
+  this->WaitForCompression();
+
+  if (this->IsDataOnDisk() || m_ByteBuffers.empty())
+    return;
+
+  std::ofstream file;
+  std::string filename;
+  try
+  {
+    filename = IOUtil::CreateTemporaryFile(file, std::ios_base::binary, "CompressedImage-XXXXXX");
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_ERROR << "Could not move compressed image to disk: " << e.GetDescription();
+    return;
+  }
+
+  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  {
+    file.write(reinterpret_cast<const char *>(iter->first), iter->second);
+  }
+  file.close();
+
+  if (file.fail())
+  {
+    MITK_ERROR << "Could not move compressed image to disk: writing " << filename << " failed";
+    std::remove(filename.c_str());
+    return;
+  }
+
+  // the sizes are kept to read the buffers again
+  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  {
+    free(iter->first);
+    iter->first = nullptr;
+  }
+  m_DataFilename = filename;
+  m_MemoryUsage = 0;
+}
+
 mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
 {
+  this->WaitForCompression();
+
   if (m_ByteBuffers.empty())
     return nullptr;
 
+  std::ifstream file;
+  std::vector<unsigned char> fileBuffer;
+  if (this->IsDataOnDisk())
+  {
+    file.open(m_DataFilename.c_str(), std::ios_base::binary);
+    if (!file.good())
+    {
+      MITK_ERROR << "Could not read compressed image from " << m_DataFilename;
+      return nullptr;
+    }
+  }
+
   // uncompress image data, create an Image
   Image::Pointer image = Image::New();
   unsigned int dims[20]; // more than 20 dimensions and bang
@@ -147,6 +257,26 @@ mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
     ::uLongf destLen(m_OneTimeStepImageSizeInBytes);
     ::Bytef *source(iter->first);
     ::uLongf sourceLen(iter->second);
+
+    if (this->IsDataOnDisk())
+    {
+      fileBuffer.resize(iter->second);
+      file.read(reinterpret_cast<char *>(fileBuffer.data()), iter->second);
+      if (!file || static_cast<::uLongf>(file.gcount()) != sourceLen)
+      {
+        MITK_ERROR << "Could not read compressed image from " << m_DataFilename << ": time step " << timeStep
+                   << " is truncated";
+        return nullptr;
+      }
+      source = fileBuffer.data();
+    }
+
+    if (!m_IsCompressed[timeStep])
+    {
+      memcpy(dest, source, sourceLen);
+      continue;
+    }
+
     int zlibRetVal = ::uncompress(dest, &destLen, source, sourceLen);
     if (itk::Object::GetDebug())
     {
@@ -23,9 +23,23 @@ See LICENSE.txt or http://www.mitk.org for details.
 class mitkCompressedImageContainerTestClass
 {
 public:
-  static void Test(mitk::CompressedImageContainer *container, mitk::Image *image, unsigned int &numberFailed)
+  static void Test(mitk::CompressedImageContainer *container,
+                   mitk::Image *image,
+                   unsigned int &numberFailed,
+                   bool moveDataToDisk = false)
   {
-    container->SetImage(image);                                     // compress
+    container->SetImage(image); // compress
+
+    if (moveDataToDisk)
+    {
+      container->MoveDataToDisk();
+      if (!container->IsDataOnDisk() || container->GetMemoryUsage() != 0)
+      {
+        ++numberFailed;
+        std::cerr << "  (EE) Data still in memory after moving it to disk" << std::endl;
+      }
+    }
+
     mitk::Image::Pointer uncompressedImage = container->GetImage(); // uncompress
 
     // check dimensions
@@ -166,6 +180,9 @@ int mitkCompressedImageContainerTest(int argc, char *argv[])
   // some real work
   mitkCompressedImageContainerTestClass::Test(container, image, numberFailed);
 
+  std::cout << "Testing data on disk" << std::endl;
+  mitkCompressedImageContainerTestClass::Test(container, image, numberFailed, true);
+
   std::cout << "Testing destruction" << std::endl;
 
   // freeing
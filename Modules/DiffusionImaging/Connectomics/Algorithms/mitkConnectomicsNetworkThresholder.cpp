@@ -119,6 +119,7 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkThresholder::Thresho
   result->ImportNetwort( input );
 
   mitk::ConnectomicsStatisticsCalculator::Pointer calculator = mitk::ConnectomicsStatisticsCalculator::New();
+  calculator->CalculateSpectralMetricsOff();
 
   calculator->SetNetwork( result );
   calculator->Update();
@@ -168,10 +169,8 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkThresholder::Thresho
     // Which to delete
     int deleteNumber( rng.lrand32( count - 1 ) );
 
-    boost::remove_edge( candidateVector.at( deleteNumber ), *boostGraph );
-
-    calculator->SetNetwork( result );
-    calculator->Update();
+    // removes the edge and updates the statistics incrementally
+    calculator->RemoveEdge( candidateVector.at( deleteNumber ) );
     notBelow = targetDensity < calculator->GetConnectionDensity();
   }
 
@@ -185,6 +184,7 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkThresholder::Thresho
   result->ImportNetwort( input );
 
   mitk::ConnectomicsStatisticsCalculator::Pointer calculator = mitk::ConnectomicsStatisticsCalculator::New();
+  calculator->CalculateSpectralMetricsOff();
 
   calculator->SetNetwork( result );
   calculator->Update();
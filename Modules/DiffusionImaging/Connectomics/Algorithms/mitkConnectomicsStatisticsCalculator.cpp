@@ -17,44 +17,117 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkConnectomicsStatisticsCalculator.h"
 #include "mitkConnectomicsNetworkConverter.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <numeric>
 
+#include <itkMultiThreader.h>
+
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/clustering_coefficient.hpp>
-#include <boost/graph/betweenness_centrality.hpp>
-#include <boost/graph/visitors.hpp>
 
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 
-template<typename GraphType>
-class all_pairs_shortest_recorder : public boost::default_bfs_visitor
+namespace
 {
-public:
-  typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexType;
-  typedef typename boost::graph_traits<GraphType>::edge_descriptor EdgeType;
-
-  all_pairs_shortest_recorder(int* dist, int &max, unsigned int &size)
+  struct ShortestPathThreadData
   {
-    d = dist;
-    ecc = &max;
-    component_size = &size;
+    const mitk::ConnectomicsStatisticsCalculator::AdjacencyListType* adjacencyList;
+    const std::vector< int >* sources;
+    int* distances;
+    double weight;
+    unsigned int numberOfEdges;
+    std::vector< std::vector< double > > vertexBetweenness;
+    std::vector< std::vector< double > > edgeBetweenness;
+  };
+
+  /**
+  * Breadth first search from source, which writes the distances to the row of the source. Afterwards the
+  * dependencies are accumulated in reverse order of discovery as in boost::brandes_betweenness_centrality.
+  * The predecessors of a vertex are its neighbors one hop closer to the source.
+  */
+  void TraverseFromSource( const mitk::ConnectomicsStatisticsCalculator::AdjacencyListType& adjacencyList,
+    int source, int* distances, double weight, double* vertexBetweenness, double* edgeBetweenness,
+    std::vector< int >& order, std::vector< double >& pathCounts, std::vector< double >& dependencies )
+  {
+    const int numberOfVertices = static_cast< int >( adjacencyList.size() );
+    std::fill( distances, distances + numberOfVertices, -1 );
+    std::fill( pathCounts.begin(), pathCounts.end(), 0.0 );
+    std::fill( dependencies.begin(), dependencies.end(), 0.0 );
+    order.clear();
+
+    distances[ source ] = 0;
+    pathCounts[ source ] = 1.0;
+    order.push_back( source );
+
+    // order doubles as the queue of the search
+    for( std::size_t head( 0 ); head < order.size(); ++head )
+    {
+      int v = order[ head ];
+      for( std::size_t i( 0 ); i < adjacencyList[ v ].size(); ++i )
+      {
+        int w = adjacencyList[ v ][ i ].first;
+        if( distances[ w ] < 0 )
+        {
+          distances[ w ] = distances[ v ] + 1;
+          order.push_back( w );
+        }
+        if( distances[ w ] == distances[ v ] + 1 )
+        {
+          pathCounts[ w ] += pathCounts[ v ];
+        }
+      }
+    }
+
+    for( std::size_t k( order.size() ); k > 0; --k )
+    {
+      int w = order[ k - 1 ];
+      for( std::size_t i( 0 ); i < adjacencyList[ w ].size(); ++i )
+      {
+        int v = adjacencyList[ w ][ i ].first;
+        if( distances[ v ] == distances[ w ] - 1 )
+        {
+          double factor = ( pathCounts[ v ] / pathCounts[ w ] ) * ( 1.0 + dependencies[ w ] );
+          dependencies[ v ] += factor;
+          edgeBetweenness[ adjacencyList[ w ][ i ].second ] += weight * factor;
+        }
+      }
+      if( w != source )
+      {
+        vertexBetweenness[ w ] += weight * dependencies[ w ];
+      }
+    }
   }
 
-  void tree_edge(EdgeType edge, const GraphType& graph) {
-    VertexType u = boost::source(edge, graph);
-    VertexType v = boost::target(edge, graph);
-    d[v] = d[u] + 1;
-    *ecc = d[v];
-    *component_size = *component_size + 1;
+  ITK_THREAD_RETURN_TYPE TraverseFromSourcesThread( void* arg )
+  {
+    itk::MultiThreader::ThreadInfoStruct* info = static_cast< itk::MultiThreader::ThreadInfoStruct* >( arg );
+    ShortestPathThreadData* data = static_cast< ShortestPathThreadData* >( info->UserData );
+    const unsigned int numberOfVertices = data->adjacencyList->size();
+
+    std::vector< double >& vertexBetweenness = data->vertexBetweenness[ info->ThreadID ];
+    std::vector< double >& edgeBetweenness = data->edgeBetweenness[ info->ThreadID ];
+    vertexBetweenness.assign( numberOfVertices, 0.0 );
+    edgeBetweenness.assign( data->numberOfEdges, 0.0 );
+
+    std::vector< int > order;
+    order.reserve( numberOfVertices );
+    std::vector< double > pathCounts( numberOfVertices );
+    std::vector< double > dependencies( numberOfVertices );
+
+    for( std::size_t i( info->ThreadID ); i < data->sources->size(); i += info->NumberOfThreads )
+    {
+      int source = data->sources->at( i );
+      TraverseFromSource( *data->adjacencyList, source, data->distances + source * numberOfVertices, data->weight,
+        vertexBetweenness.data(), edgeBetweenness.data(), order, pathCounts, dependencies );
+    }
+    return ITK_THREAD_RETURN_VALUE;
   }
-private:
-  int* d;
-  int* ecc;
-  unsigned int* component_size;
-};
+}
 
 mitk::ConnectomicsStatisticsCalculator::ConnectomicsStatisticsCalculator()
   : m_Network( nullptr )
+  , m_CalculateSpectralMetrics( true )
   , m_NumberOfVertices( 0 )
   , m_NumberOfEdges( 0 )
   , m_AverageDegree( 0.0 )
@@ -91,6 +164,7 @@ mitk::ConnectomicsStatisticsCalculator::ConnectomicsStatisticsCalculator()
   , m_AverageEccentricity( 0.0 )
   , m_AverageEccentricity90( 0.0 )
   , m_AveragePathLength( 0.0 )
+  , m_GlobalEfficiency( 0.0 )
   , m_NumberOfCentralPoints( 0 )
   , m_RatioOfCentralPoints( 0.0 )
   , m_VectorOfSortedEigenValues( 0 )
@@ -122,6 +196,50 @@ void mitk::ConnectomicsStatisticsCalculator::Update()
 {
   CalculateNumberOfVertices();
   CalculateNumberOfEdges();
+  CalculateShortestPaths();
+  CalculateMetrics();
+}
+
+void mitk::ConnectomicsStatisticsCalculator::RemoveEdge( EdgeDescriptorType edge )
+{
+  NetworkType* boostGraph = m_Network->GetBoostGraph();
+  EdgeIndexStdMapType::iterator edgeIndex = m_EdgeIndices.find( edge );
+  if( m_NumberOfVertices != boost::num_vertices( *boostGraph ) || m_NumberOfEdges != boost::num_edges( *boostGraph )
+    || edgeIndex == m_EdgeIndices.end() )
+  {
+    boost::remove_edge( edge, *boostGraph );
+    Update();
+    return;
+  }
+
+  // The distances and path counts from a source only change if the edge connects two subsequent levels of
+  // its search, all other sources keep their betweenness contributions.
+  int u = boost::source( edge, *boostGraph );
+  int v = boost::target( edge, *boostGraph );
+  std::vector< int > affectedSources;
+  for( unsigned int source( 0 ); source < m_NumberOfVertices; ++source )
+  {
+    const int* distances = &m_Distances[ source * m_NumberOfVertices ];
+    if( distances[ u ] >= 0 && std::abs( distances[ u ] - distances[ v ] ) == 1 )
+    {
+      affectedSources.push_back( source );
+    }
+  }
+
+  TraverseFromSources( affectedSources, -0.5 );
+
+  m_VectorOfEdgeBetweennessCentralities.erase( m_VectorOfEdgeBetweennessCentralities.begin() + edgeIndex->second );
+  boost::remove_edge( edge, *boostGraph );
+  CalculateNumberOfEdges();
+  CalculateAdjacencyList();
+
+  TraverseFromSources( affectedSources, 0.5 );
+
+  CalculateMetrics();
+}
+
+void mitk::ConnectomicsStatisticsCalculator::CalculateMetrics()
+{
   CalculateAverageDegree();
   CalculateConnectionDensity();
   CalculateNumberOfConnectedComponents();
@@ -133,9 +251,12 @@ void mitk::ConnectomicsStatisticsCalculator::Update()
   CalculateBetweennessCentrality();
   CalculateIsolatedAndEndPoints();
   CalculateShortestPathMetrics();
-  CalculateSpectralMetrics();
-  CalculateLaplacianMetrics();
-  CalculateNormalizedLaplacianMetrics();
+  if( m_CalculateSpectralMetrics )
+  {
+    CalculateSpectralMetrics();
+    CalculateLaplacianMetrics();
+    CalculateNormalizedLaplacianMetrics();
+  }
   CalculateSmallWorldness();
 }
 
@@ -196,31 +317,99 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateRatioOfNodesInLargestCompo
   m_RatioOfNodesInLargestComponent = (double) m_LargestComponentSize / (double) m_NumberOfVertices ;
 }
 
-void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
+void mitk::ConnectomicsStatisticsCalculator::CalculateAdjacencyList()
 {
-  std::vector<int> bins( m_NumberOfVertices );
+  NetworkType* boostGraph = m_Network->GetBoostGraph();
 
+  m_EdgeIndices.clear();
+  m_AdjacencyList.assign( m_NumberOfVertices, std::vector< std::pair< int, int > >() );
+
+  EdgeIteratorType iterator, end;
+  int i( 0 );
+  for( boost::tie( iterator, end ) = boost::edges( *boostGraph ); iterator != end; ++iterator, ++i )
+  {
+    m_EdgeIndices.insert( std::pair< EdgeDescriptorType, int >( *iterator, i ) );
+  }
+
+  // neighbors in the order of the out edges, as seen by boost::breadth_first_search
   VertexIteratorType vi, vi_end;
-  unsigned int index( 0 );
+  for( boost::tie( vi, vi_end ) = boost::vertices( *boostGraph ); vi != vi_end; ++vi )
+  {
+    NetworkType::out_edge_iterator oe, oe_end;
+    for( boost::tie( oe, oe_end ) = boost::out_edges( *vi, *boostGraph ); oe != oe_end; ++oe )
+    {
+      m_AdjacencyList[ *vi ].push_back( std::make_pair( static_cast< int >( boost::target( *oe, *boostGraph ) ),
+        m_EdgeIndices[ *oe ] ) );
+    }
+  }
+}
+
+void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPaths()
+{
+  CalculateAdjacencyList();
 
-  for( boost::tie( vi, vi_end ) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi != vi_end; ++vi)
+  m_Distances.assign( m_NumberOfVertices * m_NumberOfVertices, -1 );
+  m_VectorOfVertexBetweennessCentralities.assign( m_NumberOfVertices, 0.0 );
+  m_VectorOfEdgeBetweennessCentralities.assign( m_NumberOfEdges, 0.0 );
+
+  std::vector< int > sources( m_NumberOfVertices );
+  for( unsigned int i( 0 ); i < m_NumberOfVertices; ++i )
   {
-    std::vector<int> distances(m_NumberOfVertices, 0);
-    int max_distance = 0;
-    VertexDescriptorType src = *vi;
-    distances[src] = 0;
-    unsigned int size = 0;
+    sources[ i ] = i;
+  }
+
+  // every path is found from both of its ends in an undirected network
+  TraverseFromSources( sources, 0.5 );
+}
 
-    boost::breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder< NetworkType >
-      (&distances[0], max_distance, size)));
+void mitk::ConnectomicsStatisticsCalculator::TraverseFromSources( const std::vector< int >& sources, double weight )
+{
+  if( sources.empty() )
+  {
+    return;
+  }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  int numberOfThreads = std::min< int >( threader->GetNumberOfThreads(), sources.size() );
+  threader->SetNumberOfThreads( numberOfThreads );
+  numberOfThreads = threader->GetNumberOfThreads();
 
-    for(index=0; index < distances.size(); index++)
+  ShortestPathThreadData data;
+  data.adjacencyList = &m_AdjacencyList;
+  data.sources = &sources;
+  data.distances = &m_Distances[0];
+  data.weight = weight;
+  data.numberOfEdges = m_NumberOfEdges;
+  data.vertexBetweenness.resize( numberOfThreads );
+  data.edgeBetweenness.resize( numberOfThreads );
+
+  threader->SetSingleMethod( TraverseFromSourcesThread, &data );
+  threader->SingleMethodExecute();
+
+  for( int thread( 0 ); thread < numberOfThreads; ++thread )
+  {
+    for( unsigned int i( 0 ); i < data.vertexBetweenness[ thread ].size(); ++i )
     {
-      if(distances[index] > 0)
-      {
-        bins[distances[index]]++;
-      }
+      m_VectorOfVertexBetweennessCentralities[ i ] += data.vertexBetweenness[ thread ][ i ];
+    }
+    for( unsigned int i( 0 ); i < data.edgeBetweenness[ thread ].size(); ++i )
+    {
+      m_VectorOfEdgeBetweennessCentralities[ i ] += data.edgeBetweenness[ thread ][ i ];
+    }
+  }
+}
+
+void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
+{
+  std::vector<int> bins( m_NumberOfVertices );
+
+  unsigned int index( 0 );
+
+  for( index = 0; index < m_Distances.size(); index++ )
+  {
+    if( m_Distances[ index ] > 0 )
+    {
+      bins[ m_Distances[ index ] ]++;
     }
   }
 
@@ -341,36 +530,12 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateClusteringCoefficients()
 
 void mitk::ConnectomicsStatisticsCalculator::CalculateBetweennessCentrality()
 {
-  // std::map used for convenient initialization
-  EdgeIndexStdMapType stdEdgeIndex;
-  // associative property map needed for iterator property map-wrapper
-  EdgeIndexMapType edgeIndex(stdEdgeIndex);
-
-  EdgeIteratorType iterator, end;
+  // The centralities are accumulated by the shortest path traversal, create the external property maps
+  m_PropertyMapOfEdgeBetweennessCentralities = EdgeIteratorPropertyMapType(m_VectorOfEdgeBetweennessCentralities.begin(), EdgeIndexMapType( m_EdgeIndices ) );
 
-  // sets iterator to start end end to end
-  boost::tie(iterator, end) = boost::edges( *(m_Network->GetBoostGraph()) );
-
-  int i(0);
-  for ( ; iterator != end; ++iterator, ++i)
-  {
-    stdEdgeIndex.insert(std::pair< EdgeDescriptorType, int >( *iterator, i));
-  }
-
-  // Define EdgeCentralityMap
-  m_VectorOfEdgeBetweennessCentralities.resize( m_NumberOfEdges, 0.0);
-  // Create the external property map
-  m_PropertyMapOfEdgeBetweennessCentralities = EdgeIteratorPropertyMapType(m_VectorOfEdgeBetweennessCentralities.begin(), edgeIndex);
-
-  // Define VertexCentralityMap
   VertexIndexMapType vertexIndex = get(boost::vertex_index, *(m_Network->GetBoostGraph()) );
-  m_VectorOfVertexBetweennessCentralities.resize( m_NumberOfVertices, 0.0);
-  // Create the external property map
   m_PropertyMapOfVertexBetweennessCentralities = VertexIteratorPropertyMapType(m_VectorOfVertexBetweennessCentralities.begin(), vertexIndex);
 
-  boost::brandes_betweenness_centrality( *(m_Network->GetBoostGraph()),
-    m_PropertyMapOfVertexBetweennessCentralities, m_PropertyMapOfEdgeBetweennessCentralities );
-
   m_AverageVertexBetweennessCentrality = std::accumulate(m_VectorOfVertexBetweennessCentralities.begin(),
     m_VectorOfVertexBetweennessCentralities.end(),
     0.0) / (double) m_NumberOfVertices;
@@ -406,12 +571,13 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateIsolatedAndEndPoints()
 
 /**
 * Calculates Shortest Path Related metrics of the graph.  The
-* function runs a BFS from each node to find out the shortest
-* distances to other nodes in the graph. The maximum of this distance
+* function uses the distances found by the BFS from each node to the
+* other nodes in the graph. The maximum of this distance
 * is called the eccentricity of that node. The maximum eccentricity
 * in the graph is called diameter and the minimum eccentricity is
 * called the radius of the graph.  Central points are those nodes
-* having eccentricity equals to radius.
+* having eccentricity equals to radius. The global efficiency is the
+* average inverse distance of all pairs of nodes.
 */
 void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
 {
@@ -419,9 +585,9 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   VertexIteratorType vi, vi_end;
 
   //store the eccentricities in a vector.
-  m_VectorOfEccentrities.resize( m_NumberOfVertices );
-  m_VectorOfEccentrities90.resize( m_NumberOfVertices );
-  m_VectorOfAveragePathLengths.resize( m_NumberOfVertices );
+  m_VectorOfEccentrities.assign( m_NumberOfVertices, 0 );
+  m_VectorOfEccentrities90.assign( m_NumberOfVertices, 0 );
+  m_VectorOfAveragePathLengths.assign( m_NumberOfVertices, 0.0 );
 
   //assign diameter and radius while iterating over the ecccencirities.
   m_Diameter              = 0;
@@ -431,6 +597,7 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   m_AverageEccentricity   = 0.0;
   m_AverageEccentricity90 = 0.0;
   m_AveragePathLength     = 0.0;
+  m_GlobalEfficiency      = 0.0;
 
   //The size of the giant connected component so far.
   unsigned int giant_component_size = 0;
@@ -439,22 +606,24 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   //Loop over the vertices
   for( boost::tie(vi, vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi!=vi_end; ++vi)
   {
-    //We are going to start a BFS, initialize the neccessary
-    //structures for that.  Store the distances of nodes from the
-    //source in distance vector. The maximum distance is stored in
-    //max. The BFS will start from the node that vi is pointing, that
-    //is the src is *vi. We also init the distance of the src node to
-    //itself to 0. size gives the number of nodes discovered during
-    //this BFS.
-    std::vector<int> distances( m_NumberOfVertices );
-    int max_distance = 0;
+    //The distances of nodes from the source src are stored in its row
+    //of the distance matrix. The maximum distance is stored in
+    //max_distance, size gives the number of nodes discovered during
+    //the BFS from src.
     VertexDescriptorType src = *vi;
-    distances[src] = 0;
+    const int* distances = &m_Distances[ src * m_NumberOfVertices ];
+    int max_distance = 0;
     unsigned int size = 0;
+    for(unsigned int i=0; i<m_NumberOfVertices; i++)
+    {
+      if(distances[i]>0)
+      {
+        max_distance = std::max( max_distance, distances[i] );
+        size++;
+        m_GlobalEfficiency += 1.0 / distances[i];
+      }
+    }
 
-    breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder<NetworkType>
-      (&distances[0], max_distance, size)));
     // vertex vi has eccentricity equal to max_distance
     m_VectorOfEccentrities[src] = max_distance;
 
@@ -489,7 +658,7 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
     int reachable90 = std::ceil((double)size * 0.9);
     std::vector <int> bucket (max_distance+1);
     int counter = 0;
-    for(unsigned int i=0; i<distances.size(); i++)
+    for(unsigned int i=0; i<m_NumberOfVertices; i++)
     {
       if(distances[i]>0)
       {
@@ -521,13 +690,11 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   //that when we start a BFS gives the giant connected component, and
   //we have the eccentricities calculated. Iterate over the nodes of
   //this giant component and find the minimum eccentricity.
-  std::vector<int> component( m_NumberOfVertices );
-  boost::connected_components( *(m_Network->GetBoostGraph()), &component[0]);
-  for (unsigned int i=0; i<component.size(); i++)
+  for (unsigned int i=0; i<m_Components.size(); i++)
   {
     //If we are in the same component and the radius is not the
     //minimum so far store the eccentricity as the radius.
-    if( component[i] == component[radius_src])
+    if( m_Components[i] == m_Components[radius_src])
     {
       if(m_Radius > m_VectorOfEccentrities[i])
       {
@@ -549,6 +716,11 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   m_AveragePathLength = std::accumulate(m_VectorOfAveragePathLengths.begin(),
     m_VectorOfAveragePathLengths.end(), 0.0) / m_NumberOfVertices;
 
+  if(m_NumberOfVertices > 1)
+  {
+    m_GlobalEfficiency = m_GlobalEfficiency / ( (double) m_NumberOfVertices * ( m_NumberOfVertices - 1 ) );
+  }
+
   //calculate Number of Central Points, nodes having eccentricity = radius.
   m_NumberOfCentralPoints = 0;
   for (boost::tie(vi, vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi != vi_end; ++vi)
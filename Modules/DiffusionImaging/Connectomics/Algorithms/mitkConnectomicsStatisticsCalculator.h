@@ -30,7 +30,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace mitk
 {
   /**
-  * \brief A class giving functions for calculating a variety of network indices */
+  * \brief A class giving functions for calculating a variety of network indices
+  *
+  * The path based indices (hop plot, eccentricities, path lengths, efficiency and betweenness centrality) share
+  * one traversal of the network. It runs a breadth first search with the dependency accumulation of Brandes'
+  * algorithm from every vertex, the sources are distributed over several threads.
+  *
+  * After an Update() single edges can be removed by RemoveEdge(), which updates the indices incrementally. */
   class MITKCONNECTOMICS_EXPORT ConnectomicsStatisticsCalculator : public itk::Object
   {
   public:
@@ -54,9 +60,13 @@ namespace mitk
     typedef boost::iterator_property_map< std::vector< double >::iterator, EdgeIndexMapType > EdgeIteratorPropertyMapType;
     typedef boost::property_map< NetworkType, boost::vertex_index_t>::type VertexIndexMapType;
     typedef boost::iterator_property_map< std::vector< double >::iterator, VertexIndexMapType > VertexIteratorPropertyMapType;
+    typedef std::vector< std::vector< std::pair< int, int > > > AdjacencyListType;
 
     // Set/Get Macros
     itkSetObjectMacro( Network, mitk::ConnectomicsNetwork );
+    itkSetMacro( CalculateSpectralMetrics, bool );
+    itkGetMacro( CalculateSpectralMetrics, bool );
+    itkBooleanMacro( CalculateSpectralMetrics );
     itkGetMacro( NumberOfVertices, unsigned int );
     itkGetMacro( NumberOfEdges, unsigned int );
     itkGetMacro( AverageDegree, double );
@@ -94,6 +104,7 @@ namespace mitk
     itkGetMacro( AverageEccentricity, double );
     itkGetMacro( AverageEccentricity90, double );
     itkGetMacro( AveragePathLength, double );
+    itkGetMacro( GlobalEfficiency, double );
     itkGetMacro( NumberOfCentralPoints, unsigned int );
     itkGetMacro( RatioOfCentralPoints, double );
     itkGetMacro( VectorOfSortedEigenValues, std::vector< double > );
@@ -117,12 +128,24 @@ namespace mitk
 
     void Update();
 
+    /**
+    * \brief Removes an edge from the network and updates the statistics
+    *
+    * Only the sources whose shortest paths run over the edge are traversed again, their old betweenness
+    * contributions are replaced by the new ones. The other indices are recalculated from the stored distances.
+    * If the statistics have not been updated for the current network, a complete Update() is done.
+    */
+    void RemoveEdge( EdgeDescriptorType edge );
+
   protected:
 
     //////////////////// Functions ///////////////////////
     ConnectomicsStatisticsCalculator();
     ~ConnectomicsStatisticsCalculator();
 
+    /** Calculates all indices except the number of vertices and edges from the shortest path data */
+    void CalculateMetrics();
+
     void CalculateNumberOfVertices();
 
     void CalculateNumberOfEdges();
@@ -139,6 +162,20 @@ namespace mitk
 
     void CalculateRatioOfNodesInLargestComponent();
 
+    /** Converts the network to the adjacency list used by the shortest path traversal */
+    void CalculateAdjacencyList();
+
+    /** Traverses the network from every vertex and stores the distances and the betweenness centralities */
+    void CalculateShortestPaths();
+
+    /**
+    * \brief Traverses the network from the given sources in parallel
+    *
+    * Stores the distances from the sources and adds the betweenness contributions of the sources, multiplied
+    * by weight, to the betweenness centralities.
+    */
+    void TraverseFromSources( const std::vector< int >& sources, double weight );
+
     void CalculateHopPlotValues();
 
     /**
@@ -178,6 +215,15 @@ namespace mitk
     // The connectomics network, which is used for statistics calculation
     mitk::ConnectomicsNetwork::Pointer m_Network;
 
+    // Whether the eigenvalue based indices are calculated, which is the most expensive part
+    bool m_CalculateSpectralMetrics;
+
+    // Shortest path data of the last update
+    AdjacencyListType m_AdjacencyList;
+    EdgeIndexStdMapType m_EdgeIndices;
+    // Row-major matrix of hop distances from source to target, -1 if the target is not reachable
+    std::vector< int > m_Distances;
+
     // Statistics
     unsigned int m_NumberOfVertices;
     unsigned int m_NumberOfEdges;
@@ -216,6 +262,7 @@ namespace mitk
     double m_AverageEccentricity;
     double m_AverageEccentricity90;
     double m_AveragePathLength;
+    double m_GlobalEfficiency;
     unsigned int m_NumberOfCentralPoints;
     double m_RatioOfCentralPoints;
     std::vector<double> m_VectorOfSortedEigenValues;
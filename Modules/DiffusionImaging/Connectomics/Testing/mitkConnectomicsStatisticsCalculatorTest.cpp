@@ -38,6 +38,7 @@ class mitkConnectomicsStatisticsCalculatorTestSuite : public mitk::TestFixture
   vtkDebugLeaks::SetExitError(0);
 
   MITK_TEST(StatisticsCalculatorUpdate);
+  MITK_TEST(StatisticsCalculatorRemoveEdge);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -117,6 +118,7 @@ public:
     CPPUNIT_ASSERT_MESSAGE( "GetAverageEccentricity", mitk::Equal( statisticsCalculator->GetAverageEccentricity( ), 1.5 , eps, true ) );
     CPPUNIT_ASSERT_MESSAGE( "GetAverageEccentricity90", mitk::Equal( statisticsCalculator->GetAverageEccentricity90( ), 1.5 , eps, true ) );
     CPPUNIT_ASSERT_MESSAGE( "GetAveragePathLength" , mitk::Equal( statisticsCalculator->GetAveragePathLength( ), 1.16667 , eps, true ) );
+    CPPUNIT_ASSERT_MESSAGE( "GetGlobalEfficiency" , mitk::Equal( statisticsCalculator->GetGlobalEfficiency( ), 0.916667 , eps, true ) );
     CPPUNIT_ASSERT_MESSAGE( "GetNumberOfCentralPoints" , mitk::Equal( statisticsCalculator->GetNumberOfCentralPoints( ), 2 , eps, true ) );
     CPPUNIT_ASSERT_MESSAGE( "GetRatioOfCentralPoints", mitk::Equal( statisticsCalculator->GetRatioOfCentralPoints( ), 0.5 , eps, true ) );
     // CPPUNIT_ASSERT_MESSAGE( " ", mitk::Equal( statisticsCalculator->GetSpectralRadius( ), , eps, true ) );
@@ -136,6 +138,53 @@ public:
     CPPUNIT_ASSERT_MESSAGE( "GetSmallWorldness", mitk::Equal( statisticsCalculator->GetSmallWorldness( ), 1.72908 , eps, true ) );
 
   }
+
+  void StatisticsCalculatorRemoveEdge()
+  {
+    mitk::ConnectomicsNetwork::Pointer incrementalNetwork = mitk::ConnectomicsNetwork::New();
+    incrementalNetwork->ImportNetwort( m_Network );
+    mitk::ConnectomicsNetwork::Pointer referenceNetwork = mitk::ConnectomicsNetwork::New();
+    referenceNetwork->ImportNetwort( m_Network );
+
+    mitk::ConnectomicsStatisticsCalculator::Pointer incrementalCalculator = mitk::ConnectomicsStatisticsCalculator::New();
+    incrementalCalculator->SetNetwork( incrementalNetwork );
+    incrementalCalculator->Update();
+
+    mitk::ConnectomicsStatisticsCalculator::Pointer referenceCalculator = mitk::ConnectomicsStatisticsCalculator::New();
+    referenceCalculator->SetNetwork( referenceNetwork );
+
+    double eps( 0.0001 );
+
+    // remove the edges one by one, the incremental update has to give the same values as a complete update
+    while( boost::num_edges( *(incrementalNetwork->GetBoostGraph()) ) > 0 )
+    {
+      incrementalCalculator->RemoveEdge( *boost::edges( *(incrementalNetwork->GetBoostGraph()) ).first );
+      boost::remove_edge( *boost::edges( *(referenceNetwork->GetBoostGraph()) ).first, *(referenceNetwork->GetBoostGraph()) );
+      referenceCalculator->Update();
+
+      CPPUNIT_ASSERT_MESSAGE( "GetNumberOfEdges" , mitk::Equal( incrementalCalculator->GetNumberOfEdges( ), referenceCalculator->GetNumberOfEdges( ), eps, true ) );
+      CPPUNIT_ASSERT_MESSAGE( "GetConnectionDensity", mitk::Equal( incrementalCalculator->GetConnectionDensity( ), referenceCalculator->GetConnectionDensity( ), eps, true ) );
+      CPPUNIT_ASSERT_MESSAGE( "GetNumberOfConnectedComponents", mitk::Equal( incrementalCalculator->GetNumberOfConnectedComponents( ), referenceCalculator->GetNumberOfConnectedComponents( ), eps, true ) );
+      CPPUNIT_ASSERT_MESSAGE( "GetDiameter", mitk::Equal( incrementalCalculator->GetDiameter( ), referenceCalculator->GetDiameter( ), eps, true ) );
+      CPPUNIT_ASSERT_MESSAGE( "GetAveragePathLength" , mitk::Equal( incrementalCalculator->GetAveragePathLength( ), referenceCalculator->GetAveragePathLength( ), eps, true ) );
+      CPPUNIT_ASSERT_MESSAGE( "GetGlobalEfficiency" , mitk::Equal( incrementalCalculator->GetGlobalEfficiency( ), referenceCalculator->GetGlobalEfficiency( ), eps, true ) );
+
+      std::vector< double > incrementalVertexBetweenness = incrementalCalculator->GetVectorOfVertexBetweennessCentralities();
+      std::vector< double > referenceVertexBetweenness = referenceCalculator->GetVectorOfVertexBetweennessCentralities();
+      for( unsigned int i( 0 ); i < referenceVertexBetweenness.size(); ++i )
+      {
+        CPPUNIT_ASSERT_MESSAGE( "Vertex betweenness", mitk::Equal( incrementalVertexBetweenness[ i ], referenceVertexBetweenness[ i ], eps, true ) );
+      }
+
+      std::vector< double > incrementalEdgeBetweenness = incrementalCalculator->GetVectorOfEdgeBetweennessCentralities();
+      std::vector< double > referenceEdgeBetweenness = referenceCalculator->GetVectorOfEdgeBetweennessCentralities();
+      CPPUNIT_ASSERT_MESSAGE( "Number of edge betweenness values", incrementalEdgeBetweenness.size() == referenceEdgeBetweenness.size() );
+      for( unsigned int i( 0 ); i < referenceEdgeBetweenness.size(); ++i )
+      {
+        CPPUNIT_ASSERT_MESSAGE( "Edge betweenness", mitk::Equal( incrementalEdgeBetweenness[ i ], referenceEdgeBetweenness[ i ], eps, true ) );
+      }
+    }
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkConnectomicsStatisticsCalculator)
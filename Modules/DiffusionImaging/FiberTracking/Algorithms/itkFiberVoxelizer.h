@@ -0,0 +1,217 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __itkFiberVoxelizer_h__
+#define __itkFiberVoxelizer_h__
+
+#include <itkSize.h>
+#include <vtkPolyData.h>
+#include <vtkCellArray.h>
+#include <boost/progress.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace itk{
+
+/**
+* \brief Multi-threaded accumulation of fiber points into an image buffer (used by the tract image filters).
+*
+* A user supplied function converts the points of one fiber into splats, i.e. contributions to a single voxel or to
+* the 2x2x2 voxels of a trilinear stencil. The fibers are processed in two passes:
+*  - the splats of consecutive blocks of fibers are computed in parallel and sorted into slabs of z-slices
+*  - the slabs are filled in parallel, every slab visits the blocks in fiber order
+*
+* Every voxel thus receives its contributions in the same order as in a serial loop over the fibers and the result
+* does not depend on the number of threads. The fibers are voxelized in chunks to limit the memory used by the splats.
+*/
+template< class TValue, unsigned int VComponents = 1 >
+class FiberVoxelizer
+{
+public:
+
+    /** Contribution of one fiber point. */
+    struct Splat
+    {
+        int             index[3];           ///< voxel index, lower corner of the stencil in case of trilinear splats
+        bool            trilinear;
+        float           weights[3][2];      ///< trilinear weights of the lower and upper voxel per axis
+        float           values[VComponents];
+    };
+
+    FiberVoxelizer(TValue* buffer, const itk::Size<3>& size)
+        : m_Buffer(buffer)
+        , m_BinaryOutput(false)
+        , m_NumberOfThreads(1)
+        , m_MaxPointsPerChunk(1<<21)
+    {
+        for (int i=0; i<3; i++)
+            m_Size[i] = size[i];
+    }
+
+    /** Voxels hit by a splat are set to 1 instead of accumulating the values. */
+    void SetBinaryOutput(bool binary){ m_BinaryOutput = binary; }
+
+    void SetNumberOfThreads(int numThreads){ m_NumberOfThreads = std::max(1, numThreads); }
+
+    /** Convenience function for splat functions: single voxel splat with the given value in all components. */
+    static Splat NearestNeighborSplat(const int index[3], float value)
+    {
+        Splat splat;
+        splat.trilinear = false;
+        for (int i=0; i<3; i++)
+        {
+            splat.index[i] = index[i];
+            splat.weights[i][0] = 1;
+            splat.weights[i][1] = 0;
+        }
+        for (unsigned int c=0; c<VComponents; c++)
+            splat.values[c] = value;
+        return splat;
+    }
+
+    /** Returns true if the voxel, or all voxels of the trilinear stencil, are inside of the image. */
+    bool IsInside(const Splat& splat) const
+    {
+        int upper = splat.trilinear ? 1 : 0;
+        for (int i=0; i<3; i++)
+            if (splat.index[i]<0 || splat.index[i]+upper>=m_Size[i])
+                return false;
+        return true;
+    }
+
+    /**
+    * \brief Voxelizes all fibers of the polydata.
+    *
+    * splatFunction(fiberIndex, numPoints, points, splats) is called for every fiber and appends the splats of its
+    * points. It is called from several threads concurrently and must therefore only read shared data (e.g. use the
+    * thread safe vtkPolyData::GetPoint(id, x)). Splats outside of the image are skipped.
+    */
+    template< class TSplatFunction >
+    void Voxelize(vtkPolyData* fiberPolyData, TSplatFunction splatFunction)
+    {
+        std::vector< vtkIdType > fiberNumPoints;
+        std::vector< vtkIdType* > fiberPoints;
+        vtkCellArray* vLines = fiberPolyData->GetLines();
+        vLines->InitTraversal();
+        vtkIdType numPoints(0);
+        vtkIdType* points(NULL);
+        while (vLines->GetNextCell(numPoints, points))
+        {
+            fiberNumPoints.push_back(numPoints);
+            fiberPoints.push_back(points);
+        }
+        int numFibers = fiberPoints.size();
+
+        int numSlabs = std::min(m_Size[2], 4*m_NumberOfThreads);
+        if (numSlabs<1)
+            return;
+        m_SlabThickness = (m_Size[2]+numSlabs-1)/numSlabs;
+        numSlabs = (m_Size[2]+m_SlabThickness-1)/m_SlabThickness;
+
+        boost::progress_display disp(numFibers);
+        int chunkStart = 0;
+        while (chunkStart<numFibers)
+        {
+            int chunkEnd = chunkStart;
+            vtkIdType chunkPoints = 0;
+            while (chunkEnd<numFibers && (chunkEnd==chunkStart || chunkPoints+fiberNumPoints[chunkEnd]<=m_MaxPointsPerChunk))
+                chunkPoints += fiberNumPoints[chunkEnd++];
+
+            // several blocks per thread balance fibers of different length
+            int numBlocks = std::min(chunkEnd-chunkStart, 4*m_NumberOfThreads);
+            std::vector< std::vector< std::vector< Splat > > > slabSplats(numBlocks, std::vector< std::vector< Splat > >(numSlabs));
+
+#pragma omp parallel for schedule(dynamic) num_threads(m_NumberOfThreads)
+            for (int b=0; b<numBlocks; b++)
+            {
+                int blockStart = chunkStart + (long)(chunkEnd-chunkStart)*b/numBlocks;
+                int blockEnd = chunkStart + (long)(chunkEnd-chunkStart)*(b+1)/numBlocks;
+
+                std::vector< Splat > fiberSplats;
+                for (int i=blockStart; i<blockEnd; i++)
+                {
+                    fiberSplats.clear();
+                    splatFunction(i, fiberNumPoints[i], fiberPoints[i], fiberSplats);
+                    for (const Splat& splat : fiberSplats)
+                    {
+                        if (!IsInside(splat))
+                            continue;
+                        int slab = splat.index[2]/m_SlabThickness;
+                        slabSplats[b][slab].push_back(splat);
+                        if (splat.trilinear && (splat.index[2]+1)/m_SlabThickness!=slab)
+                            slabSplats[b][slab+1].push_back(splat);
+                    }
+                }
+
+#pragma omp critical
+                disp += blockEnd-blockStart;
+            }
+
+#pragma omp parallel for schedule(dynamic) num_threads(m_NumberOfThreads)
+            for (int s=0; s<numSlabs; s++)
+                for (int b=0; b<numBlocks; b++)
+                    for (const Splat& splat : slabSplats[b][s])
+                        AddSplat(splat, s*m_SlabThickness, (s+1)*m_SlabThickness);
+
+            chunkStart = chunkEnd;
+        }
+    }
+
+protected:
+
+    /** Writes the voxels of the splat with zBegin <= z < zEnd. */
+    void AddSplat(const Splat& splat, int zBegin, int zEnd)
+    {
+        int upper = splat.trilinear ? 1 : 0;
+        for (int dz=0; dz<=upper; dz++)
+        {
+            int z = splat.index[2]+dz;
+            if (z<zBegin || z>=zEnd)
+                continue;
+            for (int dy=0; dy<=upper; dy++)
+                for (int dx=0; dx<=upper; dx++)
+                {
+                    TValue* voxel = m_Buffer + VComponents*(splat.index[0]+dx + m_Size[0]*(splat.index[1]+dy + m_Size[1]*z));
+                    if (m_BinaryOutput)
+                    {
+                        for (unsigned int c=0; c<VComponents; c++)
+                            voxel[c] = 1;
+                    }
+                    else if (splat.trilinear)
+                    {
+                        float weight = splat.weights[0][dx]*splat.weights[1][dy]*splat.weights[2][dz];
+                        for (unsigned int c=0; c<VComponents; c++)
+                            voxel[c] += weight*splat.values[c];
+                    }
+                    else
+                    {
+                        for (unsigned int c=0; c<VComponents; c++)
+                            voxel[c] += splat.values[c];
+                    }
+                }
+        }
+    }
+
+    TValue*     m_Buffer;
+    int         m_Size[3];
+    bool        m_BinaryOutput;
+    int         m_NumberOfThreads;
+    vtkIdType   m_MaxPointsPerChunk;
+    int         m_SlabThickness;
+};
+
+}
+
+#endif // __itkFiberVoxelizer_h__
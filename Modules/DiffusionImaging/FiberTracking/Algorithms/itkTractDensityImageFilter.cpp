@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 #include "itkTractDensityImageFilter.h"
 
+#include "itkFiberVoxelizer.h"
+
 // VTK
 #include <vtkPolyLine.h>
 #include <vtkCellArray.h>
@@ -23,7 +25,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // misc
 #include <math.h>
-#include <boost/progress.hpp>
 
 namespace itk{
 
@@ -143,92 +144,55 @@ void TractDensityImageFilter< OutputImageType >::GenerateData()
     MITK_INFO << "TractDensityImageFilter: starting image generation";
 
     vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
-    vtkSmartPointer<vtkCellArray> vLines = fiberPolyData->GetLines();
-    vLines->InitTraversal();
-    int numFibers = m_FiberBundle->GetNumFibers();
-    boost::progress_display disp(numFibers);
-    for( int i=0; i<numFibers; i++ )
+    const OutputImageType* image = outImage.GetPointer();
+    mitk::FiberBundle* fib = m_FiberBundle.GetPointer();
+    bool useTrilinearInterpolation = m_UseTrilinearInterpolation;
+
+    typedef FiberVoxelizer< OutPixelType > VoxelizerType;
+    VoxelizerType voxelizer(outImageBufferPointer, upsampledSize);
+    voxelizer.SetBinaryOutput(m_BinaryOutput);
+    voxelizer.SetNumberOfThreads(this->GetNumberOfThreads());
+    voxelizer.Voxelize(fiberPolyData, [&](int i, vtkIdType numPoints, const vtkIdType* points, std::vector< typename VoxelizerType::Splat >& splats)
     {
-        ++disp;
-        vtkIdType   numPoints(0);
-        vtkIdType*  points(NULL);
-        vLines->GetNextCell ( numPoints, points );
-        float weight = m_FiberBundle->GetFiberWeight(i);
+        float weight = fib->GetFiberWeight(i);
 
-        // fill output image
         for( int j=0; j<numPoints; j++)
         {
-            itk::Point<float, 3> vertex = GetItkPoint(fiberPolyData->GetPoint(points[j]));
+            double p[3];
+            fiberPolyData->GetPoint(points[j], p);
+            itk::Point<float, 3> vertex = GetItkPoint(p);
             itk::Index<3> index;
             itk::ContinuousIndex<float, 3> contIndex;
-            outImage->TransformPhysicalPointToIndex(vertex, index);
-            outImage->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
-
-            if (!m_UseTrilinearInterpolation && outImage->GetLargestPossibleRegion().IsInside(index))
-            {
-                if (m_BinaryOutput)
-                    outImage->SetPixel(index, 1);
-                else
-                    outImage->SetPixel(index, outImage->GetPixel(index)+0.01*weight);
-                continue;
-            }
+            image->TransformPhysicalPointToIndex(vertex, index);
+            image->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
 
-            float frac_x = contIndex[0] - index[0];
-            float frac_y = contIndex[1] - index[1];
-            float frac_z = contIndex[2] - index[2];
+            typename VoxelizerType::Splat splat;
+            for (int k=0; k<3; k++)
+                splat.index[k] = index[k];
 
-            if (frac_x<0)
-            {
-                index[0] -= 1;
-                frac_x += 1;
-            }
-            if (frac_y<0)
-            {
-                index[1] -= 1;
-                frac_y += 1;
-            }
-            if (frac_z<0)
+            if (!useTrilinearInterpolation && image->GetLargestPossibleRegion().IsInside(index))
             {
-                index[2] -= 1;
-                frac_z += 1;
-            }
-
-            frac_x = 1-frac_x;
-            frac_y = 1-frac_y;
-            frac_z = 1-frac_z;
-
-            // int coordinates inside image?
-            if (index[0] < 0 || index[0] >= w-1)
-                continue;
-            if (index[1] < 0 || index[1] >= h-1)
-                continue;
-            if (index[2] < 0 || index[2] >= d-1)
+                splats.push_back(VoxelizerType::NearestNeighborSplat(splat.index, 0.01*weight));
                 continue;
-
-            if (m_BinaryOutput)
-            {
-                outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]  ))] = 1;
-                outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]  ))] = 1;
-                outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]+h))] = 1;
-                outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]+h))] = 1;
-                outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]  ))] = 1;
-                outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]+h))] = 1;
-                outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]  ))] = 1;
-                outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]+h))] = 1;
             }
-            else
+
+            // trilinear weights of the lower and upper neighbor, the fiber weight is not applied here
+            splat.trilinear = true;
+            splat.values[0] = 1;
+            for (int k=0; k<3; k++)
             {
-                outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]  ))] += (  frac_x)*(  frac_y)*(  frac_z);
-                outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]  ))] += (  frac_x)*(1-frac_y)*(  frac_z);
-                outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]+h))] += (  frac_x)*(  frac_y)*(1-frac_z);
-                outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]+h))] += (  frac_x)*(1-frac_y)*(1-frac_z);
-                outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]  ))] += (1-frac_x)*(  frac_y)*(  frac_z);
-                outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]+h))] += (1-frac_x)*(  frac_y)*(1-frac_z);
-                outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]  ))] += (1-frac_x)*(1-frac_y)*(  frac_z);
-                outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]+h))] += (1-frac_x)*(1-frac_y)*(1-frac_z);
+                float frac = contIndex[k] - index[k];
+                if (frac<0)
+                {
+                    splat.index[k] -= 1;
+                    frac += 1;
+                }
+                splat.weights[k][0] = 1-frac;
+                splat.weights[k][1] = 1-splat.weights[k][0];
             }
+            splats.push_back(splat);
         }
-    }
+    });
 
     m_MaxDensity = 0;
     for (int i=0; i<w*h*d; i++)
@@ -15,11 +15,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 #include "itkTractsToFiberEndingsImageFilter.h"
 
+#include "itkFiberVoxelizer.h"
+
 // VTK
 #include <vtkPolyLine.h>
 #include <vtkCellArray.h>
 #include <vtkCellData.h>
-#include <boost/progress.hpp>
 
 namespace itk{
 
@@ -117,41 +118,32 @@ namespace itk{
         minSpacing = newSpacing[2];
 
     vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
-    vtkSmartPointer<vtkCellArray> vLines = fiberPolyData->GetLines();
-    vLines->InitTraversal();
+    const OutputImageType* image = outImage.GetPointer();
 
-    int numFibers = m_FiberBundle->GetNumFibers();
-    boost::progress_display disp(numFibers);
-    for( int i=0; i<numFibers; i++ )
+    typedef FiberVoxelizer< OutPixelType > VoxelizerType;
+    VoxelizerType voxelizer(outImageBufferPointer, upsampledSize);
+    voxelizer.SetBinaryOutput(m_BinaryOutput);
+    voxelizer.SetNumberOfThreads(this->GetNumberOfThreads());
+    voxelizer.Voxelize(fiberPolyData, [&](int, vtkIdType numPoints, const vtkIdType* points, std::vector< typename VoxelizerType::Splat >& splats)
     {
-        ++disp;
-      vtkIdType   numPoints(0);
-      vtkIdType*  points(NULL);
-      vLines->GetNextCell ( numPoints, points );
-
-      // fill output image
-      if (numPoints>0)
+      auto addEnding = [&](vtkIdType pointId)
       {
-        itk::Point<float, 3> vertex = GetItkPoint(fiberPolyData->GetPoint(points[0]));
+        double p[3];
+        fiberPolyData->GetPoint(pointId, p);
+        itk::Point<float, 3> vertex = GetItkPoint(p);
         itk::Index<3> index;
-        outImage->TransformPhysicalPointToIndex(vertex, index);
-        if (m_BinaryOutput)
-            outImage->SetPixel(index, 1);
-        else
-            outImage->SetPixel(index, outImage->GetPixel(index)+1);
-      }
+        image->TransformPhysicalPointToIndex(vertex, index);
+
+        // endings outside of the image are skipped by the voxelizer
+        int voxel[3] = {(int)index[0], (int)index[1], (int)index[2]};
+        splats.push_back(VoxelizerType::NearestNeighborSplat(voxel, 1));
+      };
 
+      if (numPoints>0)
+        addEnding(points[0]);
       if (numPoints>2)
-      {
-        itk::Point<float, 3> vertex = GetItkPoint(fiberPolyData->GetPoint(points[numPoints-1]));
-        itk::Index<3> index;
-        outImage->TransformPhysicalPointToIndex(vertex, index);
-        if (m_BinaryOutput)
-            outImage->SetPixel(index, 1);
-        else
-            outImage->SetPixel(index, outImage->GetPixel(index)+1);
-      }
-    }
+        addEnding(points[numPoints-1]);
+    });
 
     if (m_InvertImage)
       for (int i=0; i<w*h*d; i++)
@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 #include "itkTractsToRgbaImageFilter.h"
 
+#include "itkFiberVoxelizer.h"
+
 // VTK
 #include <vtkPolyLine.h>
 #include <vtkCellArray.h>
@@ -22,7 +24,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // misc
 #include <math.h>
-#include <boost/progress.hpp>
 
 namespace itk{
 
@@ -108,9 +109,7 @@ namespace itk{
 
     // set/initialize output
     unsigned char* outImageBufferPointer = (unsigned char*)outImage->GetBufferPointer();
-    float* buffer = new float[w*h*d*4];
-    for (int i=0; i<w*h*d*4; i++)
-      buffer[i] = 0;
+    std::vector<float> buffer(w*h*d*4, 0);
 
     // resample fiber bundle
     float minSpacing = 1;
@@ -125,17 +124,21 @@ namespace itk{
     m_FiberBundle->ResampleSpline(minSpacing);
 
     vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
-    vtkSmartPointer<vtkCellArray> vLines = fiberPolyData->GetLines();
-    vLines->InitTraversal();
+    const OutputImageType* image = outImage.GetPointer();
+    float scale = 100 * pow((float)m_UpsamplingFactor,3);
 
-    int numFibers = m_FiberBundle->GetNumFibers();
-    boost::progress_display disp(numFibers);
-    for( int i=0; i<numFibers; i++ )
+    typedef FiberVoxelizer< float, 4 > VoxelizerType;
+    VoxelizerType voxelizer(buffer.data(), upsampledSize);
+    voxelizer.SetNumberOfThreads(this->GetNumberOfThreads());
+    voxelizer.Voxelize(fiberPolyData, [&](int, vtkIdType numPoints, const vtkIdType* points, std::vector< typename VoxelizerType::Splat >& splats)
     {
-      ++disp;
-      vtkIdType   numPoints(0);
-      vtkIdType*  points(NULL);
-      vLines->GetNextCell ( numPoints, points );
+      std::vector< itk::Point<float, 3> > vertices(numPoints);
+      for( int j=0; j<numPoints; j++)
+      {
+        double p[3];
+        fiberPolyData->GetPoint(points[j], p);
+        vertices[j] = GetItkPoint(p);
+      }
 
       // calc directions (which are used as weights)
       std::list< itk::Point<float, 3> > rgbweights;
@@ -143,14 +146,10 @@ namespace itk{
 
       for( int j=0; j<numPoints-1; j++)
       {
-
-        itk::Point<float, 3> vertex = GetItkPoint(fiberPolyData->GetPoint(points[j]));
-        itk::Point<float, 3> vertexPost = GetItkPoint(fiberPolyData->GetPoint(points[j+1]));
-
         itk::Point<float, 3> dir;
-        dir[0] = fabs((vertexPost[0] - vertex[0]) * outImage->GetSpacing()[0]);
-        dir[1] = fabs((vertexPost[1] - vertex[1]) * outImage->GetSpacing()[1]);
-        dir[2] = fabs((vertexPost[2] - vertex[2]) * outImage->GetSpacing()[2]);
+        dir[0] = fabs((vertices[j+1][0] - vertices[j][0]) * image->GetSpacing()[0]);
+        dir[1] = fabs((vertices[j+1][1] - vertices[j][1]) * image->GetSpacing()[1]);
+        dir[2] = fabs((vertices[j+1][2] - vertices[j][2]) * image->GetSpacing()[2]);
 
         rgbweights.push_back(dir);
 
@@ -168,92 +167,44 @@ namespace itk{
       // fill output image
       for( int j=0; j<numPoints; j++)
       {
-        itk::Point<float, 3> vertex = GetItkPoint(fiberPolyData->GetPoint(points[j]));
         itk::Index<3> index;
         itk::ContinuousIndex<float, 3> contIndex;
-        outImage->TransformPhysicalPointToIndex(vertex, index);
-        outImage->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
-
-        float frac_x = contIndex[0] - index[0];
-        float frac_y = contIndex[1] - index[1];
-        float frac_z = contIndex[2] - index[2];
+        image->TransformPhysicalPointToIndex(vertices[j], index);
+        image->TransformPhysicalPointToContinuousIndex(vertices[j], contIndex);
 
-        int px = index[0];
-        if (frac_x<0)
+        typename VoxelizerType::Splat splat;
+        splat.trilinear = true;
+        for (int k=0; k<3; k++)
         {
-          px -= 1;
-          frac_x += 1;
+          splat.index[k] = index[k];
+          float frac = contIndex[k] - index[k];
+          if (frac<0)
+          {
+            splat.index[k] -= 1;
+            frac += 1;
+          }
+          splat.weights[k][0] = 1-frac;
+          splat.weights[k][1] = frac;
         }
 
-        int py = index[1];
-        if (frac_y<0)
-        {
-          py -= 1;
-          frac_y += 1;
-        }
-
-        int pz = index[2];
-        if (frac_z<0)
-        {
-          pz -= 1;
-          frac_z += 1;
-        }
-
-        // int coordinates inside image?
-        if (px < 0 || px >= w-1)
-          continue;
-        if (py < 0 || py >= h-1)
-          continue;
-        if (pz < 0 || pz >= d-1)
+        // int coordinates inside image? only those points consume a weight
+        if (!voxelizer.IsInside(splat))
           continue;
 
-        float scale = 100 * pow((float)m_UpsamplingFactor,3);
         itk::Point<float, 3> rgbweight = rgbweights.front();
         rgbweights.pop_front();
         float intweight = intensities.front();
         intensities.pop_front();
 
-        // add to r-channel in output image
-        buffer[0+4*( px   + w*(py  + h*pz  ))] += (1-frac_x)*(1-frac_y)*(1-frac_z) * rgbweight[0] * scale;
-        buffer[0+4*( px   + w*(py+1+ h*pz  ))] += (1-frac_x)*(  frac_y)*(1-frac_z) * rgbweight[0] * scale;
-        buffer[0+4*( px   + w*(py  + h*pz+h))] += (1-frac_x)*(1-frac_y)*(  frac_z) * rgbweight[0] * scale;
-        buffer[0+4*( px   + w*(py+1+ h*pz+h))] += (1-frac_x)*(  frac_y)*(  frac_z) * rgbweight[0] * scale;
-        buffer[0+4*( px+1 + w*(py  + h*pz  ))] += (  frac_x)*(1-frac_y)*(1-frac_z) * rgbweight[0] * scale;
-        buffer[0+4*( px+1 + w*(py  + h*pz+h))] += (  frac_x)*(1-frac_y)*(  frac_z) * rgbweight[0] * scale;
-        buffer[0+4*( px+1 + w*(py+1+ h*pz  ))] += (  frac_x)*(  frac_y)*(1-frac_z) * rgbweight[0] * scale;
-        buffer[0+4*( px+1 + w*(py+1+ h*pz+h))] += (  frac_x)*(  frac_y)*(  frac_z) * rgbweight[0] * scale;
-
-        // add to g-channel in output image
-        buffer[1+4*( px   + w*(py  + h*pz  ))] += (1-frac_x)*(1-frac_y)*(1-frac_z) * rgbweight[1] * scale;
-        buffer[1+4*( px   + w*(py+1+ h*pz  ))] += (1-frac_x)*(  frac_y)*(1-frac_z) * rgbweight[1] * scale;
-        buffer[1+4*( px   + w*(py  + h*pz+h))] += (1-frac_x)*(1-frac_y)*(  frac_z) * rgbweight[1] * scale;
-        buffer[1+4*( px   + w*(py+1+ h*pz+h))] += (1-frac_x)*(  frac_y)*(  frac_z) * rgbweight[1] * scale;
-        buffer[1+4*( px+1 + w*(py  + h*pz  ))] += (  frac_x)*(1-frac_y)*(1-frac_z) * rgbweight[1] * scale;
-        buffer[1+4*( px+1 + w*(py  + h*pz+h))] += (  frac_x)*(1-frac_y)*(  frac_z) * rgbweight[1] * scale;
-        buffer[1+4*( px+1 + w*(py+1+ h*pz  ))] += (  frac_x)*(  frac_y)*(1-frac_z) * rgbweight[1] * scale;
-        buffer[1+4*( px+1 + w*(py+1+ h*pz+h))] += (  frac_x)*(  frac_y)*(  frac_z) * rgbweight[1] * scale;
-
-        // add to b-channel in output image
-        buffer[2+4*( px   + w*(py  + h*pz  ))] += (1-frac_x)*(1-frac_y)*(1-frac_z) * rgbweight[2] * scale;
-        buffer[2+4*( px   + w*(py+1+ h*pz  ))] += (1-frac_x)*(  frac_y)*(1-frac_z) * rgbweight[2] * scale;
-        buffer[2+4*( px   + w*(py  + h*pz+h))] += (1-frac_x)*(1-frac_y)*(  frac_z) * rgbweight[2] * scale;
-        buffer[2+4*( px   + w*(py+1+ h*pz+h))] += (1-frac_x)*(  frac_y)*(  frac_z) * rgbweight[2] * scale;
-        buffer[2+4*( px+1 + w*(py  + h*pz  ))] += (  frac_x)*(1-frac_y)*(1-frac_z) * rgbweight[2] * scale;
-        buffer[2+4*( px+1 + w*(py  + h*pz+h))] += (  frac_x)*(1-frac_y)*(  frac_z) * rgbweight[2] * scale;
-        buffer[2+4*( px+1 + w*(py+1+ h*pz  ))] += (  frac_x)*(  frac_y)*(1-frac_z) * rgbweight[2] * scale;
-        buffer[2+4*( px+1 + w*(py+1+ h*pz+h))] += (  frac_x)*(  frac_y)*(  frac_z) * rgbweight[2] * scale;
-
-        // add to a-channel in output image
-        buffer[3+4*( px   + w*(py  + h*pz  ))] += (1-frac_x)*(1-frac_y)*(1-frac_z) * intweight * scale;
-        buffer[3+4*( px   + w*(py+1+ h*pz  ))] += (1-frac_x)*(  frac_y)*(1-frac_z) * intweight * scale;
-        buffer[3+4*( px   + w*(py  + h*pz+h))] += (1-frac_x)*(1-frac_y)*(  frac_z) * intweight * scale;
-        buffer[3+4*( px   + w*(py+1+ h*pz+h))] += (1-frac_x)*(  frac_y)*(  frac_z) * intweight * scale;
-        buffer[3+4*( px+1 + w*(py  + h*pz  ))] += (  frac_x)*(1-frac_y)*(1-frac_z) * intweight * scale;
-        buffer[3+4*( px+1 + w*(py  + h*pz+h))] += (  frac_x)*(1-frac_y)*(  frac_z) * intweight * scale;
-        buffer[3+4*( px+1 + w*(py+1+ h*pz  ))] += (  frac_x)*(  frac_y)*(1-frac_z) * intweight * scale;
-        buffer[3+4*( px+1 + w*(py+1+ h*pz+h))] += (  frac_x)*(  frac_y)*(  frac_z) * intweight * scale;
+        // r, g, b and a channel of the output image
+        splat.values[0] = rgbweight[0] * scale;
+        splat.values[1] = rgbweight[1] * scale;
+        splat.values[2] = rgbweight[2] * scale;
+        splat.values[3] = intweight * scale;
+        splats.push_back(splat);
       }
-    }
+    });
+
     float maxRgb = 0.000000001;
     float maxInt = 0.000000001;
     int numPix;
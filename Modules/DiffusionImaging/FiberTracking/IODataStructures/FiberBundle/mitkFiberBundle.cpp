@@ -29,6 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkUnsignedCharArray.h>
 #include <vtkPolyLine.h>
 #include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkCellData.h>
 #include <vtkIdFilter.h>
 #include <vtkClipPolyData.h>
@@ -40,6 +41,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolygon.h>
 #include <vtkCleanPolyData.h>
 #include <cmath>
+#include <algorithm>
+#include <unordered_map>
 #include <boost/progress.hpp>
 #include <vtkTransformPolyDataFilter.h>
 #include <mitkTransferFunction.h>
@@ -51,7 +54,9 @@ const char* mitk::FiberBundle::FIBER_ID_ARRAY = "Fiber_IDs";
 using namespace std;
 
 mitk::FiberBundle::FiberBundle( vtkPolyData* fiberPolyData )
-    : m_NumFibers(0)
+    : m_FiberPointsSource(nullptr)
+    , m_FiberPointsMTime(0)
+    , m_NumFibers(0)
 {
     m_FiberWeights = vtkSmartPointer<vtkFloatArray>::New();
     m_FiberWeights->SetName("FIBER_WEIGHTS");
@@ -114,8 +119,250 @@ vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vecto
     return newFiberPolyData;
 }
 
+namespace
+{
+  /**
+   * Spatial hash of fiber end points. Each fiber is stored in the grid cell of its start point, so looking up a fiber
+   * with the same (or the reversed) pair of end points only has to compare against the few fibers in one or two cells
+   * instead of against all fibers of the bundle.
+   */
+  class FiberEndPointHash
+  {
+  public:
+
+    typedef itk::Point<float, 3> PointType;
+
+    FiberEndPointHash(double cellSize=1.0)
+      : m_CellSize(cellSize)
+      , m_Tolerance(std::sqrt(mitk::eps))   // end points match if their squared distance is below mitk::eps
+    {}
+
+    void Reserve(size_t numFibers)
+    {
+      m_Cells.reserve(numFibers);
+      m_EndPoints.reserve(numFibers);
+    }
+
+    void Insert(const PointType& start, const PointType& end)
+    {
+      m_Cells[GetCellIndex(start)].push_back(m_EndPoints.size());
+      m_EndPoints.push_back(std::make_pair(start, end));
+    }
+
+    // true if a fiber with the same start and end point (in either direction) was inserted before
+    bool Contains(const PointType& start, const PointType& end) const
+    {
+      return ContainsStartingAt(start, end) || ContainsStartingAt(end, start);
+    }
+
+  private:
+
+    struct CellIndex
+    {
+      long long x, y, z;
+      bool operator==(const CellIndex& other) const { return x==other.x && y==other.y && z==other.z; }
+    };
+
+    struct CellIndexHash
+    {
+      size_t operator()(const CellIndex& c) const
+      {
+        return static_cast<size_t>(c.x*73856093LL ^ c.y*19349663LL ^ c.z*83492791LL);
+      }
+    };
+
+    long long GetCellCoordinate(double value) const
+    {
+      return static_cast<long long>(std::floor(value/m_CellSize));
+    }
+
+    CellIndex GetCellIndex(const PointType& p) const
+    {
+      CellIndex c = {GetCellCoordinate(p[0]), GetCellCoordinate(p[1]), GetCellCoordinate(p[2])};
+      return c;
+    }
+
+    bool ContainsStartingAt(const PointType& start, const PointType& end) const
+    {
+      // points closer than the tolerance to a cell border may have been hashed into the neighbouring cell
+      long long lower[3], upper[3];
+      for (int d=0; d<3; d++)
+      {
+        lower[d] = GetCellCoordinate(start[d]-m_Tolerance);
+        upper[d] = GetCellCoordinate(start[d]+m_Tolerance);
+      }
+
+      CellIndex c;
+      for (c.x=lower[0]; c.x<=upper[0]; c.x++)
+        for (c.y=lower[1]; c.y<=upper[1]; c.y++)
+          for (c.z=lower[2]; c.z<=upper[2]; c.z++)
+          {
+            auto cell = m_Cells.find(c);
+            if (cell==m_Cells.end())
+              continue;
+
+            for (size_t id : cell->second)
+            {
+              const std::pair<PointType, PointType>& candidate = m_EndPoints[id];
+              if (candidate.first.SquaredEuclideanDistanceTo(start)<mitk::eps && candidate.second.SquaredEuclideanDistanceTo(end)<mitk::eps)
+                return true;
+            }
+          }
+      return false;
+    }
+
+    double m_CellSize;
+    double m_Tolerance;
+    std::unordered_map< CellIndex, std::vector< size_t >, CellIndexHash > m_Cells;
+    std::vector< std::pair< PointType, PointType > > m_EndPoints;
+  };
+}
+
+namespace
+{
+  // polydata with one polyline per fiber, built from contiguous fiber points and offsets
+  vtkSmartPointer<vtkPolyData> CreateFiberPolyData(const std::vector< float >& points, const std::vector< vtkIdType >& offsets)
+  {
+    long numFibers = offsets.empty() ? 0 : offsets.size()-1;
+    vtkIdType numPoints = points.size()/3;
+
+    vtkSmartPointer<vtkFloatArray> pointData = vtkSmartPointer<vtkFloatArray>::New();
+    pointData->SetNumberOfComponents(3);
+    pointData->SetNumberOfTuples(numPoints);
+    if (numPoints>0)
+      std::copy(points.begin(), points.end(), pointData->GetPointer(0));
+
+    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+    vtkNewPoints->SetData(pointData);
+
+    // legacy cell array layout: number of points followed by the point ids, for each fiber
+    vtkSmartPointer<vtkIdTypeArray> cellData = vtkSmartPointer<vtkIdTypeArray>::New();
+    cellData->SetNumberOfValues(numFibers+numPoints);
+    if (numFibers>0)
+    {
+      vtkIdType* cells = cellData->GetPointer(0);
+#pragma omp parallel for
+      for (long i=0; i<numFibers; i++)
+      {
+        vtkIdType* cell = cells + offsets[i] + i;
+        *cell = offsets[i+1]-offsets[i];
+        for (vtkIdType j=offsets[i]; j<offsets[i+1]; j++)
+          *(++cell) = j;
+      }
+    }
+
+    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    vtkNewCells->SetCells(numFibers, cellData);
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(vtkNewPoints);
+    polyData->SetLines(vtkNewCells);
+    return polyData;
+  }
+
+  // copy the fibers flagged in keep to newPoints/newOffsets
+  void CopyFibers(const std::vector< float >& points, const std::vector< vtkIdType >& offsets, const std::vector< unsigned char >& keep,
+                  std::vector< float >& newPoints, std::vector< vtkIdType >& newOffsets)
+  {
+    std::vector< long > sourceFibers;
+    newOffsets.assign(1, 0);
+    for (unsigned int i=0; i<keep.size() && i+1<offsets.size(); i++)
+    {
+      if (!keep[i])
+        continue;
+      sourceFibers.push_back(i);
+      newOffsets.push_back(newOffsets.back()+offsets[i+1]-offsets[i]);
+    }
+
+    newPoints.resize(3*newOffsets.back());
+#pragma omp parallel for
+    for (long i=0; i<(long)sourceFibers.size(); i++)
+    {
+      long source = sourceFibers[i];
+      std::copy(points.begin()+3*offsets[source], points.begin()+3*offsets[source+1], newPoints.begin()+3*newOffsets[i]);
+    }
+  }
+}
+
+void mitk::FiberBundle::UpdateFiberPointArrays()
+{
+    if (m_FiberPointsSource==m_FiberPolyData.GetPointer() && m_FiberPointsMTime==m_FiberPolyData->GetMTime())
+        return;
+
+    m_FiberPointOffsets.assign(1, 0);
+    m_FiberPointIds.clear();
+
+    // the cell array has to be traversed sequentially, the coordinates are copied in parallel afterwards
+    std::vector< vtkIdType > pointIds;
+    bool consecutive = true;
+    vtkCellArray* lines = m_FiberPolyData->GetLines();
+    vtkPoints* points = m_FiberPolyData->GetPoints();
+    if (lines!=nullptr && points!=nullptr)
+    {
+        pointIds.reserve(lines->GetNumberOfConnectivityEntries()-lines->GetNumberOfCells());
+        m_FiberPointOffsets.reserve(lines->GetNumberOfCells()+1);
+
+        vtkIdType numPoints;
+        vtkIdType* ids;
+        lines->InitTraversal();
+        while (lines->GetNextCell(numPoints, ids))
+        {
+            for (vtkIdType j=0; j<numPoints; j++)
+            {
+                if (ids[j]!=(vtkIdType)pointIds.size())
+                    consecutive = false;
+                pointIds.push_back(ids[j]);
+            }
+            m_FiberPointOffsets.push_back(pointIds.size());
+        }
+    }
+
+    m_FiberPoints.resize(3*pointIds.size());
+#pragma omp parallel for
+    for (long k=0; k<(long)pointIds.size(); k++)
+    {
+        double p[3];
+        points->GetPoint(pointIds[k], p);
+        m_FiberPoints[3*k] = p[0];
+        m_FiberPoints[3*k+1] = p[1];
+        m_FiberPoints[3*k+2] = p[2];
+    }
+
+    if (!consecutive)
+        m_FiberPointIds.swap(pointIds);
+
+    m_FiberPointsSource = m_FiberPolyData.GetPointer();
+    m_FiberPointsMTime = m_FiberPolyData->GetMTime();
+}
+
+const std::vector< float >& mitk::FiberBundle::GetFiberPoints()
+{
+    this->UpdateFiberPointArrays();
+    return m_FiberPoints;
+}
+
+const std::vector< vtkIdType >& mitk::FiberBundle::GetFiberPointOffsets()
+{
+    this->UpdateFiberPointArrays();
+    return m_FiberPointOffsets;
+}
+
+bool mitk::FiberBundle::GetFiberEndPoints(vtkPolyData* polyData, vtkIdType fiber, itk::Point<float, 3>& start, itk::Point<float, 3>& end)
+{
+    vtkCell* cell = polyData->GetCell(fiber);
+    int numPoints = cell->GetNumberOfPoints();
+    vtkPoints* points = cell->GetPoints();
+
+    if (points==nullptr || numPoints<=0)
+        return false;
+
+    start = GetItkPoint(points->GetPoint(0));
+    end = GetItkPoint(points->GetPoint(numPoints-1));
+    return true;
+}
+
 // merge two fiber bundles
-mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
+mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib, bool removeDuplicates)
 {
     if (fib==nullptr)
     {
@@ -128,59 +375,64 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
     vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
     vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
 
-    // add current fiber bundle
-    vtkSmartPointer<vtkFloatArray> weights = vtkSmartPointer<vtkFloatArray>::New();
-    weights->SetNumberOfValues(this->GetNumFibers()+fib->GetNumFibers());
+    std::vector< float > weights;
+    weights.reserve(this->GetNumFibers()+fib->GetNumFibers());
 
-    unsigned int counter = 0;
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
-    {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+    FiberEndPointHash endPointHash;
+    if (removeDuplicates)
+        endPointHash.Reserve(this->GetNumFibers()+fib->GetNumFibers());
 
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-        for (int j=0; j<numPoints; j++)
+    // add current fiber bundle, then the new fiber bundle
+    mitk::FiberBundle* bundles[2] = {this, fib};
+    for (mitk::FiberBundle* bundle : bundles)
+    {
+        vtkPolyData* polyData = bundle->GetFiberPolyData();
+        for (int i=0; i<polyData->GetNumberOfCells(); i++)
         {
-            double p[3];
-            points->GetPoint(j, p);
-
-            vtkIdType id = vNewPoints->InsertNextPoint(p);
-            container->GetPointIds()->InsertNextId(id);
-        }
-        weights->InsertValue(counter, this->GetFiberWeight(i));
-        vNewLines->InsertNextCell(container);
-        counter++;
-    }
+            if (removeDuplicates)
+            {
+                itk::Point<float, 3> start, end;
+                if (GetFiberEndPoints(polyData, i, start, end))
+                {
+                    if (endPointHash.Contains(start, end))
+                        continue;
+                    endPointHash.Insert(start, end);
+                }
+            }
 
-    // add new fiber bundle
-    for (int i=0; i<fib->GetFiberPolyData()->GetNumberOfCells(); i++)
-    {
-        vtkCell* cell = fib->GetFiberPolyData()->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+            vtkCell* cell = polyData->GetCell(i);
+            int numPoints = cell->GetNumberOfPoints();
+            vtkPoints* points = cell->GetPoints();
 
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-        for (int j=0; j<numPoints; j++)
-        {
-            double p[3];
-            points->GetPoint(j, p);
+            vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+            for (int j=0; j<numPoints; j++)
+            {
+                double p[3];
+                points->GetPoint(j, p);
 
-            vtkIdType id = vNewPoints->InsertNextPoint(p);
-            container->GetPointIds()->InsertNextId(id);
+                vtkIdType id = vNewPoints->InsertNextPoint(p);
+                container->GetPointIds()->InsertNextId(id);
+            }
+            weights.push_back(bundle->GetFiberWeight(i));
+            vNewLines->InsertNextCell(container);
         }
-        weights->InsertValue(counter, fib->GetFiberWeight(i));
-        vNewLines->InsertNextCell(container);
-        counter++;
     }
 
+    if (removeDuplicates)
+        MITK_INFO << "Removed " << this->GetNumFibers()+fib->GetNumFibers()-weights.size() << " duplicate fibers";
+
+    vtkSmartPointer<vtkFloatArray> weightArray = vtkSmartPointer<vtkFloatArray>::New();
+    weightArray->SetNumberOfValues(weights.size());
+    for (unsigned int i=0; i<weights.size(); i++)
+        weightArray->SetValue(i, weights.at(i));
+
     // initialize polydata
     vNewPolyData->SetPoints(vNewPoints);
     vNewPolyData->SetLines(vNewLines);
 
     // initialize fiber bundle
     mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(vNewPolyData);
-    newFib->SetFiberWeights(weights);
+    newFib->SetFiberWeights(weightArray);
     return newFib;
 }
 
@@ -193,87 +445,38 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
     vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
     vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
 
-    std::vector< std::vector< itk::Point<float, 3> > > points1;
-    for( int i=0; i<m_NumFibers; i++ )
-    {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        if (points==nullptr || numPoints<=0)
-            continue;
-
-        itk::Point<float, 3> start = GetItkPoint(points->GetPoint(0));
-        itk::Point<float, 3> end = GetItkPoint(points->GetPoint(numPoints-1));
-
-        points1.push_back( {start, end} );
-    }
-
-    std::vector< std::vector< itk::Point<float, 3> > > points2;
+    FiberEndPointHash endPointHash;
+    endPointHash.Reserve(fib->GetNumFibers());
     for( int i=0; i<fib->GetNumFibers(); i++ )
     {
-        vtkCell* cell = fib->GetFiberPolyData()->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        if (points==nullptr || numPoints<=0)
-            continue;
-
-        itk::Point<float, 3> start = GetItkPoint(points->GetPoint(0));
-        itk::Point<float, 3> end = GetItkPoint(points->GetPoint(numPoints-1));
-
-        points2.push_back( {start, end} );
+        itk::Point<float, 3> start, end;
+        if (GetFiberEndPoints(fib->GetFiberPolyData(), i, start, end))
+            endPointHash.Insert(start, end);
     }
 
-    int progress = 0;
-    std::vector< int > ids;
+    // vtkPolyData::GetCell is not thread safe, so the end points are collected first
+    std::vector< itk::Point<float, 3> > starts(m_NumFibers), ends(m_NumFibers);
+    std::vector< unsigned char > keep(m_NumFibers, 0);
+    for( int i=0; i<m_NumFibers; i++ )
+        keep[i] = GetFiberEndPoints(m_FiberPolyData, i, starts[i], ends[i]);
+
+    // the hash is only read from here on, so the fibers can be matched in parallel
 #pragma omp parallel for
-    for (int i=0; i<points1.size(); i++)
+    for( int i=0; i<m_NumFibers; i++ )
     {
-#pragma omp critical
-        {
-          progress++;
-          std::cout << (int)(100*(float)progress/points1.size()) << "%" << '\r';
-          cout.flush();
-        }
-
-        bool match = false;
-        for (int j=0; j<points2.size(); j++)
-        {
-            auto v1 = points1.at(i);
-            auto v2 = points2.at(j);
-
-            unsigned int matches = 0;
-            unsigned int reverse_matches = 0;
-            for (int c=0; c<v1.size(); c++)
-            {
-                if (v1[c].SquaredEuclideanDistanceTo(v2[c])<mitk::eps)
-                    matches++;
-                if (v1[v1.size() - c - 1].SquaredEuclideanDistanceTo(v2[c])<mitk::eps)
-                    reverse_matches++;
-            }
-
-            if (matches==v1.size() || reverse_matches==v1.size())
-            {
-                match = true;
-                j=points2.size();
-            }
-        }
-
-#pragma omp critical
-        if (!match)
-            ids.push_back(i);
+        if (keep[i] && endPointHash.Contains(starts[i], ends[i]))
+            keep[i] = 0;
     }
 
-    for( int i : ids )
+    for( int i=0; i<m_NumFibers; i++ )
     {
+        if (!keep[i])
+            continue;
+
         vtkCell* cell = m_FiberPolyData->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
-        if (points==nullptr || numPoints<=0)
-            continue;
-
         vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
         for( int j=0; j<numPoints; j++)
         {
@@ -339,105 +542,59 @@ void mitk::FiberBundle::ColorFibersByOrientation()
     //  + one fiber with 0 points
     //=================================================
 
-    vtkPoints* extrPoints = nullptr;
-    extrPoints = m_FiberPolyData->GetPoints();
-    int numOfPoints = 0;
-    if (extrPoints!=nullptr)
-        numOfPoints = extrPoints->GetNumberOfPoints();
+    this->UpdateFiberPointArrays();
+
+    vtkIdType numOfPoints = 0;
+    if (m_FiberPolyData->GetPoints()!=nullptr)
+        numOfPoints = m_FiberPolyData->GetNumberOfPoints();
 
     //colors and alpha value for each single point, RGBA = 4 components
-    unsigned char rgba[4] = {0,0,0,0};
     int componentSize = 4;
     m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    m_FiberColors->Allocate(numOfPoints * componentSize);
     m_FiberColors->SetNumberOfComponents(componentSize);
+    m_FiberColors->SetNumberOfTuples(numOfPoints);
     m_FiberColors->SetName("FIBER_COLORS");
+    if (numOfPoints>0)
+        std::fill(m_FiberColors->GetPointer(0), m_FiberColors->GetPointer(0)+numOfPoints*componentSize, 0);
 
-    int numOfFibers = m_FiberPolyData->GetNumberOfLines();
+    int numOfFibers = m_FiberPointOffsets.size()-1;
     if (numOfFibers < 1)
         return;
 
-    /* extract single fibers of fiberBundle */
-    vtkCellArray* fiberList = m_FiberPolyData->GetLines();
-    fiberList->InitTraversal();
-    for (int fi=0; fi<numOfFibers; ++fi) {
+    unsigned char* colors = m_FiberColors->GetPointer(0);
 
-        vtkIdType* idList; // contains the point id's of the line
-        vtkIdType pointsPerFiber; // number of points for current line
-        fiberList->GetNextCell(pointsPerFiber, idList);
+#pragma omp parallel for
+    for (int fi=0; fi<numOfFibers; ++fi)
+    {
+        vtkIdType first = m_FiberPointOffsets[fi];
+        int pointsPerFiber = m_FiberPointOffsets[fi+1]-first;
 
-        /* single fiber checkpoints: is number of points valid */
-        if (pointsPerFiber > 1)
+        /* a single point does not define a fiber (use vertex mechanisms instead), fibers with 0 points are skipped as well */
+        if (pointsPerFiber < 2)
+            continue;
+
+        for (int i=0; i<pointsPerFiber; ++i)
         {
-            /* operate on points of single fiber */
-            for (int i=0; i <pointsPerFiber; ++i)
+            /* The color value of the current point is given by the direction from the previous to the next point. The
+             * first and the last point only use the direction to their single neighbour. */
+            const float* prevPnt = &m_FiberPoints[3*(first + std::max(i-1, 0))];
+            const float* nextPnt = &m_FiberPoints[3*(first + std::min(i+1, pointsPerFiber-1))];
+
+            double diff[3] = {(double)nextPnt[0]-prevPnt[0], (double)nextPnt[1]-prevPnt[1], (double)nextPnt[2]-prevPnt[2]};
+            double norm = std::sqrt(diff[0]*diff[0]+diff[1]*diff[1]+diff[2]*diff[2]);
+            if (norm>0)
             {
-                /* process all points except starting and endpoint for calculating color value take current point, previous point and next point */
-                if (i<pointsPerFiber-1 && i > 0)
-                {
-                    /* The color value of the current point is influenced by the previous point and next point. */
-                    vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-                    vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
-                    vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
-
-                    vnl_vector_fixed< double, 3 > diff1;
-                    diff1 = currentPntvtk - nextPntvtk;
-
-                    vnl_vector_fixed< double, 3 > diff2;
-                    diff2 = currentPntvtk - prevPntvtk;
-
-                    vnl_vector_fixed< double, 3 > diff;
-                    diff = (diff1 - diff2) / 2.0;
-                    diff.normalize();
-
-                    rgba[0] = (unsigned char) (255.0 * std::fabs(diff[0]));
-                    rgba[1] = (unsigned char) (255.0 * std::fabs(diff[1]));
-                    rgba[2] = (unsigned char) (255.0 * std::fabs(diff[2]));
-                    rgba[3] = (unsigned char) (255.0);
-                }
-                else if (i==0)
-                {
-                    /* First point has no previous point, therefore only diff1 is taken */
-
-                    vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-                    vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
-
-                    vnl_vector_fixed< double, 3 > diff1;
-                    diff1 = currentPntvtk - nextPntvtk;
-                    diff1.normalize();
-
-                    rgba[0] = (unsigned char) (255.0 * std::fabs(diff1[0]));
-                    rgba[1] = (unsigned char) (255.0 * std::fabs(diff1[1]));
-                    rgba[2] = (unsigned char) (255.0 * std::fabs(diff1[2]));
-                    rgba[3] = (unsigned char) (255.0);
-                }
-                else if (i==pointsPerFiber-1)
-                {
-                    /* Last point has no next point, therefore only diff2 is taken */
-                    vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-                    vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
-
-                    vnl_vector_fixed< double, 3 > diff2;
-                    diff2 = currentPntvtk - prevPntvtk;
-                    diff2.normalize();
-
-                    rgba[0] = (unsigned char) (255.0 * std::fabs(diff2[0]));
-                    rgba[1] = (unsigned char) (255.0 * std::fabs(diff2[1]));
-                    rgba[2] = (unsigned char) (255.0 * std::fabs(diff2[2]));
-                    rgba[3] = (unsigned char) (255.0);
-                }
-                m_FiberColors->InsertTupleValue(idList[i], rgba);
+                diff[0] /= norm;
+                diff[1] /= norm;
+                diff[2] /= norm;
             }
-        }
-        else if (pointsPerFiber == 1)
-        {
-            /* a single point does not define a fiber (use vertex mechanisms instead */
-            continue;
-        }
-        else
-        {
-            MITK_DEBUG << "Fiber with 0 points detected... please check your tractography algorithm!" ;
-            continue;
+
+            vtkIdType pointId = m_FiberPointIds.empty() ? first+i : m_FiberPointIds[first+i];
+            unsigned char* rgba = colors + componentSize*pointId;
+            rgba[0] = (unsigned char) (255.0 * std::fabs(diff[0]));
+            rgba[1] = (unsigned char) (255.0 * std::fabs(diff[1]));
+            rgba[2] = (unsigned char) (255.0 * std::fabs(diff[2]));
+            rgba[3] = (unsigned char) (255.0);
         }
     }
     m_UpdateTime3D.Modified();
@@ -1166,23 +1323,29 @@ void mitk::FiberBundle::UpdateFiberGeometry()
     m_FiberPolyData->GetBounds(b);
 
     // calculate statistics
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    this->UpdateFiberPointArrays();
+    m_FiberLengths.resize(m_NumFibers, 0);
+#pragma omp parallel for
+    for (int i=0; i<m_NumFibers; i++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int p = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+        if (i+1>=(int)m_FiberPointOffsets.size())
+            continue;
+
         float length = 0;
-        for (int j=0; j<p-1; j++)
+        for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]-1; j++)
         {
-            double p1[3];
-            points->GetPoint(j, p1);
-            double p2[3];
-            points->GetPoint(j+1, p2);
+            const float* p1 = &m_FiberPoints[3*j];
+            const float* p2 = &m_FiberPoints[3*j+3];
 
             float dist = std::sqrt((p1[0]-p2[0])*(p1[0]-p2[0])+(p1[1]-p2[1])*(p1[1]-p2[1])+(p1[2]-p2[2])*(p1[2]-p2[2]));
             length += dist;
         }
-        m_FiberLengths.push_back(length);
+        m_FiberLengths[i] = length;
+    }
+
+    for (int i=0; i<m_NumFibers; i++)
+    {
+        float length = m_FiberLengths[i];
         m_MeanFiberLength += length;
         if (i==0)
         {
@@ -1366,36 +1529,24 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
     mitk::BaseGeometry::Pointer geom = this->GetGeometry();
     mitk::Point3D center = geom->GetCenter();
 
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    this->UpdateFiberPointArrays();
+    std::vector< float > newPoints(m_FiberPoints.size());
 
-    for (int i=0; i<m_NumFibers; i++)
+#pragma omp parallel for
+    for (long k=0; k<(long)m_FiberPoints.size()/3; k++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-        for (int j=0; j<numPoints; j++)
-        {
-            double* p = points->GetPoint(j);
-            vnl_vector_fixed< double, 3 > dir;
-            dir[0] = p[0]-center[0];
-            dir[1] = p[1]-center[1];
-            dir[2] = p[2]-center[2];
-            dir = rot*dir;
-            dir[0] += center[0]+tx;
-            dir[1] += center[1]+ty;
-            dir[2] += center[2]+tz;
-            vtkIdType id = vtkNewPoints->InsertNextPoint(dir.data_block());
-            container->GetPointIds()->InsertNextId(id);
-        }
-        vtkNewCells->InsertNextCell(container);
+        const float* p = &m_FiberPoints[3*k];
+        vnl_vector_fixed< double, 3 > dir;
+        dir[0] = p[0]-center[0];
+        dir[1] = p[1]-center[1];
+        dir[2] = p[2]-center[2];
+        dir = rot*dir;
+        newPoints[3*k] = dir[0]+center[0]+tx;
+        newPoints[3*k+1] = dir[1]+center[1]+ty;
+        newPoints[3*k+2] = dir[2]+center[2]+tz;
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
+    m_FiberPolyData = CreateFiberPolyData(newPoints, m_FiberPointOffsets);
     this->SetFiberPolyData(m_FiberPolyData, true);
 }
 
@@ -1727,39 +1878,19 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
         return false;
     }
 
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-    float min = m_MaxFiberLength;
-
-    boost::progress_display disp(m_NumFibers);
+    std::vector< unsigned char > keep(m_NumFibers);
     for (int i=0; i<m_NumFibers; i++)
-    {
-        ++disp;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+        keep[i] = m_FiberLengths.at(i)>=lengthInMM;
 
-        if (m_FiberLengths.at(i)>=lengthInMM)
-        {
-            vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-            for (int j=0; j<numPoints; j++)
-            {
-                double* p = points->GetPoint(j);
-                vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                container->GetPointIds()->InsertNextId(id);
-            }
-            vtkNewCells->InsertNextCell(container);
-            if (m_FiberLengths.at(i)<min)
-                min = m_FiberLengths.at(i);
-        }
-    }
+    this->UpdateFiberPointArrays();
+    std::vector< float > newPoints;
+    std::vector< vtkIdType > newOffsets;
+    CopyFibers(m_FiberPoints, m_FiberPointOffsets, keep, newPoints, newOffsets);
 
-    if (vtkNewCells->GetNumberOfCells()<=0)
+    if (newOffsets.size()<=1)
         return false;
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
+    m_FiberPolyData = CreateFiberPolyData(newPoints, newOffsets);
     this->SetFiberPolyData(m_FiberPolyData, true);
     return true;
 }
@@ -1772,37 +1903,20 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
     if (lengthInMM<m_MinFiberLength)    // can't remove all fibers
         return false;
 
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
     MITK_INFO << "Removing long fibers";
-    boost::progress_display disp(m_NumFibers);
+    std::vector< unsigned char > keep(m_NumFibers);
     for (int i=0; i<m_NumFibers; i++)
-    {
-        ++disp;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+        keep[i] = m_FiberLengths.at(i)<=lengthInMM;
 
-        if (m_FiberLengths.at(i)<=lengthInMM)
-        {
-            vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-            for (int j=0; j<numPoints; j++)
-            {
-                double* p = points->GetPoint(j);
-                vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                container->GetPointIds()->InsertNextId(id);
-            }
-            vtkNewCells->InsertNextCell(container);
-        }
-    }
+    this->UpdateFiberPointArrays();
+    std::vector< float > newPoints;
+    std::vector< vtkIdType > newOffsets;
+    CopyFibers(m_FiberPoints, m_FiberPointOffsets, keep, newPoints, newOffsets);
 
-    if (vtkNewCells->GetNumberOfCells()<=0)
+    if (newOffsets.size()<=1)
         return false;
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
+    m_FiberPolyData = CreateFiberPolyData(newPoints, newOffsets);
     this->SetFiberPolyData(m_FiberPolyData, true);
     return true;
 }
@@ -1812,11 +1926,10 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
     if (pointDistance<=0)
         return;
 
-    vtkSmartPointer<vtkPoints> vtkSmoothPoints = vtkSmartPointer<vtkPoints>::New(); //in smoothpoints the interpolated points representing a fiber are stored.
+    this->UpdateFiberPointArrays();
 
-    //in vtkcells all polylines are stored, actually all id's of them are stored
-    vtkSmartPointer<vtkCellArray> vtkSmoothCells = vtkSmartPointer<vtkCellArray>::New(); //cellcontainer for smoothed lines
-    vtkIdType pointHelperCnt = 0;
+    // the resampled points of each fiber are collected separately and concatenated in fiber order afterwards
+    std::vector< std::vector< float > > smoothFibers(m_NumFibers);
 
     MITK_INFO << "Smoothing fibers";
     boost::progress_display disp(m_NumFibers);
@@ -1824,17 +1937,9 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
     for (int i=0; i<m_NumFibers; i++)
     {
         vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
-        float length = 0;
-#pragma omp critical
-        {
-            length = m_FiberLengths.at(i);
-            ++disp;
-            vtkCell* cell = m_FiberPolyData->GetCell(i);
-            int numPoints = cell->GetNumberOfPoints();
-            vtkPoints* points = cell->GetPoints();
-            for (int j=0; j<numPoints; j++)
-                newPoints->InsertNextPoint(points->GetPoint(j));
-        }
+        for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]; j++)
+            newPoints->InsertNextPoint(m_FiberPoints[3*j], m_FiberPoints[3*j+1], m_FiberPoints[3*j+2]);
+        float length = m_FiberLengths.at(i);
 
         int sampling = std::ceil(length/pointDistance);
 
@@ -1861,25 +1966,31 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
         vtkPolyData* outputFunction = functionSource->GetOutput();
         vtkPoints* tmpSmoothPnts = outputFunction->GetPoints(); //smoothPoints of current fiber
 
-        vtkSmartPointer<vtkPolyLine> smoothLine = vtkSmartPointer<vtkPolyLine>::New();
-        smoothLine->GetPointIds()->SetNumberOfIds(tmpSmoothPnts->GetNumberOfPoints());
-
-#pragma omp critical
+        std::vector< float >& smoothFiber = smoothFibers[i];
+        smoothFiber.resize(3*tmpSmoothPnts->GetNumberOfPoints());
+        for (int j=0; j<tmpSmoothPnts->GetNumberOfPoints(); j++)
         {
-            for (int j=0; j<smoothLine->GetNumberOfPoints(); j++)
-            {
-                smoothLine->GetPointIds()->SetId(j, j+pointHelperCnt);
-                vtkSmoothPoints->InsertNextPoint(tmpSmoothPnts->GetPoint(j));
-            }
-
-            vtkSmoothCells->InsertNextCell(smoothLine);
-            pointHelperCnt += tmpSmoothPnts->GetNumberOfPoints();
+            double p[3];
+            tmpSmoothPnts->GetPoint(j, p);
+            smoothFiber[3*j] = p[0];
+            smoothFiber[3*j+1] = p[1];
+            smoothFiber[3*j+2] = p[2];
         }
+
+#pragma omp critical
+        ++disp;
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkSmoothPoints);
-    m_FiberPolyData->SetLines(vtkSmoothCells);
+    std::vector< vtkIdType > smoothOffsets(1, 0);
+    for (int i=0; i<m_NumFibers; i++)
+        smoothOffsets.push_back(smoothOffsets.back()+smoothFibers[i].size()/3);
+
+    std::vector< float > smoothPoints(3*smoothOffsets.back());
+#pragma omp parallel for
+    for (int i=0; i<m_NumFibers; i++)
+        std::copy(smoothFibers[i].begin(), smoothFibers[i].end(), smoothPoints.begin()+3*smoothOffsets[i]);
+
+    m_FiberPolyData = CreateFiberPolyData(smoothPoints, smoothOffsets);
     this->SetFiberPolyData(m_FiberPolyData, true);
 }
 
@@ -1890,13 +2001,8 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance)
 
 unsigned long mitk::FiberBundle::GetNumberOfPoints()
 {
-    unsigned long points = 0;
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
-    {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        points += cell->GetNumberOfPoints();
-    }
-    return points;
+    this->UpdateFiberPointArrays();
+    return m_FiberPointOffsets.back();
 }
 
 void mitk::FiberBundle::Compress(float error)
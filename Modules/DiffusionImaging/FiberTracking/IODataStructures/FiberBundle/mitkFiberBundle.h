@@ -93,7 +93,8 @@ public:
     itk::Matrix< double, 3, 3 > TransformMatrix(itk::Matrix< double, 3, 3 > m, double rx, double ry, double rz);
 
     // add/subtract fibers
-    FiberBundle::Pointer AddBundle(FiberBundle* fib);
+    // fibers are considered equal if their start and end points match (in either direction)
+    FiberBundle::Pointer AddBundle(FiberBundle* fib, bool removeDuplicates=false);
     FiberBundle::Pointer SubtractBundle(FiberBundle* fib);
 
     // fiber subset extraction
@@ -129,6 +130,15 @@ public:
 
     unsigned long GetNumberOfPoints();
 
+    /**
+     * \brief Contiguous single precision copy of all fiber points (x, y, z interleaved, fiber after fiber).
+     *
+     * The points of fiber i are the points GetFiberPointOffsets()[i] to GetFiberPointOffsets()[i+1]-1. The arrays
+     * are rebuilt from the fiber polydata if it was modified since the last call.
+     */
+    const std::vector< float >& GetFiberPoints();
+    const std::vector< vtkIdType >& GetFiberPointOffsets();
+
     // copy fiber bundle
     mitk::FiberBundle::Pointer GetDeepCopy();
 
@@ -144,10 +154,14 @@ protected:
     virtual ~FiberBundle();
 
     itk::Point<float, 3> GetItkPoint(double point[3]);
+    bool GetFiberEndPoints(vtkPolyData* polyData, vtkIdType fiber, itk::Point<float, 3>& start, itk::Point<float, 3>& end);
 
     // calculate geometry from fiber extent
     void UpdateFiberGeometry();
 
+    // rebuild m_FiberPoints and m_FiberPointOffsets if m_FiberPolyData changed
+    void UpdateFiberPointArrays();
+
 private:
 
     // actual fiber container
@@ -156,6 +170,14 @@ private:
     // contains fiber ids
     vtkSmartPointer<vtkDataSet>   m_FiberIdDataSet;
 
+    // contiguous copy of the fiber points used by the processing methods
+    std::vector< float >      m_FiberPoints;
+    std::vector< vtkIdType >  m_FiberPointOffsets;
+    // polydata point id of each entry in m_FiberPoints, empty if the ids are consecutive
+    std::vector< vtkIdType >  m_FiberPointIds;
+    vtkPolyData*              m_FiberPointsSource;
+    unsigned long             m_FiberPointsMTime;
+
     int   m_NumFibers;
 
     vtkSmartPointer<vtkUnsignedCharArray> m_FiberColors;
@@ -22,6 +22,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIOUtil.h>
 #include <itkFiberCurvatureFilter.h>
 #include <omp.h>
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyLine.h>
+#include <cmath>
 #include "mitkTestFixture.h"
 
 class mitkFiberProcessingTestSuite : public mitk::TestFixture
@@ -45,6 +49,8 @@ class mitkFiberProcessingTestSuite : public mitk::TestFixture
     MITK_TEST(Test15);
     MITK_TEST(Test16);
     MITK_TEST(Test17);
+    MITK_TEST(Test18);
+    MITK_TEST(Test19);
     CPPUNIT_TEST_SUITE_END();
 
     typedef itk::Image<unsigned char, 3> ItkUcharImgType;
@@ -68,6 +74,22 @@ public:
         mitk::CastToItkImage(img, mask);
     }
 
+    /** Bundle of a single straight fiber starting at (startX, 0.5, 0.5) */
+    mitk::FiberBundle::Pointer CreateSingleFiberBundle(double startX)
+    {
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+        vtkSmartPointer<vtkPolyLine> line = vtkSmartPointer<vtkPolyLine>::New();
+        line->GetPointIds()->InsertNextId(points->InsertNextPoint(startX, 0.5, 0.5));
+        line->GetPointIds()->InsertNextId(points->InsertNextPoint(startX + 10, 0.5, 0.5));
+        lines->InsertNextCell(line);
+
+        vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+        polyData->SetPoints(points);
+        polyData->SetLines(lines);
+        return mitk::FiberBundle::New(polyData);
+    }
+
     void tearDown() override
     {
         original = NULL;
@@ -284,6 +306,39 @@ public:
         CPPUNIT_ASSERT_MESSAGE("Should be equal", ref->Equals(fib));
     }
 
+    void Test18()
+    {
+        MITK_INFO << "TEST 18: Join without duplicates";
+
+        mitk::FiberBundle::Pointer fib = original->GetDeepCopy();
+        mitk::FiberBundle::Pointer fib2 = original->GetDeepCopy();
+        fib2->TranslateFibers(1000, 0, 0);
+
+        mitk::FiberBundle::Pointer joined = fib->AddBundle(original, true);
+        CPPUNIT_ASSERT_MESSAGE("Duplicates should be removed", joined->GetNumFibers() == original->GetNumFibers());
+        CPPUNIT_ASSERT_MESSAGE("Should be equal", original->Equals(joined));
+        CPPUNIT_ASSERT_MESSAGE("Nothing should be left", joined->SubtractBundle(original).IsNull());
+
+        joined = joined->AddBundle(fib2, true);
+        CPPUNIT_ASSERT_MESSAGE("Translated fibers should be kept", joined->GetNumFibers() == 2*original->GetNumFibers());
+
+        mitk::FiberBundle::Pointer subtracted = joined->SubtractBundle(original);
+        CPPUNIT_ASSERT_MESSAGE("Should be equal", fib2->Equals(subtracted));
+    }
+
+    void Test19()
+    {
+        MITK_INFO << "TEST 19: Duplicates on both sides of a hash cell border";
+
+        // start points one float step apart, the first one lies in the cell below the border at x = 1
+        mitk::FiberBundle::Pointer fib = CreateSingleFiberBundle(1.0);
+        mitk::FiberBundle::Pointer fib2 = CreateSingleFiberBundle(std::nextafter(1.0f, 0.0f));
+
+        mitk::FiberBundle::Pointer joined = fib->AddBundle(fib2, true);
+        CPPUNIT_ASSERT_MESSAGE("Duplicate should be removed", joined->GetNumFibers() == 1);
+        CPPUNIT_ASSERT_MESSAGE("Nothing should be left", fib2->SubtractBundle(fib).IsNull());
+    }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberProcessing)
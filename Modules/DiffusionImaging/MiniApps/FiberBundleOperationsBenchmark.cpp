@@ -0,0 +1,156 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <mitkFiberBundle.h>
+#include "mitkCommandLineParser.h"
+#include <itkTimeProbe.h>
+
+#include <vtkCellArray.h>
+#include <vtkPolyLine.h>
+
+/*!
+\brief Straight synthetic fibers with random end points in a 200 mm cube. Fibers [0, shared) are identical for every
+seed (every second one reversed if requested), the remaining fibers depend on the seed.
+*/
+mitk::FiberBundle::Pointer CreateSyntheticBundle(int numFibers, int numPoints, int shared, unsigned int seed, bool reverse)
+{
+    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    vtkNewPoints->Allocate(numFibers*numPoints);
+
+    std::mt19937 sharedRandGen(0);
+    std::mt19937 randGen(seed);
+    std::uniform_real_distribution<double> coordinate(-100, 100);
+
+    for (int i=0; i<numFibers; i++)
+    {
+        std::mt19937& gen = i<shared ? sharedRandGen : randGen;
+        double start[3], end[3];
+        for (int d=0; d<3; d++)
+        {
+            start[d] = coordinate(gen);
+            end[d] = coordinate(gen);
+        }
+        if (reverse && i<shared && i%2==1)
+            std::swap(start, end);
+
+        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+        for (int j=0; j<numPoints; j++)
+        {
+            double t = numPoints>1 ? (double)j/(numPoints-1) : 0;
+            double p[3];
+            for (int d=0; d<3; d++)
+                p[d] = start[d] + t*(end[d]-start[d]);
+            vtkIdType id = vtkNewPoints->InsertNextPoint(p);
+            container->GetPointIds()->InsertNextId(id);
+        }
+        vtkNewCells->InsertNextCell(container);
+    }
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(vtkNewPoints);
+    polyData->SetLines(vtkNewCells);
+    return mitk::FiberBundle::New(polyData);
+}
+
+/*!
+\brief Measure the runtime of fiber bundle subtraction and duplicate free joining on synthetic bundles.
+*/
+int main(int argc, char* argv[])
+{
+    mitkCommandLineParser parser;
+
+    parser.setTitle("Fiber Bundle Operations Benchmark");
+    parser.setCategory("Fiber Tracking and Processing Methods");
+    parser.setDescription("Measure the runtime of fiber bundle subtraction and duplicate free joining on synthetic bundles.");
+    parser.setContributor("MBI");
+
+    parser.setArgumentPrefix("--", "-");
+    parser.addArgument("fibers", "f", mitkCommandLineParser::Int, "Fibers:", "number of fibers per bundle (default 1000000)", us::Any());
+    parser.addArgument("points", "p", mitkCommandLineParser::Int, "Points:", "number of points per fiber (default 10)", us::Any());
+    parser.addArgument("shared", "s", mitkCommandLineParser::Float, "Shared fraction:", "fraction of fibers contained in both bundles (default 0.5)", us::Any());
+
+    std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+
+    int numFibers = 1000000;
+    if (parsedArgs.count("fibers"))
+        numFibers = us::any_cast<int>(parsedArgs["fibers"]);
+
+    int numPoints = 10;
+    if (parsedArgs.count("points"))
+        numPoints = us::any_cast<int>(parsedArgs["points"]);
+
+    float sharedFraction = 0.5;
+    if (parsedArgs.count("shared"))
+        sharedFraction = us::any_cast<float>(parsedArgs["shared"]);
+
+    if (numFibers<=0 || numPoints<=0 || sharedFraction<0 || sharedFraction>1)
+    {
+        std::cout << "Invalid arguments!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        int shared = (int)(sharedFraction*numFibers);
+
+        std::cout << "Generating two bundles with " << numFibers << " fibers (" << shared << " shared)" << std::endl;
+        mitk::FiberBundle::Pointer fib1 = CreateSyntheticBundle(numFibers, numPoints, shared, 1, false);
+        mitk::FiberBundle::Pointer fib2 = CreateSyntheticBundle(numFibers, numPoints, shared, 2, true);
+
+        itk::TimeProbe subtractClock;
+        subtractClock.Start();
+        mitk::FiberBundle::Pointer subtracted = fib1->SubtractBundle(fib2);
+        subtractClock.Stop();
+
+        int numSubtracted = subtracted.IsNull() ? 0 : subtracted->GetNumFibers();
+        std::cout << "SubtractBundle: " << subtractClock.GetTotal() << " s, " << numSubtracted << " fibers left (expected " << numFibers-shared << ")" << std::endl;
+
+        itk::TimeProbe addClock;
+        addClock.Start();
+        mitk::FiberBundle::Pointer joined = fib1->AddBundle(fib2, true);
+        addClock.Stop();
+
+        std::cout << "AddBundle without duplicates: " << addClock.GetTotal() << " s, " << joined->GetNumFibers() << " fibers (expected " << 2*numFibers-shared << ")" << std::endl;
+
+        if (numSubtracted!=numFibers-shared || joined->GetNumFibers()!=2*numFibers-shared)
+        {
+            std::cout << "Unexpected number of fibers!" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    catch (itk::ExceptionObject e)
+    {
+        std::cout << e;
+        return EXIT_FAILURE;
+    }
+    catch (std::exception e)
+    {
+        std::cout << e.what();
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cout << "ERROR!?!";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
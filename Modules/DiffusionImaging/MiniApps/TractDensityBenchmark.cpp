@@ -0,0 +1,199 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <mitkFiberBundle.h>
+#include "mitkCommandLineParser.h"
+#include <itkTimeProbe.h>
+#include <itkTractDensityImageFilter.h>
+#include <itkTractsToFiberEndingsImageFilter.h>
+#include <itkTractsToRgbaImageFilter.h>
+
+#include <vtkCellArray.h>
+#include <vtkPolyLine.h>
+
+/*!
+\brief Straight synthetic fibers with random end points in a 200 mm cube.
+*/
+mitk::FiberBundle::Pointer CreateSyntheticBundle(int numFibers, int numPoints)
+{
+    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    vtkNewPoints->Allocate(numFibers*numPoints);
+
+    std::mt19937 randGen(0);
+    std::uniform_real_distribution<double> coordinate(-100, 100);
+
+    for (int i=0; i<numFibers; i++)
+    {
+        double start[3], end[3];
+        for (int d=0; d<3; d++)
+        {
+            start[d] = coordinate(randGen);
+            end[d] = coordinate(randGen);
+        }
+
+        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+        for (int j=0; j<numPoints; j++)
+        {
+            double t = numPoints>1 ? (double)j/(numPoints-1) : 0;
+            double p[3];
+            for (int d=0; d<3; d++)
+                p[d] = start[d] + t*(end[d]-start[d]);
+            vtkIdType id = vtkNewPoints->InsertNextPoint(p);
+            container->GetPointIds()->InsertNextId(id);
+        }
+        vtkNewCells->InsertNextCell(container);
+    }
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(vtkNewPoints);
+    polyData->SetLines(vtkNewCells);
+    return mitk::FiberBundle::New(polyData);
+}
+
+/*!
+\brief Run the filter single threaded and with the given number of threads. Returns false if the outputs differ.
+*/
+template< class FilterType >
+bool RunFilter(const std::string& name, typename FilterType::Pointer filter, int numThreads)
+{
+    typedef typename FilterType::OutputImageType ImageType;
+
+    filter->SetNumberOfThreads(1);
+    itk::TimeProbe serialClock;
+    serialClock.Start();
+    filter->Update();
+    serialClock.Stop();
+    typename ImageType::Pointer serial = filter->GetOutput();
+    serial->DisconnectPipeline();
+
+    filter->SetNumberOfThreads(numThreads);
+    itk::TimeProbe parallelClock;
+    parallelClock.Start();
+    filter->Update();
+    parallelClock.Stop();
+    typename ImageType::Pointer parallel = filter->GetOutput();
+
+    bool equal = serial->GetLargestPossibleRegion()==parallel->GetLargestPossibleRegion() &&
+            std::memcmp(serial->GetBufferPointer(), parallel->GetBufferPointer(),
+                        serial->GetLargestPossibleRegion().GetNumberOfPixels()*sizeof(typename ImageType::PixelType))==0;
+
+    std::cout << name << ": " << serialClock.GetTotal() << " s (1 thread), " << parallelClock.GetTotal() << " s (" << numThreads << " threads), "
+              << (equal ? "identical" : "DIFFERENT") << std::endl;
+    return equal;
+}
+
+/*!
+\brief Measure the runtime of the tract density, fiber endings and rgba image filters on a synthetic bundle.
+*/
+int main(int argc, char* argv[])
+{
+    mitkCommandLineParser parser;
+
+    parser.setTitle("Tract Density Benchmark");
+    parser.setCategory("Fiber Tracking and Processing Methods");
+    parser.setDescription("Measure the runtime of the tract image filters single- and multi-threaded and check that the results are identical.");
+    parser.setContributor("MBI");
+
+    parser.setArgumentPrefix("--", "-");
+    parser.addArgument("fibers", "f", mitkCommandLineParser::Int, "Fibers:", "number of fibers (default 100000)", us::Any());
+    parser.addArgument("points", "p", mitkCommandLineParser::Int, "Points:", "number of points per fiber (default 100)", us::Any());
+    parser.addArgument("upsampling", "u", mitkCommandLineParser::Float, "Upsampling:", "upsampling factor of the output images (default 2)", us::Any());
+    parser.addArgument("threads", "t", mitkCommandLineParser::Int, "Threads:", "number of threads (default: number of processors)", us::Any());
+
+    std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+
+    int numFibers = 100000;
+    if (parsedArgs.count("fibers"))
+        numFibers = us::any_cast<int>(parsedArgs["fibers"]);
+
+    int numPoints = 100;
+    if (parsedArgs.count("points"))
+        numPoints = us::any_cast<int>(parsedArgs["points"]);
+
+    float upsampling = 2;
+    if (parsedArgs.count("upsampling"))
+        upsampling = us::any_cast<float>(parsedArgs["upsampling"]);
+
+    int numThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    if (parsedArgs.count("threads"))
+        numThreads = us::any_cast<int>(parsedArgs["threads"]);
+
+    if (numFibers<=0 || numPoints<=0 || upsampling<=0 || numThreads<=0)
+    {
+        std::cout << "Invalid arguments!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::cout << "Generating bundle with " << numFibers << " fibers" << std::endl;
+        mitk::FiberBundle::Pointer fib = CreateSyntheticBundle(numFibers, numPoints);
+
+        bool equal = true;
+
+        typedef itk::TractDensityImageFilter< itk::Image<float, 3> > DensityFilterType;
+        for (int trilinear=0; trilinear<2; trilinear++)
+        {
+            DensityFilterType::Pointer density = DensityFilterType::New();
+            density->SetFiberBundle(fib);
+            density->SetUpsamplingFactor(upsampling);
+            density->SetOutputAbsoluteValues(true);
+            density->SetDoFiberResampling(false);
+            density->SetUseTrilinearInterpolation(trilinear==1);
+            equal &= RunFilter<DensityFilterType>(trilinear==1 ? "TDI (trilinear)" : "TDI", density, numThreads);
+        }
+
+        typedef itk::TractsToFiberEndingsImageFilter< itk::Image<float, 3> > EndingsFilterType;
+        EndingsFilterType::Pointer endings = EndingsFilterType::New();
+        endings->SetFiberBundle(fib);
+        endings->SetUpsamplingFactor(upsampling);
+        equal &= RunFilter<EndingsFilterType>("Fiber endings", endings, numThreads);
+
+        typedef itk::TractsToRgbaImageFilter< itk::Image<itk::RGBAPixel<unsigned char>, 3> > RgbaFilterType;
+        RgbaFilterType::Pointer rgba = RgbaFilterType::New();
+        rgba->SetFiberBundle(fib);
+        rgba->SetUpsamplingFactor(upsampling);
+        equal &= RunFilter<RgbaFilterType>("RGBA", rgba, numThreads);
+
+        if (!equal)
+        {
+            std::cout << "Multi-threaded results differ!" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    catch (itk::ExceptionObject e)
+    {
+        std::cout << e;
+        return EXIT_FAILURE;
+    }
+    catch (std::exception e)
+    {
+        std::cout << e.what();
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cout << "ERROR!?!";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
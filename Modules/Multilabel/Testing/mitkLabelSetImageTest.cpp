@@ -39,7 +39,9 @@ class mitkLabelSetImageTestSuite : public mitk::TestFixture
   MITK_TEST(TestRemoveLabels);
   MITK_TEST(TestMergeLabel);
   // TODO check it these functionalities can be moved into a process object
-  //  MITK_TEST(TestMergeLabels);
+  MITK_TEST(TestMergeLabels);
+  MITK_TEST(TestMergeLabelInInactiveLayer);
+  MITK_TEST(TestLabelStatistics);
   //  MITK_TEST(TestConcatenate);
   //  MITK_TEST(TestClearBuffer);
   //  MITK_TEST(TestUpdateCenterOfMass);
@@ -443,6 +445,93 @@ public:
     // Check if merge label has 507 + 823 = 1330 pixels
     CPPUNIT_ASSERT_MESSAGE("Label with value 7 was not remove from the image", m_LabelSetImage->GetStatistics()->GetCountOfMaxValuedVoxels() == 1330);
   }
+
+  void TestMergeLabels()
+  {
+    mitk::Image::Pointer image = mitk::IOUtil::LoadImage(GetTestDataFilePath("Multilabel/LabelSetTestInitializeImage.nrrd"));
+    m_LabelSetImage = 0;
+    m_LabelSetImage = mitk::LabelSetImage::New();
+    m_LabelSetImage->InitializeByLabeledImage(image);
+
+    // Values within the image are 0, 1, 3, 5, 6, 7 - merge all but the exterior into label 6
+    std::vector<mitk::Label::PixelType> labelsToBeMerged;
+    labelsToBeMerged.push_back(1);
+    labelsToBeMerged.push_back(3);
+    labelsToBeMerged.push_back(5);
+    labelsToBeMerged.push_back(7);
+    m_LabelSetImage->MergeLabels(6, labelsToBeMerged);
+
+    CPPUNIT_ASSERT_MESSAGE("Wrong MIN value", m_LabelSetImage->GetStatistics()->GetScalarValueMin() == 0);
+    // 2ndMin because of the exterior label = 0
+    CPPUNIT_ASSERT_MESSAGE("Merged labels are still present in the image",
+                           m_LabelSetImage->GetStatistics()->GetScalarValue2ndMin() == 6);
+    CPPUNIT_ASSERT_MESSAGE("Merged labels are still present in the image",
+                           m_LabelSetImage->GetStatistics()->GetScalarValueMax() == 6);
+    CPPUNIT_ASSERT_MESSAGE("Merged label is not active", m_LabelSetImage->GetActiveLabel()->GetValue() == 6);
+  }
+
+  void TestMergeLabelInInactiveLayer()
+  {
+    mitk::Image::Pointer image = mitk::IOUtil::LoadImage(GetTestDataFilePath("Multilabel/LabelSetTestInitializeImage.nrrd"));
+    m_LabelSetImage = 0;
+    m_LabelSetImage = mitk::LabelSetImage::New();
+    m_LabelSetImage->InitializeByLabeledImage(image);
+
+    // adding a layer activates the new, empty layer
+    m_LabelSetImage->AddLayer();
+    CPPUNIT_ASSERT_MESSAGE("Wrong active layer", m_LabelSetImage->GetActiveLayer() == 1);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of label 7 in layer 0",
+                           m_LabelSetImage->GetLabelStatistics(7, 0)->voxelCount == 823);
+
+    m_LabelSetImage->MergeLabel(6, 7, 0);
+    mitk::Image *layerImage = m_LabelSetImage->GetLayerImage(0);
+    CPPUNIT_ASSERT_MESSAGE("Label with value 7 was not removed from layer 0",
+                           layerImage->GetStatistics()->GetScalarValueMax() == 6);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of merged label in layer 0",
+                           layerImage->GetStatistics()->GetCountOfMaxValuedVoxels() == 1330);
+    CPPUNIT_ASSERT_MESSAGE("Statistics of layer 0 are not up to date after merging",
+                           m_LabelSetImage->IsLabelStatisticsUpToDate(0));
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of merged label statistics",
+                           m_LabelSetImage->GetLabelStatistics(6, 0)->voxelCount == 1330);
+    CPPUNIT_ASSERT_MESSAGE("Active layer was modified", m_LabelSetImage->GetStatistics()->GetScalarValueMax() == 0);
+  }
+
+  void TestLabelStatistics()
+  {
+    mitk::Image::Pointer image = mitk::IOUtil::LoadImage(GetTestDataFilePath("Multilabel/LabelSetTestInitializeImage.nrrd"));
+    m_LabelSetImage = 0;
+    m_LabelSetImage = mitk::LabelSetImage::New();
+    m_LabelSetImage->InitializeByLabeledImage(image);
+
+    // Count all pixels with value 7 = 823
+    // Count all pixels with value 6 = 507
+    const mitk::LabelSetImage::LabelStatistics *statistics = m_LabelSetImage->GetLabelStatistics(7);
+    CPPUNIT_ASSERT_MESSAGE("No statistics for label 7", statistics != nullptr);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of label 7", statistics->voxelCount == 823);
+    CPPUNIT_ASSERT_MESSAGE("Statistics are not up to date", m_LabelSetImage->IsLabelStatisticsUpToDate(0));
+    CPPUNIT_ASSERT_MESSAGE("Statistics of a non existing label", m_LabelSetImage->GetLabelStatistics(2) == nullptr);
+
+    const mitk::Point3D centerOfMass = statistics->GetCenterOfMassIndex();
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Center of mass outside of bounding box",
+                             centerOfMass[i] >= statistics->minIndex[i] && centerOfMass[i] <= statistics->maxIndex[i]);
+    }
+
+    // merging moves the statistics without invalidating them
+    m_LabelSetImage->MergeLabel(6, 7);
+    CPPUNIT_ASSERT_MESSAGE("Statistics are not up to date after merging", m_LabelSetImage->IsLabelStatisticsUpToDate(0));
+    CPPUNIT_ASSERT_MESSAGE("Merged label still has statistics", m_LabelSetImage->GetLabelStatistics(7) == nullptr);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of merged label",
+                           m_LabelSetImage->GetLabelStatistics(6)->voxelCount == 1330);
+
+    // modifications of the pixel data outside of the label set image invalidate them
+    m_LabelSetImage->Modified();
+    CPPUNIT_ASSERT_MESSAGE("Statistics are up to date after modification",
+                           !m_LabelSetImage->IsLabelStatisticsUpToDate(0));
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count after recomputation",
+                           m_LabelSetImage->GetLabelStatistics(6)->voxelCount == 1330);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImage)
@@ -34,6 +34,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include <itkRelabelComponentImageFilter.h>
 
 #include <itkCommand.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkMath.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 
 template <typename TPixel, unsigned int VDimensions>
 void SetToZero(itk::Image<TPixel, VDimensions> *source)
@@ -79,7 +85,13 @@ mitk::LabelSetImage::LabelSetImage(const mitk::LabelSetImage &other)
 
 void mitk::LabelSetImage::OnLabelSetModified()
 {
+  // label set changes do not touch the pixel data, so current label statistics stay valid
+  const bool statisticsUpToDate = this->IsLabelStatisticsUpToDate(this->GetActiveLayer());
   Superclass::Modified();
+  if (statisticsUpToDate)
+  {
+    m_LabelStatistics[this->GetActiveLayer()].mTime = this->GetMTime();
+  }
 }
 
 void mitk::LabelSetImage::SetExteriorLabel(mitk::Label *label)
@@ -388,33 +400,21 @@ bool mitk::LabelSetImage::ExistLabelSet(unsigned int layer) const
 
 void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, unsigned int layer)
 {
-  try
-  {
-    AccessByItk_2(this, MergeLabelProcessing, pixelValue, sourcePixelValue);
-  }
-  catch (itk::ExceptionObject &e)
-  {
-    mitkThrow() << e.GetDescription();
-  }
+  std::map<PixelType, PixelType> labelMapping;
+  labelMapping[sourcePixelValue] = pixelValue;
+  this->RemapLabels(labelMapping, layer);
   GetLabelSet(layer)->SetActiveLabel(pixelValue);
-  Modified();
 }
 
 void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, unsigned int layer)
 {
-  try
+  std::map<PixelType, PixelType> labelMapping;
+  for (unsigned int idx = 0; idx < vectorOfSourcePixelValues.size(); idx++)
   {
-    for (unsigned int idx = 0; idx < vectorOfSourcePixelValues.size(); idx++)
-    {
-      AccessByItk_2(this, MergeLabelProcessing, pixelValue, vectorOfSourcePixelValues[idx]);
-    }
-  }
-  catch (itk::ExceptionObject &e)
-  {
-    mitkThrow() << e.GetDescription();
+    labelMapping[vectorOfSourcePixelValues[idx]] = pixelValue;
   }
+  this->RemapLabels(labelMapping, layer);
   GetLabelSet(layer)->SetActiveLabel(pixelValue);
-  Modified();
 }
 
 void mitk::LabelSetImage::RemoveLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer)
@@ -422,29 +422,70 @@ void mitk::LabelSetImage::RemoveLabels(std::vector<PixelType> &VectorOfLabelPixe
   for (unsigned int idx = 0; idx < VectorOfLabelPixelValues.size(); idx++)
   {
     GetLabelSet(layer)->RemoveLabel(VectorOfLabelPixelValues[idx]);
-    EraseLabel(VectorOfLabelPixelValues[idx], layer);
   }
+  this->EraseLabels(VectorOfLabelPixelValues, layer);
 }
 
 void mitk::LabelSetImage::EraseLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer)
 {
+  std::map<PixelType, PixelType> labelMapping;
   for (unsigned int i = 0; i < VectorOfLabelPixelValues.size(); i++)
   {
-    this->EraseLabel(VectorOfLabelPixelValues[i], layer);
+    labelMapping[VectorOfLabelPixelValues[i]] = 0;
   }
+  this->RemapLabels(labelMapping, layer);
 }
 
 void mitk::LabelSetImage::EraseLabel(PixelType pixelValue, unsigned int layer)
 {
+  std::map<PixelType, PixelType> labelMapping;
+  labelMapping[pixelValue] = 0;
+  this->RemapLabels(labelMapping, layer);
+}
+
+void mitk::LabelSetImage::RemapLabels(const std::map<PixelType, PixelType> &labelMapping, unsigned int layer)
+{
+  if (labelMapping.empty() || layer >= this->GetNumberOfLayers())
+    return;
+
+  // identity lookup table over the whole label value range, overwritten by the requested mapping
+  std::vector<PixelType> lookupTable(static_cast<size_t>(std::numeric_limits<PixelType>::max()) + 1);
+  for (size_t value = 0; value < lookupTable.size(); ++value)
+  {
+    lookupTable[value] = static_cast<PixelType>(value);
+  }
+  for (auto mapping : labelMapping)
+  {
+    lookupTable[mapping.first] = mapping.second;
+  }
+
+  // the content of the active layer lives in this image, the layer container holds the others
+  mitk::Image *layerImage = layer == this->GetActiveLayer() ? this : this->GetLayerImage(layer);
+  const bool statisticsUpToDate = this->IsLabelStatisticsUpToDate(layer);
+
   try
   {
-    AccessByItk_2(this, EraseLabelProcessing, pixelValue, layer);
+    AccessByItk_1(layerImage, RemapLabelsProcessing, lookupTable);
   }
   catch (itk::ExceptionObject &e)
   {
     mitkThrow() << e.GetDescription();
   }
+  layerImage->Modified();
   Modified();
+
+  if (statisticsUpToDate)
+  {
+    // whole labels are moved, so their statistics can simply be combined
+    LayerLabelStatistics &layerStatistics = m_LabelStatistics[layer];
+    LabelStatisticsMap remappedLabels;
+    for (auto labelStatistics : layerStatistics.labels)
+    {
+      remappedLabels[lookupTable[labelStatistics.first]].Merge(labelStatistics.second);
+    }
+    layerStatistics.labels.swap(remappedLabels);
+    layerStatistics.mTime = layerImage->GetMTime();
+  }
 }
 
 mitk::Label *mitk::LabelSetImage::GetActiveLabel(unsigned int layer)
@@ -489,7 +530,264 @@ mitk::LabelSet *mitk::LabelSetImage::GetActiveLabelSet()
 
 void mitk::LabelSetImage::UpdateCenterOfMass(PixelType pixelValue, unsigned int layer)
 {
-  AccessByItk_2(this, CalculateCenterOfMassProcessing, pixelValue, layer);
+  if (this->GetDimension() != 3)
+    return;
+
+  mitk::Point3D pos;
+  pos.Fill(0.0);
+
+  const LabelStatistics *statistics = this->GetLabelStatistics(pixelValue, layer);
+  if (statistics != nullptr)
+  {
+    pos = statistics->GetCenterOfMassIndex();
+  }
+
+  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassIndex(pos);
+  this->GetSlicedGeometry()->IndexToWorld(pos, pos); // TODO: TimeGeometry?
+  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassCoordinates(pos);
+}
+
+mitk::LabelSetImage::LabelStatistics::LabelStatistics() : voxelCount(0), boundingBoxIsTight(true)
+{
+  indexSum[0] = indexSum[1] = indexSum[2] = 0.0;
+  minIndex.Fill(0);
+  maxIndex.Fill(0);
+}
+
+void mitk::LabelSetImage::LabelStatistics::Update(const itk::Index<3> &index, int count)
+{
+  if (count > 0)
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (voxelCount == 0 || index[i] < minIndex[i])
+        minIndex[i] = index[i];
+      if (voxelCount == 0 || index[i] > maxIndex[i])
+        maxIndex[i] = index[i];
+    }
+    voxelCount += static_cast<itk::SizeValueType>(count);
+  }
+  else if (count < 0)
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (index[i] == minIndex[i] || index[i] == maxIndex[i])
+        boundingBoxIsTight = false;
+    }
+    voxelCount -= static_cast<itk::SizeValueType>(-count);
+  }
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    indexSum[i] += count * static_cast<double>(index[i]);
+  }
+}
+
+void mitk::LabelSetImage::LabelStatistics::Merge(const LabelStatistics &other)
+{
+  if (other.voxelCount == 0)
+    return;
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (voxelCount == 0 || other.minIndex[i] < minIndex[i])
+      minIndex[i] = other.minIndex[i];
+    if (voxelCount == 0 || other.maxIndex[i] > maxIndex[i])
+      maxIndex[i] = other.maxIndex[i];
+    indexSum[i] += other.indexSum[i];
+  }
+  boundingBoxIsTight = (voxelCount == 0 || boundingBoxIsTight) && other.boundingBoxIsTight;
+  voxelCount += other.voxelCount;
+}
+
+mitk::Point3D mitk::LabelSetImage::LabelStatistics::GetCenterOfMassIndex() const
+{
+  mitk::Point3D center;
+  center.Fill(0.0);
+  if (voxelCount > 0)
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      center[i] = indexSum[i] / voxelCount;
+    }
+  }
+  return center;
+}
+
+bool mitk::LabelSetImage::IsLabelStatisticsUpToDate(unsigned int layer) const
+{
+  if (layer >= m_LabelStatistics.size() || layer >= this->GetNumberOfLayers())
+    return false;
+
+  // the content of the active layer lives in this image, the layer container holds the others
+  const mitk::Image *layerImage = layer == this->GetActiveLayer() ? this : this->GetLayerImage(layer);
+  const LayerLabelStatistics &layerStatistics = m_LabelStatistics[layer];
+
+  return layerStatistics.image == layerImage && layerStatistics.mTime >= layerImage->GetMTime();
+}
+
+const mitk::LabelSetImage::LabelStatistics *mitk::LabelSetImage::GetLabelStatistics(PixelType pixelValue,
+                                                                                    unsigned int layer)
+{
+  if (this->GetDimension() != 3 || layer >= this->GetNumberOfLayers())
+    return nullptr;
+
+  if (!this->IsLabelStatisticsUpToDate(layer))
+  {
+    this->ComputeLabelStatistics(layer);
+  }
+
+  LabelStatisticsMap::const_iterator finding = m_LabelStatistics[layer].labels.find(pixelValue);
+  if (finding == m_LabelStatistics[layer].labels.end())
+    return nullptr;
+
+  if (!finding->second.boundingBoxIsTight)
+  {
+    // voxels have been removed on the border of the bounding box, so it has to be shrunk
+    this->ComputeLabelStatistics(layer);
+    finding = m_LabelStatistics[layer].labels.find(pixelValue);
+    if (finding == m_LabelStatistics[layer].labels.end())
+      return nullptr;
+  }
+
+  return &finding->second;
+}
+
+void mitk::LabelSetImage::ComputeLabelStatistics(unsigned int layer)
+{
+  if (m_LabelStatistics.size() < this->GetNumberOfLayers())
+  {
+    m_LabelStatistics.resize(this->GetNumberOfLayers());
+  }
+
+  mitk::Image *layerImage = layer == this->GetActiveLayer() ? this : this->GetLayerImage(layer);
+  LayerLabelStatistics &layerStatistics = m_LabelStatistics[layer];
+  layerStatistics.labels.clear();
+
+  try
+  {
+    AccessFixedDimensionByItk_1(layerImage, ComputeLabelStatisticsProcessing, 3, &layerStatistics.labels);
+  }
+  catch (const mitk::AccessByItkException &e)
+  {
+    mitkThrow() << e.what();
+  }
+
+  layerStatistics.image = layerImage;
+  layerStatistics.mTime = layerImage->GetMTime();
+}
+
+void mitk::LabelSetImage::UpdateLabelStatistics(const mitk::Image *originalSlice,
+                                                const mitk::Image *modifiedSlice,
+                                                unsigned int timeStep)
+{
+  const unsigned int layer = this->GetActiveLayer();
+  if (layer >= m_LabelStatistics.size() || m_LabelStatistics[layer].image != this)
+    return;
+
+  LayerLabelStatistics &layerStatistics = m_LabelStatistics[layer];
+
+  // invalid until the difference has been applied completely
+  layerStatistics.mTime = 0;
+
+  if (timeStep != 0 || this->GetDimension() != 3 || originalSlice == nullptr || modifiedSlice == nullptr)
+    return;
+
+  const mitk::PixelType labelPixelType = mitk::MakeScalarPixelType<PixelType>();
+  if (originalSlice->GetPixelType() != labelPixelType || modifiedSlice->GetPixelType() != labelPixelType)
+    return;
+
+  const unsigned int width = originalSlice->GetDimension(0);
+  const unsigned int height = originalSlice->GetDimension(1);
+  if (modifiedSlice->GetDimension(0) != width || modifiedSlice->GetDimension(1) != height)
+    return;
+
+  // map slice pixels onto image voxels; only a one to one mapping allows an exact update
+  const mitk::BaseGeometry *sliceGeometry = originalSlice->GetGeometry();
+  const mitk::BaseGeometry *imageGeometry = this->GetGeometry(timeStep);
+
+  itk::Index<3> sliceOrigin;
+  itk::Offset<3> axes[2];
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    mitk::Point3D sliceIndex;
+    sliceIndex.Fill(0.0);
+    if (axis > 0)
+      sliceIndex[axis - 1] = 1.0;
+
+    mitk::Point3D worldPosition;
+    mitk::Point3D imageIndex;
+    sliceGeometry->IndexToWorld(sliceIndex, worldPosition);
+    imageGeometry->WorldToIndex(worldPosition, imageIndex);
+
+    itk::Index<3> roundedIndex;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      roundedIndex[i] = itk::Math::Round<itk::IndexValueType>(imageIndex[i]);
+      if (std::abs(imageIndex[i] - roundedIndex[i]) > 0.01)
+        return;
+    }
+
+    if (axis == 0)
+    {
+      sliceOrigin = roundedIndex;
+    }
+    else
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+        axes[axis - 1][i] = roundedIndex[i] - sliceOrigin[i];
+    }
+  }
+
+  for (unsigned int axis = 0; axis < 2; ++axis)
+  {
+    itk::OffsetValueType length = 0;
+    for (unsigned int i = 0; i < 3; ++i)
+      length += std::abs(axes[axis][i]);
+    if (length != 1)
+      return;
+  }
+
+  ImageReadAccessor originalAccessor(originalSlice);
+  ImageReadAccessor modifiedAccessor(modifiedSlice);
+  const PixelType *originalData = static_cast<const PixelType *>(originalAccessor.GetData());
+  const PixelType *modifiedData = static_cast<const PixelType *>(modifiedAccessor.GetData());
+
+  for (unsigned int y = 0; y < height; ++y)
+  {
+    for (unsigned int x = 0; x < width; ++x)
+    {
+      const unsigned int pos = y * width + x;
+      if (originalData[pos] == modifiedData[pos])
+        continue;
+
+      itk::Index<3> index;
+      bool insideImage = true;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        index[i] = sliceOrigin[i] + axes[0][i] * x + axes[1][i] * y;
+        insideImage &= index[i] >= 0 && index[i] < static_cast<itk::IndexValueType>(this->GetDimension(i));
+      }
+      if (!insideImage)
+        continue;
+
+      LabelStatistics &removedFrom = layerStatistics.labels[originalData[pos]];
+      if (removedFrom.voxelCount == 0)
+      {
+        // the slice does not match the statistics, recompute them on the next query
+        layerStatistics.labels.erase(originalData[pos]);
+        return;
+      }
+      removedFrom.Update(index, -1);
+      if (removedFrom.voxelCount == 0)
+      {
+        layerStatistics.labels.erase(originalData[pos]);
+      }
+      layerStatistics.labels[modifiedData[pos]].Update(index, 1);
+    }
+  }
+
+  layerStatistics.mTime = this->GetMTime();
 }
 
 unsigned int mitk::LabelSetImage::GetNumberOfLabels(unsigned int layer) const
@@ -715,45 +1013,25 @@ void mitk::LabelSetImage::CreateLabelMaskProcessing(ImageType *itkImage, mitk::I
 }
 
 template <typename ImageType>
-void mitk::LabelSetImage::CalculateCenterOfMassProcessing(ImageType *itkImage, PixelType pixelValue, unsigned int layer)
+void mitk::LabelSetImage::ComputeLabelStatisticsProcessing(ImageType *itkImage, LabelStatisticsMap *labelStatistics)
 {
-  // for now, we just retrieve the voxel in the middle
-  typedef itk::ImageRegionConstIterator<ImageType> IteratorType;
+  typedef itk::ImageRegionConstIteratorWithIndex<ImageType> IteratorType;
   IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
-  iter.GoToBegin();
 
-  std::vector<typename ImageType::IndexType> indexVector;
+  // consecutive voxels mostly belong to the same label, so avoid a map lookup for each of them
+  LabelStatistics *currentStatistics = nullptr;
+  PixelType currentValue = 0;
 
-  while (!iter.IsAtEnd())
+  for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
   {
-    // TODO fix comparison warning more effective
-    if (iter.Get() == pixelValue)
+    const PixelType value = static_cast<PixelType>(iter.Get());
+    if (currentStatistics == nullptr || value != currentValue)
     {
-      indexVector.push_back(iter.GetIndex());
+      currentStatistics = &(*labelStatistics)[value];
+      currentValue = value;
     }
-    ++iter;
+    currentStatistics->Update(iter.GetIndex(), 1);
   }
-
-  mitk::Point3D pos;
-  pos.Fill(0.0);
-
-  if (!indexVector.empty())
-  {
-    typename itk::ImageRegionConstIteratorWithIndex<ImageType>::IndexType centerIndex;
-    centerIndex = indexVector.at(indexVector.size() / 2);
-    if (centerIndex.GetIndexDimension() == 3)
-    {
-      pos[0] = centerIndex[0];
-      pos[1] = centerIndex[1];
-      pos[2] = centerIndex[2];
-    }
-    else
-      return;
-  }
-
-  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassIndex(pos);
-  this->GetSlicedGeometry()->IndexToWorld(pos, pos); // TODO: TimeGeometry?
-  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassCoordinates(pos);
 }
 
 template <typename ImageType>
@@ -844,40 +1122,28 @@ void mitk::LabelSetImage::ImageToLayerContainerProcessing(itk::Image<TPixel, VIm
 }
 
 template <typename ImageType>
-void mitk::LabelSetImage::EraseLabelProcessing(ImageType *itkImage, PixelType pixelValue, unsigned int /*layer*/)
+void mitk::LabelSetImage::RemapLabelsProcessing(ImageType *itkImage, const std::vector<PixelType> &lookupTable)
 {
-  typedef itk::ImageRegionIterator<ImageType> IteratorType;
+  typedef typename ImageType::PixelType ImagePixelType;
 
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
-  iter.GoToBegin();
+  ImagePixelType *buffer = itkImage->GetBufferPointer();
+  const long long numberOfPixels = static_cast<long long>(itkImage->GetBufferedRegion().GetNumberOfPixels());
+  const double maxLabel = static_cast<double>(lookupTable.size() - 1);
 
-  while (!iter.IsAtEnd())
+#pragma omp parallel for
+  for (long long i = 0; i < numberOfPixels; ++i)
   {
-    PixelType value = iter.Get();
+    const ImagePixelType value = buffer[i];
 
-    if (value == pixelValue)
-    {
-      iter.Set(0);
-    }
-    ++iter;
-  }
-}
-
-template <typename ImageType>
-void mitk::LabelSetImage::MergeLabelProcessing(ImageType *itkImage, PixelType pixelValue, PixelType index)
-{
-  typedef itk::ImageRegionIterator<ImageType> IteratorType;
+    // only integral values within the label range can be mapped
+    if (static_cast<double>(value) < 0.0 || static_cast<double>(value) > maxLabel)
+      continue;
 
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
-  iter.GoToBegin();
-
-  while (!iter.IsAtEnd())
-  {
-    if (iter.Get() == index)
+    const PixelType label = static_cast<PixelType>(value);
+    if (static_cast<ImagePixelType>(label) == value && lookupTable[label] != label)
     {
-      iter.Set(pixelValue);
+      buffer[i] = static_cast<ImagePixelType>(lookupTable[label]);
     }
-    ++iter;
   }
 }
 
@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 #include <mitkLabelSet.h>
 
+#include <map>
+
 #include <MitkMultilabelExports.h>
 
 namespace mitk
@@ -89,6 +91,76 @@ namespace mitk
       * \brief  */
     void UpdateCenterOfMass(PixelType pixelValue, unsigned int layer = 0);
 
+    /**
+     * @brief Voxel count, bounding box and centroid sums of a label, all in index coordinates
+     */
+    struct MITKMULTILABEL_EXPORT LabelStatistics
+    {
+      LabelStatistics();
+
+      /** @brief Adds (count > 0) or removes (count < 0) the voxel at index */
+      void Update(const itk::Index<3> &index, int count);
+
+      /** @brief Adds all voxels of another label */
+      void Merge(const LabelStatistics &other);
+
+      /** @brief Returns the centroid of all voxels of the label in index coordinates */
+      mitk::Point3D GetCenterOfMassIndex() const;
+
+      itk::SizeValueType voxelCount;
+      double indexSum[3];
+      itk::Index<3> minIndex;
+      itk::Index<3> maxIndex;
+
+      /** false if voxels were removed on the border of the bounding box, which may thus be too large */
+      bool boundingBoxIsTight;
+    };
+
+    /**
+     * @brief Returns voxel count, bounding box and center of mass of a label
+     *
+     * The statistics of all labels of a layer are computed in a single pass when first requested
+     * and kept until the layer image is modified. Slice-wise edits can keep them up to date by
+     * calling UpdateLabelStatistics(), which makes subsequent queries O(1).
+     *
+     * @param pixelValue  the value of the label
+     * @param layer       the layer of the label
+     * @return the statistics, or nullptr if the label has no voxels or the image is not 3D
+     */
+    const LabelStatistics *GetLabelStatistics(PixelType pixelValue, unsigned int layer = 0);
+
+    /**
+     * @brief Returns true if the label statistics of the given layer reflect the current image content
+     */
+    bool IsLabelStatisticsUpToDate(unsigned int layer) const;
+
+    /**
+     * @brief Incrementally updates the label statistics of the active layer after a slice has been written
+     *
+     * Must only be called if IsLabelStatisticsUpToDate() was true for the active layer before the slice
+     * was written. The voxels that differ between both slices are moved between the labels. If the
+     * slices cannot be mapped one to one onto image voxels (e.g. oblique planes), the statistics are
+     * recomputed on the next query instead.
+     *
+     * @param originalSlice  the slice content before writing
+     * @param modifiedSlice  the slice content that has been written, with the same geometry
+     * @param timeStep       the time step the slice has been written to
+     */
+    void UpdateLabelStatistics(const mitk::Image *originalSlice, const mitk::Image *modifiedSlice, unsigned int timeStep);
+
+    /**
+     * @brief Replaces label values within the image in a single pass
+     *
+     * Every pixel whose value is a key of labelMapping is set to the mapped value, all other
+     * pixels remain unchanged. The mapping is applied through a lookup table, so the image is
+     * traversed only once regardless of the number of labels involved. Merging and erasing
+     * labels is implemented on top of this method.
+     *
+     * @param labelMapping  pairs of (current label value, new label value)
+     * @param layer         the layer in which the labels should be remapped
+     */
+    void RemapLabels(const std::map<PixelType, PixelType> &labelMapping, unsigned int layer = 0);
+
     /**
      * @brief Removes labels from the mitk::LabelSet of given layer.
      *        Calls mitk::LabelSetImage::EraseLabels() which also removes the labels from within the image.
@@ -282,20 +354,30 @@ namespace mitk
     template <typename TPixel, unsigned int VImageDimension>
     void ImageToLayerContainerProcessing(itk::Image<TPixel, VImageDimension> *source, unsigned int layer) const;
 
-    template <typename ImageType>
-    void CalculateCenterOfMassProcessing(ImageType *input, PixelType index, unsigned int layer);
+    typedef std::map<PixelType, LabelStatistics> LabelStatisticsMap;
+
+    /** Statistics of all labels of a layer and the image state they were computed for */
+    struct LayerLabelStatistics
+    {
+      LayerLabelStatistics() : image(nullptr), mTime(0) {}
+      const mitk::Image *image;
+      itk::ModifiedTimeType mTime;
+      LabelStatisticsMap labels;
+    };
+
+    void ComputeLabelStatistics(unsigned int layer);
 
     template <typename ImageType>
-    void ClearBufferProcessing(ImageType *input);
+    void ComputeLabelStatisticsProcessing(ImageType *input, LabelStatisticsMap *labelStatistics);
 
     template <typename ImageType>
-    void EraseLabelProcessing(ImageType *input, PixelType index, unsigned int layer);
+    void ClearBufferProcessing(ImageType *input);
 
     //  template < typename ImageType >
     //  void ReorderLabelProcessing( ImageType* input, int index, int layer);
 
     template <typename ImageType>
-    void MergeLabelProcessing(ImageType *input, PixelType pixelValue, PixelType index);
+    void RemapLabelsProcessing(ImageType *input, const std::vector<PixelType> &lookupTable);
 
     template <typename ImageType>
     void ConcatenateProcessing(ImageType *input, mitk::LabelSetImage *other);
@@ -317,6 +399,8 @@ namespace mitk
     bool m_activeLayerInvalid;
 
     mitk::Label::Pointer m_ExteriorLabel;
+
+    std::vector<LayerLabelStatistics> m_LabelStatistics;
   };
 
   /**
@@ -22,13 +22,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDataStorage.h"
 #include "mitkNodePredicateBase.h"
 
-#include <Poco/Zip/ZipLocalFileHeader.h>
-
 class TiXmlElement;
 
+namespace Poco
+{
+  namespace Zip
+  {
+    class Compress;
+  }
+}
+
 namespace mitk
 {
   class BaseData;
+  class BaseDataSerializer;
   class PropertyList;
 
   class MITKSCENESERIALIZATION_EXPORT SceneIO : public itk::Object
@@ -45,7 +52,9 @@ namespace mitk
      * GetFailedProperties() for more detail.
      *
      * Attempts to read the provided file and create objects with
-     * parent/child relations into a DataStorage.
+     * parent/child relations into a DataStorage. The index of the scene
+     * is read directly from the archive, the files of the nodes are
+     * extracted by several threads, see also SetLoadDataOnDemand().
      *
      * \param filename full filename of the scene file
      * \param storage If given, this DataStorage is used instead of a newly created one
@@ -65,6 +74,9 @@ namespace mitk
      *
      * Attempts to write a scene file, which contains the nodes of the
      * provided DataStorage, their parent/child relations, and properties.
+     * The index and the property lists are written directly into the archive.
+     * The data of the nodes is serialized by several threads and each file
+     * is added to the archive as soon as it is written.
      *
      * \param storage a DataStorage containing all nodes that should be saved
      * \param filename full filename of the scene file
@@ -95,23 +107,71 @@ namespace mitk
      */
     const PropertyList *GetFailedProperties();
 
+    /**
+     * \brief Store the files of saved scenes without compression.
+     *
+     * Storing is much faster than deflating for data that does not compress
+     * well, e.g. data which is compressed already. Such scenes are loaded like
+     * compressed ones. Default is false.
+     */
+    itkSetMacro(StoreWithoutCompression, bool);
+    itkGetConstMacro(StoreWithoutCompression, bool);
+    itkBooleanMacro(StoreWithoutCompression);
+
+    /**
+     * \brief Number of threads that serialize the data of the nodes or extract the files of a scene.
+     *
+     * Default is the number of cores. Only serializers which report
+     * BaseDataSerializer::IsThreadSafe() run concurrently, the others one at a time.
+     */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+     * \brief Load the data of the nodes when it is accessed for the first time.
+     *
+     * LoadScene() then only creates the nodes with their properties and relations.
+     * The data of a node is extracted and read by its first GetData(), see
+     * DataNode::SetDataLoader(). If more than one thread is allowed, the data of
+     * visible nodes is read in the background meanwhile. Data type queries with
+     * NodePredicateDataType and the rendering of hidden nodes do not read the data.
+     * The scene file must not
+     * change as long as nodes wait for their data, and errors while reading the
+     * data are only logged, they are not listed by GetFailedNodes(). Default is false.
+     */
+    itkSetMacro(LoadDataOnDemand, bool);
+    itkGetConstMacro(LoadDataOnDemand, bool);
+    itkBooleanMacro(LoadDataOnDemand);
+
   protected:
     SceneIO();
     virtual ~SceneIO();
 
     std::string CreateEmptyTempDirectory();
 
-    TiXmlElement *SaveBaseData(BaseData *data, const std::string &filenamehint, bool &error);
-    TiXmlElement *SavePropertyList(PropertyList *propertyList, const std::string &filenamehint);
+    /**
+     * \brief Creates the XML element of the data and looks for its serializer, which is NULL if there is none.
+     */
+    TiXmlElement *CreateBaseDataElement(BaseData *data,
+                                        const std::string &filenamehint,
+                                        itk::SmartPointer<BaseDataSerializer> &serializer);
 
-    void OnUnzipError(const void *pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> &info);
-    void OnUnzipOk(const void *pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path> &info);
+    /**
+     * \brief Serializes the property list into a new entry of the archive.
+     */
+    TiXmlElement *SavePropertyList(PropertyList *propertyList,
+                                   const std::string &filenamehint,
+                                   Poco::Zip::Compress &zipper);
 
     FailedBaseDataListType::Pointer m_FailedNodes;
     PropertyList::Pointer m_FailedProperties;
 
     std::string m_WorkingDirectory;
     unsigned int m_UnzipErrors;
+
+    bool m_StoreWithoutCompression;
+    unsigned int m_NumberOfThreads;
+    bool m_LoadDataOnDemand;
   };
 }
 
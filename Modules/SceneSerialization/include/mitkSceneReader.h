@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDataStorage.h"
 
+#include <functional>
+
 namespace mitk
 {
   class MITKSCENESERIALIZATION_EXPORT SceneReader : public itk::Object
@@ -31,5 +33,31 @@ namespace mitk
     itkFactorylessNewMacro(Self) itkCloneMacro(Self)
 
       virtual bool LoadScene(TiXmlDocument &document, const std::string &workingDirectory, DataStorage *storage);
+
+    /**
+     * \brief Extracts a data file of the scene into the working directory, false if that failed
+     */
+    typedef std::function<bool(const std::string &)> DataFileProviderType;
+
+    /**
+     * \brief Read the data of the nodes on first access, see DataNode::SetDataLoader()
+     *
+     * The provider is called before a data file is read, possibly by another thread,
+     * and has to keep the working directory alive as long as it exists. If no provider
+     * is set, all data is read while loading the scene.
+     */
+    void SetDataFileProvider(const DataFileProviderType &provider) { m_DataFileProvider = provider; }
+
+    /**
+     * \brief Read the data of visible nodes in the background if a data file provider is set
+     */
+    itkSetMacro(PrefetchVisibleData, bool);
+    itkGetConstMacro(PrefetchVisibleData, bool);
+
+  protected:
+    SceneReader();
+
+    DataFileProviderType m_DataFileProvider;
+    bool m_PrefetchVisibleData;
   };
 }
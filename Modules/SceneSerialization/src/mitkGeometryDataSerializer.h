@@ -33,6 +33,8 @@ namespace mitk
     mitkClassMacro(GeometryDataSerializer, BaseDataSerializer);
     itkFactorylessNewMacro(Self) itkCloneMacro(Self) virtual std::string Serialize() override;
 
+    virtual bool IsThreadSafe() const override { return true; }
+
   protected:
     GeometryDataSerializer();
     virtual ~GeometryDataSerializer();
@@ -30,6 +30,8 @@ namespace mitk
     mitkClassMacro(PointSetSerializer, BaseDataSerializer);
     itkFactorylessNewMacro(Self) itkCloneMacro(Self) virtual std::string Serialize() override;
 
+    virtual bool IsThreadSafe() const override { return true; }
+
   protected:
     PointSetSerializer();
     virtual ~PointSetSerializer();
@@ -0,0 +1,216 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkSceneArchive.h"
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/StreamCopier.h>
+#include <Poco/Zip/ZipArchive.h>
+#include <Poco/Zip/ZipStream.h>
+
+#include <mitkLogMacros.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+  /**
+   * \brief Path of an archive entry below the directory, false if the entry would end up outside of it.
+   */
+  bool GetEntryPath(const std::string &directory, const std::string &entryName, Poco::Path &path)
+  {
+    Poco::Path entryPath(entryName, Poco::Path::PATH_UNIX);
+    if (entryPath.isAbsolute())
+    {
+      return false;
+    }
+    for (int i = 0; i <= entryPath.depth(); ++i)
+    {
+      if (entryPath[i] == "..")
+      {
+        return false;
+      }
+    }
+    path = Poco::Path(Poco::Path(directory).makeDirectory(), entryPath);
+    return true;
+  }
+}
+
+mitk::SceneArchive::SceneArchive(const std::string &filename, const std::string &workingDirectory)
+  : m_Filename(filename), m_WorkingDirectory(workingDirectory), m_RemoveWorkingDirectory(false)
+{
+}
+
+mitk::SceneArchive::~SceneArchive()
+{
+  if (m_RemoveWorkingDirectory)
+  {
+    try
+    {
+      Poco::File(m_WorkingDirectory).remove(true);
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
+    }
+  }
+}
+
+unsigned int mitk::SceneArchive::ReadIndex(std::string &index)
+{
+  unsigned int errors(0);
+  m_Entries.clear();
+
+  try
+  {
+    std::ifstream file(m_Filename.c_str(), std::ios::binary);
+    Poco::Zip::ZipArchive archive(file);
+
+    for (auto iter = archive.headerBegin(); iter != archive.headerEnd(); ++iter)
+    {
+      const Poco::Zip::ZipLocalFileHeader &header = iter->second;
+      Poco::Path path;
+      if (!GetEntryPath(m_WorkingDirectory, header.getFileName(), path))
+      {
+        MITK_ERROR << "Error while unzipping: invalid entry " << header.getFileName();
+        ++errors;
+      }
+      else if (header.getFileName() == "index.xml")
+      {
+        Poco::Zip::ZipInputStream zipin(file, header);
+        Poco::StreamCopier::copyToString(zipin, index);
+      }
+      else if (header.isDirectory())
+      {
+        Poco::File(path).createDirectories();
+      }
+      else
+      {
+        // directories are created here, so that the extracting threads only write files
+        Poco::File(path.parent()).createDirectories();
+        m_Entries.push_back(header);
+      }
+    }
+  }
+  catch (std::exception &e)
+  {
+    MITK_ERROR << "Error while unzipping: " << e.what();
+    return errors + 1;
+  }
+
+  return errors;
+}
+
+unsigned int mitk::SceneArchive::ExtractEntries(const std::set<std::string> &skippedDataFiles,
+                                                unsigned int numberOfThreads)
+{
+  std::set<std::string> skippedStems;
+  for (const auto &dataFile : skippedDataFiles)
+  {
+    skippedStems.insert(GetStem(dataFile));
+  }
+
+  std::vector<std::size_t> entries;
+  for (std::size_t i = 0; i < m_Entries.size(); ++i)
+  {
+    if (skippedStems.find(GetStem(m_Entries[i].getFileName())) == skippedStems.end())
+    {
+      entries.push_back(i);
+    }
+  }
+
+  return this->Extract(entries, numberOfThreads);
+}
+
+bool mitk::SceneArchive::ExtractDataFile(const std::string &dataFile)
+{
+  const std::string stem = GetStem(dataFile);
+
+  std::vector<std::size_t> entries;
+  for (std::size_t i = 0; i < m_Entries.size(); ++i)
+  {
+    if (GetStem(m_Entries[i].getFileName()) == stem)
+    {
+      entries.push_back(i);
+    }
+  }
+
+  if (entries.empty())
+  {
+    MITK_ERROR << "Error while unzipping: " << dataFile << " is not part of " << m_Filename;
+    return false;
+  }
+
+  return this->Extract(entries, 1) == 0;
+}
+
+std::string mitk::SceneArchive::GetStem(const std::string &entryName)
+{
+  std::string::size_type nameStart = entryName.find_last_of('/');
+  nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+  return entryName.substr(0, entryName.find('.', nameStart));
+}
+
+unsigned int mitk::SceneArchive::Extract(const std::vector<std::size_t> &entries, unsigned int numberOfThreads)
+{
+  std::atomic<unsigned int> errors(0);
+  std::atomic<std::size_t> nextEntry(0);
+
+  auto extract = [&]() {
+    std::ifstream file(m_Filename.c_str(), std::ios::binary);
+    for (std::size_t i = nextEntry++; i < entries.size(); i = nextEntry++)
+    {
+      const Poco::Zip::ZipLocalFileHeader &header = m_Entries[entries[i]];
+      try
+      {
+        Poco::Path path;
+        GetEntryPath(m_WorkingDirectory, header.getFileName(), path);
+        std::ofstream out(path.toString().c_str(), std::ios::binary);
+        Poco::Zip::ZipInputStream zipin(file, header);
+        Poco::StreamCopier::copyStream(zipin, out);
+        if (!out.good())
+        {
+          throw std::runtime_error("could not write " + path.toString());
+        }
+      }
+      catch (std::exception &e)
+      {
+        MITK_ERROR << "Error while unzipping: " << e.what();
+        file.clear();
+        ++errors;
+      }
+    }
+  };
+
+  numberOfThreads = std::max(1u, std::min<unsigned int>(numberOfThreads, entries.size()));
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+  {
+    threads.push_back(std::thread(extract));
+  }
+  extract();
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  return errors;
+}
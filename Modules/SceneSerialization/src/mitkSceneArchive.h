@@ -0,0 +1,94 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkSceneArchive_h_included
+#define mitkSceneArchive_h_included
+
+#include <Poco/Zip/ZipLocalFileHeader.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Extracts the entries of a scene file for mitk::SceneIO
+
+    The index of the scene is read into memory, all other entries are
+    extracted into a working directory. Entries can be extracted all at
+    once by several threads or per data file when the data is needed.
+    The files of one data file are the file itself and all files with
+    the same name up to the first dot, e.g. the .raw file of a .mhd file.
+
+    After ReadIndex(), ExtractEntries() and ExtractDataFile() may be called
+    by several threads at the same time.
+  */
+  class SceneArchive
+  {
+  public:
+    SceneArchive(const std::string &filename, const std::string &workingDirectory);
+
+    /**
+      \brief Removes the working directory if SetRemoveWorkingDirectory() was called
+    */
+    ~SceneArchive();
+
+    /**
+      \brief Reads the list of entries and the content of index.xml
+      \return the number of invalid entries, or one more if the archive could not be read
+    */
+    unsigned int ReadIndex(std::string &index);
+
+    /**
+      \brief Extracts all entries except those of the given data files
+      \return the number of entries that could not be extracted
+    */
+    unsigned int ExtractEntries(const std::set<std::string> &skippedDataFiles, unsigned int numberOfThreads);
+
+    /**
+      \brief Extracts the entries of one data file, which is referenced by the "file" attribute of a <data> element
+      \return false if an entry could not be extracted
+    */
+    bool ExtractDataFile(const std::string &dataFile);
+
+    const std::string &GetWorkingDirectory() const { return m_WorkingDirectory; }
+
+    void SetRemoveWorkingDirectory(bool remove) { m_RemoveWorkingDirectory = remove; }
+
+  private:
+    SceneArchive(const SceneArchive &);
+    SceneArchive &operator=(const SceneArchive &);
+
+    /**
+      \brief Name of the entry up to the first dot of its file name
+    */
+    static std::string GetStem(const std::string &entryName);
+
+    /**
+      \brief Extracts the entries with the given indices, each thread reads the archive through its own stream
+    */
+    unsigned int Extract(const std::vector<std::size_t> &entries, unsigned int numberOfThreads);
+
+    std::string m_Filename;
+    std::string m_WorkingDirectory;
+    bool m_RemoveWorkingDirectory;
+
+    std::vector<Poco::Zip::ZipLocalFileHeader> m_Entries;
+  };
+}
+
+#endif
@@ -14,14 +14,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
 
-#include <Poco/Delegate.h>
+#include <Poco/DateTime.h>
+#include <Poco/File.h>
 #include <Poco/Path.h>
-#include <Poco/TemporaryFile.h>
 #include <Poco/Zip/Compress.h>
-#include <Poco/Zip/Decompress.h>
 
 #include "mitkBaseDataSerializer.h"
 #include "mitkPropertyListSerializer.h"
+#include "mitkSceneArchive.h"
 #include "mitkSceneIO.h"
 #include "mitkSceneReader.h"
 
@@ -36,13 +36,164 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <tinyxml.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <mitkIOUtil.h>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
 
 #include "itksys/SystemTools.hxx"
 
-mitk::SceneIO::SceneIO() : m_WorkingDirectory(""), m_UnzipErrors(0)
+namespace
+{
+  /**
+   * \brief Serialization of the data of one node into its own directory.
+   */
+  struct BaseDataJob
+  {
+    mitk::DataNode *node;
+    mitk::BaseDataSerializer::Pointer serializer;
+    TiXmlElement *element;
+    std::string directory;
+    std::string filename;
+    bool error;
+    bool done;
+  };
+
+  void SerializeBaseData(BaseDataJob &job)
+  {
+    job.error = true;
+    if (job.serializer.IsNull())
+    {
+      return;
+    }
+
+    try
+    {
+      Poco::File(job.directory).createDirectories();
+      job.serializer->SetWorkingDirectory(job.directory);
+      job.filename = job.serializer->Serialize();
+      job.error = false;
+    }
+    catch (std::exception &e)
+    {
+      MITK_ERROR << "Serializer " << job.serializer->GetNameOfClass() << " failed: " << e.what();
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Serializer " << job.serializer->GetNameOfClass() << " failed";
+    }
+  }
+
+  /**
+   * \brief Serializes the jobs with several threads while the calling thread hands the finished jobs in their
+   * order to finished. Threads only run a limited number of jobs ahead, so that the written files do not pile up.
+   * Serializers which are not thread-safe run one at a time.
+   */
+  void SerializeBaseDataInParallel(std::vector<BaseDataJob> &jobs,
+                                   unsigned int numberOfThreads,
+                                   const std::function<void(BaseDataJob &)> &finished)
+  {
+    numberOfThreads = std::max(1u, std::min<unsigned int>(numberOfThreads, jobs.size()));
+    if (numberOfThreads == 1)
+    {
+      for (auto &job : jobs)
+      {
+        SerializeBaseData(job);
+        finished(job);
+      }
+      return;
+    }
+
+    const std::size_t maximumJobsAhead = 2 * numberOfThreads;
+    std::mutex mutex;
+    std::mutex serialMutex;
+    std::condition_variable condition;
+    std::size_t nextJob = 0;
+    std::size_t finishedJobs = 0;
+
+    auto worker = [&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true)
+      {
+        condition.wait(lock, [&]() { return nextJob >= jobs.size() || nextJob < finishedJobs + maximumJobsAhead; });
+        if (nextJob >= jobs.size())
+        {
+          return;
+        }
+        BaseDataJob &job = jobs[nextJob++];
+        lock.unlock();
+        if (job.serializer.IsNotNull() && job.serializer->IsThreadSafe())
+        {
+          SerializeBaseData(job);
+        }
+        else
+        {
+          std::lock_guard<std::mutex> serialLock(serialMutex);
+          SerializeBaseData(job);
+        }
+        lock.lock();
+        job.done = true;
+        condition.notify_all();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.push_back(std::thread(worker));
+    }
+
+    // the threads have to be joined before an exception of finished is passed on
+    std::exception_ptr failure;
+    for (auto &job : jobs)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return job.done; });
+      }
+      try
+      {
+        finished(job);
+      }
+      catch (...)
+      {
+        if (!failure)
+        {
+          failure = std::current_exception();
+        }
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++finishedJobs;
+      }
+      condition.notify_all();
+    }
+
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+
+    if (failure)
+    {
+      std::rethrow_exception(failure);
+    }
+  }
+}
+
+mitk::SceneIO::SceneIO()
+  : m_WorkingDirectory(""),
+    m_UnzipErrors(0),
+    m_StoreWithoutCompression(false),
+    m_NumberOfThreads(std::max(1u, std::thread::hardware_concurrency())),
+    m_LoadDataOnDemand(false)
 {
 }
 
@@ -133,18 +284,48 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
     return storage;
   }
 
-  // unzip all filenames contents to temp dir
-  m_UnzipErrors = 0;
-  Poco::Zip::Decompress unzipper(file, Poco::Path(m_WorkingDirectory));
-  unzipper.EError += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
-    this, &SceneIO::OnUnzipError);
-  unzipper.EOk += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
-    this, &SceneIO::OnUnzipOk);
-  unzipper.decompressAllFiles();
-  unzipper.EError -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
-    this, &SceneIO::OnUnzipError);
-  unzipper.EOk -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
-    this, &SceneIO::OnUnzipOk);
+  file.close();
+
+  // read the index, the other files are extracted to the temp dir after the index is parsed
+  auto archive = std::make_shared<SceneArchive>(filename, m_WorkingDirectory);
+  std::string index;
+  m_UnzipErrors = archive->ReadIndex(index);
+
+  // parse index.xml with TinyXML, with line endings normalized like TiXmlDocument::LoadFile() does
+  index.erase(std::remove(index.begin(), index.end(), '\r'), index.end());
+  TiXmlDocument document;
+  document.Parse(index.c_str());
+  if (index.empty() || document.Error())
+  {
+    MITK_ERROR << "Could not open/read/parse index.xml of " << filename << "\nTinyXML reports: " << document.ErrorDesc()
+               << std::endl;
+    try
+    {
+      Poco::File(m_WorkingDirectory).remove(true);
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
+    }
+    return storage;
+  }
+
+  // data files are left in the archive until their data is accessed
+  std::set<std::string> dataFiles;
+  if (m_LoadDataOnDemand)
+  {
+    for (TiXmlElement *element = document.FirstChildElement("node"); element != NULL;
+         element = element->NextSiblingElement("node"))
+    {
+      TiXmlElement *dataElement = element->FirstChildElement("data");
+      if (dataElement && dataElement->Attribute("file"))
+      {
+        dataFiles.insert(dataElement->Attribute("file"));
+      }
+    }
+  }
+
+  m_UnzipErrors += archive->ExtractEntries(dataFiles, m_NumberOfThreads);
 
   if (m_UnzipErrors)
   {
@@ -152,31 +333,33 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
                << "'. Will attempt to read whatever could be unzipped.";
   }
 
-  // test if index.xml exists
-  // parse index.xml with TinyXML
-  TiXmlDocument document(m_WorkingDirectory + mitk::IOUtil::GetDirectorySeparator() + "index.xml");
-  if (!document.LoadFile())
+  SceneReader::Pointer reader = SceneReader::New();
+  if (m_LoadDataOnDemand)
   {
-    MITK_ERROR << "Could not open/read/parse " << m_WorkingDirectory << mitk::IOUtil::GetDirectorySeparator()
-               << "index.xml\nTinyXML reports: " << document.ErrorDesc() << std::endl;
-    return storage;
+    // the loaders of the nodes keep the archive and its working directory until the last one is done
+    archive->SetRemoveWorkingDirectory(true);
+    reader->SetDataFileProvider(
+      [archive](const std::string &dataFile) { return archive->ExtractDataFile(dataFile); });
+    reader->SetPrefetchVisibleData(m_NumberOfThreads > 1);
   }
 
-  SceneReader::Pointer reader = SceneReader::New();
   if (!reader->LoadScene(document, m_WorkingDirectory, storage))
   {
     MITK_ERROR << "There were errors while loading scene file " << filename << ". Your data may be corrupted";
   }
 
-  // delete temp directory
-  try
+  if (!m_LoadDataOnDemand)
   {
-    Poco::File deleteDir(m_WorkingDirectory);
-    deleteDir.remove(true); // recursive
-  }
-  catch (...)
-  {
-    MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
+    // delete temp directory
+    try
+    {
+      Poco::File deleteDir(m_WorkingDirectory);
+      deleteDir.remove(true); // recursive
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
+    }
   }
 
   // return new data storage, even if empty or uncomplete (return as much as possible but notify calling method)
@@ -207,11 +390,30 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
 
   mitk::LocaleSwitch localeSwitch("C");
 
+  Poco::Zip::ZipCommon::CompressionMethod compressionMethod =
+    m_StoreWithoutCompression ? Poco::Zip::ZipCommon::CM_STORE : Poco::Zip::ZipCommon::CM_DEFLATE;
+  bool success(true);
+
   try
   {
     m_FailedNodes = DataStorage::SetOfObjects::New();
     m_FailedProperties = PropertyList::New();
 
+    Poco::File deleteFile(filename.c_str());
+    if (deleteFile.exists())
+    {
+      deleteFile.remove();
+    }
+
+    // create zip at filename, all parts of the scene are written directly into it
+    std::ofstream file(filename.c_str(), std::ios::binary | std::ios::out);
+    if (!file.good())
+    {
+      MITK_ERROR << "Could not open a zip file for writing: '" << filename << "'";
+      return false;
+    }
+    Poco::Zip::Compress zipper(file, true);
+
     // start XML DOM
     TiXmlDocument document;
     TiXmlDeclaration *decl = new TiXmlDeclaration(
@@ -290,6 +492,10 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
         }
       }
 
+      // the data of the nodes is serialized in parallel after the XML structure is complete
+      std::vector<BaseDataJob> baseDataJobs;
+      unsigned int nodesWithoutData = 0;
+
       // write out objects, dependencies and properties
       for (DataStorage::SetOfObjects::const_iterator iter = sceneNodes->begin(); iter != sceneNodes->end(); ++iter)
       {
@@ -328,23 +534,30 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
           if (BaseData *data = node->GetData())
           {
             // std::string filenameHint( node->GetName() );
-            bool error(false);
-            TiXmlElement *dataElement(SaveBaseData(data, filenameHint, error)); // returns a reference to a file
-            if (error)
-            {
-              m_FailedNodes->push_back(node);
-            }
+            BaseDataJob job;
+            job.node = node;
+            job.element = CreateBaseDataElement(data, filenameHint, job.serializer);
+            std::ostringstream directory;
+            directory << m_WorkingDirectory << Poco::Path::separator() << baseDataJobs.size();
+            job.directory = directory.str();
+            job.error = true;
+            job.done = false;
+            baseDataJobs.push_back(job);
 
             // store basedata properties
             PropertyList *propertyList = data->GetPropertyList();
             if (propertyList && !propertyList->IsEmpty())
             {
               TiXmlElement *baseDataPropertiesElement(
-                SavePropertyList(propertyList, filenameHint + "-data")); // returns a reference to a file
-              dataElement->LinkEndChild(baseDataPropertiesElement);
+                SavePropertyList(propertyList, filenameHint + "-data", zipper)); // returns a reference to a file
+              job.element->LinkEndChild(baseDataPropertiesElement);
             }
 
-            nodeElement->LinkEndChild(dataElement);
+            nodeElement->LinkEndChild(job.element);
+          }
+          else
+          {
+            ++nodesWithoutData;
           }
 
           // store all renderwindow specific propertylists
@@ -354,8 +567,8 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
             PropertyList *propertyList = node->GetPropertyList(renderWindowName);
             if (propertyList && !propertyList->IsEmpty())
             {
-              TiXmlElement *renderWindowPropertiesElement(
-                SavePropertyList(propertyList, filenameHint + "-" + renderWindowName)); // returns a reference to a file
+              TiXmlElement *renderWindowPropertiesElement(SavePropertyList(
+                propertyList, filenameHint + "-" + renderWindowName, zipper)); // returns a reference to a file
               renderWindowPropertiesElement->SetAttribute("renderwindow", renderWindowName);
               nodeElement->LinkEndChild(renderWindowPropertiesElement);
             }
@@ -366,7 +579,7 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
           if (propertyList && !propertyList->IsEmpty())
           {
             TiXmlElement *propertiesElement(
-              SavePropertyList(propertyList, filenameHint + "-node")); // returns a reference to a file
+              SavePropertyList(propertyList, filenameHint + "-node", zipper)); // returns a reference to a file
             nodeElement->LinkEndChild(propertiesElement);
           }
           document.LinkEndChild(nodeElement);
@@ -374,72 +587,90 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
         else
         {
           MITK_WARN << "Ignoring NULL node during scene serialization.";
+          ++nodesWithoutData;
         }
-
-        ProgressBar::GetInstance()->Progress();
       } // end for all nodes
-    }   // end if sceneNodes
 
-    if (!document.SaveFile(m_WorkingDirectory + Poco::Path::separator() + "index.xml"))
-    {
-      MITK_ERROR << "Could not write scene to " << m_WorkingDirectory << Poco::Path::separator() << "index.xml"
-                 << "\nTinyXML reports '" << document.ErrorDesc() << "'";
-      return false;
-    }
-    else
-    {
-      try
+      if (nodesWithoutData > 0)
       {
-        Poco::File deleteFile(filename.c_str());
-        if (deleteFile.exists())
-        {
-          deleteFile.remove();
-        }
+        ProgressBar::GetInstance()->Progress(nodesWithoutData);
+      }
 
-        // create zip at filename
-        std::ofstream file(filename.c_str(), std::ios::binary | std::ios::out);
-        if (!file.good())
-        {
-          MITK_ERROR << "Could not open a zip file for writing: '" << filename << "'";
-          return false;
-        }
-        else
-        {
-          Poco::Zip::Compress zipper(file, true);
-          Poco::Path tmpdir(m_WorkingDirectory);
-          zipper.addRecursive(tmpdir);
-          zipper.close();
-        }
+      // serialize the data, every finished node is moved into the archive right away
+      try
+      {
+        SerializeBaseDataInParallel(baseDataJobs, m_NumberOfThreads, [&](BaseDataJob &job) {
+          if (job.error)
+          {
+            m_FailedNodes->push_back(job.node);
+          }
+          else
+          {
+            job.element->SetAttribute("file", job.filename);
+            zipper.addRecursive(Poco::Path(job.directory).makeDirectory(), compressionMethod);
+          }
+          try
+          {
+            Poco::File(job.directory).remove(true);
+          }
+          catch (...)
+          {
+            MITK_ERROR << "Could not delete temporary directory " << job.directory;
+          }
+          ProgressBar::GetInstance()->Progress();
+        });
+      }
+      catch (...)
+      {
         try
         {
-          Poco::File deleteDir(m_WorkingDirectory);
-          deleteDir.remove(true); // recursive
+          Poco::File(m_WorkingDirectory).remove(true);
         }
         catch (...)
         {
           MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
-          return false; // ok?
         }
+        throw;
       }
-      catch (std::exception &e)
+
+      try
       {
-        MITK_ERROR << "Could not create ZIP file from " << m_WorkingDirectory << "\nReason: " << e.what();
-        return false;
+        Poco::File deleteDir(m_WorkingDirectory);
+        deleteDir.remove(true); // recursive
       }
-      return true;
+      catch (...)
+      {
+        MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
+        success = false; // ok?
+      }
+    } // end if sceneNodes
+
+    TiXmlPrinter printer;
+    document.Accept(&printer);
+    std::istringstream index(printer.CStr());
+    zipper.addFile(index, Poco::DateTime(), Poco::Path("index.xml"), compressionMethod);
+    zipper.close();
+
+    if (!file.good())
+    {
+      MITK_ERROR << "Could not write scene to " << filename;
+      return false;
     }
+    return success;
   }
   catch (std::exception &e)
   {
-    MITK_ERROR << "Caught exception during saving temporary files to disk. Error description: '" << e.what() << "'";
+    MITK_ERROR << "Could not create ZIP file " << filename << "\nReason: " << e.what();
     return false;
   }
 }
 
-TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &filenamehint, bool &error)
+TiXmlElement *mitk::SceneIO::CreateBaseDataElement(BaseData *data,
+                                                   const std::string &filenamehint,
+                                                   BaseDataSerializer::Pointer &serializer)
 {
   assert(data);
-  error = true;
+  serializer = nullptr;
 
   // find correct serializer
   // the serializer must
@@ -464,21 +695,11 @@ TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &fil
        iter != thingsThatCanSerializeThis.end();
        ++iter)
   {
-    if (BaseDataSerializer *serializer = dynamic_cast<BaseDataSerializer *>(iter->GetPointer()))
+    if (BaseDataSerializer *baseDataSerializer = dynamic_cast<BaseDataSerializer *>(iter->GetPointer()))
     {
-      serializer->SetData(data);
-      serializer->SetFilenameHint(filenamehint);
-      serializer->SetWorkingDirectory(m_WorkingDirectory);
-      try
-      {
-        std::string writtenfilename = serializer->Serialize();
-        element->SetAttribute("file", writtenfilename);
-        error = false;
-      }
-      catch (std::exception &e)
-      {
-        MITK_ERROR << "Serializer " << serializer->GetNameOfClass() << " failed: " << e.what();
-      }
+      baseDataSerializer->SetData(data);
+      baseDataSerializer->SetFilenameHint(filenamehint);
+      serializer = baseDataSerializer;
       break;
     }
   }
@@ -486,7 +707,9 @@ TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &fil
   return element;
 }
 
-TiXmlElement *mitk::SceneIO::SavePropertyList(PropertyList *propertyList, const std::string &filenamehint)
+TiXmlElement *mitk::SceneIO::SavePropertyList(PropertyList *propertyList,
+                                              const std::string &filenamehint,
+                                              Poco::Zip::Compress &zipper)
 {
   assert(propertyList);
 
@@ -498,11 +721,18 @@ TiXmlElement *mitk::SceneIO::SavePropertyList(PropertyList *propertyList, const
 
   serializer->SetPropertyList(propertyList);
   serializer->SetFilenameHint(filenamehint);
-  serializer->SetWorkingDirectory(m_WorkingDirectory);
   try
   {
-    std::string writtenfilename = serializer->Serialize();
-    element->SetAttribute("file", writtenfilename);
+    std::stringstream stream;
+    std::string writtenfilename = serializer->SerializeToStream(stream);
+    if (!writtenfilename.empty())
+    {
+      zipper.addFile(stream,
+                     Poco::DateTime(),
+                     Poco::Path(writtenfilename),
+                     m_StoreWithoutCompression ? Poco::Zip::ZipCommon::CM_STORE : Poco::Zip::ZipCommon::CM_DEFLATE);
+      element->SetAttribute("file", writtenfilename);
+    }
     PropertyList::Pointer failedProperties = serializer->GetFailedProperties();
     if (failedProperties.IsNotNull())
     {
@@ -527,16 +757,3 @@ const mitk::PropertyList *mitk::SceneIO::GetFailedProperties()
 {
   return m_FailedProperties;
 }
-
-void mitk::SceneIO::OnUnzipError(const void * /*pSender*/,
-                                 std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> &info)
-{
-  ++m_UnzipErrors;
-  MITK_ERROR << "Error while unzipping: " << info.second;
-}
-
-void mitk::SceneIO::OnUnzipOk(const void * /*pSender*/,
-                              std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path> & /*info*/)
-{
-  // MITK_INFO << "Unzipped ok: " << info.second.toString();
-}
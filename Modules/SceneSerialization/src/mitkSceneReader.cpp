@@ -16,6 +16,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkSceneReader.h"
 
+mitk::SceneReader::SceneReader() : m_PrefetchVisibleData(false)
+{
+}
+
 bool mitk::SceneReader::LoadScene(TiXmlDocument &document, const std::string &workingDirectory, DataStorage *storage)
 {
   // find version node --> note version in some variable
@@ -49,6 +53,8 @@ bool mitk::SceneReader::LoadScene(TiXmlDocument &document, const std::string &wo
   {
     if (SceneReader *reader = dynamic_cast<SceneReader *>(iter->GetPointer()))
     {
+      reader->SetDataFileProvider(m_DataFileProvider);
+      reader->SetPrefetchVisibleData(m_PrefetchVisibleData);
       if (!reader->LoadScene(document, workingDirectory, storage))
       {
         MITK_ERROR << "There were errors while loading scene file "
@@ -23,6 +23,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkSerializerMacros.h"
 #include <mitkRenderingModeProperty.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 MITK_REGISTER_SERIALIZER(SceneReaderV1)
 
 namespace
@@ -51,6 +56,85 @@ namespace
     // question clearly
     return left.first.GetPointer() < right.first.GetPointer();
   }
+
+  /**
+   * \brief Reads the data of one node once, either for the prefetcher or for the first GetData() of the node.
+   */
+  class DataOnDemand
+  {
+  public:
+    explicit DataOnDemand(const std::function<mitk::BaseData::Pointer()> &read) : m_Read(read) {}
+
+    void Prefetch()
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      this->Read();
+    }
+
+    /**
+     * \brief Returns the data and releases it, so that it is not kept alive after the node is gone.
+     */
+    mitk::BaseData::Pointer Take()
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      this->Read();
+      mitk::BaseData::Pointer data = m_Data;
+      m_Data = nullptr;
+      return data;
+    }
+
+  private:
+    void Read()
+    {
+      if (m_Read)
+      {
+        try
+        {
+          m_Data = m_Read();
+        }
+        catch (...)
+        {
+          m_Data = nullptr;
+        }
+        m_Read = nullptr;
+      }
+    }
+
+    std::mutex m_Mutex;
+    std::function<mitk::BaseData::Pointer()> m_Read;
+    mitk::BaseData::Pointer m_Data;
+  };
+
+  /**
+   * \brief Reads the data of visible nodes in the background. Destroyed with the last node that waits for its data.
+   */
+  class Prefetcher
+  {
+  public:
+    explicit Prefetcher(const std::vector<std::shared_ptr<DataOnDemand>> &data) : m_Data(data), m_Abort(false)
+    {
+      m_Thread = std::thread([this]() {
+        for (std::size_t i = 0; i < m_Data.size() && !m_Abort; ++i)
+        {
+          m_Data[i]->Prefetch();
+        }
+      });
+    }
+
+    ~Prefetcher()
+    {
+      m_Abort = true;
+      m_Thread.join();
+    }
+
+  private:
+    Prefetcher(const Prefetcher &);
+    Prefetcher &operator=(const Prefetcher &);
+
+    std::vector<std::shared_ptr<DataOnDemand>> m_Data;
+    std::atomic<bool> m_Abort;
+    std::thread m_Thread;
+  };
 }
 
 bool mitk::SceneReaderV1::LoadScene(TiXmlDocument &document, const std::string &workingDirectory, DataStorage *storage)
@@ -79,24 +163,65 @@ bool mitk::SceneReaderV1::LoadScene(TiXmlDocument &document, const std::string &
 
   ProgressBar::GetInstance()->AddStepsToDo(listSize * 2);
 
+  // with a data file provider, the nodes are created without data and get it on first access
+  std::vector<std::shared_ptr<DataOnDemand>> dataOnDemand;
+  std::vector<std::string> dataTypes;
+  Self::Pointer reader = this;
+
   for (TiXmlElement *element = document.FirstChildElement("node"); element != NULL;
        element = element->NextSiblingElement("node"))
   {
-    DataNodes.push_back(LoadBaseDataFromDataTag(element->FirstChildElement("data"), workingDirectory, error));
+    TiXmlElement *dataElement = element->FirstChildElement("data");
+    if (m_DataFileProvider && dataElement && dataElement->Attribute("file"))
+    {
+      std::string filename(dataElement->Attribute("file"));
+      std::shared_ptr<TiXmlElement> propertiesElement;
+      if (dataElement->FirstChildElement("properties"))
+      {
+        propertiesElement = std::make_shared<TiXmlElement>(*dataElement->FirstChildElement("properties"));
+      }
+      DataFileProviderType provider = m_DataFileProvider;
+
+      dataOnDemand.push_back(std::make_shared<DataOnDemand>(
+        [reader, provider, filename, workingDirectory, propertiesElement]() -> BaseData::Pointer {
+          bool readError(false);
+          if (!provider(filename))
+          {
+            return nullptr;
+          }
+          BaseData::Pointer data = reader->LoadBaseData(filename, workingDirectory, readError);
+          if (data.IsNotNull() && propertiesElement)
+          {
+            reader->DecorateBaseDataWithProperties(data, propertiesElement.get(), workingDirectory);
+          }
+          return data;
+        }));
+      DataNodes.push_back(DataNode::New());
+      // the type is known before the data is read, e.g. for node predicates
+      dataTypes.push_back(dataElement->Attribute("type") ? dataElement->Attribute("type") : "");
+    }
+    else
+    {
+      dataOnDemand.push_back(nullptr);
+      dataTypes.push_back("");
+      DataNodes.push_back(LoadBaseDataFromDataTag(dataElement, workingDirectory, error));
+    }
     ProgressBar::GetInstance()->Progress();
   }
 
   // iterate all nodes
   // first level nodes should be <node> elements
+  std::vector<std::vector<std::string>> propertyListNames(DataNodes.size());
   DataNodeVector::iterator nit = DataNodes.begin();
   for (TiXmlElement *element = document.FirstChildElement("node"); element != NULL || nit != DataNodes.end();
        element = element->NextSiblingElement("node"), ++nit)
   {
     mitk::DataNode::Pointer node = *nit;
+    const std::size_t nodeIndex = nit - DataNodes.begin();
     // in case dataXmlElement is valid test whether it containts the "properties" child tag
-    // and process further if and only if yes
+    // and process further if and only if yes (data read on demand is decorated when it is read)
     TiXmlElement *dataXmlElement = element->FirstChildElement("data");
-    if (dataXmlElement && dataXmlElement->FirstChildElement("properties"))
+    if (!dataOnDemand[nodeIndex] && dataXmlElement && dataXmlElement->FirstChildElement("properties"))
     {
       TiXmlElement *baseDataElement = dataXmlElement->FirstChildElement("properties");
       if (node->GetData())
@@ -136,6 +261,14 @@ bool mitk::SceneReaderV1::LoadScene(TiXmlDocument &document, const std::string &
       error = true;
     }
 
+    // these lists replace the default properties of data read on demand
+    for (TiXmlElement *properties = element->FirstChildElement("properties"); properties != NULL;
+         properties = properties->NextSiblingElement("properties"))
+    {
+      const char *renderwindow(properties->Attribute("renderwindow"));
+      propertyListNames[nodeIndex].push_back(renderwindow ? renderwindow : "");
+    }
+
     // remember node for later adding to DataStorage
     m_OrderedNodePairs.push_back(std::make_pair(node, std::list<std::string>()));
 
@@ -153,6 +286,35 @@ bool mitk::SceneReaderV1::LoadScene(TiXmlDocument &document, const std::string &
     ProgressBar::GetInstance()->Progress();
   } // end for all <node>
 
+  // visible nodes are read in the background, the others on their first access
+  std::vector<std::shared_ptr<DataOnDemand>> visibleData;
+  for (std::size_t i = 0; i < DataNodes.size(); ++i)
+  {
+    if (dataOnDemand[i] && m_PrefetchVisibleData && DataNodes[i]->IsVisible(nullptr))
+    {
+      visibleData.push_back(dataOnDemand[i]);
+    }
+  }
+  std::shared_ptr<Prefetcher> prefetcher;
+  if (!visibleData.empty())
+  {
+    prefetcher = std::make_shared<Prefetcher>(visibleData);
+  }
+
+  for (std::size_t i = 0; i < DataNodes.size(); ++i)
+  {
+    if (dataOnDemand[i])
+    {
+      std::shared_ptr<DataOnDemand> data = dataOnDemand[i];
+      std::vector<std::string> names = propertyListNames[i];
+      DataNodes[i]->SetDataLoader(
+        [reader, data, prefetcher, names](DataNode &node) {
+          reader->SetDataOnDemand(node, data->Take(), names);
+        },
+        dataTypes[i]);
+    }
+  }
+
   // sort our nodes by their "layer" property
   // (to be inserted in that order)
   m_OrderedNodePairs.sort(&NodeSortByLayerIsLessThan);
@@ -238,6 +400,9 @@ bool mitk::SceneReaderV1::LoadScene(TiXmlDocument &document, const std::string &
     error = true;
   }
 
+  // the data loaders of the nodes keep this reader, which must not keep the nodes in turn
+  m_OrderedNodePairs.clear();
+
   return !error;
 }
 
@@ -252,26 +417,11 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag(TiXmlElemen
     const char *filename = dataElement->Attribute("file");
     if (filename)
     {
-      try
+      BaseData::Pointer data = LoadBaseData(filename, workingDirectory, error);
+      if (data.IsNotNull())
       {
-        std::vector<BaseData::Pointer> baseData = IOUtil::Load(workingDirectory + Poco::Path::separator() + filename);
-        if (baseData.size() > 1)
-        {
-          MITK_WARN << "Discarding multiple base data results from " << filename << " except the first one.";
-        }
         node = DataNode::New();
-        node->SetData(baseData.front());
-      }
-      catch (std::exception &e)
-      {
-        MITK_ERROR << "Error during attempt to read '" << filename << "'. Exception says: " << e.what();
-        error = true;
-      }
-
-      if (node.IsNull())
-      {
-        MITK_ERROR << "Error during attempt to read '" << filename << "'. Factory returned NULL object.";
-        error = true;
+        node->SetData(data);
       }
     }
   }
@@ -285,6 +435,63 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag(TiXmlElemen
   return node;
 }
 
+mitk::BaseData::Pointer mitk::SceneReaderV1::LoadBaseData(const std::string &filename,
+                                                          const std::string &workingDirectory,
+                                                          bool &error)
+{
+  BaseData::Pointer data;
+
+  try
+  {
+    std::vector<BaseData::Pointer> baseData = IOUtil::Load(workingDirectory + Poco::Path::separator() + filename);
+    if (baseData.size() > 1)
+    {
+      MITK_WARN << "Discarding multiple base data results from " << filename << " except the first one.";
+    }
+    data = baseData.front();
+  }
+  catch (std::exception &e)
+  {
+    MITK_ERROR << "Error during attempt to read '" << filename << "'. Exception says: " << e.what();
+    error = true;
+  }
+
+  if (data.IsNull())
+  {
+    MITK_ERROR << "Error during attempt to read '" << filename << "'. Factory returned NULL object.";
+    error = true;
+  }
+
+  return data;
+}
+
+void mitk::SceneReaderV1::SetDataOnDemand(DataNode &node,
+                                          BaseData *data,
+                                          const std::vector<std::string> &propertyListNames)
+{
+  if (!data)
+  {
+    MITK_ERROR << "Could not read the data of node " << node.GetName() << " from the scene.";
+    return;
+  }
+
+  // SetData() adds the default properties of the data, which are removed again like in LoadScene()
+  std::vector<PropertyList::Pointer> sceneProperties;
+  for (const auto &name : propertyListNames)
+  {
+    sceneProperties.push_back(node.GetPropertyList(name)->Clone());
+  }
+
+  node.SetData(data);
+
+  for (std::size_t i = 0; i < propertyListNames.size(); ++i)
+  {
+    PropertyList *propertyList = node.GetPropertyList(propertyListNames[i]);
+    ClearNodePropertyListWithExceptions(node, *propertyList);
+    propertyList->ConcatenatePropertyList(sceneProperties[i], true); // true = replace
+  }
+}
+
 void mitk::SceneReaderV1::ClearNodePropertyListWithExceptions(DataNode &node, PropertyList &propertyList)
 {
   // Basically call propertyList.Clear(), but implement exceptions (see bug 19354)
@@ -36,6 +36,19 @@ namespace mitk
                                               const std::string &workingDirectory,
                                               bool &error);
 
+    /**
+      \brief reads the data of a <data file="..."> element, NULL if that failed
+    */
+    BaseData::Pointer LoadBaseData(const std::string &filename, const std::string &workingDirectory, bool &error);
+
+    /**
+      \brief sets data that is read on demand and restores the properties read from the scene
+
+      Behaves like reading the data while loading the scene: the given property lists of the node
+      keep the properties of the scene instead of the default properties of the data.
+    */
+    void SetDataOnDemand(DataNode &node, BaseData *data, const std::vector<std::string> &propertyListNames);
+
     /**
       \brief reads all the properties from the XML document and recreates them in node
     */
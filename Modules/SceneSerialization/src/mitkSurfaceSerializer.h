@@ -32,6 +32,8 @@ namespace mitk
 
       virtual std::string Serialize() override;
 
+    virtual bool IsThreadSafe() const override { return true; }
+
   protected:
     SurfaceSerializer();
     virtual ~SurfaceSerializer();
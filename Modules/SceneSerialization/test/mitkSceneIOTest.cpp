@@ -20,12 +20,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkSceneIO.h"
 
 #include "Poco/File.h"
+#include "Poco/Path.h"
 #include "Poco/TemporaryFile.h"
 #include "mitkBaseData.h"
 #include "mitkCoreObjectFactory.h"
 #include "mitkGeometryData.h"
 #include "mitkIOUtil.h"
 #include "mitkImage.h"
+#include "mitkNodePredicateDataType.h"
 #include "mitkPointSet.h"
 #include "mitkStandaloneDataStorage.h"
 #include "mitkStandardFileLocations.h"
@@ -365,6 +367,40 @@ int mitkSceneIOTest(int, char *argv[])
 
     // check if data storage content has been restored correctly
     SceneIOTestClass::VerifyStorage(storage);
+
+    // save the scene again without compression and load it once more
+    sceneIO = mitk::SceneIO::New();
+    sceneIO->StoreWithoutCompressionOn();
+    MITK_TEST_CONDITION_REQUIRED(sceneIO->SaveScene(storage->GetAll(), storage, sceneFileName),
+                                 "Saving scene file '" << sceneFileName << "' without compression");
+    MITK_TEST_CONDITION_REQUIRED(sceneIO->GetFailedNodes()->empty(), "Checking if all nodes have been stored.")
+
+    sceneIO = mitk::SceneIO::New();
+    storage = sceneIO->LoadScene(sceneFileName, storage, true);
+    SceneIOTestClass::VerifyStorage(storage);
+
+    // load the scene with the data read on first access
+    sceneIO = mitk::SceneIO::New();
+    sceneIO->LoadDataOnDemandOn();
+    storage = sceneIO->LoadScene(sceneFileName, storage, true);
+    mitk::DataStorage::SetOfObjects::ConstPointer nodes = storage->GetAll();
+    unsigned int nodesWithDataLoader(0);
+    for (auto node : *nodes)
+    {
+      nodesWithDataLoader += node->HasDataLoader() ? 1 : 0;
+    }
+    MITK_TEST_CONDITION_REQUIRED(nodesWithDataLoader > 0, "Checking if data is not read while loading the scene");
+    mitk::NodePredicateDataType::Pointer isImage = mitk::NodePredicateDataType::New("Image");
+    MITK_TEST_CONDITION_REQUIRED(storage->GetSubset(isImage)->Size() == 2,
+                                 "Checking if the data type is known before the data is read");
+    unsigned int nodesWithDataLoaderAfterQuery(0);
+    for (auto node : *nodes)
+    {
+      nodesWithDataLoaderAfterQuery += node->HasDataLoader() ? 1 : 0;
+    }
+    MITK_TEST_CONDITION_REQUIRED(nodesWithDataLoaderAfterQuery == nodesWithDataLoader,
+                                 "Checking if data type queries do not read the data");
+    SceneIOTestClass::VerifyStorage(storage);
   }
   // if no sub-test failed remove the scene file, otherwise it is kept for debugging purposes
   if (mitk::TestManager::GetInstance()->NumberOfFailedTests() == 0)
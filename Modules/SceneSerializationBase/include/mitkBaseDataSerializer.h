@@ -57,6 +57,14 @@ namespace mitk
       */
     virtual std::string Serialize();
 
+    /**
+      \brief Whether Serialize() may run concurrently with other serializers.
+
+      SceneIO runs serializers on several threads only if they return true here.
+      Default is false, sub-classes that are known to be thread-safe should overwrite this.
+      */
+    virtual bool IsThreadSafe() const;
+
   protected:
     BaseDataSerializer();
     virtual ~BaseDataSerializer();
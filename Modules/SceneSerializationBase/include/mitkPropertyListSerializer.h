@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObjectFactoryBase.h>
 
+#include <ostream>
+
+class TiXmlDocument;
 class TiXmlElement;
 
 namespace mitk
@@ -51,12 +54,24 @@ namespace mitk
       */
     virtual std::string Serialize();
 
+    /**
+      \brief Serializes given PropertyList object into a stream instead of a file in the working directory.
+      \return the filename under which the stream contents have to be stored, empty on failure.
+      */
+    std::string SerializeToStream(std::ostream &stream);
+
     PropertyList *GetFailedProperties();
 
   protected:
     PropertyListSerializer();
     virtual ~PropertyListSerializer();
 
+    /** \return a new filename, unique within this process */
+    std::string GetUniqueFilename();
+
+    /** \brief Fills the XML document with the properties of the list, returns false if the list is empty */
+    bool SerializeToDocument(TiXmlDocument &document);
+
     TiXmlElement *SerializeOneProperty(const std::string &key, const BaseProperty *property);
 
     std::string m_FilenameHint;
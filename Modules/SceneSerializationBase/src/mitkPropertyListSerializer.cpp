@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkStandardFileLocations.h"
 #include <itksys/SystemTools.hxx>
 
+#include <atomic>
+
 mitk::PropertyListSerializer::PropertyListSerializer() : m_FilenameHint("unnamed"), m_WorkingDirectory("")
 {
 }
@@ -30,18 +32,10 @@ mitk::PropertyListSerializer::~PropertyListSerializer()
 {
 }
 
-std::string mitk::PropertyListSerializer::Serialize()
+std::string mitk::PropertyListSerializer::GetUniqueFilename()
 {
-  m_FailedProperties = PropertyList::New();
-
-  if (m_PropertyList.IsNull() || m_PropertyList->IsEmpty())
-  {
-    MITK_ERROR << "Not serializing NULL or empty PropertyList";
-    return "";
-  }
-
-  // tmpname
-  static unsigned long count = 1;
+  // tmpname, the counter is shared by all threads serializing a scene
+  static std::atomic<unsigned long> count(1);
   unsigned long n = count++;
   std::ostringstream name;
   for (int i = 0; i < 6; ++i)
@@ -51,19 +45,19 @@ std::string mitk::PropertyListSerializer::Serialize()
   }
   std::string filename;
   filename.append(name.str());
+  return filename;
+}
 
-  std::string fullname(m_WorkingDirectory);
-  fullname += "/";
-  fullname += filename;
-  fullname = itksys::SystemTools::ConvertToOutputPath(fullname.c_str());
-
-  // Trim quotes
-  std::string::size_type length = fullname.length();
+bool mitk::PropertyListSerializer::SerializeToDocument(TiXmlDocument &document)
+{
+  m_FailedProperties = PropertyList::New();
 
-  if (length >= 2 && fullname[0] == '"' && fullname[length - 1] == '"')
-    fullname = fullname.substr(1, length - 2);
+  if (m_PropertyList.IsNull() || m_PropertyList->IsEmpty())
+  {
+    MITK_ERROR << "Not serializing NULL or empty PropertyList";
+    return false;
+  }
 
-  TiXmlDocument document;
   auto decl = new TiXmlDeclaration("1.0", "", ""); // TODO what to write here? encoding? etc....
   document.LinkEndChild(decl);
 
@@ -90,6 +84,29 @@ std::string mitk::PropertyListSerializer::Serialize()
       m_FailedProperties->ReplaceProperty(key, const_cast<BaseProperty *>(property));
     }
   }
+  return true;
+}
+
+std::string mitk::PropertyListSerializer::Serialize()
+{
+  TiXmlDocument document;
+  if (!this->SerializeToDocument(document))
+  {
+    return "";
+  }
+
+  std::string filename = this->GetUniqueFilename();
+
+  std::string fullname(m_WorkingDirectory);
+  fullname += "/";
+  fullname += filename;
+  fullname = itksys::SystemTools::ConvertToOutputPath(fullname.c_str());
+
+  // Trim quotes
+  std::string::size_type length = fullname.length();
+
+  if (length >= 2 && fullname[0] == '"' && fullname[length - 1] == '"')
+    fullname = fullname.substr(1, length - 2);
 
   // save XML file
   if (!document.SaveFile(fullname))
@@ -102,6 +119,26 @@ std::string mitk::PropertyListSerializer::Serialize()
   return filename;
 }
 
+std::string mitk::PropertyListSerializer::SerializeToStream(std::ostream &stream)
+{
+  TiXmlDocument document;
+  if (!this->SerializeToDocument(document))
+  {
+    return "";
+  }
+
+  TiXmlPrinter printer;
+  document.Accept(&printer);
+  stream << printer.CStr();
+  if (!stream.good())
+  {
+    MITK_ERROR << "Could not write PropertyList to stream";
+    return "";
+  }
+
+  return this->GetUniqueFilename();
+}
+
 TiXmlElement *mitk::PropertyListSerializer::SerializeOneProperty(const std::string &key, const BaseProperty *property)
 {
   auto keyelement = new TiXmlElement("property");
@@ -90,6 +90,19 @@ mitk::Image::Pointer mitk::DiffSliceOperation::GetSlice()
   return image;
 }
 
+std::size_t mitk::DiffSliceOperation::GetMemoryUsage() const
+{
+  return m_zlibSliceContainer.IsNotNull() ? m_zlibSliceContainer->GetMemoryUsage() : 0;
+}
+
+void mitk::DiffSliceOperation::MoveDataToDisk()
+{
+  if (m_zlibSliceContainer.IsNotNull())
+  {
+    m_zlibSliceContainer->MoveDataToDisk();
+  }
+}
+
 bool mitk::DiffSliceOperation::IsValid()
 {
   return m_ImageIsValid && m_zlibSliceContainer.IsNotNull() && (m_WorldGeometry.IsNotNull()); // TODO improve
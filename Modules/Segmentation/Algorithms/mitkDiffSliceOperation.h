@@ -85,6 +85,11 @@ namespace mitk
     void SetCurrentWorldGeometry(BaseGeometry *worldGeometry) { this->m_WorldGeometry = worldGeometry; }
     /** \brief Get the axis where the slice has to be applied in the volume.*/
     BaseGeometry *GetWorldGeometry() { return this->m_WorldGeometry; }
+    /** \brief Get the number of bytes of the compressed slice held in memory.*/
+    virtual std::size_t GetMemoryUsage() const override;
+    /** \brief Move the compressed slice to a temporary file.*/
+    virtual void MoveDataToDisk() override;
+
   protected:
     virtual ~DiffSliceOperation();
 
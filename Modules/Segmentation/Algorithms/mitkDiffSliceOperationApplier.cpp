@@ -68,7 +68,7 @@ void mitk::DiffSliceOperationApplier::ExecuteOperation(Operation *operation)
 
     // make sure the modification is rendered
     RenderingManager::GetInstance()->RequestUpdateAll();
-    imageOperation->GetImage()->Modified();
+    imageOperation->GetImage()->TimeStepModified(imageOperation->GetTimeStep());
 
     mitk::ExtractSliceFilter::Pointer extractor2 = mitk::ExtractSliceFilter::New();
     extractor2->SetInput(imageOperation->GetImage());
@@ -383,6 +383,11 @@ void mitk::SegTool2D::WriteSliceToVolume(mitk::SegTool2D::SliceInformation slice
                            sliceInfo.plane);
   /*============= END undo/redo feature block ========================*/
 
+  // label statistics can be updated from the slice difference if they match the image before writing
+  LabelSetImage *labelSetImage = dynamic_cast<LabelSetImage *>(image);
+  const bool updateLabelStatistics =
+    labelSetImage != nullptr && labelSetImage->IsLabelStatisticsUpToDate(labelSetImage->GetActiveLayer());
+
   // Make sure that for reslicing and overwriting the same alogrithm is used. We can specify the mode of the vtk
   // reslicer
   vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
@@ -405,9 +410,14 @@ void mitk::SegTool2D::WriteSliceToVolume(mitk::SegTool2D::SliceInformation slice
   extractor->Update();
 
   // the image was modified within the pipeline, but not marked so
-  image->Modified();
+  image->TimeStepModified(sliceInfo.timestep);
   image->GetVtkImageData()->Modified();
 
+  if (updateLabelStatistics)
+  {
+    labelSetImage->UpdateLabelStatistics(originalSlice, sliceInfo.slice, sliceInfo.timestep);
+  }
+
   /*============= BEGIN undo/redo feature block ========================*/
   // specify the undo operation with the edited slice
   DiffSliceOperation *doOperation =
@@ -633,6 +633,13 @@ void QmitkSlicesInterpolator::OnSurfaceInterpolationFinished()
   {
     slicer->GetRenderer()->RequestUpdate();
   }
+
+  // A request may have arrived after the watcher had stopped waiting
+  if (m_SurfaceInterpolator->IsInterpolationRunning() && !m_Watcher.isRunning())
+  {
+    m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
+    m_Watcher.setFuture(m_Future);
+  }
 }
 
 void QmitkSlicesInterpolator::OnAcceptInterpolationClicked()
@@ -1066,7 +1073,19 @@ void QmitkSlicesInterpolator::OnInterpolationActivated(bool on)
 
 void QmitkSlicesInterpolator::Run3DInterpolation()
 {
-  m_SurfaceInterpolator->Interpolate();
+  // The interpolation itself runs in the controller, which coalesces all requests made meanwhile
+  m_SurfaceInterpolator->WaitForInterpolation();
+}
+
+void QmitkSlicesInterpolator::Start3DInterpolation()
+{
+  m_SurfaceInterpolator->InterpolateAsync();
+
+  if (!m_Watcher.isRunning())
+  {
+    m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
+    m_Watcher.setFuture(m_Future);
+  }
 }
 
 void QmitkSlicesInterpolator::StartUpdateInterpolationTimer()
@@ -1143,13 +1162,9 @@ void QmitkSlicesInterpolator::On3DInterpolationActivated(bool on)
             ret = msgBox.exec();
           }
 
-          if (m_Watcher.isRunning())
-            m_Watcher.waitForFinished();
-
           if (ret == QMessageBox::Yes)
           {
-            m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
-            m_Watcher.setFuture(m_Future);
+            this->Start3DInterpolation();
           }
           else
           {
@@ -1212,10 +1227,7 @@ void QmitkSlicesInterpolator::OnSurfaceInterpolationInfoChanged(const itk::Event
 {
   if (m_3DInterpolationEnabled)
   {
-    if (m_Watcher.isRunning())
-      m_Watcher.waitForFinished();
-    m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
-    m_Watcher.setFuture(m_Future);
+    this->Start3DInterpolation();
   }
 }
 
@@ -1272,10 +1284,7 @@ void QmitkSlicesInterpolator::SetCurrentContourListID()
 
         if (m_3DInterpolationEnabled)
         {
-          if (m_Watcher.isRunning())
-            m_Watcher.waitForFinished();
-          m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
-          m_Watcher.setFuture(m_Future);
+          this->Start3DInterpolation();
         }
       }
     }
@@ -1330,6 +1339,9 @@ void QmitkSlicesInterpolator::OnSliceNavigationControllerDeleted(const itk::Obje
 
 void QmitkSlicesInterpolator::WaitForFutures()
 {
+  // The result is not needed anymore
+  m_SurfaceInterpolator->CancelInterpolation();
+
   if (m_Watcher.isRunning())
   {
     m_Watcher.waitForFinished();
@@ -240,6 +240,11 @@ private:
   void Show3DInterpolationControls(bool show);
   void CheckSupportedImageDimension();
   void WaitForFutures();
+
+  /**
+    Requests the 3D interpolation in the background and watches it, without waiting for a running one.
+  */
+  void Start3DInterpolation();
   void NodeRemoved(const mitk::DataNode* node);
 
   mitk::SegmentationInterpolationController::Pointer m_Interpolator;
@@ -18,17 +18,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkCreateDistanceImageFromSurfaceFilter.h>
 #include <mitkIOUtil.h>
 #include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
 
 #include <vtkDebugLeaks.h>
 
+#include <limits>
+
 class mitkCreateDistanceImageFromSurfaceFilterTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkCreateDistanceImageFromSurfaceFilterTestSuite);
   vtkDebugLeaks::SetExitError(0);
   MITK_TEST(TestCreateDistanceImageForLiver);
   MITK_TEST(TestCreateDistanceImageForTube);
+  MITK_TEST(TestPartitionOfUnityForLiver);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -69,6 +73,9 @@ public:
     AccessFixedDimensionByItk_1(segmentationImage, GetImageBase, 3, itkImage);
     m_InterpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
 
+    // the reference images have been created with the global interpolant
+    m_InterpolateSurfaceFilter->SetMaximumNumberOfCentersForGlobalInterpolation(std::numeric_limits<unsigned int>::max());
+
     for (unsigned int j = 0; j < contourList.size(); j++)
     {
       m_NormalsFilter->SetInput(j, contourList.at(j));
@@ -114,6 +121,9 @@ public:
     AccessFixedDimensionByItk_1(segmentationImage, GetImageBase, 3, itkImage);
     m_InterpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
 
+    // the reference images have been created with the global interpolant
+    m_InterpolateSurfaceFilter->SetMaximumNumberOfCentersForGlobalInterpolation(std::numeric_limits<unsigned int>::max());
+
     for (unsigned int j = 0; j < contourList.size(); j++)
     {
       m_NormalsFilter->SetInput(j, contourList.at(j));
@@ -131,6 +141,72 @@ public:
     CPPUNIT_ASSERT_MESSAGE("HolesDistanceImages are not equal!",
                            mitk::Equal(*(holesDistanceImageReference), *(holeDistanceImage), 0.0001, true));
   }
+
+  // The partition of unity must give nearly the same surface as the global interpolant
+  void TestPartitionOfUnityForLiver()
+  {
+    unsigned int NUMBER_OF_LIVER_CONTOURS = 18;
+
+    for (unsigned int i = 0; i <= NUMBER_OF_LIVER_CONTOURS; ++i)
+    {
+      std::stringstream s;
+      s << "SurfaceInterpolation/InterpolateLiver/LiverContourWithNormals_";
+      s << i;
+      s << ".vtk";
+      mitk::Surface::Pointer contour = mitk::IOUtil::LoadSurface(GetTestDataFilePath(s.str()));
+      contourList.push_back(contour);
+    }
+
+    mitk::Image::Pointer segmentationImage =
+      mitk::IOUtil::LoadImage(GetTestDataFilePath("SurfaceInterpolation/Reference/LiverSegmentation.nrrd"));
+
+    mitk::ComputeContourSetNormalsFilter::Pointer m_NormalsFilter = mitk::ComputeContourSetNormalsFilter::New();
+    mitk::CreateDistanceImageFromSurfaceFilter::Pointer m_InterpolateSurfaceFilter =
+      mitk::CreateDistanceImageFromSurfaceFilter::New();
+
+    itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+    AccessFixedDimensionByItk_1(segmentationImage, GetImageBase, 3, itkImage);
+    m_InterpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
+
+    // always use the partition of unity
+    m_InterpolateSurfaceFilter->SetMaximumNumberOfCentersForGlobalInterpolation(0);
+
+    for (unsigned int j = 0; j < contourList.size(); j++)
+    {
+      m_NormalsFilter->SetInput(j, contourList.at(j));
+      m_InterpolateSurfaceFilter->SetInput(j, m_NormalsFilter->GetOutput(j));
+    }
+
+    m_InterpolateSurfaceFilter->Update();
+
+    mitk::Image::Pointer liverDistanceImage = m_InterpolateSurfaceFilter->GetOutput();
+    CPPUNIT_ASSERT(liverDistanceImage.IsNotNull());
+
+    mitk::Image::Pointer liverDistanceImageReference =
+      mitk::IOUtil::LoadImage(GetTestDataFilePath("SurfaceInterpolation/Reference/LiverDistanceImage.nrrd"));
+
+    typedef mitk::CreateDistanceImageFromSurfaceFilter::DistanceImageType DistanceImageType;
+    DistanceImageType::Pointer result;
+    DistanceImageType::Pointer reference;
+    mitk::CastToItkImage(liverDistanceImage, result);
+    mitk::CastToItkImage(liverDistanceImageReference, reference);
+
+    CPPUNIT_ASSERT_MESSAGE("Distance images have different sizes!",
+                           result->GetLargestPossibleRegion().GetNumberOfPixels() ==
+                             reference->GetLargestPossibleRegion().GetNumberOfPixels());
+
+    // inside and outside must agree for nearly all pixels
+    const std::size_t numberOfPixels = reference->GetLargestPossibleRegion().GetNumberOfPixels();
+    std::size_t numberOfDifferentSigns = 0;
+    for (std::size_t i = 0; i < numberOfPixels; ++i)
+    {
+      if ((result->GetBufferPointer()[i] < 0) != (reference->GetBufferPointer()[i] < 0))
+        ++numberOfDifferentSigns;
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Partition of unity differs from the global interpolant!",
+                           numberOfDifferentSigns <= numberOfPixels / 100);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkCreateDistanceImageFromSurfaceFilter)
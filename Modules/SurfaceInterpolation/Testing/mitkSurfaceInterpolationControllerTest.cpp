@@ -45,6 +45,7 @@ class mitkSurfaceInterpolationControllerTestSuite : public mitk::TestFixture
 
   MITK_TEST(TestAddNewContour);
   MITK_TEST(TestRemoveContour);
+  MITK_TEST(TestInterpolateAsync);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -516,6 +517,81 @@ public:
         mitk::Equal(*(surf_1->GetVtkPolyData()), *(remainingContour->GetVtkPolyData()), 0.000001, true) && success);
   }
 
+  void TestInterpolateAsync()
+  {
+    // Create segmentation image containing a cylinder
+    unsigned int dimensions[] = {40, 40, 40};
+    mitk::Image::Pointer segmentation = createImage(dimensions);
+    {
+      mitk::ImagePixelWriteAccessor<unsigned char, 3> writeAccessor(segmentation);
+      itk::Index<3> index;
+      for (index[2] = 0; index[2] < 40; ++index[2])
+      {
+        for (index[1] = 0; index[1] < 40; ++index[1])
+        {
+          for (index[0] = 0; index[0] < 40; ++index[0])
+          {
+            const double dx = index[0] - 20.0;
+            const double dy = index[1] - 20.0;
+            const bool inside = dx * dx + dy * dy < 64 && index[2] >= 10 && index[2] <= 30;
+            writeAccessor.SetPixelByIndex(index, inside ? 1 : 0);
+          }
+        }
+      }
+    }
+    m_Controller->SetCurrentInterpolationSession(segmentation);
+    m_Controller->SetMinSpacing(1);
+    m_Controller->SetMaxSpacing(1);
+
+    // Create three parallel contours of the cylinder
+    std::vector<mitk::Surface::Pointer> contours;
+    for (double z = 10; z <= 30; z += 10)
+    {
+      double center[3] = {20, 20, z};
+      double normal[3] = {0, 0, 1};
+      vtkSmartPointer<vtkRegularPolygonSource> p_source = vtkSmartPointer<vtkRegularPolygonSource>::New();
+      p_source->SetNumberOfSides(40);
+      p_source->SetCenter(center);
+      p_source->SetRadius(8);
+      p_source->SetNormal(normal);
+      p_source->Update();
+      mitk::Surface::Pointer surf = mitk::Surface::New();
+      surf->SetVtkPolyData(p_source->GetOutput());
+      contours.push_back(surf);
+    }
+    m_Controller->AddNewContours(contours);
+
+    m_Controller->Interpolate();
+    mitk::Surface::Pointer synchronousResult = m_Controller->GetInterpolationResult();
+    CPPUNIT_ASSERT_MESSAGE("Synchronous interpolation failed!",
+                           synchronousResult.IsNotNull() &&
+                             synchronousResult->GetVtkPolyData()->GetNumberOfPoints() > 0);
+
+    // Requests in a row are coalesced, the result equals the synchronous one
+    m_Controller->InterpolateAsync();
+    m_Controller->InterpolateAsync();
+    m_Controller->InterpolateAsync();
+    m_Controller->WaitForInterpolation();
+    CPPUNIT_ASSERT_MESSAGE("Interpolation still running after waiting for it!",
+                           !m_Controller->IsInterpolationRunning());
+
+    mitk::Surface::Pointer asynchronousResult = m_Controller->GetInterpolationResult();
+    CPPUNIT_ASSERT_MESSAGE("Asynchronous interpolation failed!",
+                           asynchronousResult.IsNotNull() && asynchronousResult != synchronousResult);
+    CPPUNIT_ASSERT_MESSAGE(
+      "Asynchronous interpolation differs from synchronous one!",
+      mitk::Equal(*(synchronousResult->GetVtkPolyData()), *(asynchronousResult->GetVtkPolyData()), 0.000001, true));
+
+    // A cancelled request is never published
+    m_Controller->InterpolateAsync();
+    m_Controller->CancelInterpolation();
+    m_Controller->WaitForInterpolation();
+    CPPUNIT_ASSERT_MESSAGE("Result of a cancelled interpolation was published!",
+                           m_Controller->GetInterpolationResult() == asynchronousResult);
+
+    m_Controller->RemoveInterpolationSession(segmentation);
+  }
+
   bool AssertImagesEqual4D(mitk::Image *img1, mitk::Image *img2)
   {
     mitk::ImageTimeSelector::Pointer selector1 = mitk::ImageTimeSelector::New();
@@ -0,0 +1,273 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// CTK includes
+#include "mitkCommandLineParser.h"
+
+// MITK includes
+#include <mitkCreateDistanceImageFromSurfaceFilter.h>
+#include <mitkImageCast.h>
+
+// ITK includes
+#include <itkMath.h>
+#include <itkTimeProbe.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolygon.h>
+
+typedef mitk::CreateDistanceImageFromSurfaceFilter::DistanceImageType DistanceImageType;
+
+/** \brief Axial contours of an ellipsoid with the half axes (a, a, c), with the normals the filter expects.
+ *
+ * Like mitk::ComputeContourSetNormalsFilter, the normals are stored per point in the cell data.
+ */
+std::vector<mitk::Surface::Pointer> CreateEllipsoidContours(unsigned int numberOfContours,
+                                                            unsigned int pointsPerContour,
+                                                            double a,
+                                                            double c)
+{
+  std::vector<mitk::Surface::Pointer> contours;
+
+  for (unsigned int i = 0; i < numberOfContours; ++i)
+  {
+    // the contours are evenly spread and never reach the poles
+    const double z = c * (2.0 * (i + 1) / (numberOfContours + 1) - 1);
+    const double radius = a * std::sqrt(1 - (z * z) / (c * c));
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkDoubleArray> normals = vtkSmartPointer<vtkDoubleArray>::New();
+    normals->SetNumberOfComponents(3);
+    vtkSmartPointer<vtkPolygon> polygon = vtkSmartPointer<vtkPolygon>::New();
+
+    for (unsigned int j = 0; j < pointsPerContour; ++j)
+    {
+      const double angle = 2 * itk::Math::pi * j / pointsPerContour;
+      const double p[3] = {radius * std::cos(angle), radius * std::sin(angle), z};
+
+      // gradient of the implicit ellipsoid function
+      double n[3] = {p[0] / (a * a), p[1] / (a * a), p[2] / (c * c)};
+      const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      for (double &component : n)
+        component /= length;
+
+      polygon->GetPointIds()->InsertNextId(points->InsertNextPoint(p));
+      normals->InsertNextTuple(n);
+    }
+
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->InsertNextCell(polygon);
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(polys);
+    polyData->GetCellData()->SetNormals(normals);
+
+    mitk::Surface::Pointer contour = mitk::Surface::New();
+    contour->SetVtkPolyData(polyData);
+    contours.push_back(contour);
+  }
+
+  return contours;
+}
+
+/** \brief Interpolates the contours and returns the distance image, the runtime is returned in seconds. */
+mitk::Image::Pointer Interpolate(const std::vector<mitk::Surface::Pointer> &contours,
+                                 itk::ImageBase<3> *referenceImage,
+                                 unsigned int maximumNumberOfCentersForGlobalInterpolation,
+                                 double &seconds)
+{
+  mitk::CreateDistanceImageFromSurfaceFilter::Pointer filter = mitk::CreateDistanceImageFromSurfaceFilter::New();
+  filter->SetReferenceImage(referenceImage);
+  filter->SetMaximumNumberOfCentersForGlobalInterpolation(maximumNumberOfCentersForGlobalInterpolation);
+  for (unsigned int i = 0; i < contours.size(); ++i)
+  {
+    filter->SetInput(i, contours[i]);
+  }
+
+  itk::TimeProbe clock;
+  clock.Start();
+  filter->Update();
+  clock.Stop();
+  seconds = clock.GetTotal();
+
+  return filter->GetOutput();
+}
+
+/** \brief Measures the runtime of mitk::CreateDistanceImageFromSurfaceFilter over the number of contours.
+ *
+ * Synthetic axial contours of an ellipsoid are interpolated with the default settings. As long as the number of
+ * interpolation centers does not exceed the given limit, the contours are additionally interpolated with one global
+ * interpolant and the results are compared: the fraction of pixels whose sign (inside/outside) differs and the
+ * maximum difference of the distance values where both narrow bands overlap.
+ */
+int main(int argc, char *argv[])
+{
+  mitkCommandLineParser parser;
+
+  parser.setCategory("Segmentation");
+  parser.setTitle("Surface Interpolation Benchmark");
+  parser.setDescription("Measures the runtime of the 3D surface interpolation over the number of contours.");
+  parser.setContributor("MBI");
+
+  parser.setArgumentPrefix("--", "-");
+  parser.beginGroup("Optional parameters");
+  parser.addArgument(
+    "contours", "c", mitkCommandLineParser::String, "Contours", "comma separated contour counts (default 5,10,20,40,80)");
+  parser.addArgument(
+    "points", "p", mitkCommandLineParser::Int, "Points", "number of points per contour (default 40)");
+  parser.addArgument("global",
+                     "g",
+                     mitkCommandLineParser::Int,
+                     "Global limit",
+                     "maximum number of centers that are also interpolated globally for comparison (default 6000)");
+  parser.endGroup();
+
+  std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+
+  std::string contourCountsString = "5,10,20,40,80";
+  if (parsedArgs.count("contours"))
+  {
+    contourCountsString = us::any_cast<std::string>(parsedArgs["contours"]);
+  }
+
+  int pointsPerContour = 40;
+  if (parsedArgs.count("points"))
+  {
+    pointsPerContour = us::any_cast<int>(parsedArgs["points"]);
+  }
+
+  int globalLimit = 6000;
+  if (parsedArgs.count("global"))
+  {
+    globalLimit = us::any_cast<int>(parsedArgs["global"]);
+  }
+
+  std::vector<unsigned int> contourCounts;
+  std::stringstream contourCountsStream(contourCountsString);
+  std::string contourCount;
+  while (std::getline(contourCountsStream, contourCount, ','))
+  {
+    const int count = std::atoi(contourCount.c_str());
+    if (count > 0)
+    {
+      contourCounts.push_back(count);
+    }
+  }
+
+  if (contourCounts.empty() || pointsPerContour < 3 || globalLimit < 0)
+  {
+    MITK_ERROR << "Invalid arguments!";
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    // a 1 mm grid around the ellipsoid
+    const double a = 60;
+    const double c = 90;
+
+    itk::ImageBase<3>::Pointer referenceImage = itk::ImageBase<3>::New();
+    itk::ImageBase<3>::PointType origin;
+    origin[0] = origin[1] = -a - 10;
+    origin[2] = -c - 10;
+    itk::ImageBase<3>::SizeType size;
+    size[0] = size[1] = static_cast<itk::SizeValueType>(2 * a + 20);
+    size[2] = static_cast<itk::SizeValueType>(2 * c + 20);
+    itk::ImageBase<3>::SpacingType spacing;
+    spacing.Fill(1.0);
+    itk::ImageBase<3>::RegionType region;
+    region.SetSize(size);
+    referenceImage->SetOrigin(origin);
+    referenceImage->SetSpacing(spacing);
+    referenceImage->SetRegions(region);
+
+    std::cout << "contours, centers, time [s], global time [s], different signs [%], max. difference [mm]"
+              << std::endl;
+
+    for (const auto count : contourCounts)
+    {
+      std::vector<mitk::Surface::Pointer> contours = CreateEllipsoidContours(count, pointsPerContour, a, c);
+      const unsigned int numberOfCenters = 3 * count * pointsPerContour;
+
+      double seconds = 0;
+      mitk::Image::Pointer resultImage = Interpolate(contours, referenceImage, 1500, seconds);
+
+      std::cout << count << ", " << numberOfCenters << ", " << seconds;
+
+      if (numberOfCenters <= static_cast<unsigned int>(globalLimit))
+      {
+        double globalSeconds = 0;
+        mitk::Image::Pointer referenceImageResult =
+          Interpolate(contours, referenceImage, std::numeric_limits<unsigned int>::max(), globalSeconds);
+
+        DistanceImageType::Pointer result;
+        DistanceImageType::Pointer reference;
+        mitk::CastToItkImage(resultImage, result);
+        mitk::CastToItkImage(referenceImageResult, reference);
+
+        // the spacing of the distance image is isotropic, pixels outside the narrow band hold +-10 * spacing
+        const double bandLimit = 5 * reference->GetSpacing()[0];
+        const std::size_t numberOfPixels = reference->GetLargestPossibleRegion().GetNumberOfPixels();
+        std::size_t differentSigns = 0;
+        double maximumDifference = 0;
+        for (std::size_t i = 0; i < numberOfPixels; ++i)
+        {
+          const double value = result->GetBufferPointer()[i];
+          const double referenceValue = reference->GetBufferPointer()[i];
+          if ((value < 0) != (referenceValue < 0))
+            ++differentSigns;
+          if (std::fabs(value) < bandLimit && std::fabs(referenceValue) < bandLimit)
+            maximumDifference = std::max(maximumDifference, std::fabs(value - referenceValue));
+        }
+
+        std::cout << ", " << globalSeconds << ", " << 100.0 * differentSigns / numberOfPixels << ", "
+                  << maximumDifference;
+      }
+      else
+      {
+        std::cout << ", -, -, -";
+      }
+      std::cout << std::endl;
+    }
+  }
+  catch (const itk::ExceptionObject &e)
+  {
+    MITK_ERROR << e.what();
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception &e)
+  {
+    MITK_ERROR << e.what();
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
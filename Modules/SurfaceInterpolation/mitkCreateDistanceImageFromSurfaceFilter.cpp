@@ -24,9 +24,102 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkSmartPointer.h"
 
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkNeighborhoodIterator.h"
 
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+
+namespace
+{
+  typedef mitk::CreateDistanceImageFromSurfaceFilter::PointType PointType;
+  typedef mitk::CreateDistanceImageFromSurfaceFilter::CenterList CenterList;
+
+  // Octree leaves of the partition of unity hold at most this many centers
+  const unsigned int MaximumNumberOfCentersPerLeaf = 32;
+  const unsigned int MaximumOctreeDepth = 16;
+
+  // A local interpolant is based on at least this many centers
+  const unsigned int MinimumNumberOfCentersPerPatch = 64;
+
+  // Radius of a patch relative to the diagonal of its octree leaf, see Ohtake et al., "Multi-level partition of
+  // unity implicits", SIGGRAPH 2003
+  const double PatchRadiusFactor = 0.75;
+
+  // The uniform grid for the patch lookup has at most this many cells per dimension
+  const int MaximumPatchGridSize = 64;
+
+  struct OctreeLeaf
+  {
+    PointType center;
+    double halfSize;
+    std::vector<unsigned int> centerIds;
+  };
+
+  void SubdivideOctreeCell(const CenterList &centers,
+                           const PointType &cellCenter,
+                           double halfSize,
+                           std::vector<unsigned int> &centerIds,
+                           unsigned int depth,
+                           std::vector<OctreeLeaf> &leaves)
+  {
+    if (centerIds.empty())
+      return;
+
+    if (centerIds.size() <= MaximumNumberOfCentersPerLeaf || depth == MaximumOctreeDepth)
+    {
+      OctreeLeaf leaf;
+      leaf.center = cellCenter;
+      leaf.halfSize = halfSize;
+      leaf.centerIds.swap(centerIds);
+      leaves.push_back(leaf);
+      return;
+    }
+
+    std::vector<unsigned int> childIds[8];
+    for (const auto id : centerIds)
+    {
+      const PointType &center = centers[id];
+      const unsigned int child =
+        (center[0] >= cellCenter[0] ? 1 : 0) | (center[1] >= cellCenter[1] ? 2 : 0) | (center[2] >= cellCenter[2] ? 4 : 0);
+      childIds[child].push_back(id);
+    }
+    centerIds.clear();
+    centerIds.shrink_to_fit();
+
+    const double childHalfSize = halfSize / 2;
+    for (unsigned int child = 0; child < 8; ++child)
+    {
+      PointType childCenter = cellCenter;
+      for (unsigned int dim = 0; dim < 3; ++dim)
+      {
+        childCenter[dim] += (child & (1 << dim)) ? childHalfSize : -childHalfSize;
+      }
+      SubdivideOctreeCell(centers, childCenter, childHalfSize, childIds[child], depth + 1, leaves);
+    }
+  }
+
+  // Squared distance of a point to an axis aligned cube
+  double SquaredDistanceToCube(const PointType &p, const PointType &cubeCenter, double halfSize)
+  {
+    double squaredDistance = 0;
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      const double d = std::max(0.0, std::fabs(p[dim] - cubeCenter[dim]) - halfSize);
+      squaredDistance += d * d;
+    }
+    return squaredDistance;
+  }
+
+  // Wendland's compactly supported C2 function, r relative to the support radius
+  double WendlandWeight(double r)
+  {
+    if (r >= 1)
+      return 0;
+    const double s = 1 - r;
+    return s * s * s * s * (4 * r + 1);
+  }
+}
 
 void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 {
@@ -111,6 +204,9 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 mitk::CreateDistanceImageFromSurfaceFilter::CreateDistanceImageFromSurfaceFilter()
 {
   m_DistanceImageVolume = 50000;
+  m_MaximumNumberOfCentersForGlobalInterpolation = 1500;
+  m_PatchGridSpacing = 1;
+  std::fill(m_PatchGridSize, m_PatchGridSize + 3, 0);
   this->m_UseProgressBar = false;
   this->m_ProgressStepSize = 5;
 
@@ -133,11 +229,14 @@ void mitk::CreateDistanceImageFromSurfaceFilter::GenerateData()
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(1);
 
-  m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  this->CheckAbortGenerateData();
+  this->SolveInterpolation();
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(2);
 
+  this->CheckAbortGenerateData();
+
   // The last step is to create the distance map with the interpolated distance function
   this->FillDistanceImage();
 
@@ -146,6 +245,20 @@ void mitk::CreateDistanceImageFromSurfaceFilter::GenerateData()
 
   m_Centers.clear();
   m_Normals.clear();
+  m_Patches.clear();
+  m_PatchGrid.clear();
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::CheckAbortGenerateData()
+{
+  if (this->GetAbortGenerateData())
+  {
+    m_Centers.clear();
+    m_Normals.clear();
+    m_Patches.clear();
+    m_PatchGrid.clear();
+    throw itk::ProcessAborted(__FILE__, __LINE__);
+  }
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
@@ -172,6 +285,9 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
   PointType currentPoint;
   PointType normal;
 
+  // used for the detection of duplicated points, a linear search in m_Centers would be quadratic
+  std::set<std::array<double, 3>> existingCenters;
+
   for (unsigned int i = 0; i < numberOfInputs; i++)
   {
     currentSurface = const_cast<Surface *>(this->GetInput(i));
@@ -203,9 +319,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
 
         currentPoint.copy_in(p);
 
-        int count = std::count(m_Centers.begin(), m_Centers.end(), currentPoint);
-
-        if (count == 0)
+        if (existingCenters.insert({{p[0], p[1], p[2]}}).second)
         {
           double currentNormal[3];
           currentCellNormals->GetTuple(cell[j], currentNormal);
@@ -265,9 +379,17 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateSolutionMatrixAndFunction
     m_FunctionValues[numberOfCenters * 2 + i] = m_DistanceImageSpacing;
   }
 
-  // Now we have created all centers and all function values. Next step is to create the solution matrix
+  // Now we have created all centers and all function values. Next step is to create the solution matrix, which is
+  // only needed for the global interpolant. The local interpolants create their own ones.
   numberOfCenters = m_Centers.size();
 
+  if (numberOfCenters > m_MaximumNumberOfCentersForGlobalInterpolation)
+  {
+    m_SolutionMatrix.resize(0, 0);
+    m_Weights.resize(0);
+    return;
+  }
+
   m_SolutionMatrix.resize(numberOfCenters, numberOfCenters);
 
   m_Weights.resize(numberOfCenters);
@@ -290,6 +412,195 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateSolutionMatrixAndFunction
   }
 }
 
+void mitk::CreateDistanceImageFromSurfaceFilter::SolveInterpolation()
+{
+  m_Patches.clear();
+  m_PatchGrid.clear();
+
+  if (m_Centers.size() <= m_MaximumNumberOfCentersForGlobalInterpolation)
+  {
+    m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  }
+  else
+  {
+    this->CreatePartitionOfUnity();
+  }
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::CreatePartitionOfUnity()
+{
+  const unsigned int numberOfCenters = m_Centers.size();
+
+  // The octree starts with the bounding cube of all centers
+  PointType minPoint = m_Centers[0];
+  PointType maxPoint = m_Centers[0];
+  for (const auto &center : m_Centers)
+  {
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      minPoint[dim] = std::min(minPoint[dim], center[dim]);
+      maxPoint[dim] = std::max(maxPoint[dim], center[dim]);
+    }
+  }
+
+  PointType rootCenter = (minPoint + maxPoint) / 2.0;
+  double rootHalfSize = 0;
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    rootHalfSize = std::max(rootHalfSize, (maxPoint[dim] - minPoint[dim]) / 2);
+  }
+  rootHalfSize = std::max(rootHalfSize, m_DistanceImageSpacing) * 1.0001;
+
+  std::vector<unsigned int> centerIds(numberOfCenters);
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+  {
+    centerIds[i] = i;
+  }
+
+  std::vector<OctreeLeaf> leaves;
+  SubdivideOctreeCell(m_Centers, rootCenter, rootHalfSize, centerIds, 0, leaves);
+
+  // The sphere of a patch covers its leaf and reaches beyond the narrow band around the surface in the leaf, so that
+  // every narrow band point is covered by at least one patch
+  const double minimumMargin = 3 * m_DistanceImageSpacing;
+  const double sqrt3 = std::sqrt(3.0);
+
+  m_Patches.resize(leaves.size());
+
+  const int numberOfLeaves = static_cast<int>(leaves.size());
+#pragma omp parallel for schedule(dynamic)
+  for (int l = 0; l < numberOfLeaves; ++l)
+  {
+    const OctreeLeaf &leaf = leaves[l];
+    InterpolationPatch &patch = m_Patches[l];
+
+    patch.center = leaf.center;
+    patch.radius = std::max(PatchRadiusFactor * 2 * sqrt3 * leaf.halfSize, sqrt3 * leaf.halfSize + minimumMargin);
+
+    // gather the centers within the sphere, grow it for sparse regions
+    std::vector<unsigned int> patchCenterIds;
+    for (;;)
+    {
+      patchCenterIds.clear();
+      const double squaredRadius = patch.radius * patch.radius;
+      for (const auto &otherLeaf : leaves)
+      {
+        if (SquaredDistanceToCube(patch.center, otherLeaf.center, otherLeaf.halfSize) > squaredRadius)
+          continue;
+
+        for (const auto id : otherLeaf.centerIds)
+        {
+          if ((m_Centers[id] - patch.center).squared_magnitude() <= squaredRadius)
+            patchCenterIds.push_back(id);
+        }
+      }
+
+      if (patchCenterIds.size() >= std::min(MinimumNumberOfCentersPerPatch, numberOfCenters))
+        break;
+
+      patch.radius *= 1.5;
+    }
+
+    // The local interpolant uses the same basis function as the global one
+    const unsigned int numberOfPatchCenters = patchCenterIds.size();
+    Eigen::MatrixXd solutionMatrix(numberOfPatchCenters, numberOfPatchCenters);
+    Eigen::VectorXd functionValues(numberOfPatchCenters);
+
+    patch.centers.resize(numberOfPatchCenters);
+    for (unsigned int i = 0; i < numberOfPatchCenters; ++i)
+    {
+      patch.centers[i] = m_Centers[patchCenterIds[i]];
+      functionValues[i] = m_FunctionValues[patchCenterIds[i]];
+    }
+
+    for (unsigned int i = 0; i < numberOfPatchCenters; ++i)
+    {
+      solutionMatrix(i, i) = 0;
+      for (unsigned int j = i + 1; j < numberOfPatchCenters; ++j)
+      {
+        solutionMatrix(i, j) = solutionMatrix(j, i) = (patch.centers[i] - patch.centers[j]).two_norm();
+      }
+    }
+
+    patch.weights = solutionMatrix.partialPivLu().solve(functionValues);
+  }
+
+  // Register the patches in a uniform grid over the bounding box of their spheres
+  PointType gridMax;
+  double minimumRadius = m_Patches[0].radius;
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    m_PatchGridOrigin[dim] = m_Patches[0].center[dim] - m_Patches[0].radius;
+    gridMax[dim] = m_Patches[0].center[dim] + m_Patches[0].radius;
+  }
+  for (const auto &patch : m_Patches)
+  {
+    minimumRadius = std::min(minimumRadius, patch.radius);
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      m_PatchGridOrigin[dim] = std::min(m_PatchGridOrigin[dim], patch.center[dim] - patch.radius);
+      gridMax[dim] = std::max(gridMax[dim], patch.center[dim] + patch.radius);
+    }
+  }
+
+  double maximumExtent = 0;
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    maximumExtent = std::max(maximumExtent, gridMax[dim] - m_PatchGridOrigin[dim]);
+  }
+  m_PatchGridSpacing = std::max(minimumRadius, maximumExtent / MaximumPatchGridSize);
+
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    m_PatchGridSize[dim] =
+      std::max(1, static_cast<int>(std::ceil((gridMax[dim] - m_PatchGridOrigin[dim]) / m_PatchGridSpacing)));
+  }
+  m_PatchGrid.assign(m_PatchGridSize[0] * m_PatchGridSize[1] * m_PatchGridSize[2], std::vector<unsigned int>());
+
+  for (unsigned int id = 0; id < m_Patches.size(); ++id)
+  {
+    const InterpolationPatch &patch = m_Patches[id];
+
+    int first[3];
+    int last[3];
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      first[dim] = std::max(
+        0, static_cast<int>(std::floor((patch.center[dim] - patch.radius - m_PatchGridOrigin[dim]) / m_PatchGridSpacing)));
+      last[dim] = std::min(
+        m_PatchGridSize[dim] - 1,
+        static_cast<int>(std::floor((patch.center[dim] + patch.radius - m_PatchGridOrigin[dim]) / m_PatchGridSpacing)));
+    }
+
+    for (int z = first[2]; z <= last[2]; ++z)
+    {
+      for (int y = first[1]; y <= last[1]; ++y)
+      {
+        for (int x = first[0]; x <= last[0]; ++x)
+        {
+          m_PatchGrid[(z * m_PatchGridSize[1] + y) * m_PatchGridSize[0] + x].push_back(id);
+        }
+      }
+    }
+  }
+}
+
+const std::vector<unsigned int> *mitk::CreateDistanceImageFromSurfaceFilter::GetPatchesAt(const PointType &p) const
+{
+  int cell[3];
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    const double position = (p[dim] - m_PatchGridOrigin[dim]) / m_PatchGridSpacing;
+    if (position < 0 || position >= m_PatchGridSize[dim])
+      return nullptr;
+    cell[dim] = static_cast<int>(position);
+  }
+
+  const std::vector<unsigned int> &patches =
+    m_PatchGrid[(cell[2] * m_PatchGridSize[1] + cell[1]) * m_PatchGridSize[0] + cell[0]];
+  return patches.empty() ? nullptr : &patches;
+}
+
 void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
 {
   /*
@@ -304,11 +615,10 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   */
 
   typedef itk::ImageRegionIteratorWithIndex<DistanceImageType> ImageIterator;
-  typedef itk::NeighborhoodIterator<DistanceImageType> NeighborhoodImageIterator;
 
-  std::queue<DistanceImageType::IndexType> narrowbandPoints;
   PointType currentPoint = m_Centers.at(0);
-  double distance = this->CalculateDistanceValue(currentPoint);
+  double distance(0);
+  this->CalculateDistanceValue(currentPoint, distance);
 
   // create itk::Point from vnl_vector
   DistanceImageType::PointType currentPointAsPoint;
@@ -320,49 +630,82 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   DistanceImageType::IndexType currentIndex;
   m_DistanceImageITK->TransformPhysicalPointToIndex(currentPointAsPoint, currentIndex);
 
-  assert(
-    m_DistanceImageITK->GetLargestPossibleRegion().IsInside(currentIndex)); // we are quite certain this should hold
+  const DistanceImageType::RegionType region = m_DistanceImageITK->GetLargestPossibleRegion();
+  assert(region.IsInside(currentIndex)); // we are quite certain this should hold
 
-  narrowbandPoints.push(currentIndex);
   m_DistanceImageITK->SetPixel(currentIndex, distance);
 
-  NeighborhoodImageIterator::RadiusType radius;
-  radius.Fill(1);
-  NeighborhoodImageIterator nIt(radius, m_DistanceImageITK, m_DistanceImageITK->GetLargestPossibleRegion());
-  unsigned int relativeNbIdx[] = {4, 10, 12, 14, 16, 22};
+  // The narrow band grows front by front. The distance values of all candidates of a front are independent of each
+  // other and evaluated in parallel. Every pixel is evaluated at most once.
+  std::vector<char> visited(region.GetNumberOfPixels(), 0);
+  visited[m_DistanceImageITK->ComputeOffset(currentIndex)] = 1;
+
+  std::vector<DistanceImageType::IndexType> narrowbandPoints(1, currentIndex);
+  std::vector<DistanceImageType::IndexType> candidates;
+  std::vector<double> candidateDistances;
+  std::vector<char> candidateInNarrowband;
 
-  bool isInBounds = false;
+  const DistanceImageType::SizeType size = region.GetSize();
   while (!narrowbandPoints.empty())
   {
-    nIt.SetLocation(narrowbandPoints.front());
-    narrowbandPoints.pop();
+    this->CheckAbortGenerateData();
 
-    unsigned int *relativeNb = &relativeNbIdx[0];
-    for (int i = 0; i < 6; i++)
+    candidates.clear();
+    for (const auto &index : narrowbandPoints)
     {
-      nIt.GetPixel(*relativeNb, isInBounds);
-      if (isInBounds && nIt.GetPixel(*relativeNb) == m_DistanceImageDefaultBufferValue)
+      for (unsigned int dim = 0; dim < 3; ++dim)
       {
-        currentIndex = nIt.GetIndex(*relativeNb);
+        for (int step = -1; step <= 1; step += 2)
+        {
+          DistanceImageType::IndexType neighbor = index;
+          neighbor[dim] += step;
+          if (neighbor[dim] < 0 || neighbor[dim] >= static_cast<DistanceImageType::IndexValueType>(size[dim]))
+            continue;
+
+          char &isVisited = visited[m_DistanceImageITK->ComputeOffset(neighbor)];
+          if (!isVisited)
+          {
+            isVisited = 1;
+            candidates.push_back(neighbor);
+          }
+        }
+      }
+    }
 
-        // Transform the currently checked point from index-coordinates to
-        // world-coordinates
-        m_DistanceImageITK->TransformIndexToPhysicalPoint(currentIndex, currentPointAsPoint);
+    const int numberOfCandidates = static_cast<int>(candidates.size());
+    candidateDistances.resize(numberOfCandidates);
+    candidateInNarrowband.assign(numberOfCandidates, 0);
 
-        // create a vnl_vector
-        currentPoint[0] = currentPointAsPoint[0];
-        currentPoint[1] = currentPointAsPoint[1];
-        currentPoint[2] = currentPointAsPoint[2];
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < numberOfCandidates; ++i)
+    {
+      // Transform the currently checked point from index-coordinates to world-coordinates
+      DistanceImageType::PointType candidateAsPoint;
+      m_DistanceImageITK->TransformIndexToPhysicalPoint(candidates[i], candidateAsPoint);
+
+      PointType candidatePoint;
+      candidatePoint[0] = candidateAsPoint[0];
+      candidatePoint[1] = candidateAsPoint[1];
+      candidatePoint[2] = candidateAsPoint[2];
+
+      // and check the distance
+      double candidateDistance(0);
+      if (this->CalculateDistanceValue(candidatePoint, candidateDistance) &&
+          std::fabs(candidateDistance) <= m_DistanceImageSpacing * 2)
+      {
+        candidateDistances[i] = candidateDistance;
+        candidateInNarrowband[i] = 1;
+      }
+    }
 
-        // and check the distance
-        distance = this->CalculateDistanceValue(currentPoint);
-        if (std::fabs(distance) <= m_DistanceImageSpacing * 2)
-        {
-          nIt.SetPixel(*relativeNb, distance);
-          narrowbandPoints.push(currentIndex);
-        }
+    narrowbandPoints.clear();
+    for (int i = 0; i < numberOfCandidates; ++i)
+    {
+      if (candidateInNarrowband[i])
+      {
+        m_DistanceImageITK->SetPixel(candidates[i], candidateDistances[i]);
+        narrowbandPoints.push_back(candidates[i]);
       }
-      relativeNb++;
     }
   }
 
@@ -423,25 +766,49 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   CastToMitkImage(m_DistanceImageITK, resultImage);
 }
 
-double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(PointType p)
+bool mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(const PointType &p,
+                                                                      double &distanceValue) const
 {
-  double distanceValue(0);
-  PointType p1;
-  PointType p2;
-  double norm;
+  if (m_Patches.empty())
+  {
+    distanceValue = 0;
+    for (unsigned int i = 0; i < m_Centers.size(); ++i)
+    {
+      distanceValue += (p - m_Centers[i]).two_norm() * m_Weights[i];
+    }
+    return true;
+  }
 
-  CenterList::iterator centerIter;
+  const std::vector<unsigned int> *patchIds = this->GetPatchesAt(p);
+  if (patchIds == nullptr)
+    return false;
 
-  unsigned int count(0);
-  for (centerIter = m_Centers.begin(); centerIter != m_Centers.end(); centerIter++)
+  // Blend the local interpolants whose sphere contains the point
+  double weightSum(0);
+  double weightedDistanceSum(0);
+  for (const auto id : *patchIds)
   {
-    p1 = *centerIter;
-    p2 = p - p1;
-    norm = p2.two_norm();
-    distanceValue = distanceValue + (norm * m_Weights[count]);
-    ++count;
+    const InterpolationPatch &patch = m_Patches[id];
+
+    const double weight = WendlandWeight((p - patch.center).two_norm() / patch.radius);
+    if (weight <= 0)
+      continue;
+
+    double localDistance(0);
+    for (unsigned int i = 0; i < patch.centers.size(); ++i)
+    {
+      localDistance += (p - patch.centers[i]).two_norm() * patch.weights[i];
+    }
+
+    weightSum += weight;
+    weightedDistanceSum += weight * localDistance;
   }
-  return distanceValue;
+
+  if (weightSum <= 0)
+    return false;
+
+  distanceValue = weightedDistanceSum / weightSum;
+  return true;
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::GenerateOutputInformation()
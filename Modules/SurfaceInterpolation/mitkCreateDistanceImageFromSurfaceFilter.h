@@ -37,6 +37,17 @@ namespace mitk
 
          The interpolation itself is performed via Radial Basis Function Interpolation.
 
+         Small inputs are interpolated by one global interpolant, which requires solving a dense linear system of
+         the size of the number of interpolation centers. Larger inputs (see
+         SetMaximumNumberOfCentersForGlobalInterpolation()) are interpolated by a partition of unity: the
+         bounding box of the centers is subdivided by an octree, for each leaf a small local interpolant is solved
+         for the centers within a sphere around the leaf and the local interpolants are blended with compactly
+         supported weights. Distance values are then only evaluated against the centers of the few local
+         interpolants around a point, which are found via a uniform grid.
+
+         A running update can be aborted from another thread by AbortGenerateDataOn(), Update() then throws an
+         itk::ProcessAborted.
+
          ATTENTION:
          This filter needs beside the edge points of the delineated contours additionally the normals for each
          edge point.
@@ -99,10 +110,18 @@ namespace mitk
     /**
     \brief Set the size of the output distance image. The size is specified by the image's volume
            (i.e. in this case how many pixels are enclosed by the image)
-           If non is set, the volume will be 500000 pixels.
+           If none is set, the volume will be 500000 pixels.
     */
     itkSetMacro(DistanceImageVolume, unsigned int);
 
+    /**
+    \brief Set the maximum number of interpolation centers (three per contour point) that are interpolated by
+           one global interpolant. Inputs with more centers are interpolated by a partition of unity of local
+           interpolants. If none is set, the maximum will be 1500 centers.
+    */
+    itkSetMacro(MaximumNumberOfCentersForGlobalInterpolation, unsigned int);
+    itkGetMacro(MaximumNumberOfCentersForGlobalInterpolation, unsigned int);
+
     void PrintEquationSystem();
 
     // Resets the filter, i.e. removes all inputs and outputs
@@ -131,11 +150,51 @@ namespace mitk
     virtual void GenerateOutputInformation() override;
 
   private:
+    /**
+    * \brief A local interpolant of the partition of unity, valid within a sphere around its center.
+    */
+    struct InterpolationPatch
+    {
+      PointType center;
+      double radius;
+      CenterList centers;
+      Eigen::VectorXd weights;
+    };
+
     void CreateSolutionMatrixAndFunctionValues();
-    double CalculateDistanceValue(PointType p);
+
+    /**
+    * \brief Solves the global interpolant or, for large inputs, creates and solves the local interpolants of the
+    * partition of unity.
+    */
+    void SolveInterpolation();
+
+    /**
+    * \brief Subdivides the centers by an octree and creates one local interpolant for each leaf. The patches are
+    * registered in a uniform grid, see GetPatchesAt().
+    */
+    void CreatePartitionOfUnity();
+
+    /**
+    * \brief The ids of all patches whose sphere may contain the given point, nullptr if there are none.
+    */
+    const std::vector<unsigned int> *GetPatchesAt(const PointType &p) const;
+
+    /**
+    * \brief Evaluates the interpolated distance function at the given point.
+    *
+    * Returns false if the point is not covered by any local interpolant of the partition of unity. The global
+    * interpolant is defined everywhere.
+    */
+    bool CalculateDistanceValue(const PointType &p, double &distanceValue) const;
 
     void FillDistanceImage();
 
+    /**
+    * \brief Throws an itk::ProcessAborted if AbortGenerateDataOn() has been called meanwhile, e.g. by another thread.
+    */
+    void CheckAbortGenerateData();
+
     /**
     * \brief This method fills the given variables with the minimum and
     * maximum coordinates that contain all input-points in index- and
@@ -166,6 +225,14 @@ namespace mitk
     Eigen::VectorXd m_FunctionValues;
     Eigen::VectorXd m_Weights;
 
+    // Partition of unity, empty if the global interpolant is used
+    std::vector<InterpolationPatch> m_Patches;
+    std::vector<std::vector<unsigned int>> m_PatchGrid;
+    PointType m_PatchGridOrigin;
+    double m_PatchGridSpacing;
+    int m_PatchGridSize[3];
+    unsigned int m_MaximumNumberOfCentersForGlobalInterpolation;
+
     DistanceImageType::Pointer m_DistanceImageITK;
     itk::ImageBase<3>::Pointer m_ReferenceImage;
 
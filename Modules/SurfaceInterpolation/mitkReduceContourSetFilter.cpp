@@ -42,6 +42,12 @@ void mitk::ReduceContourSetFilter::SetInput(unsigned int idx, const mitk::Surfac
   this->Modified();
 }
 
+void mitk::ReduceContourSetFilter::SetIntersectionContours(const std::vector<mitk::Surface::Pointer> &contours)
+{
+  m_IntersectionContours = contours;
+  this->Modified();
+}
+
 void mitk::ReduceContourSetFilter::SetInput(const mitk::Surface *surface)
 {
   this->SetInput(0, const_cast<mitk::Surface *>(surface));
@@ -372,14 +378,22 @@ bool mitk::ReduceContourSetFilter::CheckForIntersection(
   - That mean we can just reduce the current polygons points without considering any intersections
   */
 
+  std::vector<vtkPolyData *> otherContours;
   for (unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); i++)
   {
     // Don't check for intersection with the polygon itself
-    if (i == currentInputIndex)
-      continue;
+    if (i != currentInputIndex)
+      otherContours.push_back(const_cast<Surface *>(this->GetInput(i))->GetVtkPolyData());
+  }
+  for (const auto &contour : m_IntersectionContours)
+  {
+    otherContours.push_back(contour->GetVtkPolyData());
+  }
 
+  for (vtkPolyData *otherContour : otherContours)
+  {
     // Get the next polydata to check for intersection
-    vtkSmartPointer<vtkPolyData> poly = const_cast<Surface *>(this->GetInput(i))->GetVtkPolyData();
+    vtkSmartPointer<vtkPolyData> poly = otherContour;
     vtkSmartPointer<vtkCellArray> polygonArray = poly->GetPolys();
     polygonArray->InitTraversal();
     vtkIdType anotherInputPolygonSize(0);
@@ -486,7 +500,7 @@ bool mitk::ReduceContourSetFilter::CheckForIntersection(
       break;
     } // for (to traverse through all cells of actualInputPolyData)
 
-  } // for (to iterate through all inputs)
+  } // for (to iterate through all other contours)
 
   return true;
 }
@@ -510,6 +524,7 @@ void mitk::ReduceContourSetFilter::Reset()
   this->SetNthOutput(0, output.GetPointer());
 
   m_NumberOfPointsAfterReduction = 0;
+  m_IntersectionContours.clear();
 }
 
 void mitk::ReduceContourSetFilter::SetUseProgressBar(bool status)
@@ -30,6 +30,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkSmartPointer.h"
 
 #include <stack>
+#include <vector>
 
 namespace mitk
 {
@@ -93,6 +94,14 @@ namespace mitk
     virtual void SetInput(const mitk::Surface *surface);
     virtual void SetInput(unsigned int idx, const mitk::Surface *surface);
 
+    /**
+      \brief Set additional contours which are only considered for the detection of intersection contours
+
+      These contours are neither reduced nor part of the output. This allows to reduce a single contour
+      in the context of all others, e.g. to cache the reduction of every contour separately.
+    */
+    void SetIntersectionContours(const std::vector<mitk::Surface::Pointer> &contours);
+
     /**
       \brief Set the stepsize which the progress bar should proceed
 
@@ -132,6 +141,8 @@ namespace mitk
 
     unsigned int m_NumberOfPointsAfterReduction;
 
+    std::vector<mitk::Surface::Pointer> m_IntersectionContours;
+
   }; // class
 
 } // namespace
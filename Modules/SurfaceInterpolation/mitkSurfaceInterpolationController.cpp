@@ -23,6 +23,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include "vtkXMLPolyDataWriter.h"
 #include "vtkPolyDataWriter.h"
 
+#include <itkMutexLockHolder.h>
+
+#include <algorithm>
+#include <exception>
+
+typedef itk::MutexLockHolder<itk::SimpleMutexLock> MutexLockHolder;
+
 // Check whether the given contours are coplanar
 bool ContoursCoplanar(mitk::SurfaceInterpolationController::ContourPositionInformation leftHandSide,
                       mitk::SurfaceInterpolationController::ContourPositionInformation rightHandSide)
@@ -63,6 +70,34 @@ bool ContoursCoplanar(mitk::SurfaceInterpolationController::ContourPositionInfor
     return false;
 }
 
+// Check whether mitk::ReduceContourSetFilter could regard one of the given contours as intersection contour of the
+// other one. Only parallel contours which are at least the minimal spacing apart never are.
+bool ContoursMayIntersect(mitk::SurfaceInterpolationController::ContourPositionInformation leftHandSide,
+                          mitk::SurfaceInterpolationController::ContourPositionInformation rightHandSide,
+                          double minSpacing)
+{
+  double n[3] = {leftHandSide.contourNormal[0], leftHandSide.contourNormal[1], leftHandSide.contourNormal[2]};
+  double n2[3] = {rightHandSide.contourNormal[0], rightHandSide.contourNormal[1], rightHandSide.contourNormal[2]};
+  vtkMath::Normalize(n);
+  vtkMath::Normalize(n2);
+
+  if (!mitk::Equal(fabs(vtkMath::Dot(n, n2)), 1.0, 0.001))
+    return true;
+
+  double vec[3];
+  vec[0] = leftHandSide.contourPoint[0] - rightHandSide.contourPoint[0];
+  vec[1] = leftHandSide.contourPoint[1] - rightHandSide.contourPoint[1];
+  vec[2] = leftHandSide.contourPoint[2] - rightHandSide.contourPoint[2];
+
+  // The filter estimates the planes from a few contour points, hence the margin
+  return fabs(vtkMath::Dot(n, vec)) < minSpacing;
+}
+
+unsigned long GetContourTime(const mitk::Surface *contour)
+{
+  return std::max<unsigned long>(contour->GetMTime(), contour->GetVtkPolyData()->GetMTime());
+}
+
 mitk::SurfaceInterpolationController::ContourPositionInformation CreateContourPositionInformation(
   mitk::Surface::Pointer contour)
 {
@@ -78,20 +113,22 @@ mitk::SurfaceInterpolationController::ContourPositionInformation CreateContourPo
 }
 
 mitk::SurfaceInterpolationController::SurfaceInterpolationController()
-  : m_SelectedSegmentation(nullptr), m_CurrentTimeStep(0)
+  : m_MinSpacing(-1),
+    m_MaxSpacing(-1),
+    m_DistanceImageVolume(50000),
+    m_NumberOfPointsAfterReduction(0),
+    m_SelectedSegmentation(nullptr),
+    m_CurrentTimeStep(0),
+    m_JobCondition(itk::ConditionVariable::New()),
+    m_IdleCondition(itk::ConditionVariable::New()),
+    m_MultiThreader(itk::MultiThreader::New()),
+    m_ThreadId(-1),
+    m_HasPendingJob(false),
+    m_JobRunning(false),
+    m_StopWorker(false),
+    m_Generation(0)
 {
   m_DistanceImageSpacing = 0.0;
-  m_ReduceFilter = ReduceContourSetFilter::New();
-  m_NormalsFilter = ComputeContourSetNormalsFilter::New();
-  m_InterpolateSurfaceFilter = CreateDistanceImageFromSurfaceFilter::New();
-  // m_TimeSelector = ImageTimeSelector::New();
-
-  m_ReduceFilter->SetUseProgressBar(false);
-  //  m_ReduceFilter->SetProgressStepSize(1);
-  m_NormalsFilter->SetUseProgressBar(true);
-  m_NormalsFilter->SetProgressStepSize(1);
-  m_InterpolateSurfaceFilter->SetUseProgressBar(true);
-  m_InterpolateSurfaceFilter->SetProgressStepSize(7);
 
   m_Contours = Surface::New();
 
@@ -105,6 +142,17 @@ mitk::SurfaceInterpolationController::SurfaceInterpolationController()
 
 mitk::SurfaceInterpolationController::~SurfaceInterpolationController()
 {
+  // Stopping the background interpolation
+  m_InterpolationMutex.Lock();
+  m_StopWorker = true;
+  if (m_RunningFilter.IsNotNull())
+    m_RunningFilter->AbortGenerateDataOn();
+  m_JobCondition->Broadcast();
+  m_InterpolationMutex.Unlock();
+
+  if (m_ThreadId >= 0)
+    m_MultiThreader->TerminateThread(m_ThreadId);
+
   // Removing all observers
   auto dataIter = m_SegmentationObserverTags.begin();
   for (; dataIter != m_SegmentationObserverTags.end(); ++dataIter)
@@ -181,14 +229,11 @@ void mitk::SurfaceInterpolationController::AddToInterpolationPipeline(ContourPos
   // Don't save a new empty contour
   if (pos == -1 && newContour->GetVtkPolyData()->GetNumberOfPoints() > 0)
   {
-    m_ReduceFilter->SetInput(m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].size(),
-                             newContour);
     m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].push_back(contourInfo);
   }
   else if (pos != -1 && newContour->GetVtkPolyData()->GetNumberOfPoints() > 0)
   {
     m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].at(pos) = contourInfo;
-    m_ReduceFilter->SetInput(pos, newContour);
   }
   else if (newContour->GetVtkPolyData()->GetNumberOfPoints() == 0)
   {
@@ -265,17 +310,129 @@ unsigned int mitk::SurfaceInterpolationController::GetNumberOfContours()
 
 void mitk::SurfaceInterpolationController::Interpolate()
 {
-  m_ReduceFilter->Update();
+  InterpolationJob job;
+  const bool validJob = this->CreateInterpolationJob(job);
 
-  m_CurrentNumberOfReducedContours = m_ReduceFilter->GetNumberOfOutputs();
-  if (m_CurrentNumberOfReducedContours == 1)
+  // Supersedes all background interpolations
+  this->CancelInterpolation();
+
+  if (!validJob)
   {
-    vtkPolyData *tmp = m_ReduceFilter->GetOutput(0)->GetVtkPolyData();
-    if (tmp == nullptr)
+    MutexLockHolder lock(m_InterpolationMutex);
+    m_InterpolationResult = nullptr;
+    return;
+  }
+
+  m_InterpolationMutex.Lock();
+  job.generation = m_Generation;
+  m_InterpolationMutex.Unlock();
+
+  this->RunInterpolation(job);
+}
+
+void mitk::SurfaceInterpolationController::InterpolateAsync()
+{
+  InterpolationJob job;
+  const bool validJob = this->CreateInterpolationJob(job);
+
+  MutexLockHolder lock(m_InterpolationMutex);
+
+  ++m_Generation;
+  if (m_RunningFilter.IsNotNull())
+    m_RunningFilter->AbortGenerateDataOn();
+
+  if (!validJob)
+  {
+    m_HasPendingJob = false;
+    m_InterpolationResult = nullptr;
+    m_IdleCondition->Broadcast();
+    return;
+  }
+
+  job.generation = m_Generation;
+  m_PendingJob = job;
+  m_HasPendingJob = true;
+
+  // The worker is started on demand, it lives as long as the controller
+  if (m_ThreadId < 0)
+    m_ThreadId = m_MultiThreader->SpawnThread(InterpolationWorker, this);
+
+  m_JobCondition->Signal();
+}
+
+void mitk::SurfaceInterpolationController::CancelInterpolation()
+{
+  MutexLockHolder lock(m_InterpolationMutex);
+
+  ++m_Generation;
+  m_HasPendingJob = false;
+  m_PendingJob = InterpolationJob();
+  if (m_RunningFilter.IsNotNull())
+    m_RunningFilter->AbortGenerateDataOn();
+
+  m_IdleCondition->Broadcast();
+}
+
+void mitk::SurfaceInterpolationController::WaitForInterpolation()
+{
+  MutexLockHolder lock(m_InterpolationMutex);
+
+  while (m_HasPendingJob || m_JobRunning)
+    m_IdleCondition->Wait(&m_InterpolationMutex);
+}
+
+bool mitk::SurfaceInterpolationController::IsInterpolationRunning()
+{
+  MutexLockHolder lock(m_InterpolationMutex);
+  return m_HasPendingJob || m_JobRunning;
+}
+
+ITK_THREAD_RETURN_TYPE mitk::SurfaceInterpolationController::InterpolationWorker(void *pInfoStruct)
+{
+  itk::MultiThreader::ThreadInfoStruct *pInfo = static_cast<itk::MultiThreader::ThreadInfoStruct *>(pInfoStruct);
+  SurfaceInterpolationController *controller = static_cast<SurfaceInterpolationController *>(pInfo->UserData);
+
+  controller->m_InterpolationMutex.Lock();
+  for (;;)
+  {
+    while (!controller->m_StopWorker && !controller->m_HasPendingJob)
+      controller->m_JobCondition->Wait(&controller->m_InterpolationMutex);
+
+    if (controller->m_StopWorker)
+      break;
+
+    InterpolationJob job = controller->m_PendingJob;
+    controller->m_PendingJob = InterpolationJob();
+    controller->m_HasPendingJob = false;
+    controller->m_JobRunning = true;
+    controller->m_InterpolationMutex.Unlock();
+
+    try
     {
-      m_CurrentNumberOfReducedContours = 0;
+      controller->RunInterpolation(job);
     }
+    catch (const std::exception &e)
+    {
+      MITK_ERROR << "Surface interpolation failed: " << e.what();
+    }
+
+    controller->m_InterpolationMutex.Lock();
+    controller->m_JobRunning = false;
+    controller->m_IdleCondition->Broadcast();
   }
+  controller->m_InterpolationMutex.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+bool mitk::SurfaceInterpolationController::CreateInterpolationJob(InterpolationJob &job)
+{
+  if (!m_SelectedSegmentation || m_CurrentTimeStep >= m_SelectedSegmentation->GetTimeSteps())
+    return false;
+
+  auto session = m_ListOfInterpolationSessions.find(m_SelectedSegmentation);
+  if (session == m_ListOfInterpolationSessions.end() || m_CurrentTimeStep >= session->second.size())
+    return false;
 
   mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
   timeSelector->SetInput(m_SelectedSegmentation);
@@ -284,61 +441,247 @@ void mitk::SurfaceInterpolationController::Interpolate()
   timeSelector->Update();
   mitk::Image::Pointer refSegImage = timeSelector->GetOutput();
 
-  m_NormalsFilter->SetSegmentationBinaryImage(refSegImage);
-  for (unsigned int i = 0; i < m_CurrentNumberOfReducedContours; i++)
+  job.referenceImage = itk::ImageBase<3>::New();
+  AccessFixedDimensionByItk_1(refSegImage, GetImageBase, 3, job.referenceImage);
+
+  job.generation = 0;
+  job.session = m_SelectedSegmentation;
+  job.timeStep = m_CurrentTimeStep;
+  job.segmentation = refSegImage;
+  job.contours = session->second[m_CurrentTimeStep];
+  job.minSpacing = m_MinSpacing;
+  job.maxSpacing = m_MaxSpacing;
+  job.distanceImageVolume = m_DistanceImageVolume;
+  return true;
+}
+
+bool mitk::SurfaceInterpolationController::IsSuperseded(const InterpolationJob &job)
+{
+  MutexLockHolder lock(m_InterpolationMutex);
+  return job.generation != 0 && job.generation != m_Generation;
+}
+
+bool mitk::SurfaceInterpolationController::ReducedContour::HasSameInputs(const ReducedContour &other) const
+{
+  return contour == other.contour && contourTime == other.contourTime &&
+         intersectionContours == other.intersectionContours && session == other.session &&
+         timeStep == other.timeStep && minSpacing == other.minSpacing && maxSpacing == other.maxSpacing;
+}
+
+std::vector<mitk::Surface::Pointer> mitk::SurfaceInterpolationController::ReduceContours(const InterpolationJob &job,
+                                                                                         unsigned int &numberOfPoints)
+{
+  MutexLockHolder lock(m_ReductionMutex);
+
+  std::vector<Surface::Pointer> reducedContours;
+  numberOfPoints = 0;
+
+  for (unsigned int i = 0; i < job.contours.size(); ++i)
+  {
+    if (this->IsSuperseded(job))
+      return reducedContours;
+
+    ReducedContour reduced;
+    reduced.contour = job.contours[i].contour;
+    reduced.contourTime = GetContourTime(reduced.contour);
+    reduced.session = job.session;
+    reduced.timeStep = job.timeStep;
+    reduced.minSpacing = job.minSpacing;
+    reduced.maxSpacing = job.maxSpacing;
+    reduced.numberOfPoints = 0;
+
+    // The reduction only depends on the contours which could turn this one into an intersection contour
+    std::vector<Surface::Pointer> intersectionContours;
+    for (unsigned int j = 0; j < job.contours.size(); ++j)
+    {
+      if (j != i && ContoursMayIntersect(job.contours[i], job.contours[j], job.minSpacing))
+      {
+        intersectionContours.push_back(job.contours[j].contour);
+        reduced.intersectionContours.push_back(
+          std::make_pair(job.contours[j].contour, GetContourTime(job.contours[j].contour)));
+      }
+    }
+
+    auto cached = m_ReducedContours.find(reduced.contour.GetPointer());
+    if (cached == m_ReducedContours.end() || !cached->second.HasSameInputs(reduced))
+    {
+      ReduceContourSetFilter::Pointer reduceFilter = ReduceContourSetFilter::New();
+      reduceFilter->SetMinSpacing(job.minSpacing);
+      reduceFilter->SetMaxSpacing(job.maxSpacing);
+      reduceFilter->SetInput(0, reduced.contour);
+      reduceFilter->SetIntersectionContours(intersectionContours);
+      reduceFilter->Update();
+      reduced.numberOfPoints = reduceFilter->GetNumberOfPointsAfterReduction();
+
+      // Without any remaining polygon the output is empty
+      mitk::Surface::Pointer reducedContour = reduceFilter->GetOutput(0);
+      vtkPolyData *reducedPolyData = reducedContour->GetVtkPolyData();
+      if (reducedPolyData != nullptr && reducedPolyData->GetNumberOfPolys() > 0)
+      {
+        reducedContour->DisconnectPipeline();
+
+        ComputeContourSetNormalsFilter::Pointer normalsFilter = ComputeContourSetNormalsFilter::New();
+        if (job.maxSpacing > 0)
+          normalsFilter->SetMaxSpacing(job.maxSpacing);
+        normalsFilter->SetSegmentationBinaryImage(job.segmentation);
+        normalsFilter->SetInput(0, reducedContour);
+        normalsFilter->Update();
+        reduced.reducedContour = normalsFilter->GetOutput(0);
+        reduced.reducedContour->DisconnectPipeline();
+      }
+
+      m_ReducedContours[reduced.contour.GetPointer()] = reduced;
+      cached = m_ReducedContours.find(reduced.contour.GetPointer());
+    }
+
+    numberOfPoints += cached->second.numberOfPoints;
+    if (cached->second.reducedContour.IsNotNull())
+      reducedContours.push_back(cached->second.reducedContour);
+  }
+
+  // Forget the contours which have been replaced or removed
+  for (auto iter = m_ReducedContours.begin(); iter != m_ReducedContours.end();)
   {
-    mitk::Surface::Pointer reducedContour = m_ReduceFilter->GetOutput(i);
-    reducedContour->DisconnectPipeline();
-    m_NormalsFilter->SetInput(i, reducedContour);
-    m_InterpolateSurfaceFilter->SetInput(i, m_NormalsFilter->GetOutput(i));
+    auto contour =
+      std::find_if(job.contours.begin(), job.contours.end(), [&iter](const ContourPositionInformation &info) {
+        return info.contour.GetPointer() == iter->first;
+      });
+    if (contour == job.contours.end())
+      iter = m_ReducedContours.erase(iter);
+    else
+      ++iter;
   }
 
-  if (m_CurrentNumberOfReducedContours < 2)
+  return reducedContours;
+}
+
+void mitk::SurfaceInterpolationController::RunInterpolation(const InterpolationJob &job)
+{
+  unsigned int numberOfPoints(0);
+  std::vector<Surface::Pointer> reducedContours = this->ReduceContours(job, numberOfPoints);
+
+  if (reducedContours.size() < 2)
   {
     // If no interpolation is possible reset the interpolation result
-    m_InterpolationResult = nullptr;
+    MutexLockHolder lock(m_InterpolationMutex);
+    if (job.generation == 0 || job.generation == m_Generation)
+    {
+      m_InterpolationResult = nullptr;
+      m_CurrentNumberOfReducedContours = reducedContours.size();
+      m_NumberOfPointsAfterReduction = numberOfPoints;
+    }
     return;
   }
 
+  CreateDistanceImageFromSurfaceFilter::Pointer interpolateSurfaceFilter = CreateDistanceImageFromSurfaceFilter::New();
+  interpolateSurfaceFilter->SetUseProgressBar(true);
+  interpolateSurfaceFilter->SetProgressStepSize(7);
+  interpolateSurfaceFilter->SetReferenceImage(job.referenceImage);
+  interpolateSurfaceFilter->SetDistanceImageVolume(job.distanceImageVolume);
+  for (unsigned int i = 0; i < reducedContours.size(); i++)
+  {
+    interpolateSurfaceFilter->SetInput(i, reducedContours[i]);
+  }
+
+  // Registered, so that a new request can abort the filter
+  m_InterpolationMutex.Lock();
+  const bool superseded = job.generation != 0 && job.generation != m_Generation;
+  if (!superseded)
+    m_RunningFilter = interpolateSurfaceFilter;
+  m_InterpolationMutex.Unlock();
+
+  if (superseded)
+    return;
+
   // Setting up progress bar
   mitk::ProgressBar::GetInstance()->AddStepsToDo(10);
 
   // create a surface from the distance-image
   mitk::ImageToSurfaceFilter::Pointer imageToSurfaceFilter = mitk::ImageToSurfaceFilter::New();
-  imageToSurfaceFilter->SetInput(m_InterpolateSurfaceFilter->GetOutput());
+  imageToSurfaceFilter->SetInput(interpolateSurfaceFilter->GetOutput());
   imageToSurfaceFilter->SetThreshold(0);
   imageToSurfaceFilter->SetSmooth(true);
   imageToSurfaceFilter->SetSmoothIteration(20);
-  imageToSurfaceFilter->Update();
+
+  bool finished(false);
+  std::exception_ptr error;
+  try
+  {
+    imageToSurfaceFilter->Update();
+    finished = true;
+  }
+  catch (const itk::ProcessAborted &)
+  {
+    // Superseded by a newer request
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+
+  if (!finished)
+  {
+    m_InterpolationMutex.Lock();
+    m_RunningFilter = nullptr;
+    m_InterpolationMutex.Unlock();
+    mitk::ProgressBar::GetInstance()->Progress(20);
+
+    if (error)
+      std::rethrow_exception(error);
+    return;
+  }
 
   mitk::Surface::Pointer interpolationResult = mitk::Surface::New();
-  interpolationResult->SetVtkPolyData(imageToSurfaceFilter->GetOutput()->GetVtkPolyData(), m_CurrentTimeStep);
-  m_InterpolationResult = interpolationResult;
+  interpolationResult->SetVtkPolyData(imageToSurfaceFilter->GetOutput()->GetVtkPolyData(), job.timeStep);
+  interpolationResult->DisconnectPipeline();
 
-  m_DistanceImageSpacing = m_InterpolateSurfaceFilter->GetDistanceImageSpacing();
+  mitk::Image::Pointer distanceImage = interpolateSurfaceFilter->GetOutput();
+  distanceImage->DisconnectPipeline();
 
   vtkSmartPointer<vtkAppendPolyData> polyDataAppender = vtkSmartPointer<vtkAppendPolyData>::New();
-  for (unsigned int i = 0; i < m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].size(); i++)
+  for (unsigned int i = 0; i < job.contours.size(); i++)
   {
-    polyDataAppender->AddInputData(
-      m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].at(i).contour->GetVtkPolyData());
+    polyDataAppender->AddInputData(job.contours.at(i).contour->GetVtkPolyData());
   }
+  m_ReductionMutex.Lock();
   polyDataAppender->Update();
-  m_Contours->SetVtkPolyData(polyDataAppender->GetOutput());
+  m_ReductionMutex.Unlock();
+  mitk::Surface::Pointer contours = mitk::Surface::New();
+  contours->SetVtkPolyData(polyDataAppender->GetOutput());
+
+  // Publishing the results at once, unless a newer request superseded them meanwhile
+  m_InterpolationMutex.Lock();
+  m_RunningFilter = nullptr;
+  if (job.generation == 0 || job.generation == m_Generation)
+  {
+    m_InterpolationResult = interpolationResult;
+    m_Contours = contours;
+    m_DistanceImage = distanceImage;
+    m_DistanceImageSpacing = interpolateSurfaceFilter->GetDistanceImageSpacing();
+    m_CurrentNumberOfReducedContours = reducedContours.size();
+    m_NumberOfPointsAfterReduction = numberOfPoints;
+  }
+  m_InterpolationMutex.Unlock();
 
   // Last progress step
   mitk::ProgressBar::GetInstance()->Progress(20);
-
-  m_InterpolationResult->DisconnectPipeline();
 }
 
 mitk::Surface::Pointer mitk::SurfaceInterpolationController::GetInterpolationResult()
 {
+  MutexLockHolder lock(m_InterpolationMutex);
   return m_InterpolationResult;
 }
 
-mitk::Surface *mitk::SurfaceInterpolationController::GetContoursAsSurface()
+double mitk::SurfaceInterpolationController::GetDistanceImageSpacing()
 {
+  MutexLockHolder lock(m_InterpolationMutex);
+  return m_DistanceImageSpacing;
+}
+
+mitk::Surface::Pointer mitk::SurfaceInterpolationController::GetContoursAsSurface()
+{
+  MutexLockHolder lock(m_InterpolationMutex);
   return m_Contours;
 }
 
@@ -349,18 +692,17 @@ void mitk::SurfaceInterpolationController::SetDataStorage(DataStorage::Pointer d
 
 void mitk::SurfaceInterpolationController::SetMinSpacing(double minSpacing)
 {
-  m_ReduceFilter->SetMinSpacing(minSpacing);
+  m_MinSpacing = minSpacing;
 }
 
 void mitk::SurfaceInterpolationController::SetMaxSpacing(double maxSpacing)
 {
-  m_ReduceFilter->SetMaxSpacing(maxSpacing);
-  m_NormalsFilter->SetMaxSpacing(maxSpacing);
+  m_MaxSpacing = maxSpacing;
 }
 
 void mitk::SurfaceInterpolationController::SetDistanceImageVolume(unsigned int distImgVolume)
 {
-  m_InterpolateSurfaceFilter->SetDistanceImageVolume(distImgVolume);
+  m_DistanceImageVolume = distImgVolume;
 }
 
 mitk::Image::Pointer mitk::SurfaceInterpolationController::GetCurrentSegmentation()
@@ -370,12 +712,19 @@ mitk::Image::Pointer mitk::SurfaceInterpolationController::GetCurrentSegmentatio
 
 mitk::Image *mitk::SurfaceInterpolationController::GetImage()
 {
-  return m_InterpolateSurfaceFilter->GetOutput();
+  MutexLockHolder lock(m_InterpolationMutex);
+  return m_DistanceImage;
 }
 
 double mitk::SurfaceInterpolationController::EstimatePortionOfNeededMemory()
 {
-  double numberOfPointsAfterReduction = m_ReduceFilter->GetNumberOfPointsAfterReduction() * 3;
+  // The reduced contours are cached, so a following interpolation reuses them
+  InterpolationJob job;
+  unsigned int numberOfPoints(0);
+  if (this->CreateInterpolationJob(job))
+    this->ReduceContours(job, numberOfPoints);
+
+  double numberOfPointsAfterReduction = numberOfPoints * 3;
   double sizeOfPoints = pow(numberOfPointsAfterReduction, 2) * sizeof(double);
   double totalMem = mitk::MemoryUtilities::GetTotalSizeOfPhysicalRam();
   double percentage = sizeOfPoints / totalMem;
@@ -406,6 +755,7 @@ void mitk::SurfaceInterpolationController::SetCurrentInterpolationSession(mitk::
 
   if (currentSegmentationImage.IsNull())
   {
+    this->CancelInterpolation();
     m_SelectedSegmentation = nullptr;
     return;
   }
@@ -420,8 +770,11 @@ void mitk::SurfaceInterpolationController::SetCurrentInterpolationSession(mitk::
     ContourPositionInformationVec2D newList;
     m_ListOfInterpolationSessions.insert(
       std::pair<mitk::Image *, ContourPositionInformationVec2D>(m_SelectedSegmentation, newList));
+    this->CancelInterpolation();
+    m_InterpolationMutex.Lock();
     m_InterpolationResult = nullptr;
     m_CurrentNumberOfReducedContours = 0;
+    m_InterpolationMutex.Unlock();
 
     itk::MemberCommand<SurfaceInterpolationController>::Pointer command =
       itk::MemberCommand<SurfaceInterpolationController>::New();
@@ -460,15 +813,10 @@ bool mitk::SurfaceInterpolationController::ReplaceInterpolationSession(mitk::Ima
     std::pair<mitk::Image *, unsigned long>(newSession, newSession->AddObserver(itk::DeleteEvent(), command)));
 
   if (m_SelectedSegmentation == oldSession)
+  {
+    this->CancelInterpolation();
     m_SelectedSegmentation = newSession;
-
-  mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
-  timeSelector->SetInput(m_SelectedSegmentation);
-  timeSelector->SetTimeNr(m_CurrentTimeStep);
-  timeSelector->SetChannelNr(0);
-  timeSelector->Update();
-  mitk::Image::Pointer refSegImage = timeSelector->GetOutput();
-  m_NormalsFilter->SetSegmentationBinaryImage(refSegImage);
+  }
 
   this->RemoveInterpolationSession(oldSession);
   return true;
@@ -485,7 +833,7 @@ void mitk::SurfaceInterpolationController::RemoveInterpolationSession(mitk::Imag
   {
     if (m_SelectedSegmentation == segmentationImage)
     {
-      m_NormalsFilter->SetSegmentationBinaryImage(nullptr);
+      this->CancelInterpolation();
       m_SelectedSegmentation = nullptr;
     }
     m_ListOfInterpolationSessions.erase(segmentationImage);
@@ -511,6 +859,7 @@ void mitk::SurfaceInterpolationController::RemoveAllInterpolationSessions()
   }
 
   m_SegmentationObserverTags.clear();
+  this->CancelInterpolation();
   m_SelectedSegmentation = nullptr;
   m_ListOfInterpolationSessions.clear();
 }
@@ -631,7 +980,7 @@ void mitk::SurfaceInterpolationController::OnSegmentationDeleted(const itk::Obje
   {
     if (m_SelectedSegmentation == tempImage)
     {
-      m_NormalsFilter->SetSegmentationBinaryImage(nullptr);
+      this->CancelInterpolation();
       m_SelectedSegmentation = nullptr;
     }
     m_SegmentationObserverTags.erase(tempImage);
@@ -641,24 +990,11 @@ void mitk::SurfaceInterpolationController::OnSegmentationDeleted(const itk::Obje
 
 void mitk::SurfaceInterpolationController::ReinitializeInterpolation()
 {
-  // If session has changed reset the pipeline
-  m_ReduceFilter->Reset();
-  m_NormalsFilter->Reset();
-  m_InterpolateSurfaceFilter->Reset();
-
-  itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+  // If session has changed the running interpolation is obsolete
+  this->CancelInterpolation();
 
   if (m_SelectedSegmentation)
   {
-    mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
-    timeSelector->SetInput(m_SelectedSegmentation);
-    timeSelector->SetTimeNr(m_CurrentTimeStep);
-    timeSelector->SetChannelNr(0);
-    timeSelector->Update();
-    mitk::Image::Pointer refSegImage = timeSelector->GetOutput();
-    AccessFixedDimensionByItk_1(refSegImage, GetImageBase, 3, itkImage);
-    m_InterpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
-
     unsigned int numTimeSteps = m_SelectedSegmentation->GetTimeSteps();
     unsigned int size = m_ListOfInterpolationSessions[m_SelectedSegmentation].size();
     if (size != numTimeSteps)
@@ -666,34 +1002,6 @@ void mitk::SurfaceInterpolationController::ReinitializeInterpolation()
       m_ListOfInterpolationSessions[m_SelectedSegmentation].resize(numTimeSteps);
     }
 
-    if (m_CurrentTimeStep < numTimeSteps)
-    {
-      unsigned int numContours = m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].size();
-      for (unsigned int c = 0; c < numContours; ++c)
-      {
-        m_ReduceFilter->SetInput(c,
-                                 m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep][c].contour);
-      }
-
-      m_ReduceFilter->Update();
-
-      m_CurrentNumberOfReducedContours = m_ReduceFilter->GetNumberOfOutputs();
-      if (m_CurrentNumberOfReducedContours == 1)
-      {
-        vtkPolyData *tmp = m_ReduceFilter->GetOutput(0)->GetVtkPolyData();
-        if (tmp == nullptr)
-        {
-          m_CurrentNumberOfReducedContours = 0;
-        }
-      }
-
-      for (unsigned int i = 0; i < m_CurrentNumberOfReducedContours; i++)
-      {
-        m_NormalsFilter->SetInput(i, m_ReduceFilter->GetOutput(i));
-        m_InterpolateSurfaceFilter->SetInput(i, m_NormalsFilter->GetOutput(i));
-      }
-    }
-
     Modified();
   }
 }
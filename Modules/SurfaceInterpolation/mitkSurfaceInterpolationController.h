@@ -48,6 +48,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkProgressBar.h"
 
+#include <itkConditionVariable.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+
 namespace mitk
 {
   class MITKSURFACEINTERPOLATION_EXPORT SurfaceInterpolationController : public itk::Object
@@ -56,9 +60,7 @@ namespace mitk
     mitkClassMacroItkParent(SurfaceInterpolationController, itk::Object) itkFactorylessNewMacro(Self)
       itkCloneMacro(Self)
 
-        itkGetMacro(DistanceImageSpacing, double)
-
-          struct ContourPositionInformation
+        struct ContourPositionInformation
     {
       Surface::Pointer contour;
       Vector3D contourNormal;
@@ -125,8 +127,37 @@ namespace mitk
      */
     void Interpolate();
 
+    /**
+     * @brief Interpolates the 3D surface from the given extracted contours on a background thread
+     *
+     * Returns immediately. The contours and parameters are copied, so they can be changed while the
+     * interpolation is running. Requests are coalesced: a new request aborts the running interpolation
+     * and replaces the pending one, so only the most recent contours are interpolated. The result is
+     * published at once when the interpolation has finished, see WaitForInterpolation().
+     *
+     * The reduced contours and their normals are cached, only new or changed contours are reduced again.
+     */
+    void InterpolateAsync();
+
+    /**
+     * @brief Aborts the running and discards the pending background interpolation
+     */
+    void CancelInterpolation();
+
+    /**
+     * @brief Blocks until the background interpolation has finished all requests
+     */
+    void WaitForInterpolation();
+
+    /**
+     * @brief Returns whether a background interpolation is running or pending
+     */
+    bool IsInterpolationRunning();
+
     mitk::Surface::Pointer GetInterpolationResult();
 
+    double GetDistanceImageSpacing();
+
     /**
      * Sets the minimum spacing of the current selected segmentation
      * This is needed since the contour points we reduced before they are used to interpolate the surface
@@ -151,7 +182,7 @@ namespace mitk
      */
     mitk::Image::Pointer GetCurrentSegmentation();
 
-    Surface *GetContoursAsSurface();
+    Surface::Pointer GetContoursAsSurface();
 
     void SetDataStorage(DataStorage::Pointer ds);
 
@@ -221,18 +252,68 @@ namespace mitk
     void GetImageBase(itk::Image<TPixel, VImageDimension> *input, itk::ImageBase<3>::Pointer &result);
 
   private:
+    /**
+     * @brief Everything an interpolation needs, copied on the calling thread
+     */
+    struct InterpolationJob
+    {
+      /** 0 for jobs that are never superseded, e.g. of EstimatePortionOfNeededMemory() */
+      unsigned long generation;
+      mitk::Image *session;
+      unsigned int timeStep;
+      mitk::Image::Pointer segmentation;
+      itk::ImageBase<3>::Pointer referenceImage;
+      ContourPositionInformationList contours;
+      double minSpacing;
+      double maxSpacing;
+      unsigned int distanceImageVolume;
+    };
+
+    /**
+     * @brief The reduced contour with normals of one contour
+     *
+     * It is valid as long as neither the contour nor one of the contours which could turn it into an
+     * intersection contour (see ReduceContourSetFilter) has changed.
+     */
+    struct ReducedContour
+    {
+      Surface::Pointer contour;
+      unsigned long contourTime;
+      std::vector<std::pair<Surface::Pointer, unsigned long>> intersectionContours;
+      mitk::Image *session;
+      unsigned int timeStep;
+      double minSpacing;
+      double maxSpacing;
+      Surface::Pointer reducedContour;
+      unsigned int numberOfPoints;
+
+      bool HasSameInputs(const ReducedContour &other) const;
+    };
+
     void ReinitializeInterpolation();
 
+    bool CreateInterpolationJob(InterpolationJob &job);
+
+    std::vector<Surface::Pointer> ReduceContours(const InterpolationJob &job, unsigned int &numberOfPoints);
+
+    bool IsSuperseded(const InterpolationJob &job);
+
+    void RunInterpolation(const InterpolationJob &job);
+
+    static ITK_THREAD_RETURN_TYPE InterpolationWorker(void *pInfoStruct);
+
     void OnSegmentationDeleted(const itk::Object *caller, const itk::EventObject &event);
 
     void AddToInterpolationPipeline(ContourPositionInformation contourInfo);
 
-    ReduceContourSetFilter::Pointer m_ReduceFilter;
-    ComputeContourSetNormalsFilter::Pointer m_NormalsFilter;
-    CreateDistanceImageFromSurfaceFilter::Pointer m_InterpolateSurfaceFilter;
+    double m_MinSpacing;
+    double m_MaxSpacing;
+    unsigned int m_DistanceImageVolume;
 
     Surface::Pointer m_Contours;
 
+    mitk::Image::Pointer m_DistanceImage;
+
     double m_DistanceImageSpacing;
 
     vtkSmartPointer<vtkPolyData> m_PolyData;
@@ -245,11 +326,30 @@ namespace mitk
 
     unsigned int m_CurrentNumberOfReducedContours;
 
+    unsigned int m_NumberOfPointsAfterReduction;
+
     mitk::Image *m_SelectedSegmentation;
 
     std::map<mitk::Image *, unsigned long> m_SegmentationObserverTags;
 
     unsigned int m_CurrentTimeStep;
+
+    // Reduced contours by contour, guarded by m_ReductionMutex which also serializes the reduction
+    std::map<const Surface *, ReducedContour> m_ReducedContours;
+    itk::SimpleMutexLock m_ReductionMutex;
+
+    // The background interpolation, the published results are guarded by m_InterpolationMutex as well
+    itk::SimpleMutexLock m_InterpolationMutex;
+    itk::ConditionVariable::Pointer m_JobCondition;
+    itk::ConditionVariable::Pointer m_IdleCondition;
+    itk::MultiThreader::Pointer m_MultiThreader;
+    int m_ThreadId;
+    InterpolationJob m_PendingJob;
+    bool m_HasPendingJob;
+    bool m_JobRunning;
+    bool m_StopWorker;
+    unsigned long m_Generation;
+    CreateDistanceImageFromSurfaceFilter::Pointer m_RunningFilter;
   };
 }
 #endif
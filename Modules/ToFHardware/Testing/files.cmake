@@ -3,6 +3,7 @@ set(MODULE_TESTS
   mitkAbstractToFDeviceFactoryTest.cpp
   mitkToFCameraMITKPlayerDeviceTest.cpp
   mitkToFCameraMITKPlayerDeviceFactoryTest.cpp
+  mitkToFFrameRingBufferTest.cpp
   mitkToFImageCsvWriterTest.cpp
   mitkToFImageGrabberTest.cpp
   mitkToFImageRecorderTest.cpp
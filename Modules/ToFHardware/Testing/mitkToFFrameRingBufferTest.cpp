@@ -0,0 +1,182 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include <mitkToFFrameRingBuffer.h>
+
+#include <itkMultiThreader.h>
+
+class mitkToFFrameRingBufferTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkToFFrameRingBufferTestSuite);
+  MITK_TEST(LeaseFrame_EmptyBuffer_ReturnsFalse);
+  MITK_TEST(LeaseFrame_NoRequiredSequence_NewestFrame);
+  MITK_TEST(LeaseFrame_RequiredSequence_FrameOrNextOne);
+  MITK_TEST(BeginWrite_LeasedFrame_NotOverwritten);
+  MITK_TEST(RegisterReader_TooManyReaders_ReturnsMinusOne);
+  MITK_TEST(ConcurrentWriting_LeasedFramesConsistent);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  static const int PixelNumber = 1000;
+
+  mitk::ToFFrameRingBuffer* m_Buffer;
+
+  /** Writes a frame whose pixels all hold the sequence number the frame will get */
+  static int WriteFrame(mitk::ToFFrameRingBuffer* buffer)
+  {
+    mitk::ToFFrameRingBuffer::Frame* frame = buffer->BeginWrite();
+    if (frame == NULL)
+    {
+      return -1;
+    }
+    float value = buffer->GetLatestSequence()+1;
+    for (int i=0; i<PixelNumber; i++)
+    {
+      frame->distances[i] = value;
+      frame->amplitudes[i] = value;
+    }
+    return buffer->EndWrite();
+  }
+
+  static bool IsConsistent(const mitk::ToFFrameRingBuffer::Frame* frame)
+  {
+    for (int i=0; i<PixelNumber; i++)
+    {
+      if (frame->distances[i] != frame->sequence || frame->amplitudes[i] != frame->sequence)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static ITK_THREAD_RETURN_TYPE WriteFrames(void* pInfoStruct)
+  {
+    itk::MultiThreader::ThreadInfoStruct* pInfo = (itk::MultiThreader::ThreadInfoStruct*)pInfoStruct;
+    mitk::ToFFrameRingBuffer* buffer = (mitk::ToFFrameRingBuffer*)pInfo->UserData;
+    for (int i=0; i<20000; i++)
+    {
+      WriteFrame(buffer);
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Buffer = new mitk::ToFFrameRingBuffer();
+    m_Buffer->Initialize(1, PixelNumber, 0, 0);
+  }
+
+  void tearDown() override
+  {
+    delete m_Buffer;
+  }
+
+  void LeaseFrame_EmptyBuffer_ReturnsFalse()
+  {
+    int reader = m_Buffer->RegisterReader();
+    mitk::ToFFrameRingBuffer::Lease lease;
+    CPPUNIT_ASSERT_MESSAGE("Leasing from an empty buffer should fail.", !m_Buffer->LeaseFrame(reader, -1, lease));
+    CPPUNIT_ASSERT_MESSAGE("A failed lease should not provide a frame.", lease.GetFrame() == NULL);
+  }
+
+  void LeaseFrame_NoRequiredSequence_NewestFrame()
+  {
+    int reader = m_Buffer->RegisterReader();
+    for (int i=0; i<3; i++)
+    {
+      WriteFrame(m_Buffer);
+    }
+    mitk::ToFFrameRingBuffer::Lease lease;
+    CPPUNIT_ASSERT_MESSAGE("Leasing should succeed after writing.", m_Buffer->LeaseFrame(reader, -1, lease));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The newest frame should be leased.", 3, lease.GetFrame()->sequence);
+    CPPUNIT_ASSERT_MESSAGE("The leased frame should hold the written data.", IsConsistent(lease.GetFrame()));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("No frame should be skipped.", 0ul, m_Buffer->GetNumberOfSkippedFrames(reader));
+  }
+
+  void LeaseFrame_RequiredSequence_FrameOrNextOne()
+  {
+    int reader = m_Buffer->RegisterReader();
+    for (int i=0; i<10; i++)
+    {
+      WriteFrame(m_Buffer);
+    }
+    mitk::ToFFrameRingBuffer::Lease lease;
+    CPPUNIT_ASSERT_MESSAGE("Leasing a buffered frame should succeed.", m_Buffer->LeaseFrame(reader, 8, lease));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The required frame should be leased.", 8, lease.GetFrame()->sequence);
+
+    // the buffer has 6 slots, so frame 2 is overwritten
+    CPPUNIT_ASSERT_MESSAGE("Leasing an overwritten frame should lease a later one.", m_Buffer->LeaseFrame(reader, 2, lease));
+    CPPUNIT_ASSERT_MESSAGE("The oldest frame after the required one should be leased.", lease.GetFrame()->sequence > 2 && lease.GetFrame()->sequence < 10);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The overwritten frames should be counted as skipped.", static_cast<unsigned long>(lease.GetFrame()->sequence-2), m_Buffer->GetNumberOfSkippedFrames(reader));
+  }
+
+  void BeginWrite_LeasedFrame_NotOverwritten()
+  {
+    int reader = m_Buffer->RegisterReader();
+    WriteFrame(m_Buffer);
+    mitk::ToFFrameRingBuffer::Lease lease;
+    m_Buffer->LeaseFrame(reader, -1, lease);
+    for (int i=0; i<50; i++)
+    {
+      WriteFrame(m_Buffer);
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The leased frame should keep its sequence.", 1, lease.GetFrame()->sequence);
+    CPPUNIT_ASSERT_MESSAGE("The leased frame should not be overwritten.", IsConsistent(lease.GetFrame()));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("All frames should be written.", 51, m_Buffer->GetLatestSequence());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("No frame should be dropped.", 0ul, m_Buffer->GetNumberOfDroppedFrames());
+  }
+
+  void RegisterReader_TooManyReaders_ReturnsMinusOne()
+  {
+    for (int i=0; i<mitk::ToFFrameRingBuffer::MaxNumberOfReaders; i++)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Registering a reader should succeed.", m_Buffer->RegisterReader() >= 0);
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Registering too many readers should fail.", -1, m_Buffer->RegisterReader());
+    m_Buffer->UnregisterReader(0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("An unregistered reader id should be reused.", 0, m_Buffer->RegisterReader());
+  }
+
+  void ConcurrentWriting_LeasedFramesConsistent()
+  {
+    int reader = m_Buffer->RegisterReader();
+    itk::MultiThreader::Pointer multiThreader = itk::MultiThreader::New();
+    int threadID = multiThreader->SpawnThread(WriteFrames, m_Buffer);
+
+    bool consistent = true;
+    mitk::ToFFrameRingBuffer::Lease lease;
+    while (m_Buffer->GetLatestSequence() < 20000)
+    {
+      if (m_Buffer->LeaseFrame(reader, -1, lease))
+      {
+        consistent = consistent && IsConsistent(lease.GetFrame());
+      }
+    }
+    lease.Release();
+    multiThreader->TerminateThread(threadID);
+
+    CPPUNIT_ASSERT_MESSAGE("Frames should not change while they are leased.", consistent);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("No frame should be dropped.", 0ul, m_Buffer->GetNumberOfDroppedFrames());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkToFFrameRingBuffer)
@@ -11,6 +11,7 @@ SET(CPP_FILES
   mitkToFImageGrabber.cpp
   mitkToFOpenCVImageGrabber.cpp
   mitkToFCameraDevice.cpp
+  mitkToFFrameRingBuffer.cpp
   mitkToFCameraMITKPlayerController.cpp
   mitkToFCameraMITKPlayerDevice.cpp
   mitkToFImageSource.cpp
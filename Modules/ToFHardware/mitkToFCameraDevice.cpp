@@ -153,6 +153,16 @@ namespace mitk
     return this->m_RGBImageHeight;
   }
 
+  ToFFrameRingBuffer* ToFCameraDevice::GetFrameBuffer()
+  {
+    return m_FrameBuffer.IsInitialized() ? &m_FrameBuffer : NULL;
+  }
+
+  unsigned long ToFCameraDevice::GetNumberOfDroppedFrames() const
+  {
+    return m_FrameBuffer.GetNumberOfDroppedFrames();
+  }
+
   void ToFCameraDevice::StopCamera()
   {
     m_CameraActiveMutex->Lock();
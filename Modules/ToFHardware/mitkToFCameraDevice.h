@@ -27,6 +27,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkMultiThreader.h"
 #include "itkFastMutexLock.h"
 
+#include "mitkToFFrameRingBuffer.h"
+
 // Microservices
 #include <mitkServiceInterface.h>
 
@@ -185,6 +187,19 @@ namespace mitk
 
     virtual int GetRGBCaptureHeight();
 
+    /*!
+    \brief get the frame buffer filled by the acquisition thread. Consumers can register as reader and
+    lease frames from it without copying them.
+    \return the frame buffer or NULL if the device keeps its images in own arrays
+    */
+    ToFFrameRingBuffer* GetFrameBuffer();
+
+    /*!
+    \brief get the number of frames dropped by the acquisition thread because all frame slots were leased
+    \return 0 for devices without frame buffer
+    */
+    unsigned long GetNumberOfDroppedFrames() const;
+
   protected:
 
     ToFCameraDevice();
@@ -223,6 +238,7 @@ namespace mitk
     int m_ImageSequence; ///<  counter for acquired images
 
     PropertyList::Pointer m_PropertyList; ///< a list of the corresponding properties
+    ToFFrameRingBuffer m_FrameBuffer; ///< frame buffer, only used by devices which initialize it when connecting
 
   };
 } //END mitk namespace
@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkToFCameraMITKPlayerController.h"
 #include "mitkRealTimeClock.h"
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <itkMultiThreader.h>
@@ -24,16 +25,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace mitk
 {
-ToFCameraMITKPlayerDevice::ToFCameraMITKPlayerDevice() :
-  m_DistanceDataBuffer(NULL), m_AmplitudeDataBuffer(NULL), m_IntensityDataBuffer(NULL), m_RGBDataBuffer(NULL)
+ToFCameraMITKPlayerDevice::ToFCameraMITKPlayerDevice()
 {
   m_Controller = ToFCameraMITKPlayerController::New();
+  m_FrameReader = m_FrameBuffer.RegisterReader();
 }
 
 ToFCameraMITKPlayerDevice::~ToFCameraMITKPlayerDevice()
 {
   DisconnectCamera();
   CleanUpDataBuffers();
+  m_FrameBuffer.UnregisterReader(m_FrameReader);
 }
 
 bool ToFCameraMITKPlayerDevice::OnConnectCamera()
@@ -77,15 +79,7 @@ void ToFCameraMITKPlayerDevice::StartCamera()
   {
     // get the first image
     this->m_Controller->UpdateCamera();
-    this->m_ImageMutex->Lock();
-    this->m_Controller->GetDistances(this->m_DistanceDataBuffer[this->m_FreePos]);
-    this->m_Controller->GetAmplitudes(this->m_AmplitudeDataBuffer[this->m_FreePos]);
-    this->m_Controller->GetIntensities(this->m_IntensityDataBuffer[this->m_FreePos]);
-    this->m_Controller->GetRgb(this->m_RGBDataBuffer[this->m_FreePos]);
-    this->m_FreePos = (this->m_FreePos+1) % this->m_BufferSize;
-    this->m_CurrentPos = (this->m_CurrentPos+1) % this->m_BufferSize;
-    this->m_ImageSequence++;
-    this->m_ImageMutex->Unlock();
+    this->WriteFrame();
 
     this->m_CameraActiveMutex->Lock();
     this->m_CameraActive = true;
@@ -105,6 +99,21 @@ void ToFCameraMITKPlayerDevice::UpdateCamera()
   m_Controller->UpdateCamera();
 }
 
+void ToFCameraMITKPlayerDevice::WriteFrame()
+{
+  // the acquisition thread is the only writer of the frame buffer, consumers never block it
+  ToFFrameRingBuffer::Frame* frame = this->m_FrameBuffer.BeginWrite();
+  if (frame == NULL)
+  {
+    return;
+  }
+  this->m_Controller->GetDistances(frame->distances.data());
+  this->m_Controller->GetAmplitudes(frame->amplitudes.data());
+  this->m_Controller->GetIntensities(frame->intensities.data());
+  this->m_Controller->GetRgb(frame->rgb.data());
+  this->m_ImageSequence = this->m_FrameBuffer.EndWrite();
+}
+
 ITK_THREAD_RETURN_TYPE ToFCameraMITKPlayerDevice::Acquire(void* pInfoStruct)
 {
   /* extract this pointer from Thread Info structure */
@@ -125,35 +134,19 @@ ITK_THREAD_RETURN_TYPE ToFCameraMITKPlayerDevice::Acquire(void* pInfoStruct)
     int n = 100;
     double t1, t2;
     t1 = realTimeClock->GetCurrentStamp();
-    bool overflow = false;
     bool printStatus = false;
     while (toFCameraDevice->IsCameraActive())
     {
       // update the ToF camera
       toFCameraDevice->UpdateCamera();
-      // get image data from controller and write it to the according buffer
-      toFCameraDevice->m_Controller->GetDistances(toFCameraDevice->m_DistanceDataBuffer[toFCameraDevice->m_FreePos]);
-      toFCameraDevice->m_Controller->GetAmplitudes(toFCameraDevice->m_AmplitudeDataBuffer[toFCameraDevice->m_FreePos]);
-      toFCameraDevice->m_Controller->GetIntensities(toFCameraDevice->m_IntensityDataBuffer[toFCameraDevice->m_FreePos]);
-      toFCameraDevice->m_Controller->GetRgb(toFCameraDevice->m_RGBDataBuffer[toFCameraDevice->m_FreePos]);
+      // get image data from controller and write it to the frame buffer
+      int previousImageSequence = toFCameraDevice->m_ImageSequence;
+      toFCameraDevice->WriteFrame();
       toFCameraDevice->Modified();
-      toFCameraDevice->m_ImageMutex->Lock();
-      toFCameraDevice->m_FreePos = (toFCameraDevice->m_FreePos+1) % toFCameraDevice->m_BufferSize;
-      toFCameraDevice->m_CurrentPos = (toFCameraDevice->m_CurrentPos+1) % toFCameraDevice->m_BufferSize;
-      toFCameraDevice->m_ImageSequence++;
-      if (toFCameraDevice->m_FreePos == toFCameraDevice->m_CurrentPos)
-      {
-        overflow = true;
-      }
-      if (toFCameraDevice->m_ImageSequence % n == 0)
+      if (toFCameraDevice->m_ImageSequence != previousImageSequence && toFCameraDevice->m_ImageSequence % n == 0)
       {
         printStatus = true;
       }
-      toFCameraDevice->m_ImageMutex->Unlock();
-      if (overflow)
-      {
-        overflow = false;
-      }
       // print current framerate
       if (printStatus)
       {
@@ -170,48 +163,56 @@ ITK_THREAD_RETURN_TYPE ToFCameraMITKPlayerDevice::Acquire(void* pInfoStruct)
 void ToFCameraMITKPlayerDevice::GetAmplitudes(float* amplitudeArray, int& imageSequence)
 {
   m_ImageMutex->Lock();
-  // write amplitude image data to float array
-  for (int i=0; i<this->m_PixelNumber; i++)
+  // write amplitude image data of the newest frame to float array
+  ToFFrameRingBuffer::Lease lease;
+  if (this->m_FrameBuffer.LeaseFrame(this->m_FrameReader, -1, lease))
   {
-    amplitudeArray[i] = this->m_AmplitudeDataBuffer[this->m_CurrentPos][i];
+    memcpy(amplitudeArray, lease.GetFrame()->amplitudes.data(), this->m_PixelNumber * sizeof(float));
+    imageSequence = lease.GetFrame()->sequence;
   }
-  imageSequence = this->m_ImageSequence;
+  lease.Release();
   m_ImageMutex->Unlock();
 }
 
 void ToFCameraMITKPlayerDevice::GetIntensities(float* intensityArray, int& imageSequence)
 {
   m_ImageMutex->Lock();
-  // write intensity image data to float array
-  for (int i=0; i<this->m_PixelNumber; i++)
+  // write intensity image data of the newest frame to float array
+  ToFFrameRingBuffer::Lease lease;
+  if (this->m_FrameBuffer.LeaseFrame(this->m_FrameReader, -1, lease))
   {
-    intensityArray[i] = this->m_IntensityDataBuffer[this->m_CurrentPos][i];
+    memcpy(intensityArray, lease.GetFrame()->intensities.data(), this->m_PixelNumber * sizeof(float));
+    imageSequence = lease.GetFrame()->sequence;
   }
-  imageSequence = this->m_ImageSequence;
+  lease.Release();
   m_ImageMutex->Unlock();
 }
 
 void ToFCameraMITKPlayerDevice::GetDistances(float* distanceArray, int& imageSequence)
 {
   m_ImageMutex->Lock();
-  // write distance image data to float array
-  for (int i=0; i<this->m_PixelNumber; i++)
+  // write distance image data of the newest frame to float array
+  ToFFrameRingBuffer::Lease lease;
+  if (this->m_FrameBuffer.LeaseFrame(this->m_FrameReader, -1, lease))
   {
-    distanceArray[i] = this->m_DistanceDataBuffer[this->m_CurrentPos][i];
+    memcpy(distanceArray, lease.GetFrame()->distances.data(), this->m_PixelNumber * sizeof(float));
+    imageSequence = lease.GetFrame()->sequence;
   }
-  imageSequence = this->m_ImageSequence;
+  lease.Release();
   m_ImageMutex->Unlock();
 }
 
 void ToFCameraMITKPlayerDevice::GetRgb(unsigned char* rgbArray, int& imageSequence)
 {
   m_ImageMutex->Lock();
-  // write intensity image data to unsigned char array
-  for (int i=0; i<this->m_RGBPixelNumber*3; i++)
+  // write rgb image data of the newest frame to unsigned char array
+  ToFFrameRingBuffer::Lease lease;
+  if (this->m_FrameBuffer.LeaseFrame(this->m_FrameReader, -1, lease))
   {
-    rgbArray[i] = this->m_RGBDataBuffer[this->m_CurrentPos][i];
+    memcpy(rgbArray, lease.GetFrame()->rgb.data(), this->m_RGBPixelNumber * 3 * sizeof(unsigned char));
+    imageSequence = lease.GetFrame()->sequence;
   }
-  imageSequence = this->m_ImageSequence;
+  lease.Release();
   m_ImageMutex->Unlock();
 }
 
@@ -220,41 +221,28 @@ void ToFCameraMITKPlayerDevice::GetAllImages(float* distanceArray, float* amplit
 {
   m_ImageMutex->Lock();
 
-  //check for empty buffer
-  if (this->m_ImageSequence < 0)
+  // the frame with the required sequence number, or the next one still in the buffer
+  ToFFrameRingBuffer::Lease lease;
+  if (!this->m_FrameBuffer.LeaseFrame(this->m_FrameReader, requiredImageSequence, lease))
   {
     // buffer empty
     MITK_INFO << "Buffer empty!! ";
-    capturedImageSequence = this->m_ImageSequence;
+    capturedImageSequence = this->m_FrameBuffer.GetLatestSequence();
     m_ImageMutex->Unlock();
     return;
   }
-  // determine position of image in buffer
-  int pos = 0;
-  if ((requiredImageSequence < 0) || (requiredImageSequence > this->m_ImageSequence))
-  {
-    capturedImageSequence = this->m_ImageSequence;
-    pos = this->m_CurrentPos;
-  }
-  else if (requiredImageSequence <= this->m_ImageSequence - this->m_BufferSize)
-  {
-    capturedImageSequence = (this->m_ImageSequence - this->m_BufferSize) + 1;
-    pos = (this->m_CurrentPos + 1) % this->m_BufferSize;
-  }
-  else // (requiredImageSequence > this->m_ImageSequence - this->m_BufferSize) && (requiredImageSequence <= this->m_ImageSequence)
-  {
-    capturedImageSequence = requiredImageSequence;
-    pos = (this->m_CurrentPos + (10-(this->m_ImageSequence - requiredImageSequence))) % this->m_BufferSize;
-  }
 
-  if(this->m_DistanceDataBuffer&&this->m_AmplitudeDataBuffer&&this->m_IntensityDataBuffer&&this->m_RGBDataBuffer)
+  // write image data to float arrays
+  const ToFFrameRingBuffer::Frame* frame = lease.GetFrame();
+  memcpy(distanceArray, frame->distances.data(), this->m_PixelNumber * sizeof(float));
+  memcpy(amplitudeArray, frame->amplitudes.data(), this->m_PixelNumber * sizeof(float));
+  memcpy(intensityArray, frame->intensities.data(), this->m_PixelNumber * sizeof(float));
+  if (rgbDataArray)
   {
-    // write image data to float arrays
-    memcpy(distanceArray, this->m_DistanceDataBuffer[pos], this->m_PixelNumber * sizeof(float));
-    memcpy(amplitudeArray, this->m_AmplitudeDataBuffer[pos], this->m_PixelNumber * sizeof(float));
-    memcpy(intensityArray, this->m_IntensityDataBuffer[pos], this->m_PixelNumber * sizeof(float));
-    memcpy(rgbDataArray, this->m_RGBDataBuffer[pos], this->m_RGBPixelNumber * 3 * sizeof(unsigned char));
+    memcpy(rgbDataArray, frame->rgb.data(), this->m_RGBPixelNumber * 3 * sizeof(unsigned char));
   }
+  capturedImageSequence = frame->sequence;
+  lease.Release();
   m_ImageMutex->Unlock();
 }
 
@@ -319,64 +307,14 @@ void ToFCameraMITKPlayerDevice::SetProperty( const char *propertyKey, BaseProper
 
 void ToFCameraMITKPlayerDevice::CleanUpDataBuffers()
 {
-  if (m_DistanceDataBuffer)
-  {
-    for(int i=0; i<this->m_MaxBufferSize; i++)
-    {
-      delete[] this->m_DistanceDataBuffer[i];
-    }
-    delete[] this->m_DistanceDataBuffer;
-  }
-  if (m_AmplitudeDataBuffer)
-  {
-    for(int i=0; i<this->m_MaxBufferSize; i++)
-    {
-      delete[] this->m_AmplitudeDataBuffer[i];
-    }
-    delete[] this->m_AmplitudeDataBuffer;
-  }
-  if (m_IntensityDataBuffer)
-  {
-    for(int i=0; i<this->m_MaxBufferSize; i++)
-    {
-      delete[] this->m_IntensityDataBuffer[i];
-    }
-    delete[] this->m_IntensityDataBuffer;
-  }
-  if (m_RGBDataBuffer)
-  {
-    for(int i=0; i<this->m_MaxBufferSize; i++)
-    {
-      delete[] this->m_RGBDataBuffer[i];
-    }
-    delete[] this->m_RGBDataBuffer;
-  }
+  this->m_FrameBuffer.Clear();
 }
 
 void ToFCameraMITKPlayerDevice::AllocateDataBuffers()
 {
   // free memory if it was already allocated
   this->CleanUpDataBuffers();
-  // allocate buffers
-  this->m_DistanceDataBuffer = new float*[this->m_MaxBufferSize];
-  for(int i=0; i<this->m_MaxBufferSize; i++)
-  {
-    this->m_DistanceDataBuffer[i] = new float[this->m_PixelNumber];
-  }
-  this->m_AmplitudeDataBuffer = new float*[this->m_MaxBufferSize];
-  for(int i=0; i<this->m_MaxBufferSize; i++)
-  {
-    this->m_AmplitudeDataBuffer[i] = new float[this->m_PixelNumber];
-  }
-  this->m_IntensityDataBuffer = new float*[this->m_MaxBufferSize];
-  for(int i=0; i<this->m_MaxBufferSize; i++)
-  {
-    this->m_IntensityDataBuffer[i] = new float[this->m_PixelNumber];
-  }
-  this->m_RGBDataBuffer = new unsigned char*[this->m_MaxBufferSize];
-  for(int i=0; i<this->m_MaxBufferSize; i++)
-  {
-    this->m_RGBDataBuffer[i] = new unsigned char[this->m_RGBPixelNumber*3];
-  }
+  // allocate the frame slots, the frame buffer adds the slots needed for its readers
+  this->m_FrameBuffer.Initialize(this->m_BufferSize, this->m_PixelNumber, this->m_RGBPixelNumber, this->m_SourceDataSize);
 }
 }
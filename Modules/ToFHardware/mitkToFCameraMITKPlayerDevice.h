@@ -117,11 +117,11 @@ namespace mitk
     */
     static ITK_THREAD_RETURN_TYPE Acquire(void* pInfoStruct);
     /*!
-    \brief Clean up memory (pixel buffers)
+    \brief Clean up memory (frame buffer)
     */
     void CleanUpDataBuffers();
     /*!
-    \brief Allocate pixel buffers
+    \brief Allocate the frame buffer
     */
     void AllocateDataBuffers();
 
@@ -130,10 +130,12 @@ namespace mitk
 
   private:
 
-    float** m_DistanceDataBuffer; ///< buffer holding the last distance images
-    float** m_AmplitudeDataBuffer; ///< buffer holding the last amplitude images
-    float** m_IntensityDataBuffer; ///< buffer holding the last intensity images
-    unsigned char** m_RGBDataBuffer; ///< buffer holding the last rgb images
+    /*!
+    \brief Reads the current images of the controller into the next slot of the frame buffer
+    */
+    void WriteFrame();
+
+    int m_FrameReader; ///< reader of the frame buffer used by the Get methods, which copy the images
 
   };
 } //END mitk namespace
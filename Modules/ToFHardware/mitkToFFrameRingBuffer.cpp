@@ -0,0 +1,271 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#include "mitkToFFrameRingBuffer.h"
+
+#include <algorithm>
+
+namespace mitk
+{
+  ToFFrameRingBuffer::Lease::Lease() : m_Buffer(NULL), m_Reader(-1), m_Frame(NULL)
+  {
+  }
+
+  ToFFrameRingBuffer::Lease::~Lease()
+  {
+    this->Release();
+  }
+
+  void ToFFrameRingBuffer::Lease::Release()
+  {
+    if (m_Buffer)
+    {
+      m_Buffer->ReleaseLease(m_Reader);
+    }
+    m_Buffer = NULL;
+    m_Reader = -1;
+    m_Frame = NULL;
+  }
+
+  ToFFrameRingBuffer::ToFFrameRingBuffer() : m_WriteSlot(-1)
+  {
+    for (int i=0; i<MaxNumberOfReaders; i++)
+    {
+      m_Leases[i].store(-1);
+      m_ReaderRegistered[i].store(false);
+      m_SkippedFrames[i].store(0);
+    }
+    m_LatestSlot.store(-1);
+    m_LatestSequence.store(0);
+    m_DroppedFrames.store(0);
+  }
+
+  ToFFrameRingBuffer::~ToFFrameRingBuffer()
+  {
+  }
+
+  void ToFFrameRingBuffer::Initialize(int numberOfSlots, int pixelNumber, int rgbPixelNumber, int sourceDataSize)
+  {
+    numberOfSlots = std::max(numberOfSlots, MaxNumberOfReaders+2);
+
+    m_Frames.assign(numberOfSlots, Frame());
+    for (int i=0; i<numberOfSlots; i++)
+    {
+      m_Frames[i].distances.assign(pixelNumber, 0.0f);
+      m_Frames[i].amplitudes.assign(pixelNumber, 0.0f);
+      m_Frames[i].intensities.assign(pixelNumber, 0.0f);
+      m_Frames[i].rgb.assign(rgbPixelNumber*3, 0);
+      m_Frames[i].sourceData.assign(sourceDataSize, 0);
+      m_Frames[i].sequence = 0;
+    }
+    std::vector<std::atomic<int> > slotSequences(numberOfSlots);
+    m_SlotSequences.swap(slotSequences);
+    for (int i=0; i<numberOfSlots; i++)
+    {
+      m_SlotSequences[i].store(0);
+    }
+
+    for (int i=0; i<MaxNumberOfReaders; i++)
+    {
+      m_Leases[i].store(-1);
+      m_SkippedFrames[i].store(0);
+    }
+    m_LatestSlot.store(-1);
+    m_LatestSequence.store(0);
+    m_DroppedFrames.store(0);
+    m_WriteSlot = -1;
+  }
+
+  void ToFFrameRingBuffer::Clear()
+  {
+    m_Frames.clear();
+    std::vector<std::atomic<int> >().swap(m_SlotSequences);
+    for (int i=0; i<MaxNumberOfReaders; i++)
+    {
+      m_Leases[i].store(-1);
+    }
+    m_LatestSlot.store(-1);
+    m_LatestSequence.store(0);
+    m_WriteSlot = -1;
+  }
+
+  bool ToFFrameRingBuffer::IsInitialized() const
+  {
+    return !m_Frames.empty();
+  }
+
+  ToFFrameRingBuffer::Frame* ToFFrameRingBuffer::BeginWrite()
+  {
+    int numberOfSlots = static_cast<int>(m_Frames.size());
+    int latestSlot = m_LatestSlot.load();
+    int firstSlot = latestSlot<0 ? 0 : latestSlot+1;
+    for (int i=0; i<numberOfSlots; i++)
+    {
+      int slot = (firstSlot+i) % numberOfSlots;
+      if (slot == latestSlot)
+      {
+        continue;
+      }
+      // Invalidate the slot before looking at the leases. A reader stores its lease before it checks the
+      // sequence of the slot, so either the producer sees the lease or the reader sees the invalid slot.
+      int previousSequence = m_SlotSequences[slot].exchange(-1);
+      bool leased = false;
+      for (int reader=0; reader<MaxNumberOfReaders; reader++)
+      {
+        leased = leased || m_Leases[reader].load() == slot;
+      }
+      if (leased)
+      {
+        m_SlotSequences[slot].store(previousSequence);
+        continue;
+      }
+      m_WriteSlot = slot;
+      return &m_Frames[slot];
+    }
+    m_WriteSlot = -1;
+    ++m_DroppedFrames;
+    return NULL;
+  }
+
+  int ToFFrameRingBuffer::EndWrite()
+  {
+    if (m_WriteSlot < 0)
+    {
+      return m_LatestSequence.load();
+    }
+    int sequence = m_LatestSequence.load()+1;
+    m_Frames[m_WriteSlot].sequence = sequence;
+    m_SlotSequences[m_WriteSlot].store(sequence);
+    m_LatestSlot.store(m_WriteSlot);
+    m_LatestSequence.store(sequence);
+    m_WriteSlot = -1;
+    return sequence;
+  }
+
+  int ToFFrameRingBuffer::RegisterReader()
+  {
+    for (int reader=0; reader<MaxNumberOfReaders; reader++)
+    {
+      bool registered = false;
+      if (m_ReaderRegistered[reader].compare_exchange_strong(registered, true))
+      {
+        m_Leases[reader].store(-1);
+        m_SkippedFrames[reader].store(0);
+        return reader;
+      }
+    }
+    return -1;
+  }
+
+  void ToFFrameRingBuffer::UnregisterReader(int reader)
+  {
+    if (reader>=0 && reader<MaxNumberOfReaders)
+    {
+      m_Leases[reader].store(-1);
+      m_ReaderRegistered[reader].store(false);
+    }
+  }
+
+  bool ToFFrameRingBuffer::LeaseFrame(int reader, int requiredSequence, Lease& lease)
+  {
+    lease.Release();
+    if (reader<0 || reader>=MaxNumberOfReaders || m_Frames.empty())
+    {
+      return false;
+    }
+    this->ReleaseLease(reader);
+
+    int numberOfSlots = static_cast<int>(m_Frames.size());
+    // a candidate only fails if the producer started to overwrite it in the meantime, which needs a whole
+    // round through the ring, hence a few attempts are sufficient
+    for (int attempt=0; attempt<numberOfSlots; attempt++)
+    {
+      int latestSequence = m_LatestSequence.load();
+      if (latestSequence <= 0)
+      {
+        return false;
+      }
+
+      int slot = -1;
+      int sequence = 0;
+      if (requiredSequence <= 0 || requiredSequence >= latestSequence)
+      {
+        slot = m_LatestSlot.load();
+        sequence = m_SlotSequences[slot].load();
+      }
+      else
+      {
+        // the oldest frame which is not older than the required one
+        for (int i=0; i<numberOfSlots; i++)
+        {
+          int slotSequence = m_SlotSequences[i].load();
+          if (slotSequence >= requiredSequence && (sequence == 0 || slotSequence < sequence))
+          {
+            slot = i;
+            sequence = slotSequence;
+          }
+        }
+      }
+      if (slot < 0 || sequence <= 0)
+      {
+        continue;
+      }
+
+      m_Leases[reader].store(slot);
+      if (m_SlotSequences[slot].load() != sequence)
+      {
+        m_Leases[reader].store(-1);
+        continue;
+      }
+
+      if (requiredSequence > 0 && sequence > requiredSequence && requiredSequence < latestSequence)
+      {
+        m_SkippedFrames[reader] += sequence-requiredSequence;
+      }
+      lease.m_Buffer = this;
+      lease.m_Reader = reader;
+      lease.m_Frame = &m_Frames[slot];
+      return true;
+    }
+    return false;
+  }
+
+  void ToFFrameRingBuffer::ReleaseLease(int reader)
+  {
+    if (reader>=0 && reader<MaxNumberOfReaders)
+    {
+      m_Leases[reader].store(-1);
+    }
+  }
+
+  int ToFFrameRingBuffer::GetLatestSequence() const
+  {
+    return m_LatestSequence.load();
+  }
+
+  unsigned long ToFFrameRingBuffer::GetNumberOfDroppedFrames() const
+  {
+    return m_DroppedFrames.load();
+  }
+
+  unsigned long ToFFrameRingBuffer::GetNumberOfSkippedFrames(int reader) const
+  {
+    if (reader<0 || reader>=MaxNumberOfReaders)
+    {
+      return 0;
+    }
+    return m_SkippedFrames[reader].load();
+  }
+}
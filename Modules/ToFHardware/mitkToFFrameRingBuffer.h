@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __mitkToFFrameRingBuffer_h
+#define __mitkToFFrameRingBuffer_h
+
+#include <MitkToFHardwareExports.h>
+
+#include <atomic>
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * @brief Lock-free ring of frame slots between the acquisition thread of a ToF device and its consumers.
+  *
+  * The acquisition thread is the only producer. It fills a slot obtained by BeginWrite() in place and publishes
+  * it with EndWrite(), which assigns the next image sequence number. Consumers register as readers and lease
+  * frames by sequence number. A leased frame is read directly from its slot and is never overwritten while the
+  * lease is held, so no consumer has to copy a frame and the producer never waits for a consumer. Each reader
+  * must only be used by one thread at a time and holds at most one lease.
+  *
+  * The producer skips leased slots and the slot of the newest frame. If no slot is free the frame is dropped.
+  * Frames which are overwritten before a reader leased them are counted as skipped for that reader.
+  *
+  * @ingroup ToFHardware
+  */
+  class MITKTOFHARDWARE_EXPORT ToFFrameRingBuffer
+  {
+  public:
+
+    /** Maximal number of readers registered at the same time */
+    static const int MaxNumberOfReaders = 4;
+
+    /** One slot of the ring, the arrays have the size given to Initialize() */
+    struct Frame
+    {
+      std::vector<float> distances;
+      std::vector<float> amplitudes;
+      std::vector<float> intensities;
+      std::vector<unsigned char> rgb;
+      std::vector<char> sourceData;
+      int sequence; ///< image sequence number, valid while the frame is leased
+    };
+
+    /**
+    * @brief Read access to one frame of the ring. The lease is returned when it is released, reused or destroyed.
+    */
+    class MITKTOFHARDWARE_EXPORT Lease
+    {
+    public:
+      Lease();
+      ~Lease();
+
+      /** \return the leased frame or NULL if nothing is leased */
+      const Frame* GetFrame() const { return m_Frame; }
+
+      void Release();
+
+    private:
+      friend class ToFFrameRingBuffer;
+      Lease(const Lease&);
+      Lease& operator=(const Lease&);
+
+      ToFFrameRingBuffer* m_Buffer;
+      int m_Reader;
+      const Frame* m_Frame;
+    };
+
+    ToFFrameRingBuffer();
+    ~ToFFrameRingBuffer();
+
+    /*!
+    \brief Allocates the slots and discards all frames. Must not be called while frames are written or leased.
+    At least MaxNumberOfReaders+2 slots are allocated, so that the producer always finds a free slot.
+    */
+    void Initialize(int numberOfSlots, int pixelNumber, int rgbPixelNumber, int sourceDataSize);
+
+    /*!
+    \brief Frees the slots. Must not be called while frames are written or leased.
+    */
+    void Clear();
+
+    bool IsInitialized() const;
+
+    /*!
+    \brief Producer: returns the slot for the next frame or NULL if all slots are leased (the frame is dropped then).
+    */
+    Frame* BeginWrite();
+
+    /*!
+    \brief Producer: publishes the slot returned by the last BeginWrite() as the newest frame.
+    \return the image sequence number of the frame
+    */
+    int EndWrite();
+
+    /*!
+    \brief Registers a reader.
+    \return the reader id used for leasing or -1 if MaxNumberOfReaders readers are registered already
+    */
+    int RegisterReader();
+
+    void UnregisterReader(int reader);
+
+    /*!
+    \brief Leases the frame with the required sequence number. If that frame is already overwritten the oldest
+    frame after it is leased, if the required sequence is negative or not yet acquired the newest frame is leased.
+    A lease the reader held before is released.
+    \return false if there is no frame yet
+    */
+    bool LeaseFrame(int reader, int requiredSequence, Lease& lease);
+
+    /** \return the sequence number of the newest frame or 0 if there is none */
+    int GetLatestSequence() const;
+
+    /** \return the number of frames dropped by the producer because all slots were leased */
+    unsigned long GetNumberOfDroppedFrames() const;
+
+    /** \return the number of frames the reader asked for but which were overwritten before */
+    unsigned long GetNumberOfSkippedFrames(int reader) const;
+
+  private:
+    ToFFrameRingBuffer(const ToFFrameRingBuffer&);
+    ToFFrameRingBuffer& operator=(const ToFFrameRingBuffer&);
+
+    void ReleaseLease(int reader);
+
+    std::vector<Frame> m_Frames;
+    std::vector<std::atomic<int> > m_SlotSequences; ///< sequence of the frame in each slot, 0 if empty and -1 while written
+
+    std::atomic<int> m_Leases[MaxNumberOfReaders]; ///< slot leased by each reader or -1
+    std::atomic<bool> m_ReaderRegistered[MaxNumberOfReaders];
+    std::atomic<unsigned long> m_SkippedFrames[MaxNumberOfReaders];
+
+    std::atomic<int> m_LatestSlot; ///< slot of the newest frame or -1
+    std::atomic<int> m_LatestSequence;
+    std::atomic<unsigned long> m_DroppedFrames;
+    int m_WriteSlot; ///< slot currently written, only accessed by the producer
+  };
+} //END mitk namespace
+#endif
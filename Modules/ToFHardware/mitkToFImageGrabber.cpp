@@ -35,7 +35,8 @@ ToFImageGrabber::ToFImageGrabber():
   m_AmplitudeArray(NULL),
   m_SourceDataArray(NULL),
   m_RgbDataArray(NULL),
-  m_DeviceObserverTag()
+  m_DeviceObserverTag(),
+  m_FrameReader(-1)
 {
   // Create the output. We use static_cast<> here because we know the default
   // output must be of type TOutputImage
@@ -65,31 +66,57 @@ ToFImageGrabber::~ToFImageGrabber()
 
 void ToFImageGrabber::GenerateData()
 {
-  int requiredImageSequence = 0;
-  // acquire new image data
-  this->m_ToFCameraDevice->GetAllImages(this->m_DistanceArray, this->m_AmplitudeArray, this->m_IntensityArray, this->m_SourceDataArray,
-                                        requiredImageSequence, this->m_ImageSequence, this->m_RgbDataArray );
+  const float* distanceArray = this->m_DistanceArray;
+  const float* amplitudeArray = this->m_AmplitudeArray;
+  const float* intensityArray = this->m_IntensityArray;
+  const unsigned char* rgbDataArray = this->m_RgbDataArray;
+
+  // Devices with frame buffer lend the newest frame, which is copied into the outputs directly.
+  // The lease has to be held until all outputs are filled.
+  ToFFrameRingBuffer::Lease lease;
+  ToFFrameRingBuffer* frameBuffer = this->m_ToFCameraDevice->GetFrameBuffer();
+  if (frameBuffer && m_FrameReader >= 0)
+  {
+    if (!frameBuffer->LeaseFrame(m_FrameReader, -1, lease))
+    {
+      // no frame acquired yet
+      return;
+    }
+    const ToFFrameRingBuffer::Frame* frame = lease.GetFrame();
+    distanceArray = frame->distances.data();
+    amplitudeArray = frame->amplitudes.data();
+    intensityArray = frame->intensities.data();
+    rgbDataArray = frame->rgb.data();
+    this->m_ImageSequence = frame->sequence;
+  }
+  else
+  {
+    int requiredImageSequence = 0;
+    // acquire new image data
+    this->m_ToFCameraDevice->GetAllImages(this->m_DistanceArray, this->m_AmplitudeArray, this->m_IntensityArray, this->m_SourceDataArray,
+                                          requiredImageSequence, this->m_ImageSequence, this->m_RgbDataArray );
+  }
 
   mitk::Image::Pointer distanceImage = this->GetOutput(0);
-  if (m_DistanceArray)
+  if (distanceArray)
   {
-    distanceImage->SetSlice(this->m_DistanceArray, 0, 0, 0);
+    distanceImage->SetSlice(distanceArray, 0, 0, 0);
   }
 
   bool hasAmplitudeImage = false;
   m_ToFCameraDevice->GetBoolProperty("HasAmplitudeImage", hasAmplitudeImage);
-  if((hasAmplitudeImage) && (m_AmplitudeArray))
+  if((hasAmplitudeImage) && (amplitudeArray))
   {
     mitk::Image::Pointer amplitudeImage = this->GetOutput(1);
-    amplitudeImage->SetSlice(this->m_AmplitudeArray, 0, 0, 0);
+    amplitudeImage->SetSlice(amplitudeArray, 0, 0, 0);
   }
 
   bool hasIntensityImage = false;
   m_ToFCameraDevice->GetBoolProperty("HasIntensityImage", hasIntensityImage);
-  if((hasIntensityImage) && (m_IntensityArray))
+  if((hasIntensityImage) && (intensityArray))
   {
     mitk::Image::Pointer intensityImage = this->GetOutput(2);
-    intensityImage->SetSlice(this->m_IntensityArray, 0, 0, 0);
+    intensityImage->SetSlice(intensityArray, 0, 0, 0);
   }
 
   bool hasRGBImage = false;
@@ -97,9 +124,9 @@ void ToFImageGrabber::GenerateData()
   if( hasRGBImage )
   {
     mitk::Image::Pointer rgbImage = this->GetOutput(3);
-    if (m_RgbDataArray)
+    if (rgbDataArray)
     {
-      rgbImage->SetSlice(this->m_RgbDataArray, 0, 0, 0);
+      rgbImage->SetSlice(rgbDataArray, 0, 0, 0);
     }
   }
 }
@@ -120,15 +147,31 @@ bool ToFImageGrabber::ConnectCamera()
     this->m_SourceDataSize = m_ToFCameraDevice->GetSourceDataSize();
     this->AllocateImageArrays();
     this->InitializeImages();
+
+    ToFFrameRingBuffer* frameBuffer = this->m_ToFCameraDevice->GetFrameBuffer();
+    if (frameBuffer && m_FrameReader < 0)
+    {
+      m_FrameReader = frameBuffer->RegisterReader();
+    }
   }
   return ok;
 }
 
 bool ToFImageGrabber::DisconnectCamera()
 {
+  this->UnregisterFrameReader();
   return m_ToFCameraDevice->DisconnectCamera();
 }
 
+void ToFImageGrabber::UnregisterFrameReader()
+{
+  if (m_FrameReader >= 0 && m_ToFCameraDevice.IsNotNull() && m_ToFCameraDevice->GetFrameBuffer())
+  {
+    m_ToFCameraDevice->GetFrameBuffer()->UnregisterReader(m_FrameReader);
+  }
+  m_FrameReader = -1;
+}
+
 void ToFImageGrabber::StartCamera()
 {
   m_ToFCameraDevice->StartCamera();
@@ -156,6 +199,7 @@ bool ToFImageGrabber::IsCameraConnected()
 
 void ToFImageGrabber::SetCameraDevice(ToFCameraDevice* aToFCameraDevice)
 {
+  this->UnregisterFrameReader();
   m_ToFCameraDevice = aToFCameraDevice;
   itk::SimpleMemberCommand<ToFImageGrabber>::Pointer modifiedCommand = itk::SimpleMemberCommand<ToFImageGrabber>::New();
   modifiedCommand->SetCallbackFunction(this, &ToFImageGrabber::OnToFCameraDeviceModified);
@@ -170,6 +170,10 @@ namespace mitk
     \brief Allocate memory for the image arrays m_IntensityArray, m_DistanceArray, m_AmplitudeArray and m_SourceDataArray
     */
     virtual void AllocateImageArrays();
+    /*!
+    \brief Returns the reader id of this grabber to the frame buffer of the device
+    */
+    void UnregisterFrameReader();
 
     /**
      * @brief InitializeImages Initialze the geometries of the images according to the device properties.
@@ -191,6 +195,7 @@ namespace mitk
     char* m_SourceDataArray;///< member holding the current source data array
     unsigned char* m_RgbDataArray; ///< member holding the current rgb data array
     unsigned long m_DeviceObserverTag; ///< tag of the observer for the ToFCameraDevice
+    int m_FrameReader; ///< reader id at the frame buffer of the device or -1 if the device has no frame buffer
     ToFImageGrabber();
 
     ~ToFImageGrabber();
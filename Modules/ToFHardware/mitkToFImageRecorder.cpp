@@ -56,6 +56,8 @@ ToFImageRecorder::ToFImageRecorder()
   this->m_IntensityArray = NULL;
   this->m_RGBArray = NULL;
   this->m_SourceDataArray = NULL;
+  this->m_FrameReader = -1;
+  this->m_NumberOfDroppedFrames = 0;
 }
 
 ToFImageRecorder::~ToFImageRecorder()
@@ -144,6 +146,14 @@ void ToFImageRecorder::StartRecording()
   this->m_ToFImageWriter->SetRGBImageSelected(this->m_RGBImageSelected);
   this->m_ToFImageWriter->Open();
 
+  // devices with frame buffer lend their frames to the writer, they are not copied into the arrays above
+  ToFFrameRingBuffer* frameBuffer = this->m_ToFCameraDevice->GetFrameBuffer();
+  if (frameBuffer && this->m_FrameReader < 0)
+  {
+    this->m_FrameReader = frameBuffer->RegisterReader();
+  }
+  this->m_NumberOfDroppedFrames = 0;
+
   this->m_AbortMutex->Lock();
   this->m_Abort = false;
   this->m_AbortMutex->Unlock();
@@ -155,6 +165,11 @@ void ToFImageRecorder::WaitForThreadBeingTerminated()
   this->m_MultiThreader->TerminateThread(this->m_ThreadID);
 }
 
+unsigned long ToFImageRecorder::GetNumberOfDroppedFrames() const
+{
+  return this->m_NumberOfDroppedFrames;
+}
+
 ITK_THREAD_RETURN_TYPE ToFImageRecorder::RecordData(void* pInfoStruct)
 {
   struct itk::MultiThreader::ThreadInfoStruct * pInfo = (struct itk::MultiThreader::ThreadInfoStruct*)pInfoStruct;
@@ -171,6 +186,8 @@ ITK_THREAD_RETURN_TYPE ToFImageRecorder::RecordData(void* pInfoStruct)
   {
 
     ToFCameraDevice::Pointer toFCameraDevice = toFImageRecorder->GetCameraDevice();
+    ToFFrameRingBuffer* frameBuffer = toFImageRecorder->m_FrameReader >= 0 ? toFCameraDevice->GetFrameBuffer() : NULL;
+    ToFFrameRingBuffer::Lease lease;
 
     mitk::RealTimeClock::Pointer realTimeClock;
     realTimeClock = mitk::RealTimeClock::New();
@@ -193,18 +210,44 @@ ITK_THREAD_RETURN_TYPE ToFImageRecorder::RecordData(void* pInfoStruct)
            (toFImageRecorder->m_RecordMode == ToFImageRecorder::Infinite) )
       {
 
-        toFCameraDevice->GetAllImages(toFImageRecorder->m_DistanceArray, toFImageRecorder->m_AmplitudeArray,
-                                      toFImageRecorder->m_IntensityArray, toFImageRecorder->m_SourceDataArray, requiredImageSequence, toFImageRecorder->m_ImageSequence, toFImageRecorder->m_RGBArray );
+        float* distanceArray = toFImageRecorder->m_DistanceArray;
+        float* amplitudeArray = toFImageRecorder->m_AmplitudeArray;
+        float* intensityArray = toFImageRecorder->m_IntensityArray;
+        unsigned char* rgbArray = toFImageRecorder->m_RGBArray;
+        bool frameAvailable = true;
+        if (frameBuffer)
+        {
+          if (frameBuffer->LeaseFrame(toFImageRecorder->m_FrameReader, requiredImageSequence, lease))
+          {
+            // the writer only reads the images, the leased frame is not modified
+            const ToFFrameRingBuffer::Frame* frame = lease.GetFrame();
+            distanceArray = const_cast<float*>(frame->distances.data());
+            amplitudeArray = const_cast<float*>(frame->amplitudes.data());
+            intensityArray = const_cast<float*>(frame->intensities.data());
+            rgbArray = const_cast<unsigned char*>(frame->rgb.data());
+            toFImageRecorder->m_ImageSequence = frame->sequence;
+          }
+          else
+          {
+            frameAvailable = false;
+          }
+        }
+        else
+        {
+          toFCameraDevice->GetAllImages(toFImageRecorder->m_DistanceArray, toFImageRecorder->m_AmplitudeArray,
+                                        toFImageRecorder->m_IntensityArray, toFImageRecorder->m_SourceDataArray, requiredImageSequence, toFImageRecorder->m_ImageSequence, toFImageRecorder->m_RGBArray );
+        }
 
-        if (toFImageRecorder->m_ImageSequence >= requiredImageSequence)
+        if (frameAvailable && toFImageRecorder->m_ImageSequence >= requiredImageSequence)
         {
-          if (toFImageRecorder->m_ImageSequence > requiredImageSequence)
+          if (toFImageRecorder->m_ImageSequence > requiredImageSequence && requiredImageSequence > 0)
           {
             MITK_INFO << "Problem! required: " << requiredImageSequence << " captured: " << toFImageRecorder->m_ImageSequence;
+            toFImageRecorder->m_NumberOfDroppedFrames += toFImageRecorder->m_ImageSequence - requiredImageSequence;
           }
           requiredImageSequence = toFImageRecorder->m_ImageSequence + 1;
-          toFImageRecorder->m_ToFImageWriter->Add( toFImageRecorder->m_DistanceArray,
-                                                   toFImageRecorder->m_AmplitudeArray, toFImageRecorder->m_IntensityArray, toFImageRecorder->m_RGBArray );
+          toFImageRecorder->m_ToFImageWriter->Add( distanceArray, amplitudeArray, intensityArray, rgbArray );
+          lease.Release();
           numOfFramesRecorded++;
           if (numOfFramesRecorded % n == 0)
           {
@@ -228,6 +271,13 @@ ITK_THREAD_RETURN_TYPE ToFImageRecorder::RecordData(void* pInfoStruct)
       }
     }  // end of while loop
 
+    lease.Release();
+    if (frameBuffer)
+    {
+      frameBuffer->UnregisterReader(toFImageRecorder->m_FrameReader);
+      toFImageRecorder->m_FrameReader = -1;
+    }
+
     toFImageRecorder->InvokeEvent(itk::AbortEvent());
 
     toFImageRecorder->m_ToFImageWriter->Close();
@@ -27,6 +27,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkFastMutexLock.h>
 #include <itkCommand.h>
 
+#include <atomic>
+
 namespace mitk
 {
 /**
@@ -39,7 +41,7 @@ namespace mitk
   *
   * @warning It is currently not guaranteed that all acquired images are recorded, since the recording
   * is done in a newly spawned thread. However, in practise only very few images are lost. See bug #12997
-  * for more details.
+  * for more details. The number of lost images is provided by GetNumberOfDroppedFrames().
   *
   * @ingroup ToFHardware
   */
@@ -125,6 +127,11 @@ public:
     \brief Wait until thread is terinated
     */
   void WaitForThreadBeingTerminated();
+  /*!
+    \brief Get the number of acquired frames which could not be recorded because they were already
+    overwritten in the buffer of the device when the recorder asked for them
+    */
+  unsigned long GetNumberOfDroppedFrames() const;
 
 protected:
 
@@ -172,6 +179,8 @@ protected:
   int m_ThreadID; ///< ID of the thread recording the data
   itk::FastMutexLock::Pointer m_AbortMutex; ///< mutex for thread-safe data access of abort flag
   bool m_Abort; ///< flag controlling the abort mechanism of the recording procedure. For thread-safety only use in combination with m_AbortMutex
+  int m_FrameReader; ///< reader id at the frame buffer of the device while recording or -1
+  std::atomic<unsigned long> m_NumberOfDroppedFrames; ///< number of frames missing in the current recording
 
 private:
 
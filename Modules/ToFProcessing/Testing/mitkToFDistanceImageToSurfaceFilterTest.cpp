@@ -379,6 +379,43 @@ int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
   }
   MITK_TEST_CONDITION_REQUIRED(compareToInput,"Testing backward transformation compared to original image with interpixeldistance");
 
+  // test Kinect reconstruction after changing the intrinsics of the already used camera
+  MITK_INFO<<"Test filter with Kinect reconstruction and modified intrinsics ";
+  filter->SetReconstructionMode(mitk::ToFDistanceImageToSurfaceFilter::Kinect);
+  cameraIntrinsics->SetFocalLength(2*focalLengthX,2*focalLengthY);
+  filter->Modified();
+  filter->Update();
+  result = filter->GetOutput()->GetVtkPolyData()->GetPoints();
+  bool kinectPointsEqual = true;
+  unsigned int numberOfValidPixels = 0;
+  {
+    mitk::ImagePixelReadAccessor<float,2> readAccess(image, image->GetSliceData());
+    for (unsigned int j=0; j<dimY; j++)
+    {
+      for (unsigned int i=0; i<dimX; i++)
+      {
+        itk::Index<2> index = {{ i, j }};
+        float distance = readAccess.GetPixelByIndex(index);
+        if (distance <= mitk::eps)
+        {
+          continue;
+        }
+        ToFPoint3D expectedPoint = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(i,j,distance,2*focalLengthX,2*focalLengthY,principalPoint[0],principalPoint[1]);
+        double* res = result->GetPoint(numberOfValidPixels++);
+        ToFPoint3D resultPoint;
+        resultPoint[0] = res[0];
+        resultPoint[1] = res[1];
+        resultPoint[2] = res[2];
+        if (!mitk::Equal(expectedPoint,resultPoint))
+        {
+          kinectPointsEqual = false;
+        }
+      }
+    }
+  }
+  MITK_TEST_CONDITION_REQUIRED(numberOfValidPixels==result->GetNumberOfPoints(),"Test if number of points in Kinect surface is equal");
+  MITK_TEST_CONDITION_REQUIRED(kinectPointsEqual,"Testing Kinect reconstruction with modified intrinsics");
+
   //clean up
   delete point;
   //  expectedResult->Delete();
@@ -26,6 +26,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolyData.h>
 #include <vtkPointData.h>
 #include <vtkFloatArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
 
@@ -99,8 +101,7 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   int xDimension = input->GetDimension(0);
   int yDimension = input->GetDimension(1);
   unsigned int size = xDimension*yDimension; //size of the image-array
-  std::vector<bool> isPointValid;
-  isPointValid.resize(size);
+  std::vector<char> isPointValid(size);
   vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
   points->SetDataTypeToDouble();
   vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
@@ -108,19 +109,12 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
   vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
   textureCoords->SetNumberOfComponents(2);
-  textureCoords->Allocate(size);
 
   //Make a vtkIdList to save the ID's of the polyData corresponding to the image
-  //pixel ID's. See below for more documentation.
+  //pixel ID's. Pixels without a valid distance are mapped to 0.
   m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
-  //Allocate the object once else it would automatically allocate new memory
-  //for every vertex and perform a copy which is expensive.
-  m_VertexIdList->Allocate(size);
   m_VertexIdList->SetNumberOfIds(size);
-  for(unsigned int i = 0; i < size; ++i)
-  {
-    m_VertexIdList->SetId(i, 0);
-  }
+  vtkIdType* vertexIds = m_VertexIdList->GetPointer(0);
 
   float* scalarFloatData = nullptr;
 
@@ -136,158 +130,202 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
 
   ImageReadAccessor inputAcc(input, input->GetSliceData(0,0,0));
   float* inputFloatData = (float*)inputAcc.GetData();
-  //calculate world coordinates
-  mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
-  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm;
-  if((m_ReconstructionMode == WithOutInterPixelDistance) || (m_ReconstructionMode == Kinect))
+
+  /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
+  * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
+  * due to cropping or the spacing differes due to up- or downsampling.*/
+  this->UpdateRayTable(xDimension, yDimension, input->GetGeometry()->GetOrigin(), input->GetGeometry()->GetSpacing());
+  const mitk::ToFProcessingCommon::ToFScalarType* rayNumerators = m_RayNumerators.data();
+  const mitk::ToFProcessingCommon::ToFScalarType* rayDenominators = m_RayDenominators.data();
+
+  //Points are only created for valid pixels. Their ID's are assigned in pixel order,
+  //hence every row first counts its valid pixels to know the ID of its first point.
+  //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
+  std::vector<vtkIdType> firstPointOfRow(yDimension+1, 0);
+#pragma omp parallel for
+  for (int j=0; j<yDimension; j++)
   {
-    focalLengthInPixelUnits[0] = m_CameraIntrinsics->GetFocalLengthX();
-    focalLengthInPixelUnits[1] = m_CameraIntrinsics->GetFocalLengthY();
+    vtkIdType numberOfValidPoints = 0;
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      isPointValid[pixelID] = (double)inputFloatData[pixelID] > mitk::eps;
+      numberOfValidPoints += isPointValid[pixelID];
+    }
+    firstPointOfRow[j+1] = numberOfValidPoints;
   }
-  else if( m_ReconstructionMode == WithInterPixelDistance)
+  for (int j=0; j<yDimension; j++)
   {
-    //convert focallength from pixel to mm
-    focalLengthInMm = (m_CameraIntrinsics->GetFocalLengthX()*m_InterPixelDistance[0]+m_CameraIntrinsics->GetFocalLengthY()*m_InterPixelDistance[1])/2.0;
+    firstPointOfRow[j+1] += firstPointOfRow[j];
   }
+  vtkIdType numberOfPoints = firstPointOfRow[yDimension];
 
-  mitk::ToFProcessingCommon::ToFPoint2D principalPoint;
-  principalPoint[0] = m_CameraIntrinsics->GetPrincipalPointX();
-  principalPoint[1] = m_CameraIntrinsics->GetPrincipalPointY();
-
-  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
-  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+  points->SetNumberOfPoints(numberOfPoints);
+  textureCoords->SetNumberOfTuples(numberOfPoints);
+  if (scalarFloatData)
+  {
+    scalarArray->SetNumberOfTuples(numberOfPoints);
+  }
+  double* pointData = numberOfPoints>0 ? static_cast<vtkDoubleArray*>(points->GetData())->GetPointer(0) : nullptr;
+  float* textureCoordsData = numberOfPoints>0 ? textureCoords->GetPointer(0) : nullptr;
+  float* scalarData = (scalarFloatData && numberOfPoints>0) ? scalarArray->GetPointer(0) : nullptr;
 
+  //calculate world coordinates, the distance scales the precomputed ray of the pixel
+#pragma omp parallel for
   for (int j=0; j<yDimension; j++)
   {
+    vtkIdType pointID = firstPointOfRow[j];
     for (int i=0; i<xDimension; i++)
     {
       unsigned int pixelID = i+j*xDimension;
-
-      mitk::ToFProcessingCommon::ToFScalarType distance = (double)inputFloatData[pixelID];
-
-      /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
-      * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
-      * due to cropping or the spacing differes due to up- or downsampling.*/
-      unsigned int completeIndexX = i*spacing[0]+origin[0];
-      unsigned int completeIndexY = j*spacing[1]+origin[1];
-
-      mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates;
-      switch (m_ReconstructionMode)
+      if (!isPointValid[pixelID])
       {
-      case WithOutInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
+        vertexIds[pixelID] = 0;
+        continue;
       }
-      case WithInterPixelDistance:
+      vertexIds[pixelID] = pointID;
+
+      mitk::ToFProcessingCommon::ToFScalarType distance = (double)inputFloatData[pixelID];
+      for (int c=0; c<3; c++)
       {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
-        break;
+        pointData[3*pointID+c] = distance*rayNumerators[3*pixelID+c]/rayDenominators[3*pixelID+c];
       }
-      case Kinect:
+
+      //Scalar values are necessary for mapping colors/texture onto the surface
+      if (scalarData)
       {
-        cartesianCoordinates = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
+        scalarData[pointID] = scalarFloatData[pixelID];
       }
-      default:
+      //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
+      textureCoordsData[2*pointID] = (((float)i)/xDimension);// correct video texture scale for kinect
+      textureCoordsData[2*pointID+1] = ((float)j)/yDimension; //don't flip. we don't need to flip.
+      pointID++;
+    }
+  }
+
+  //Decide for every valid pixel whether it closes two triangles, stays a single vertex or
+  //produces no cell at all. The cells are then written in pixel order, like the points.
+  enum CellType { NoCell = 0, TwoTriangles = 1, SingleVertex = 2 };
+  std::vector<char> cellTypes(size, NoCell);
+  std::vector<vtkIdType> firstTriangleOfRow(yDimension+1, 0);
+  std::vector<vtkIdType> firstVertexOfRow(yDimension+1, 0);
+#pragma omp parallel for
+  for (int j=0; j<yDimension; j++)
+  {
+    vtkIdType numberOfTriangles = 0;
+    vtkIdType numberOfVertices = 0;
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      if (!isPointValid[pixelID])
       {
-        MITK_ERROR << "Incorrect reconstruction mode!";
-      }
+        continue;
       }
-      //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
-      if (distance<=mitk::eps)
+
+      if (!m_GenerateTriangularMesh)
       {
-        isPointValid[pixelID] = false;
+        //We dont want triangulation, we only want vertices
+        cellTypes[pixelID] = SingleVertex;
       }
-      else
+      else if ((i >= 1) && (j >= 1))
       {
-        isPointValid[pixelID] = true;
-        //VTK would insert empty points into the polydata if we use
-        //points->InsertPoint(pixelID, cartesianCoordinates.GetDataPointer()).
-        //If we use points->InsertNextPoint(...) instead, the ID's do not
-        //correspond to the image pixel ID's. Thus, we have to save them
-        //in the vertexIdList.
-        m_VertexIdList->SetId(pixelID, points->InsertNextPoint(cartesianCoordinates.GetDataPointer()));
-
-        if (m_GenerateTriangularMesh)
+        //This little piece of art explains the ID's:
+        //
+        // P(x_1y_1)---P(xy_1)
+        // |           |
+        // |           |
+        // |           |
+        // P(x_1y)-----P(xy)
+        //
+        //We can only start triangulation if we are at vertex (1,1),
+        //because we need the other 3 vertices near this one.
+        //To go one pixel line back in the image array, we have to
+        //subtract 1x xDimension.
+        vtkIdType xy = pixelID;
+        vtkIdType x_1y = pixelID-1;
+        vtkIdType xy_1 = pixelID-xDimension;
+        vtkIdType x_1y_1 = xy_1-1;
+
+        if (isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1]) // check if points of cell are valid
         {
-          if((i >= 1) && (j >= 1))
+          double* pointXY = pointData + 3*vertexIds[xy];
+          double* pointX_1Y = pointData + 3*vertexIds[x_1y];
+          double* pointXY_1 = pointData + 3*vertexIds[xy_1];
+          double* pointX_1Y_1 = pointData + 3*vertexIds[x_1y_1];
+
+          if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
+                                                               && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
+                                                               && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
+                                                               && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
           {
-            //This little piece of art explains the ID's:
-            //
-            // P(x_1y_1)---P(xy_1)
-            // |           |
-            // |           |
-            // |           |
-            // P(x_1y)-----P(xy)
-            //
-            //We can only start triangulation if we are at vertex (1,1),
-            //because we need the other 3 vertices near this one.
-            //To go one pixel line back in the image array, we have to
-            //subtract 1x xDimension.
-            vtkIdType xy = pixelID;
-            vtkIdType x_1y = pixelID-1;
-            vtkIdType xy_1 = pixelID-xDimension;
-            vtkIdType x_1y_1 = xy_1-1;
-
-            //Find the corresponding vertex ID's in the saved vertexIdList:
-            vtkIdType xyV = m_VertexIdList->GetId(xy);
-            vtkIdType x_1yV = m_VertexIdList->GetId(x_1y);
-            vtkIdType xy_1V = m_VertexIdList->GetId(xy_1);
-            vtkIdType x_1y_1V = m_VertexIdList->GetId(x_1y_1);
-
-            if (isPointValid[xy]&&isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1]) // check if points of cell are valid
-            {
-              double pointXY[3], pointX_1Y[3], pointXY_1[3], pointX_1Y_1[3];
-
-              points->GetPoint(xyV, pointXY);
-              points->GetPoint(x_1yV, pointX_1Y);
-              points->GetPoint(xy_1V, pointXY_1);
-              points->GetPoint(x_1y_1V, pointX_1Y_1);
-
-              if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
-              {
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1yV);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(x_1y_1V);
-
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1y_1V);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(xy_1V);
-              }
-              else
-              {
-                //We dont want triangulation, but we want to keep the vertex
-                vertices->InsertNextCell(1);
-                vertices->InsertCellPoint(xyV);
-              }
-            }
+            cellTypes[pixelID] = TwoTriangles;
+          }
+          else
+          {
+            //We dont want triangulation, but we want to keep the vertex
+            cellTypes[pixelID] = SingleVertex;
           }
         }
-        else
-        {
-          //We dont want triangulation, we only want vertices
-          vertices->InsertNextCell(1);
-          vertices->InsertCellPoint(m_VertexIdList->GetId(pixelID));
-        }
-        //Scalar values are necessary for mapping colors/texture onto the surface
-        if (scalarFloatData)
-        {
-          scalarArray->InsertTuple1(m_VertexIdList->GetId(pixelID), scalarFloatData[pixelID]);
-        }
-        //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
-        float xNorm = (((float)i)/xDimension);// correct video texture scale for kinect
-        float yNorm = ((float)j)/yDimension; //don't flip. we don't need to flip.
-        textureCoords->InsertTuple2(m_VertexIdList->GetId(pixelID), xNorm, yNorm);
       }
+
+      numberOfTriangles += (cellTypes[pixelID] == TwoTriangles) ? 2 : 0;
+      numberOfVertices += (cellTypes[pixelID] == SingleVertex) ? 1 : 0;
     }
+    firstTriangleOfRow[j+1] = numberOfTriangles;
+    firstVertexOfRow[j+1] = numberOfVertices;
+  }
+  for (int j=0; j<yDimension; j++)
+  {
+    firstTriangleOfRow[j+1] += firstTriangleOfRow[j];
+    firstVertexOfRow[j+1] += firstVertexOfRow[j];
   }
 
+  //legacy cell array layout: number of points followed by the point ids, for each cell
+  vtkIdType numberOfTriangles = firstTriangleOfRow[yDimension];
+  vtkIdType numberOfVertices = firstVertexOfRow[yDimension];
+  vtkSmartPointer<vtkIdTypeArray> polyCells = vtkSmartPointer<vtkIdTypeArray>::New();
+  polyCells->SetNumberOfValues(4*numberOfTriangles);
+  vtkSmartPointer<vtkIdTypeArray> vertexCells = vtkSmartPointer<vtkIdTypeArray>::New();
+  vertexCells->SetNumberOfValues(2*numberOfVertices);
+  vtkIdType* polyCellData = numberOfTriangles>0 ? polyCells->GetPointer(0) : nullptr;
+  vtkIdType* vertexCellData = numberOfVertices>0 ? vertexCells->GetPointer(0) : nullptr;
+
+#pragma omp parallel for
+  for (int j=0; j<yDimension; j++)
+  {
+    vtkIdType* polyCell = polyCellData + 4*firstTriangleOfRow[j];
+    vtkIdType* vertexCell = vertexCellData + 2*firstVertexOfRow[j];
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      if (cellTypes[pixelID] == TwoTriangles)
+      {
+        //Find the corresponding vertex ID's in the saved vertexIdList:
+        vtkIdType xyV = vertexIds[pixelID];
+        vtkIdType x_1yV = vertexIds[pixelID-1];
+        vtkIdType xy_1V = vertexIds[pixelID-xDimension];
+        vtkIdType x_1y_1V = vertexIds[pixelID-xDimension-1];
+
+        *(polyCell++) = 3;
+        *(polyCell++) = x_1yV;
+        *(polyCell++) = xyV;
+        *(polyCell++) = x_1y_1V;
+
+        *(polyCell++) = 3;
+        *(polyCell++) = x_1y_1V;
+        *(polyCell++) = xyV;
+        *(polyCell++) = xy_1V;
+      }
+      else if (cellTypes[pixelID] == SingleVertex)
+      {
+        *(vertexCell++) = 1;
+        *(vertexCell++) = vertexIds[pixelID];
+      }
+    }
+  }
+  polys->SetCells(numberOfTriangles, polyCells);
+  vertices->SetCells(numberOfVertices, vertexCells);
+
   vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
   mesh->SetPoints(points);
   mesh->SetPolys(polys);
@@ -302,6 +340,104 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   output->SetVtkPolyData(mesh);
 }
 
+void mitk::ToFDistanceImageToSurfaceFilter::UpdateRayTable(int xDimension, int yDimension, const mitk::Point3D& origin, const mitk::Vector3D& spacing)
+{
+  std::vector<double> parameters;
+  parameters.push_back(xDimension);
+  parameters.push_back(yDimension);
+  parameters.push_back(origin[0]);
+  parameters.push_back(origin[1]);
+  parameters.push_back(spacing[0]);
+  parameters.push_back(spacing[1]);
+  parameters.push_back(m_ReconstructionMode);
+  parameters.push_back(m_CameraIntrinsics->GetFocalLengthX());
+  parameters.push_back(m_CameraIntrinsics->GetFocalLengthY());
+  parameters.push_back(m_CameraIntrinsics->GetPrincipalPointX());
+  parameters.push_back(m_CameraIntrinsics->GetPrincipalPointY());
+  parameters.push_back(m_InterPixelDistance[0]);
+  parameters.push_back(m_InterPixelDistance[1]);
+  if (parameters == m_RayTableParameters)
+  {
+    return;
+  }
+
+  mitk::ToFProcessingCommon::ToFScalarType focalLengthX = m_CameraIntrinsics->GetFocalLengthX();
+  mitk::ToFProcessingCommon::ToFScalarType focalLengthY = m_CameraIntrinsics->GetFocalLengthY();
+  mitk::ToFProcessingCommon::ToFScalarType principalPointX = m_CameraIntrinsics->GetPrincipalPointX();
+  mitk::ToFProcessingCommon::ToFScalarType principalPointY = m_CameraIntrinsics->GetPrincipalPointY();
+  //convert focallength from pixel to mm
+  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm = (focalLengthX*m_InterPixelDistance[0]+focalLengthY*m_InterPixelDistance[1])/2.0;
+
+  unsigned int size = xDimension*yDimension;
+  m_RayNumerators.resize(3*size);
+  m_RayDenominators.resize(3*size);
+
+  //The terms follow ToFProcessingCommon::IndexToCartesianCoordinates(), IndexToCartesianCoordinatesWithInterpixdist()
+  //and KinectIndexToCartesianCoordinates() to give identical results.
+#pragma omp parallel for
+  for (int j=0; j<yDimension; j++)
+  {
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      mitk::ToFProcessingCommon::ToFScalarType* numerator = &m_RayNumerators[3*pixelID];
+      mitk::ToFProcessingCommon::ToFScalarType* denominator = &m_RayDenominators[3*pixelID];
+
+      unsigned int completeIndexX = i*spacing[0]+origin[0];
+      unsigned int completeIndexY = j*spacing[1]+origin[1];
+
+      switch (m_ReconstructionMode)
+      {
+      case WithOutInterPixelDistance:
+      {
+        mitk::ToFProcessingCommon::ToFScalarType imageX = completeIndexX - principalPointX;
+        mitk::ToFProcessingCommon::ToFScalarType imageY = completeIndexY - principalPointY;
+        mitk::ToFProcessingCommon::ToFScalarType imageY_in_pX = imageY * (focalLengthX / focalLengthY);
+        mitk::ToFProcessingCommon::ToFScalarType d_in_pX = sqrt(imageX*imageX + imageY_in_pX*imageY_in_pX + focalLengthX*focalLengthX);
+        numerator[0] = imageX;
+        numerator[1] = imageY_in_pX;
+        numerator[2] = focalLengthX;
+        denominator[0] = denominator[1] = denominator[2] = d_in_pX;
+        break;
+      }
+      case WithInterPixelDistance:
+      {
+        mitk::ToFProcessingCommon::ToFScalarType imageX = (( completeIndexX - principalPointX ) * m_InterPixelDistance[0]);
+        mitk::ToFProcessingCommon::ToFScalarType imageY = (( completeIndexY - principalPointY ) * m_InterPixelDistance[1]);
+        mitk::ToFProcessingCommon::ToFScalarType d = sqrt(imageX*imageX + imageY*imageY + focalLengthInMm*focalLengthInMm);
+        numerator[0] = imageX;
+        numerator[1] = imageY;
+        numerator[2] = focalLengthInMm;
+        denominator[0] = denominator[1] = denominator[2] = d;
+        break;
+      }
+      case Kinect:
+      {
+        numerator[0] = completeIndexX - principalPointX;
+        numerator[1] = completeIndexY - principalPointY;
+        numerator[2] = 1;
+        denominator[0] = focalLengthX;
+        denominator[1] = focalLengthY;
+        denominator[2] = 1;
+        break;
+      }
+      default:
+      {
+        numerator[0] = numerator[1] = numerator[2] = 0;
+        denominator[0] = denominator[1] = denominator[2] = 1;
+      }
+      }
+    }
+  }
+
+  if (m_ReconstructionMode != WithOutInterPixelDistance && m_ReconstructionMode != WithInterPixelDistance && m_ReconstructionMode != Kinect)
+  {
+    MITK_ERROR << "Incorrect reconstruction mode!";
+  }
+
+  m_RayTableParameters = parameters;
+}
+
 void mitk::ToFDistanceImageToSurfaceFilter::CreateOutputsForAllInputs()
 {
   this->SetNumberOfOutputs(this->GetNumberOfInputs());  // create outputs for all inputs
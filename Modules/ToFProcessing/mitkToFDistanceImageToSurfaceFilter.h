@@ -29,6 +29,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
 
+#include <vector>
+
 namespace mitk
 {
   /**
@@ -172,6 +174,16 @@ namespace mitk
     */
     void CreateOutputsForAllInputs();
 
+    /*!
+    \brief Computes the unprojection of all pixels if the camera intrinsics, the reconstruction mode or the
+    size, spacing or origin of the input changed since the last call.
+
+    The point of pixel k with distance d is (d*n[3k+c])/m[3k+c] for c = 0..2, with the numerators n and the
+    denominators m of the table. This is exactly the computation of the ToFProcessingCommon conversion
+    functions, but each frame needs only one multiplication and division per coordinate.
+    */
+    void UpdateRayTable(int xDimension, int yDimension, const mitk::Point3D& origin, const mitk::Vector3D& spacing);
+
     IplImage* m_IplScalarImage; ///< Scalar image used for surface texturing
 
     mitk::CameraIntrinsics::Pointer m_CameraIntrinsics; ///< Specifies the intrinsic parameters
@@ -189,6 +201,10 @@ namespace mitk
 
     double m_TriangulationThreshold;
 
+    std::vector<ToFProcessingCommon::ToFScalarType> m_RayNumerators; ///< per pixel numerators of the x, y and z coordinate, see UpdateRayTable()
+    std::vector<ToFProcessingCommon::ToFScalarType> m_RayDenominators; ///< per pixel denominators of the x, y and z coordinate, see UpdateRayTable()
+    std::vector<double> m_RayTableParameters; ///< intrinsics, mode and input geometry the ray table was computed for
+
   };
 } //END mitk namespace
 #endif
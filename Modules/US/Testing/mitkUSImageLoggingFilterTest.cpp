@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkUSImageLoggingFilter.h"
+#include "mitkUSImageRecordingSource.h"
 #include <mitkTestingMacros.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingConfig.h>
@@ -25,6 +26,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIMimeTypeProvider.h>
 
 #include "mitkImageGenerator.h"
+#include <mitkImageReadAccessor.h>
 
 #include "itksys/SystemTools.hxx"
 
@@ -40,6 +42,8 @@ class mitkUSImageLoggingFilterTestSuite : public mitk::TestFixture
   MITK_TEST(TestSavingAfterMupltipleUpdateCalls);
   MITK_TEST(TestFilterWithEmptyImages);
   MITK_TEST(TestFilterWithInvalidPath);
+  MITK_TEST(TestStreamingRecording);
+  MITK_TEST(TestRecordingWithFullFramePool);
   //MITK_TEST(TestJpgFileExtension); //bug 19614
   CPPUNIT_TEST_SUITE_END();
 
@@ -162,6 +166,74 @@ public:
                                mitk::Exception);
   }
 
+  void TestStreamingRecording()
+  {
+  std::string filename = m_TemporaryTestDirectory + "/mitkUSImageLoggingFilterTest.usrec";
+  m_TestFilter->SetInput(m_RandomSingleSliceImage);
+  m_TestFilter->StartRecording(filename);
+  CPPUNIT_ASSERT_MESSAGE("Testing if recording is running",m_TestFilter->GetIsRecording());
+
+  for(int i=0; i<5; i++)
+    {
+    m_TestFilter->Modified();
+    m_TestFilter->Update();
+    if (i==2) m_TestFilter->AddMessageToCurrentImage("testmessage");
+    itksys::SystemTools::Delay(10);
+    }
+  m_TestFilter->StopRecording();
+  CPPUNIT_ASSERT_MESSAGE("Testing if recording is stopped",!m_TestFilter->GetIsRecording());
+  CPPUNIT_ASSERT_MESSAGE("Testing number of recorded frames",m_TestFilter->GetNumberOfRecordedFrames() == 5);
+
+  mitk::USImageRecordingSource::Pointer source = mitk::USImageRecordingSource::New();
+  source->Open(filename);
+  CPPUNIT_ASSERT_MESSAGE("Testing number of frames in the recording",source->GetNumberOfFrames() == 5);
+  CPPUNIT_ASSERT_MESSAGE("Testing message of frame 2",source->GetFrameMessage(2) == "testmessage");
+  CPPUNIT_ASSERT_MESSAGE("Testing that frame 3 has no message",source->GetFrameMessage(3).empty());
+  CPPUNIT_ASSERT_MESSAGE("Testing timestamps",source->GetFrameTimestamp(4) > source->GetFrameTimestamp(0));
+
+  mitk::Image::Pointer frame = source->GetFrame(4);
+  CPPUNIT_ASSERT_MESSAGE("Testing pixel type of the frame",frame->GetPixelType() == m_RandomSingleSliceImage->GetPixelType());
+  CPPUNIT_ASSERT_MESSAGE("Testing size of the frame",frame->GetDimension(0) == 100 && frame->GetDimension(1) == 100);
+  mitk::ImageReadAccessor frameAccessor(frame);
+  mitk::ImageReadAccessor inputAccessor(m_RandomSingleSliceImage);
+  CPPUNIT_ASSERT_MESSAGE("Testing pixel data of the frame",
+                         memcmp(frameAccessor.GetData(), inputAccessor.GetData(), 100*100*sizeof(float)) == 0);
+
+  //playback starts again after the last frame
+  source->SetCurrentFrame(4);
+  CPPUNIT_ASSERT_MESSAGE("Testing playback of the last frame",source->GetNextImage().IsNotNull());
+  CPPUNIT_ASSERT_MESSAGE("Testing playback restart",source->GetNextImage().IsNotNull() && source->GetCurrentFrame() == 1);
+
+  source->Close();
+  std::remove(filename.c_str());
+  }
+
+  void TestRecordingWithFullFramePool()
+  {
+  std::string filename = m_TemporaryTestDirectory + "/mitkUSImageLoggingFilterTest2.usrec";
+  m_TestFilter->SetInput(m_RandomRestImage1);
+  m_TestFilter->StartRecording(filename, 1);
+
+  for(int i=0; i<20; i++)
+    {
+    m_TestFilter->Modified();
+    m_TestFilter->Update();
+    }
+  m_TestFilter->StopRecording();
+
+  //with a single frame in the pool images may be dropped, but every accepted one is written
+  CPPUNIT_ASSERT_MESSAGE("Testing number of recorded and dropped frames",
+                         m_TestFilter->GetNumberOfRecordedFrames() + m_TestFilter->GetNumberOfDroppedFrames() == 20);
+  mitk::USImageRecordingSource::Pointer source = mitk::USImageRecordingSource::New();
+  source->Open(filename);
+  CPPUNIT_ASSERT_MESSAGE("Testing number of frames in the recording",
+                         source->GetNumberOfFrames() == m_TestFilter->GetNumberOfRecordedFrames());
+  CPPUNIT_ASSERT_MESSAGE("Testing dimension of the frames",source->GetFrame(0)->GetDimension(2) == 100);
+
+  source->Close();
+  std::remove(filename.c_str());
+  }
+
   void TestJpgFileExtension()
   {
   CPPUNIT_ASSERT_MESSAGE("Testing setting of jpg extension.",m_TestFilter->SetImageFilesExtension(".jpg"));
@@ -23,15 +23,33 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIOMimeTypes.h>
 #include <mitkCoreServices.h>
 #include <mitkIMimeTypeProvider.h>
+#include <mitkImageReadAccessor.h>
+
+#include <cstring>
 
 
 mitk::USImageLoggingFilter::USImageLoggingFilter() : m_SystemTimeClock(RealTimeClock::New()),
-                                                     m_ImageExtension(".nrrd")
+                                                     m_ImageExtension(".nrrd"),
+                                                     m_RecordingCondition(itk::ConditionVariable::New()),
+                                                     m_MultiThreader(itk::MultiThreader::New()),
+                                                     m_RecordingThreadID(-1),
+                                                     m_IsRecording(false),
+                                                     m_StopRecording(false),
+                                                     m_NumberOfRecordedFrames(0),
+                                                     m_NumberOfDroppedFrames(0)
 {
 }
 
 mitk::USImageLoggingFilter::~USImageLoggingFilter()
 {
+  try
+  {
+    this->StopRecording();
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_ERROR << e.GetDescription();
+  }
 }
 
 void mitk::USImageLoggingFilter::GenerateData()
@@ -45,6 +63,13 @@ void mitk::USImageLoggingFilter::GenerateData()
     return;
     }
 
+  //images are streamed to disk during a recording, no clone is kept
+  if (m_IsRecording)
+    {
+    this->RecordImage(inputImage);
+    return;
+    }
+
   //a clone is needed for a output and to store it.
   mitk::Image::Pointer inputClone = inputImage->Clone();
 
@@ -83,6 +108,11 @@ void mitk::USImageLoggingFilter::GenerateData()
 
 void mitk::USImageLoggingFilter::AddMessageToCurrentImage(std::string message)
 {
+  if (m_IsRecording)
+    {
+    m_RecordedMessages.insert(std::make_pair(static_cast<int>(m_NumberOfRecordedFrames)-1,message));
+    return;
+    }
   m_LoggedMessages.insert(std::make_pair(static_cast<int>(m_LoggedImages.size()-1),message));
 }
 
@@ -163,3 +193,203 @@ bool mitk::USImageLoggingFilter::SetImageFilesExtension(std::string extension)
   }
   return false;
  }
+
+void mitk::USImageLoggingFilter::StartRecording(const std::string& filename, unsigned int framePoolSize)
+{
+  if (m_IsRecording)
+    {
+    mitkThrow() << "A recording is already running!";
+    }
+  if (framePoolSize == 0)
+    {
+    mitkThrow() << "The frame pool of a recording needs at least one frame!";
+    }
+
+  m_RecordingWriter.Open(filename);
+
+  //preallocate the frames for the current input, later images of the same size need no allocations
+  size_t frameSize = 0;
+  mitk::Image::ConstPointer inputImage = this->GetInput();
+  if (inputImage.IsNotNull() && !inputImage->IsEmpty())
+    {
+    frameSize = inputImage->GetPixelType().GetSize();
+    for (unsigned int i=0; i<3; i++) frameSize *= inputImage->GetDimension(i);
+    }
+
+  m_FramePool.resize(framePoolSize);
+  m_FreeFrames.clear();
+  for (unsigned int i=0; i<framePoolSize; i++)
+    {
+    m_FramePool[i].data.reserve(frameSize);
+    m_FreeFrames.push_back(i);
+    }
+  m_QueuedFrames.clear();
+  m_RecordedMessages.clear();
+  m_RecordingPixelType.reset();
+  m_NumberOfRecordedFrames = 0;
+  m_NumberOfDroppedFrames = 0;
+  m_RecordingError.clear();
+  m_StopRecording = false;
+  m_IsRecording = true;
+
+  m_RecordingThreadID = m_MultiThreader->SpawnThread(RecordingThread, this);
+}
+
+void mitk::USImageLoggingFilter::StopRecording()
+{
+  if (!m_IsRecording)
+    {
+    return;
+    }
+
+  m_RecordingMutex.Lock();
+  m_StopRecording = true;
+  m_RecordingCondition->Signal();
+  m_RecordingMutex.Unlock();
+
+  //waits until the thread has written all queued frames
+  m_MultiThreader->TerminateThread(m_RecordingThreadID);
+  m_RecordingThreadID = -1;
+  m_IsRecording = false;
+
+  std::string error = m_RecordingError;
+  try
+    {
+    m_RecordingWriter.Close(m_RecordedMessages);
+    }
+  catch (const mitk::Exception& e)
+    {
+    if (error.empty()) error = e.GetDescription();
+    }
+
+  //release the memory of the frame pool
+  std::vector<USImageRecordingWriter::Frame>().swap(m_FramePool);
+  m_FreeFrames.clear();
+
+  if (m_NumberOfDroppedFrames > 0)
+    {
+    MITK_WARN << m_NumberOfDroppedFrames << " images were dropped during the recording.";
+    }
+  if (!error.empty())
+    {
+    mitkThrow() << "Recording failed: " << error;
+    }
+}
+
+bool mitk::USImageLoggingFilter::GetIsRecording() const
+{
+  return m_IsRecording;
+}
+
+unsigned int mitk::USImageLoggingFilter::GetNumberOfRecordedFrames() const
+{
+  return m_NumberOfRecordedFrames;
+}
+
+unsigned int mitk::USImageLoggingFilter::GetNumberOfDroppedFrames() const
+{
+  return m_NumberOfDroppedFrames;
+}
+
+void mitk::USImageLoggingFilter::RecordImage(const mitk::Image* image)
+{
+  //all frames of a recording share the pixel type of the first one
+  const mitk::PixelType pixelType = image->GetPixelType();
+  if (!m_RecordingPixelType)
+    {
+    m_RecordingPixelType.reset(new mitk::PixelType(pixelType));
+    }
+  else if (!(*m_RecordingPixelType == pixelType))
+    {
+    MITK_WARN << "Pixel type of the image differs from the recording. Image is dropped!";
+    m_NumberOfDroppedFrames++;
+    return;
+    }
+
+  m_RecordingMutex.Lock();
+  if (m_FreeFrames.empty())
+    {
+    m_RecordingMutex.Unlock();
+    m_NumberOfDroppedFrames++;
+    return;
+    }
+  unsigned int index = m_FreeFrames.back();
+  m_FreeFrames.pop_back();
+  m_RecordingMutex.Unlock();
+
+  //the frame is not shared until it is queued
+  USImageRecordingWriter::Frame& frame = m_FramePool[index];
+  frame.componentType = pixelType.GetComponentType();
+  frame.pixelType = pixelType.GetPixelType();
+  frame.numberOfComponents = static_cast<unsigned int>(pixelType.GetNumberOfComponents());
+  frame.bytesPerComponent = static_cast<unsigned int>(pixelType.GetBitsPerComponent() / 8);
+  size_t frameSize = pixelType.GetSize();
+  for (unsigned int i=0; i<3; i++)
+    {
+    frame.dimensions[i] = image->GetDimension(i);
+    frame.spacing[i] = image->GetGeometry()->GetSpacing()[i];
+    frame.origin[i] = image->GetGeometry()->GetOrigin()[i];
+    frameSize *= frame.dimensions[i];
+    }
+  frame.timestamp = m_SystemTimeClock->GetCurrentStamp();
+
+  //only the first time step is recorded, it is located at the start of the image data
+  frame.data.resize(frameSize);
+  mitk::ImageReadAccessor accessor(image);
+  std::memcpy(frame.data.data(), accessor.GetData(), frameSize);
+
+  m_RecordingMutex.Lock();
+  m_QueuedFrames.push_back(index);
+  m_RecordingCondition->Signal();
+  m_RecordingMutex.Unlock();
+
+  m_NumberOfRecordedFrames++;
+}
+
+ITK_THREAD_RETURN_TYPE mitk::USImageLoggingFilter::RecordingThread(void* pInfoStruct)
+{
+  /* extract this pointer from Thread Info structure */
+  struct itk::MultiThreader::ThreadInfoStruct* pInfo =
+    (struct itk::MultiThreader::ThreadInfoStruct*)pInfoStruct;
+  mitk::USImageLoggingFilter* filter = (mitk::USImageLoggingFilter*)pInfo->UserData;
+
+  while (true)
+    {
+    filter->m_RecordingMutex.Lock();
+    while (filter->m_QueuedFrames.empty() && !filter->m_StopRecording)
+      {
+      filter->m_RecordingCondition->Wait(&filter->m_RecordingMutex);
+      }
+    if (filter->m_QueuedFrames.empty())
+      {
+      filter->m_RecordingMutex.Unlock();
+      break;
+      }
+    unsigned int index = filter->m_QueuedFrames.front();
+    filter->m_QueuedFrames.pop_front();
+    bool failed = !filter->m_RecordingError.empty();
+    filter->m_RecordingMutex.Unlock();
+
+    //after an error the remaining frames are discarded
+    if (!failed)
+      {
+      try
+        {
+        filter->m_RecordingWriter.WriteFrame(filter->m_FramePool[index]);
+        }
+      catch (const mitk::Exception& e)
+        {
+        MITK_ERROR << e.GetDescription();
+        filter->m_RecordingMutex.Lock();
+        filter->m_RecordingError = e.GetDescription();
+        filter->m_RecordingMutex.Unlock();
+        }
+      }
+
+    filter->m_RecordingMutex.Lock();
+    filter->m_FreeFrames.push_back(index);
+    filter->m_RecordingMutex.Unlock();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
@@ -21,7 +21,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkUSExports.h>
 #include <mitkImageToImageFilter.h>
 #include <mitkRealTimeClock.h>
+#include "mitkUSImageRecordingWriter.h"
 
+// ITK
+#include <itkConditionVariable.h>
+#include <itkMultiThreader.h>
+#include <itkSimpleMutexLock.h>
+
+// STL
+#include <deque>
+#include <memory>
 
 namespace mitk {
   /** An object of this class is a filter which saves/logs a clone of the current image whenever
@@ -29,6 +38,10 @@ namespace mitk {
    *  add messages. All data (images, timestamps and messages) is written to the harddisc when
    *  the method SaveImages(...) is called.
    *
+   *  For long sessions the images can be streamed to disk instead (see StartRecording(...)). The
+   *  images are then copied into a bounded pool of preallocated frames and written to one recording
+   *  file by a background thread. Recordings can be played back by the mitk::USImageRecordingSource.
+   *
    *  Caution: only supports logging of one input at the moment, multiple inputs are ignored!
    *
    *  \ingroup US
@@ -76,6 +89,28 @@ namespace mitk {
      */
     bool SetImageFilesExtension(std::string extension);
 
+    /** Starts streaming all following images to the given recording file instead of keeping them in memory.
+     *  Every image is copied into one of framePoolSize preallocated frames and appended to the file by a
+     *  background thread. If the writer falls behind and all frames of the pool are in use, images are
+     *  dropped (see GetNumberOfDroppedFrames()). Messages added during the recording are stored in the
+     *  index of the recording file.
+     *  @throw mitk::Exception if a recording is already running or the file cannot be created.
+     */
+    void StartRecording(const std::string& filename, unsigned int framePoolSize = 64);
+
+    /** Stops the recording, waits until all pending images are written and appends the index to the file.
+     *  @throw mitk::Exception if an image or the index could not be written.
+     */
+    void StopRecording();
+
+    bool GetIsRecording() const;
+
+    /** @return the number of images which were written (or are still pending) in the current or last recording */
+    unsigned int GetNumberOfRecordedFrames() const;
+
+    /** @return the number of images which were dropped in the current or last recording */
+    unsigned int GetNumberOfDroppedFrames() const;
+
 
   protected:
     USImageLoggingFilter();
@@ -89,6 +124,29 @@ namespace mitk {
     std::vector<double> m_LoggedMITKSystemTimes; ///< Logged system times for every logged image
     std::string m_ImageExtension; ///< stores the image extension, default is ".nrrd"
 
+    /** Copies the image into a free frame of the pool and queues it for the recording thread. */
+    void RecordImage(const mitk::Image* image);
+
+    /** Writes the queued frames until the recording is stopped. */
+    static ITK_THREAD_RETURN_TYPE RecordingThread(void* pInfoStruct);
+
+    //members for streaming recording
+    USImageRecordingWriter m_RecordingWriter;
+    std::vector<USImageRecordingWriter::Frame> m_FramePool; ///< preallocated frames, owned by the recording thread while queued
+    std::vector<unsigned int> m_FreeFrames;                ///< pool indices of the frames which can be filled
+    std::deque<unsigned int> m_QueuedFrames;               ///< pool indices of the frames which wait to be written
+    std::map<int, std::string> m_RecordedMessages;         ///< messages of the recorded images
+    std::unique_ptr<mitk::PixelType> m_RecordingPixelType; ///< pixel type of the first recorded image
+    itk::SimpleMutexLock m_RecordingMutex;                 ///< guards the frame lists, the stop flag and the error
+    itk::ConditionVariable::Pointer m_RecordingCondition;  ///< signals queued frames and stop requests
+    itk::MultiThreader::Pointer m_MultiThreader;
+    int m_RecordingThreadID;
+    bool m_IsRecording;
+    bool m_StopRecording;
+    unsigned int m_NumberOfRecordedFrames;
+    unsigned int m_NumberOfDroppedFrames;
+    std::string m_RecordingError;                          ///< first write error of the recording thread
+
   };
 } // namespace mitk
 #endif /* MITKUSImageSource_H_HEADER_INCLUDED_ */
@@ -0,0 +1,318 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageRecordingSource.h"
+#include "mitkUSImageRecordingWriter.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkImageIOBase.h>
+
+#include <algorithm>
+
+namespace
+{
+  template <typename T>
+  bool ReadValue(std::istream& stream, T& value)
+  {
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return stream.good();
+  }
+
+  // size of a frame record without the pixel data
+  const unsigned long long FrameRecordHeaderSize = 4 + 3 * 4 + 3 * 8 + 3 * 8 + 8 + 8;
+
+  // size of the file header
+  const unsigned long long FileHeaderSize = 8 + 5 * 4;
+
+  // guards against reading garbage from a damaged file
+  const unsigned int MaximumMessageLength = 1 << 24;
+
+  /** Only used to create a mitk::PixelType from the stored ITK component and pixel type. */
+  class PixelTypeImageIO : public itk::ImageIOBase
+  {
+  public:
+    typedef PixelTypeImageIO Self;
+    typedef itk::SmartPointer<Self> Pointer;
+    itkNewMacro(Self);
+
+    virtual bool CanReadFile(const char*) override { return false; }
+    virtual void ReadImageInformation() override {}
+    virtual void Read(void*) override {}
+    virtual bool CanWriteFile(const char*) override { return false; }
+    virtual void WriteImageInformation() override {}
+    virtual void Write(const void*) override {}
+  };
+}
+
+mitk::USImageRecordingSource::USImageRecordingSource()
+  : m_StreamMutex(itk::FastMutexLock::New()),
+    m_ComponentType(0),
+    m_PixelType(0),
+    m_NumberOfComponents(0),
+    m_BytesPerComponent(0),
+    m_CurrentFrame(0)
+{
+}
+
+mitk::USImageRecordingSource::~USImageRecordingSource()
+{
+  this->Close();
+}
+
+void mitk::USImageRecordingSource::Open(const std::string& filename)
+{
+  this->Close();
+
+  m_StreamMutex->Lock();
+
+  m_Stream.open(filename.c_str(), std::ios::binary);
+  if (!m_Stream.is_open())
+  {
+    m_StreamMutex->Unlock();
+    mitkThrow() << "Cannot open recording file " << filename << "!";
+  }
+
+  m_Stream.seekg(0, std::ios::end);
+  unsigned long long fileSize = static_cast<unsigned long long>(m_Stream.tellg());
+  m_Stream.seekg(0, std::ios::beg);
+
+  char magic[sizeof(USImageRecordingWriter::FileMagic)];
+  m_Stream.read(magic, sizeof(magic));
+  unsigned int version = 0;
+  if (!m_Stream.good() ||
+      !std::equal(magic, magic + sizeof(magic), USImageRecordingWriter::FileMagic) ||
+      !ReadValue(m_Stream, version) || version != USImageRecordingWriter::FileVersion ||
+      !ReadValue(m_Stream, m_ComponentType) || !ReadValue(m_Stream, m_PixelType) ||
+      !ReadValue(m_Stream, m_NumberOfComponents) || !ReadValue(m_Stream, m_BytesPerComponent))
+  {
+    m_Stream.close();
+    m_StreamMutex->Unlock();
+    mitkThrow() << filename << " is no valid ultrasound recording file!";
+  }
+
+  // the index is appended when the recording is closed, followed by its offset and the index magic
+  bool indexRead = false;
+  if (fileSize >= FileHeaderSize + sizeof(unsigned long long) + sizeof(USImageRecordingWriter::IndexMagic))
+  {
+    unsigned long long indexOffset = 0;
+    char indexMagic[sizeof(USImageRecordingWriter::IndexMagic)];
+    m_Stream.seekg(fileSize - sizeof(indexOffset) - sizeof(indexMagic));
+    ReadValue(m_Stream, indexOffset);
+    m_Stream.read(indexMagic, sizeof(indexMagic));
+
+    unsigned int tag = 0;
+    unsigned long long numberOfFrames = 0;
+    if (m_Stream.good() &&
+        std::equal(indexMagic, indexMagic + sizeof(indexMagic), USImageRecordingWriter::IndexMagic) &&
+        indexOffset >= FileHeaderSize && indexOffset < fileSize &&
+        m_Stream.seekg(indexOffset) && ReadValue(m_Stream, tag) && tag == USImageRecordingWriter::IndexTag &&
+        ReadValue(m_Stream, numberOfFrames) && numberOfFrames <= fileSize / FrameRecordHeaderSize)
+    {
+      indexRead = true;
+      for (unsigned long long i = 0; i < numberOfFrames && indexRead; ++i)
+      {
+        unsigned long long offset = 0;
+        double timestamp = 0;
+        indexRead = ReadValue(m_Stream, offset) && ReadValue(m_Stream, timestamp);
+        m_FrameOffsets.push_back(offset);
+        m_FrameTimestamps.push_back(timestamp);
+      }
+
+      unsigned long long numberOfMessages = 0;
+      indexRead = indexRead && ReadValue(m_Stream, numberOfMessages);
+      for (unsigned long long i = 0; i < numberOfMessages && indexRead; ++i)
+      {
+        int frame = 0;
+        unsigned int length = 0;
+        indexRead = ReadValue(m_Stream, frame) && ReadValue(m_Stream, length) && length <= MaximumMessageLength;
+        if (indexRead)
+        {
+          std::string message(length, '\0');
+          if (length > 0)
+          {
+            m_Stream.read(&message[0], length);
+          }
+          indexRead = m_Stream.good();
+          m_FrameMessages[frame] = message;
+        }
+      }
+    }
+  }
+
+  if (!indexRead)
+  {
+    MITK_WARN << "Recording file " << filename << " has no valid index, it was probably not closed properly. "
+              << "Reading all complete frames.";
+    m_FrameOffsets.clear();
+    m_FrameTimestamps.clear();
+    m_FrameMessages.clear();
+    this->ScanFrames(fileSize);
+  }
+
+  m_Stream.clear();
+  m_CurrentFrame = 0;
+
+  m_StreamMutex->Unlock();
+}
+
+void mitk::USImageRecordingSource::ScanFrames(unsigned long long fileSize)
+{
+  m_Stream.clear();
+
+  unsigned long long offset = FileHeaderSize;
+  while (offset + FrameRecordHeaderSize <= fileSize)
+  {
+    m_Stream.seekg(offset);
+
+    unsigned int tag = 0;
+    if (!ReadValue(m_Stream, tag) || tag != USImageRecordingWriter::FrameTag)
+    {
+      break;
+    }
+
+    // skip dimensions, spacing and origin
+    m_Stream.seekg(3 * 4 + 3 * 8 + 3 * 8, std::ios::cur);
+    double timestamp = 0;
+    unsigned long long dataSize = 0;
+    if (!ReadValue(m_Stream, timestamp) || !ReadValue(m_Stream, dataSize) ||
+        dataSize > fileSize - offset - FrameRecordHeaderSize)
+    {
+      break;
+    }
+
+    m_FrameOffsets.push_back(offset);
+    m_FrameTimestamps.push_back(timestamp);
+    offset += FrameRecordHeaderSize + dataSize;
+  }
+}
+
+void mitk::USImageRecordingSource::Close()
+{
+  m_StreamMutex->Lock();
+  if (m_Stream.is_open())
+  {
+    m_Stream.close();
+  }
+  m_Stream.clear();
+  m_FrameOffsets.clear();
+  m_FrameTimestamps.clear();
+  m_FrameMessages.clear();
+  m_CurrentFrame = 0;
+  m_StreamMutex->Unlock();
+}
+
+bool mitk::USImageRecordingSource::GetIsOpen() const
+{
+  return m_Stream.is_open();
+}
+
+unsigned int mitk::USImageRecordingSource::GetNumberOfFrames() const
+{
+  return static_cast<unsigned int>(m_FrameOffsets.size());
+}
+
+mitk::Image::Pointer mitk::USImageRecordingSource::GetFrame(unsigned int frame)
+{
+  if (frame >= m_FrameOffsets.size())
+  {
+    mitkThrow() << "Invalid frame number " << frame << ", the recording has " << m_FrameOffsets.size() << " frames!";
+  }
+
+  unsigned int dimensions[3];
+  mitk::Vector3D spacing;
+  mitk::Point3D origin;
+  double timestamp = 0;
+  unsigned long long dataSize = 0;
+  unsigned int tag = 0;
+
+  m_StreamMutex->Lock();
+  m_Stream.clear();
+  m_Stream.seekg(m_FrameOffsets[frame]);
+  bool good = ReadValue(m_Stream, tag) && tag == USImageRecordingWriter::FrameTag;
+  for (int i = 0; i < 3 && good; ++i)
+    good = ReadValue(m_Stream, dimensions[i]);
+  for (int i = 0; i < 3 && good; ++i)
+    good = ReadValue(m_Stream, spacing[i]);
+  for (int i = 0; i < 3 && good; ++i)
+    good = ReadValue(m_Stream, origin[i]);
+  good = good && ReadValue(m_Stream, timestamp) && ReadValue(m_Stream, dataSize) &&
+         dataSize == static_cast<unsigned long long>(dimensions[0]) * dimensions[1] * dimensions[2] *
+                       m_NumberOfComponents * m_BytesPerComponent;
+  if (!good)
+  {
+    m_StreamMutex->Unlock();
+    mitkThrow() << "Cannot read frame " << frame << " of the recording!";
+  }
+
+  PixelTypeImageIO::Pointer pixelTypeIO = PixelTypeImageIO::New();
+  pixelTypeIO->SetComponentType(static_cast<itk::ImageIOBase::IOComponentType>(m_ComponentType));
+  pixelTypeIO->SetPixelType(static_cast<itk::ImageIOBase::IOPixelType>(m_PixelType));
+  pixelTypeIO->SetNumberOfComponents(m_NumberOfComponents);
+
+  mitk::Image::Pointer image = mitk::Image::New();
+  image->Initialize(mitk::MakePixelType(pixelTypeIO.GetPointer()), dimensions[2] > 1 ? 3 : 2, dimensions);
+  image->SetSpacing(spacing);
+  image->SetOrigin(origin);
+
+  {
+    mitk::ImageWriteAccessor accessor(image);
+    m_Stream.read(static_cast<char*>(accessor.GetData()), dataSize);
+  }
+  good = m_Stream.good();
+  m_StreamMutex->Unlock();
+
+  if (!good)
+  {
+    mitkThrow() << "Cannot read frame " << frame << " of the recording!";
+  }
+
+  return image;
+}
+
+double mitk::USImageRecordingSource::GetFrameTimestamp(unsigned int frame) const
+{
+  return frame < m_FrameTimestamps.size() ? m_FrameTimestamps[frame] : 0;
+}
+
+std::string mitk::USImageRecordingSource::GetFrameMessage(unsigned int frame) const
+{
+  std::map<int, std::string>::const_iterator it = m_FrameMessages.find(static_cast<int>(frame));
+  return it == m_FrameMessages.end() ? std::string() : it->second;
+}
+
+void mitk::USImageRecordingSource::SetCurrentFrame(unsigned int frame)
+{
+  m_CurrentFrame = frame;
+}
+
+void mitk::USImageRecordingSource::GetNextRawImage(mitk::Image::Pointer& image)
+{
+  if (m_FrameOffsets.empty())
+  {
+    image = nullptr;
+    return;
+  }
+
+  if (m_CurrentFrame >= m_FrameOffsets.size())
+  {
+    m_CurrentFrame = 0;
+  }
+
+  image = this->GetFrame(m_CurrentFrame);
+  ++m_CurrentFrame;
+}
@@ -0,0 +1,106 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageRecordingSource_H_HEADER_INCLUDED_
+#define MITKUSImageRecordingSource_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+#include "mitkUSImageSource.h"
+
+// ITK
+#include <itkFastMutexLock.h>
+
+// STL
+#include <fstream>
+#include <map>
+
+namespace mitk {
+  /**
+    * \brief Plays back a recording file written by the mitk::USImageLoggingFilter
+    * (see mitk::USImageRecordingWriter for the file format).
+    *
+    * Frames are read from disk on demand. Every call of GetNextImage() delivers the next
+    * frame of the recording, after the last frame the playback starts again at the first one.
+    * Timestamps and messages of the frames are available by the frame number.
+    *
+    * \ingroup US
+    */
+  class MITKUS_EXPORT USImageRecordingSource : public mitk::USImageSource
+  {
+  public:
+    mitkClassMacro(USImageRecordingSource, USImageSource);
+    itkFactorylessNewMacro(Self)
+    itkCloneMacro(Self)
+
+    /**
+      * \brief Opens a recording file. Recordings which were not closed properly are read
+      * up to the last complete frame, their messages are lost.
+      * @throw mitk::Exception if the file cannot be read or is no recording file
+      */
+    void Open(const std::string& filename);
+
+    void Close();
+
+    bool GetIsOpen() const;
+
+    unsigned int GetNumberOfFrames() const;
+
+    /**
+      * \brief Reads the given frame of the recording.
+      * @throw mitk::Exception if the frame number is invalid or the frame cannot be read
+      */
+    mitk::Image::Pointer GetFrame(unsigned int frame);
+
+    /** \return the MITK system timestamp of the frame (see mitk::RealTimeClock) */
+    double GetFrameTimestamp(unsigned int frame) const;
+
+    /** \return the message of the frame or an empty string if there is none */
+    std::string GetFrameMessage(unsigned int frame) const;
+
+    /** \brief Sets the frame which is delivered by the next call of GetNextImage(). */
+    void SetCurrentFrame(unsigned int frame);
+    itkGetConstMacro(CurrentFrame, unsigned int);
+
+  protected:
+    USImageRecordingSource();
+    virtual ~USImageRecordingSource();
+
+    /**
+      * \brief Reads the current frame and advances to the next one. The image is null
+      * if no recording is open.
+      */
+    virtual void GetNextRawImage(mitk::Image::Pointer& image) override;
+
+    /** \brief Rebuilds the frame index of a recording without index by scanning all frame records. */
+    void ScanFrames(unsigned long long fileSize);
+
+    std::ifstream m_Stream;
+    itk::FastMutexLock::Pointer m_StreamMutex;
+
+    int m_ComponentType;
+    int m_PixelType;
+    unsigned int m_NumberOfComponents;
+    unsigned int m_BytesPerComponent;
+
+    std::vector<unsigned long long> m_FrameOffsets;
+    std::vector<double> m_FrameTimestamps;
+    std::map<int, std::string> m_FrameMessages;
+
+    unsigned int m_CurrentFrame;
+  };
+} // namespace mitk
+#endif /* MITKUSImageRecordingSource_H_HEADER_INCLUDED_ */
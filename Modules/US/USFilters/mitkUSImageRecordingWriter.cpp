@@ -0,0 +1,152 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageRecordingWriter.h"
+#include <mitkExceptionMacro.h>
+
+namespace
+{
+  template <typename T>
+  void WriteValue(std::ostream& stream, T value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+}
+
+// "MITKUSRC" at the start and "MITKUSRI" at the end of the file
+const char mitk::USImageRecordingWriter::FileMagic[8] = { 'M', 'I', 'T', 'K', 'U', 'S', 'R', 'C' };
+const char mitk::USImageRecordingWriter::IndexMagic[8] = { 'M', 'I', 'T', 'K', 'U', 'S', 'R', 'I' };
+const unsigned int mitk::USImageRecordingWriter::FileVersion = 1;
+const unsigned int mitk::USImageRecordingWriter::FrameTag = 0x4D415246; // "FRAM"
+const unsigned int mitk::USImageRecordingWriter::IndexTag = 0x58444E49; // "INDX"
+
+mitk::USImageRecordingWriter::USImageRecordingWriter() : m_HeaderWritten(false)
+{
+}
+
+mitk::USImageRecordingWriter::~USImageRecordingWriter()
+{
+}
+
+void mitk::USImageRecordingWriter::Open(const std::string& filename)
+{
+  if (m_Stream.is_open())
+  {
+    mitkThrow() << "Recording file " << m_Filename << " is still open!";
+  }
+
+  m_Stream.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!m_Stream.is_open())
+  {
+    mitkThrow() << "Cannot create recording file " << filename << "!";
+  }
+
+  m_Filename = filename;
+  m_HeaderWritten = false;
+  m_FrameOffsets.clear();
+  m_FrameTimestamps.clear();
+}
+
+void mitk::USImageRecordingWriter::WriteFrame(const Frame& frame)
+{
+  if (!m_Stream.is_open())
+  {
+    mitkThrow() << "No recording file is open!";
+  }
+
+  if (!m_HeaderWritten)
+  {
+    m_Stream.write(FileMagic, sizeof(FileMagic));
+    WriteValue(m_Stream, FileVersion);
+    WriteValue(m_Stream, frame.componentType);
+    WriteValue(m_Stream, frame.pixelType);
+    WriteValue(m_Stream, frame.numberOfComponents);
+    WriteValue(m_Stream, frame.bytesPerComponent);
+    m_HeaderWritten = true;
+  }
+
+  unsigned long long offset = static_cast<unsigned long long>(m_Stream.tellp());
+
+  WriteValue(m_Stream, FrameTag);
+  for (int i = 0; i < 3; ++i)
+    WriteValue(m_Stream, frame.dimensions[i]);
+  for (int i = 0; i < 3; ++i)
+    WriteValue(m_Stream, frame.spacing[i]);
+  for (int i = 0; i < 3; ++i)
+    WriteValue(m_Stream, frame.origin[i]);
+  WriteValue(m_Stream, frame.timestamp);
+  WriteValue<unsigned long long>(m_Stream, frame.data.size());
+  m_Stream.write(frame.data.data(), frame.data.size());
+
+  if (!m_Stream.good())
+  {
+    mitkThrow() << "Cannot write frame " << m_FrameOffsets.size() << " to recording file " << m_Filename << "!";
+  }
+
+  m_FrameOffsets.push_back(offset);
+  m_FrameTimestamps.push_back(frame.timestamp);
+}
+
+void mitk::USImageRecordingWriter::Close(const std::map<int, std::string>& messages)
+{
+  if (!m_Stream.is_open())
+  {
+    return;
+  }
+
+  // the index is only useful if there is at least one frame, i.e. a header
+  if (m_HeaderWritten)
+  {
+    unsigned long long indexOffset = static_cast<unsigned long long>(m_Stream.tellp());
+
+    WriteValue(m_Stream, IndexTag);
+    WriteValue<unsigned long long>(m_Stream, m_FrameOffsets.size());
+    for (size_t i = 0; i < m_FrameOffsets.size(); ++i)
+    {
+      WriteValue(m_Stream, m_FrameOffsets[i]);
+      WriteValue(m_Stream, m_FrameTimestamps[i]);
+    }
+
+    WriteValue<unsigned long long>(m_Stream, messages.size());
+    for (const auto& message : messages)
+    {
+      WriteValue(m_Stream, message.first);
+      WriteValue<unsigned int>(m_Stream, static_cast<unsigned int>(message.second.size()));
+      m_Stream.write(message.second.data(), message.second.size());
+    }
+
+    WriteValue(m_Stream, indexOffset);
+    m_Stream.write(IndexMagic, sizeof(IndexMagic));
+  }
+
+  bool good = m_Stream.good();
+  m_Stream.close();
+
+  if (!good)
+  {
+    mitkThrow() << "Cannot write index of recording file " << m_Filename << "!";
+  }
+}
+
+bool mitk::USImageRecordingWriter::IsOpen() const
+{
+  return m_Stream.is_open();
+}
+
+unsigned int mitk::USImageRecordingWriter::GetNumberOfFrames() const
+{
+  return static_cast<unsigned int>(m_FrameOffsets.size());
+}
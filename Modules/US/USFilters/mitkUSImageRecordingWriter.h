@@ -0,0 +1,96 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageRecordingWriter_H_HEADER_INCLUDED_
+#define MITKUSImageRecordingWriter_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+
+// STL
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mitk {
+  /** Writes an ultrasound image stream to one append-only recording file, which can be played back by the
+   *  mitk::USImageRecordingSource. The file consists of
+   *   - a header with the pixel type of all frames,
+   *   - one record per frame with its dimensions, spacing, origin, timestamp and pixel data,
+   *   - an index of all frame offsets, timestamps and messages, which is appended by Close().
+   *
+   *  Frames are written to disk directly. If the recording is not closed properly, the index is missing but all
+   *  completely written frames can still be read by scanning the frame records.
+   *
+   *  \ingroup US
+   */
+  class MITKUS_EXPORT USImageRecordingWriter
+  {
+  public:
+
+    /** One frame of the recording, all frames of a recording must have the same pixel type. */
+    struct Frame
+    {
+      int componentType;                ///< itk::ImageIOBase::IOComponentType
+      int pixelType;                    ///< itk::ImageIOBase::IOPixelType
+      unsigned int numberOfComponents;
+      unsigned int bytesPerComponent;
+      unsigned int dimensions[3];
+      double spacing[3];
+      double origin[3];
+      double timestamp;
+      std::vector<char> data;
+    };
+
+    static const char FileMagic[8];
+    static const char IndexMagic[8];
+    static const unsigned int FileVersion;
+    static const unsigned int FrameTag;
+    static const unsigned int IndexTag;
+
+    USImageRecordingWriter();
+    ~USImageRecordingWriter();
+
+    /** Creates the recording file, an existing file is replaced.
+     *  @throw mitk::Exception if the file cannot be created.
+     */
+    void Open(const std::string& filename);
+
+    /** Appends a frame. The header is written together with the first frame.
+     *  @throw mitk::Exception if the frame cannot be written.
+     */
+    void WriteFrame(const Frame& frame);
+
+    /** Appends the index with the given messages (by frame number) and closes the file.
+     *  @throw mitk::Exception if the index cannot be written.
+     */
+    void Close(const std::map<int, std::string>& messages);
+
+    bool IsOpen() const;
+
+    unsigned int GetNumberOfFrames() const;
+
+  private:
+
+    std::ofstream m_Stream;
+    std::string m_Filename;
+    bool m_HeaderWritten;
+    std::vector<unsigned long long> m_FrameOffsets;
+    std::vector<double> m_FrameTimestamps;
+  };
+} // namespace mitk
+#endif /* MITKUSImageRecordingWriter_H_HEADER_INCLUDED_ */
@@ -14,74 +14,454 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <thread>
 
 #include "mbilog.h"
 
 static std::list<mbilog::BackendBase *> backends;
 static std::set<mbilog::OutputType> disabledBackendTypes;
 
+// guards the backends, recursive because backends may emit messages themselves
+static std::recursive_mutex backendMutex;
+
 namespace mbilog
 {
   static const std::string NA_STRING = "n/a";
 }
 
+namespace
+{
+  /** \brief A log message which owns all of its data, so that it can be stored in the buffer. */
+  struct LogRecord
+  {
+    int level;
+    const char *filePath;
+    int lineNumber;
+    const char *functionName;
+    const char *moduleName;
+    std::string category;
+    std::string message;
+  };
+
+  /** \brief Bounded buffer for several emitting threads and one processing thread (D. Vyukov's bounded queue).
+   *
+   *  Each slot has a sequence number, which tells the emitting threads whether the slot is free for position
+   *  and the processing thread whether the slot is filled. Emitting threads only compete for the position by
+   *  compare and swap, no lock is involved.
+   */
+  class LogRecordBuffer
+  {
+  public:
+    explicit LogRecordBuffer(std::size_t size) : m_Mask(0), m_PushPosition(0), m_PopPosition(0)
+    {
+      std::size_t capacity = 2;
+      while (capacity < size)
+        capacity *= 2;
+      m_Mask = capacity - 1;
+      m_Slots.reset(new Slot[capacity]);
+      for (std::size_t i = 0; i < capacity; ++i)
+        m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /** \brief Moves the message into the buffer, false if the buffer is full. */
+    bool TryPush(mbilog::LogMessage &l)
+    {
+      Slot *slot;
+      std::size_t position = m_PushPosition.load(std::memory_order_relaxed);
+      while (true)
+      {
+        slot = &m_Slots[position & m_Mask];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0)
+        {
+          if (m_PushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (difference < 0)
+        {
+          return false;
+        }
+        else
+        {
+          position = m_PushPosition.load(std::memory_order_relaxed);
+        }
+      }
+
+      LogRecord &record = slot->record;
+      record.level = l.level;
+      record.filePath = l.filePath;
+      record.lineNumber = l.lineNumber;
+      record.functionName = l.functionName;
+      record.moduleName = l.moduleName;
+      record.category.swap(l.category);
+      record.message.swap(l.message);
+      slot->sequence.store(position + 1, std::memory_order_release);
+      return true;
+    }
+
+    /** \brief Takes the oldest record out of the buffer, false if the buffer is empty. Only called by one thread. */
+    bool TryPop(LogRecord &record)
+    {
+      Slot &slot = m_Slots[m_PopPosition & m_Mask];
+      if (slot.sequence.load(std::memory_order_acquire) != m_PopPosition + 1)
+        return false;
+
+      record.level = slot.record.level;
+      record.filePath = slot.record.filePath;
+      record.lineNumber = slot.record.lineNumber;
+      record.functionName = slot.record.functionName;
+      record.moduleName = slot.record.moduleName;
+      record.category.swap(slot.record.category);
+      record.message.swap(slot.record.message);
+      slot.sequence.store(m_PopPosition + m_Mask + 1, std::memory_order_release);
+      ++m_PopPosition;
+      return true;
+    }
+
+    /** \brief Number of positions taken by emitting threads so far, including slots which are still being filled. */
+    std::size_t GetPushPosition() const { return m_PushPosition.load(); }
+
+    bool IsEmpty() const
+    {
+      return m_Slots[m_PopPosition & m_Mask].sequence.load(std::memory_order_acquire) != m_PopPosition + 1;
+    }
+
+  private:
+    struct Slot
+    {
+      std::atomic<std::size_t> sequence;
+      LogRecord record;
+    };
+
+    std::unique_ptr<Slot[]> m_Slots;
+    std::size_t m_Mask;
+    std::atomic<std::size_t> m_PushPosition;
+    std::size_t m_PopPosition;
+  };
+
+  void CropMessage(std::string &message)
+  {
+    std::string::size_type i = message.find_last_not_of(" \t\f\v\n\r");
+    message = (i != std::string::npos) ? message.substr(0, i + 1) : "";
+  }
+
+  void DistributeToRegisteredBackends(mbilog::LogMessage &l);
+
+  /** \brief Owns the buffer and the thread of the asynchronous mode.
+   *
+   *  The object is never deleted, because emitting threads may still use it while the mode is disabled.
+   */
+  class AsynchronousDistributor
+  {
+  public:
+    AsynchronousDistributor(std::size_t bufferSize)
+      : m_Buffer(bufferSize),
+        m_Running(false),
+        m_Stop(false),
+        m_Policy(mbilog::Block),
+        m_EmittingThreads(0),
+        m_ProcessedPosition(0),
+        m_Dropped(0),
+        m_Sleeping(false)
+    {
+    }
+
+    void Start(mbilog::FullBufferPolicy policy)
+    {
+      // the processing thread cannot restart itself
+      if (isProcessingThread)
+        return;
+
+      m_Policy.store(policy);
+      if (m_Running.load())
+        return;
+
+      // the thread might have stopped itself
+      if (m_Thread.joinable())
+        m_Thread.join();
+
+      m_Stop.store(false);
+      m_Thread = std::thread(&AsynchronousDistributor::Run, this);
+      m_Running.store(true);
+    }
+
+    void Stop()
+    {
+      // called by a backend: the thread cannot join itself, it ends after the buffer is drained
+      if (isProcessingThread)
+      {
+        m_Running.store(false);
+        m_Stop.store(true);
+        return;
+      }
+
+      if (m_Running.load())
+      {
+        // new messages are distributed synchronously, wait for the messages which are just being pushed
+        m_Running.store(false);
+        while (m_EmittingThreads.load() > 0)
+          std::this_thread::yield();
+
+        {
+          std::lock_guard<std::mutex> lock(m_WakeMutex);
+          m_Stop.store(true);
+        }
+        m_WakeCondition.notify_one();
+      }
+
+      if (m_Thread.joinable())
+        m_Thread.join();
+    }
+
+    static bool IsProcessingThread() { return isProcessingThread; }
+
+    bool IsRunning() const { return m_Running.load(); }
+
+    /** \brief Pushes the message into the buffer, false if the message has to be distributed synchronously. */
+    bool Push(mbilog::LogMessage &l)
+    {
+      if (isProcessingThread)
+        return false;
+
+      ++m_EmittingThreads;
+      if (!m_Running.load())
+      {
+        --m_EmittingThreads;
+        return false;
+      }
+
+      while (!m_Buffer.TryPush(l))
+      {
+        if (m_Policy.load(std::memory_order_relaxed) == mbilog::Drop)
+        {
+          ++m_Dropped;
+          --m_EmittingThreads;
+          return true;
+        }
+        this->Wake();
+        std::this_thread::yield();
+      }
+      --m_EmittingThreads;
+
+      this->Wake();
+      return true;
+    }
+
+    void Flush()
+    {
+      if (isProcessingThread)
+        return;
+
+      // every position taken before this call is published eventually, the record is distributed when the
+      // processed position has passed it
+      const std::size_t pushPosition = m_Buffer.GetPushPosition();
+      while (m_Running.load() && m_ProcessedPosition.load() < pushPosition)
+      {
+        this->Wake();
+        std::this_thread::yield();
+      }
+    }
+
+    unsigned long GetNumberOfDroppedMessages() const { return m_Dropped.load(); }
+
+  private:
+    void Wake()
+    {
+      if (m_Sleeping.load())
+        m_WakeCondition.notify_one();
+    }
+
+    void Run()
+    {
+      isProcessingThread = true;
+
+      LogRecord record;
+      unsigned long reportedDropped = m_Dropped.load();
+      while (true)
+      {
+        if (m_Buffer.TryPop(record))
+        {
+          mbilog::LogMessage l(record.level, record.filePath, record.lineNumber, record.functionName);
+          l.moduleName = record.moduleName;
+          l.category.swap(record.category);
+          l.message.swap(record.message);
+          DistributeToRegisteredBackends(l);
+          ++m_ProcessedPosition;
+          continue;
+        }
+
+        const unsigned long dropped = m_Dropped.load();
+        if (dropped != reportedDropped)
+        {
+          mbilog::LogMessage l(mbilog::Warn, __FILE__, __LINE__, __FUNCTION__);
+          l.moduleName = MBILOG_MODULENAME;
+          l.message = std::to_string(dropped - reportedDropped) + " log messages were dropped, the buffer was full";
+          DistributeToRegisteredBackends(l);
+          reportedDropped = dropped;
+        }
+
+        std::unique_lock<std::mutex> lock(m_WakeMutex);
+        if (m_Stop.load() && m_Buffer.IsEmpty())
+          break;
+
+        // emitting threads do not take the mutex, so a notification might get lost and the wait is limited
+        m_Sleeping.store(true);
+        m_WakeCondition.wait_for(
+          lock, std::chrono::milliseconds(10), [this]() { return m_Stop.load() || !m_Buffer.IsEmpty(); });
+        m_Sleeping.store(false);
+      }
+    }
+
+    static thread_local bool isProcessingThread;
+
+    LogRecordBuffer m_Buffer;
+    std::thread m_Thread;
+    std::atomic<bool> m_Running;
+    std::atomic<bool> m_Stop;
+    std::atomic<mbilog::FullBufferPolicy> m_Policy;
+    std::atomic<int> m_EmittingThreads;
+    std::atomic<std::size_t> m_ProcessedPosition;
+    std::atomic<unsigned long> m_Dropped;
+    std::atomic<bool> m_Sleeping;
+    std::mutex m_WakeMutex;
+    std::condition_variable m_WakeCondition;
+  };
+
+  thread_local bool AsynchronousDistributor::isProcessingThread = false;
+
+  std::atomic<AsynchronousDistributor *> asynchronousDistributor(nullptr);
+
+  // serializes enabling and disabling the asynchronous mode
+  std::mutex asynchronousModeMutex;
+
+  void DistributeToRegisteredBackends(mbilog::LogMessage &l)
+  {
+    CropMessage(l.message);
+
+    std::lock_guard<std::recursive_mutex> lock(backendMutex);
+
+    // create dummy backend if there is no backend registered (so we have an output anyway)
+    static mbilog::BackendCout *dummyBackend = nullptr;
+
+    if (backends.empty() && (dummyBackend == nullptr))
+    {
+      dummyBackend = new mbilog::BackendCout();
+      dummyBackend->SetFull(false);
+      mbilog::RegisterBackend(dummyBackend);
+    }
+    else if ((backends.size() > 1) && (dummyBackend != nullptr))
+    {
+      // if there was added another backend remove the dummy backend and delete it
+      mbilog::UnregisterBackend(dummyBackend);
+      delete dummyBackend;
+      dummyBackend = nullptr;
+    }
+
+    // iterate through all registered images and call the ProcessMessage() methods of the backends
+    std::list<mbilog::BackendBase *>::iterator i;
+    for (i = backends.begin(); i != backends.end(); i++)
+    {
+      if (mbilog::IsBackendEnabled((*i)->GetOutputType()))
+        (*i)->ProcessMessage(l);
+    }
+  }
+}
+
 void mbilog::RegisterBackend(mbilog::BackendBase *backend)
 {
+  std::lock_guard<std::recursive_mutex> lock(backendMutex);
   backends.push_back(backend);
 }
 
 void mbilog::UnregisterBackend(mbilog::BackendBase *backend)
 {
+  // the messages emitted before are still written by the backend
+  FlushBackends();
+
+  std::lock_guard<std::recursive_mutex> lock(backendMutex);
   backends.remove(backend);
 }
 
 void mbilog::DistributeToBackends(mbilog::LogMessage &l)
 {
-  // Crop Message
-  {
-    std::string::size_type i = l.message.find_last_not_of(" \t\f\v\n\r");
-    l.message = (i != std::string::npos) ? l.message.substr(0, i + 1) : "";
-  }
+  AsynchronousDistributor *distributor = asynchronousDistributor.load();
+  if (distributor != nullptr && distributor->Push(l))
+    return;
 
-  // create dummy backend if there is no backend registered (so we have an output anyway)
-  static mbilog::BackendCout *dummyBackend = nullptr;
+  DistributeToRegisteredBackends(l);
+}
 
-  if (backends.empty() && (dummyBackend == nullptr))
-  {
-    dummyBackend = new mbilog::BackendCout();
-    dummyBackend->SetFull(false);
-    RegisterBackend(dummyBackend);
-  }
-  else if ((backends.size() > 1) && (dummyBackend != nullptr))
+void mbilog::EnableAsynchronousMode(unsigned int bufferSize, FullBufferPolicy policy)
+{
+  if (AsynchronousDistributor::IsProcessingThread())
+    return;
+
+  std::lock_guard<std::mutex> lock(asynchronousModeMutex);
+  AsynchronousDistributor *distributor = asynchronousDistributor.load();
+  if (distributor == nullptr)
   {
-    // if there was added another backend remove the dummy backend and delete it
-    UnregisterBackend(dummyBackend);
-    delete dummyBackend;
-    dummyBackend = nullptr;
+    distributor = new AsynchronousDistributor(bufferSize);
+    asynchronousDistributor.store(distributor);
   }
+  distributor->Start(policy);
+}
 
-  // iterate through all registered images and call the ProcessMessage() methods of the backends
-  std::list<mbilog::BackendBase *>::iterator i;
-  for (i = backends.begin(); i != backends.end(); i++)
+void mbilog::DisableAsynchronousMode()
+{
+  // a backend must not wait for the mutex, another thread might hold it while joining the processing thread
+  if (AsynchronousDistributor::IsProcessingThread())
   {
-    if (IsBackendEnabled((*i)->GetOutputType()))
-      (*i)->ProcessMessage(l);
+    asynchronousDistributor.load()->Stop();
+    return;
   }
+
+  std::lock_guard<std::mutex> lock(asynchronousModeMutex);
+  AsynchronousDistributor *distributor = asynchronousDistributor.load();
+  if (distributor != nullptr)
+    distributor->Stop();
+}
+
+bool mbilog::IsAsynchronousModeEnabled()
+{
+  AsynchronousDistributor *distributor = asynchronousDistributor.load();
+  return distributor != nullptr && distributor->IsRunning();
+}
+
+void mbilog::FlushBackends()
+{
+  AsynchronousDistributor *distributor = asynchronousDistributor.load();
+  if (distributor != nullptr)
+    distributor->Flush();
+}
+
+unsigned long mbilog::GetNumberOfDroppedMessages()
+{
+  AsynchronousDistributor *distributor = asynchronousDistributor.load();
+  return distributor != nullptr ? distributor->GetNumberOfDroppedMessages() : 0;
 }
 
 void mbilog::EnableBackends(OutputType type)
 {
+  std::lock_guard<std::recursive_mutex> lock(backendMutex);
   disabledBackendTypes.erase(type);
 }
 
 void mbilog::DisableBackends(OutputType type)
 {
+  std::lock_guard<std::recursive_mutex> lock(backendMutex);
   disabledBackendTypes.insert(type);
 }
 
 bool mbilog::IsBackendEnabled(OutputType type)
 {
+  std::lock_guard<std::recursive_mutex> lock(backendMutex);
   return disabledBackendTypes.find(type) == disabledBackendTypes.end();
 }
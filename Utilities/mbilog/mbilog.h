@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef _MBILOG_H
 #define _MBILOG_H
 
+#include <locale>
 #include <sstream>
 
 #include "mbilogBackendBase.h"
@@ -44,10 +45,52 @@ namespace mbilog
   void MBILOG_EXPORT UnregisterBackend(BackendBase *backend);
 
   /** \brief Distributes the given message to all registered backends. Should only be called by objects
-    *        of the class pseudo stream.
+    *        of the class pseudo stream. In asynchronous mode the message is moved into the buffer.
     */
   void MBILOG_EXPORT DistributeToBackends(LogMessage &l);
 
+  /**
+   * This enum defines what happens in asynchronous mode to a message which is emitted while the buffer is full.
+   * Block: the emitting thread waits until there is space in the buffer
+   * Drop: the message is discarded, the number of discarded messages is logged later on
+   */
+  enum MBILOG_EXPORT FullBufferPolicy
+  {
+    Block = 0,
+    Drop
+  };
+
+  /** \brief Distributes the messages to the backends on a separate thread.
+   *         The emitting threads only put the message into a buffer of bufferSize messages (rounded up to a
+   *         power of two), which does not use any lock. Messages emitted by a backend while processing a
+   *         message are distributed immediately. The processing thread is stopped by DisableAsynchronousMode(),
+   *         which should be called before the program exits, so that all messages are written.
+   *         A second call only changes the policy, the size of the buffer is kept. Calls from a backend
+   *         while it processes a message are ignored.
+   */
+  void MBILOG_EXPORT EnableAsynchronousMode(unsigned int bufferSize = 8192, FullBufferPolicy policy = Block);
+
+  /** \brief Distributes all buffered messages and stops the asynchronous mode.
+   *         Called from a backend while it processes a message, the mode is disabled for new messages at once
+   *         and the processing thread ends after the buffer is drained, without waiting for it.
+   */
+  void MBILOG_EXPORT DisableAsynchronousMode();
+
+  /**
+   * Checks wether the messages are distributed asynchronously.
+   **/
+  bool MBILOG_EXPORT IsAsynchronousModeEnabled();
+
+  /** \brief Waits until all messages emitted before are distributed to the backends. Returns immediately if
+   *         the asynchronous mode is disabled.
+   */
+  void MBILOG_EXPORT FlushBackends();
+
+  /**
+   * Returns the number of messages which were discarded because the buffer was full.
+   **/
+  unsigned long MBILOG_EXPORT GetNumberOfDroppedMessages();
+
   /**
    * Enable the output of a backend.
    **/
@@ -77,6 +120,8 @@ namespace mbilog
     inline PseudoStream(int level, const char *filePath, int lineNumber, const char *functionName)
       : disabled(false), msg(LogMessage(level, filePath, lineNumber, functionName)), ss(std::stringstream::out)
     {
+      // messages are always formatted in the "C" locale
+      ss.imbue(std::locale::classic());
     }
 
     /** \brief The message which is stored in the member ss is written to the backend. */
@@ -96,13 +141,7 @@ namespace mbilog
     {
       if (!disabled)
       {
-        std::locale C("C");
-        std::locale originalLocale = ss.getloc();
-        ss.imbue(C);
-
         ss << data;
-
-        ss.imbue(originalLocale);
       }
       return *this;
     }
@@ -113,13 +152,7 @@ namespace mbilog
     {
       if (!disabled)
       {
-        std::locale C("C");
-        std::locale originalLocale = ss.getloc();
-        ss.imbue(C);
-
         ss << data;
-
-        ss.imbue(originalLocale);
       }
       return *this;
     }
@@ -129,13 +162,7 @@ namespace mbilog
     {
       if (!disabled)
       {
-        std::locale C("C");
-        std::locale originalLocale = ss.getloc();
-        ss.imbue(C);
-
         ss << func;
-
-        ss.imbue(originalLocale);
       }
       return *this;
     }